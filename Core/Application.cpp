@@ -19,7 +19,9 @@ void Core::Dx12Application::RunApplication()
 
 	while (!this->m_window->IsClosing())
 	{
-		this->m_frameCount++;
+		// Blocks until the GPU has retired the frame that last used this frame slot.
+		this->m_framePacer->BeginFrame();
+
 		frameCounter++;
 		auto t1 = clock.now();
 		auto deltaTime = t1 - t0;
@@ -70,12 +72,9 @@ void Core::Dx12Application::RunApplication()
 		// Merge Render targets
 		this->m_swapChain->Present();
 
-		this->m_frameCounts[this->m_swapChain->GetCurrentBufferIndex()] = this->m_frameCount;
-		
-		this->m_renderDevice->ReleaseStaleDescriptors(this->m_frameCount);
-
-		// Wait on commandQueues before starting next frame
-		this->m_renderDevice->GetQueue()->WaitForFenceValue(this->m_frameFences[this->m_swapChain->GetCurrentBufferIndex()]);
+		this->m_renderDevice->FlushStaleDescriptors();
+		this->m_renderDevice->GetUploadRing()->EndFrame();
+		this->m_transientTexturePool->EndFrame();
 	}
 
 	this->Shutdown();
@@ -86,14 +85,14 @@ void Core::Dx12Application::Ininitialize()
 	this->m_window = IWindow::Create();
 	this->InitializeDx12();
 
-	this->m_frameFences.resize(NumOfBuffers);
-	this->m_frameCounts.resize(NumOfBuffers);
+	this->m_taskScheduler = std::make_unique<TaskScheduler>();
 
-	for (int i = 0; i < NumOfBuffers; i++)
-	{
-		this->m_frameFences[i] = 0;
-		this->m_frameCounts[i] = 0;
-	}
+	// The CPU can record up to m_maxFramesInFlight frames ahead of the GPU, regardless of the back buffer count.
+	this->m_framePacer = std::make_unique<FramePacer>(
+		this->m_renderDevice->GetQueue()->GetFence(),
+		this->m_maxFramesInFlight);
+
+	this->m_transientTexturePool = std::make_unique<TransientTexturePool>(this->m_renderDevice);
 
 	this->m_gui = IUserInterface::Create();
 	this->m_gui->Initialize(this->m_renderDevice, this->m_window);
@@ -101,11 +100,8 @@ void Core::Dx12Application::Ininitialize()
 
 void Core::Dx12Application::Shutdown()
 {
+	this->m_renderDevice->FlushStaleDescriptors();
 	this->m_renderDevice->Flush();
-	for (int i = 0; i < this->m_frameCounts.size(); i++)
-	{
-		this->m_renderDevice->ReleaseStaleDescriptors(this->m_frameCounts[i]);
-	}
 }
 
 void Core::Dx12Application::EndFrame()
@@ -139,7 +135,7 @@ void Core::Dx12Application::CreateSwapChain(Microsoft::WRL::ComPtr<IDXGIFactory6
 	dxgiSwapChainDesc.SampleDesc.Quality = 0;
 	dxgiSwapChainDesc.SampleDesc.Count = 1;
 	dxgiSwapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT; // Pipeline will render to this target
-	dxgiSwapChainDesc.BufferCount = 3;
+	dxgiSwapChainDesc.BufferCount = this->m_numBackBuffers;
 	dxgiSwapChainDesc.Flags = 0;
 	dxgiSwapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD; // Discard after we present.
 
@@ -158,11 +154,9 @@ void Core::Dx12Application::CreateSwapChain(Microsoft::WRL::ComPtr<IDXGIFactory6
 	ThrowIfFailed(
 		swapChain.As(&swapChain4));
 
-	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> backBuffers(NumOfBuffers);
-
 	this->m_swapChain = std::make_unique<SwapChain>(
 		swapChain4,
 		this->m_renderDevice,
-		NumOfBuffers,
+		this->m_numBackBuffers,
 		dxgiSwapChainDesc.Format);
 }
\ No newline at end of file
@@ -21,8 +21,11 @@
 #include "Dx12/PipelineStateBuilder.h"
 #include "Dx12/CommandList.h"
 #include "Dx12/GraphicResourceTypes.h"
+#include "Dx12/TransientTexturePool.h"
 
 #include "UserInterface.h"
+#include "TaskScheduler.h"
+#include "FramePacer.h"
 
 // -- STL ---
 #include <memory>
@@ -43,11 +46,15 @@ namespace Core
 		virtual void RenderScene(Dx12Texture& sceneTexture) {};
 		virtual void RenderUI() {};
 
+		// The frame is only retired once the direct queue's fence reaches fenceValue.
 		void SetCurrentFrameFence(uint64_t fenceValue)
 		{
-			this->m_frameFences[this->m_swapChain->GetCurrentBufferIndex()] = fenceValue;
+			this->m_framePacer->EndFrame(fenceValue);
 		}
 
+		// Pass to CommandQueue::ExecuteParallel to record RenderScene's draws on the workers.
+		TaskScheduler& GetTaskScheduler() { return *this->m_taskScheduler; }
+
 	private:
 		void Ininitialize();
 		void Shutdown();
@@ -60,7 +67,10 @@ namespace Core
 		void CreateSwapChain(Microsoft::WRL::ComPtr<IDXGIFactory6> dxgiFactory, IWindow* window);
 
 	protected:
-		const uint8_t NumOfBuffers = 3;
+		// Set by the derived application's constructor to change them.
+		uint32_t m_numBackBuffers = 3;
+		uint32_t m_maxFramesInFlight = 2;
+
 		std::shared_ptr<IWindow> m_window;
 
 		std::shared_ptr<Dx12RenderDevice> m_renderDevice;
@@ -68,10 +78,14 @@ namespace Core
 
 		std::unique_ptr<IUserInterface> m_gui = nullptr;
 
+		// Shared workers for loading and for recording RenderScene in parallel, see CommandQueue::ExecuteParallel.
+		std::unique_ptr<TaskScheduler> m_taskScheduler;
+
 		// -- Frame resources ---
-		std::vector<uint64_t> m_frameFences;
-		std::vector<uint64_t> m_frameCounts;
-		uint64_t m_frameCount = 0;
+		std::unique_ptr<FramePacer> m_framePacer;
+
+		// Textures that only live for part of a frame, declared and compiled by RenderScene.
+		std::unique_ptr<TransientTexturePool> m_transientTexturePool;
 	};
 }
 
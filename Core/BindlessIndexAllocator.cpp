@@ -0,0 +1,57 @@
+#include "pch.h"
+
+#include "BindlessIndexAllocator.h"
+
+using namespace Core;
+
+Core::BindlessIndexAllocator::BindlessIndexAllocator(uint32_t capacity)
+	: m_capacity(capacity)
+	, m_numUsedIndices(0)
+	, m_highWaterMark(0)
+{
+}
+
+uint32_t Core::BindlessIndexAllocator::Allocate()
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+
+	uint32_t index;
+	if (!this->m_freeIndices.empty())
+	{
+		index = this->m_freeIndices.back();
+		this->m_freeIndices.pop_back();
+	}
+	else if (this->m_numUsedIndices < this->m_capacity)
+	{
+		index = this->m_numUsedIndices++;
+	}
+	else
+	{
+		return InvalidIndex;
+	}
+
+	uint32_t numAllocated = this->m_numUsedIndices - static_cast<uint32_t>(this->m_freeIndices.size());
+	this->m_highWaterMark = std::max(this->m_highWaterMark, numAllocated);
+
+	return index;
+}
+
+void Core::BindlessIndexAllocator::Free(uint32_t index)
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+
+	LOG_CORE_ASSERT(index < this->m_numUsedIndices, "Index was never allocated");
+	this->m_freeIndices.push_back(index);
+}
+
+uint32_t Core::BindlessIndexAllocator::GetNumAllocated() const
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+	return this->m_numUsedIndices - static_cast<uint32_t>(this->m_freeIndices.size());
+}
+
+uint32_t Core::BindlessIndexAllocator::GetHighWaterMark() const
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+	return this->m_highWaterMark;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include <vector>
+
+namespace Core
+{
+	/**
+	 * Hands out indices into a fixed size table, an index stays valid until it's freed.
+	 * Indices shaders may still use in flight have to be freed through a DeferredReleaseQueue,
+	 * so they never see a different resource.
+	 * Thread safe.
+	 */
+	class BindlessIndexAllocator
+	{
+	public:
+		static constexpr uint32_t InvalidIndex = ~0u;
+
+	public:
+		explicit BindlessIndexAllocator(uint32_t capacity);
+
+		// Returns InvalidIndex if every index is in use.
+		uint32_t Allocate();
+
+		// The index can be allocated again straight away.
+		void Free(uint32_t index);
+
+		uint32_t GetCapacity() const { return this->m_capacity; }
+
+		uint32_t GetNumAllocated() const;
+
+		// The most indices that were allocated at once.
+		uint32_t GetHighWaterMark() const;
+
+	private:
+		const uint32_t m_capacity;
+
+		// Indices below this have been handed out at least once.
+		uint32_t m_numUsedIndices;
+		uint32_t m_highWaterMark;
+
+		std::vector<uint32_t> m_freeIndices;
+
+		mutable std::mutex m_mutex;
+	};
+}
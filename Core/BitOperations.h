@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Core
+{
+	/**
+	 * Bit scans on the compiler's intrinsics, so code using them builds outside of MSVC too.
+	 * The mask must not be zero.
+	 */
+	namespace BitOperations
+	{
+		// Index of the lowest set bit.
+		inline uint32_t FindLowestBit(uint32_t mask)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return static_cast<uint32_t>(index);
+#else
+			return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+		}
+
+		// Index of the highest set bit.
+		inline uint32_t FindHighestBit(uint32_t mask)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanReverse(&index, mask);
+			return static_cast<uint32_t>(index);
+#else
+			return 31u - static_cast<uint32_t>(__builtin_clz(mask));
+#endif
+		}
+	}
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Core
+{
+	/**
+	 * Table of values addressed by dense integer ids. Values live in fixed size chunks that
+	 * are never moved or freed, so a reference stays valid for the lifetime of the table and
+	 * lookups take no lock. Only handing out and recycling ids is serialized.
+	 * Access to a single entry has to be synchronized by the caller.
+	 */
+	template<class Type_, uint32_t ChunkSize_ = 1024, uint32_t MaxChunks_ = 1024>
+	class ChunkedTable
+	{
+	public:
+		static constexpr uint32_t InvalidId = ~0u;
+		static constexpr uint32_t Capacity = ChunkSize_ * MaxChunks_;
+
+	public:
+		ChunkedTable();
+		~ChunkedTable();
+
+		ChunkedTable(ChunkedTable const&) = delete;
+		ChunkedTable& operator=(ChunkedTable const&) = delete;
+
+		// Returns a recycled id if there is one, the entry is reset to value.
+		uint32_t Allocate(Type_ value = Type_());
+		void Free(uint32_t id);
+
+		Type_& operator[](uint32_t id);
+		Type_ const& operator[](uint32_t id) const;
+
+		// Number of live ids, only a snapshot while other threads allocate.
+		uint32_t Size() const { return this->m_numIds.load(std::memory_order_relaxed) - this->m_numFreeIds.load(std::memory_order_relaxed); }
+
+	private:
+		struct Chunk
+		{
+			Type_ Values[ChunkSize_];
+		};
+
+		std::atomic<Chunk*> m_chunks[MaxChunks_];
+
+		std::mutex m_allocationMutex;
+		std::vector<uint32_t> m_freeIds;
+		std::atomic_uint32_t m_numIds;
+		std::atomic_uint32_t m_numFreeIds;
+	};
+
+	template<class Type_, uint32_t ChunkSize_, uint32_t MaxChunks_>
+	inline ChunkedTable<Type_, ChunkSize_, MaxChunks_>::ChunkedTable()
+		: m_numIds(0)
+		, m_numFreeIds(0)
+	{
+		for (auto& chunk : this->m_chunks)
+		{
+			chunk.store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	template<class Type_, uint32_t ChunkSize_, uint32_t MaxChunks_>
+	inline ChunkedTable<Type_, ChunkSize_, MaxChunks_>::~ChunkedTable()
+	{
+		for (auto& chunk : this->m_chunks)
+		{
+			delete chunk.load(std::memory_order_relaxed);
+		}
+	}
+
+	template<class Type_, uint32_t ChunkSize_, uint32_t MaxChunks_>
+	inline uint32_t ChunkedTable<Type_, ChunkSize_, MaxChunks_>::Allocate(Type_ value)
+	{
+		uint32_t id;
+		{
+			std::lock_guard<std::mutex> lock(this->m_allocationMutex);
+			if (!this->m_freeIds.empty())
+			{
+				id = this->m_freeIds.back();
+				this->m_freeIds.pop_back();
+				this->m_numFreeIds.store(static_cast<uint32_t>(this->m_freeIds.size()), std::memory_order_relaxed);
+			}
+			else
+			{
+				id = this->m_numIds.load(std::memory_order_relaxed);
+				if (id == Capacity)
+				{
+					return InvalidId;
+				}
+
+				// The chunk has to be published before any thread can be handed one of its ids.
+				if (id % ChunkSize_ == 0)
+				{
+					this->m_chunks[id / ChunkSize_].store(new Chunk(), std::memory_order_release);
+				}
+
+				this->m_numIds.store(id + 1, std::memory_order_relaxed);
+			}
+		}
+
+		(*this)[id] = std::move(value);
+		return id;
+	}
+
+	template<class Type_, uint32_t ChunkSize_, uint32_t MaxChunks_>
+	inline void ChunkedTable<Type_, ChunkSize_, MaxChunks_>::Free(uint32_t id)
+	{
+		std::lock_guard<std::mutex> lock(this->m_allocationMutex);
+		this->m_freeIds.push_back(id);
+		this->m_numFreeIds.store(static_cast<uint32_t>(this->m_freeIds.size()), std::memory_order_relaxed);
+	}
+
+	template<class Type_, uint32_t ChunkSize_, uint32_t MaxChunks_>
+	inline Type_& ChunkedTable<Type_, ChunkSize_, MaxChunks_>::operator[](uint32_t id)
+	{
+		return this->m_chunks[id / ChunkSize_].load(std::memory_order_acquire)->Values[id % ChunkSize_];
+	}
+
+	template<class Type_, uint32_t ChunkSize_, uint32_t MaxChunks_>
+	inline Type_ const& ChunkedTable<Type_, ChunkSize_, MaxChunks_>::operator[](uint32_t id) const
+	{
+		return this->m_chunks[id / ChunkSize_].load(std::memory_order_acquire)->Values[id % ChunkSize_];
+	}
+}
@@ -0,0 +1,122 @@
+#include "pch.h"
+
+#include "DeferredReleaseQueue.h"
+
+using namespace Core;
+
+void Core::DeferredReleaseQueue::RegisterFence(IFence* fence, uint64_t lastSubmittedValue)
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+
+	LOG_CORE_ASSERT(
+		std::none_of(
+			this->m_fences.begin(),
+			this->m_fences.end(),
+			[fence](FenceEntry const& entry) { return entry.Fence == fence; }),
+		"Fence is already registered");
+
+	FenceEntry entry = {};
+	entry.Fence = fence;
+	entry.LastSubmittedValue = lastSubmittedValue;
+	this->m_fences.push_back(std::move(entry));
+}
+
+void Core::DeferredReleaseQueue::SetLastSubmittedValue(IFence* fence, uint64_t lastSubmittedValue)
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+	this->GetFenceEntry(fence).LastSubmittedValue = lastSubmittedValue;
+}
+
+void Core::DeferredReleaseQueue::Defer(std::function<void()> onReleased)
+{
+	// The deleter runs once the last fence drops the object, even though it's null.
+	this->Enqueue(std::shared_ptr<void>(nullptr, [onReleased](void*) { onReleased(); }));
+}
+
+void Core::DeferredReleaseQueue::ReleaseCompleted(IFence* fence)
+{
+	std::vector<std::shared_ptr<void>> releasedObjects;
+
+	{
+		std::lock_guard<std::mutex> lock(this->m_mutex);
+
+		auto& entry = this->GetFenceEntry(fence);
+		const uint64_t completedValue = fence->GetCompletedValue();
+
+		while (!entry.PendingObjects.empty() && entry.PendingObjects.front().FenceValue <= completedValue)
+		{
+			releasedObjects.push_back(std::move(entry.PendingObjects.front().Object));
+			entry.PendingObjects.pop();
+		}
+	}
+
+	// Destroyed outside the lock, releasing an object may release others.
+	releasedObjects.clear();
+}
+
+void Core::DeferredReleaseQueue::ReleaseCompleted()
+{
+	std::vector<IFence*> fences;
+
+	{
+		std::lock_guard<std::mutex> lock(this->m_mutex);
+		for (auto const& entry : this->m_fences)
+		{
+			fences.push_back(entry.Fence);
+		}
+	}
+
+	for (IFence* fence : fences)
+	{
+		this->ReleaseCompleted(fence);
+	}
+}
+
+size_t Core::DeferredReleaseQueue::GetNumPending() const
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+
+	size_t numPending = 0;
+	for (auto const& entry : this->m_fences)
+	{
+		numPending += entry.PendingObjects.size();
+	}
+
+	return numPending;
+}
+
+void Core::DeferredReleaseQueue::Enqueue(std::shared_ptr<void> object)
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+
+	// Every queue still running work gets a reference, the object lives until the slowest
+	// one is done. Checked under the lock, a completion callback that runs after this sees
+	// the entry.
+	for (auto& entry : this->m_fences)
+	{
+		if (!entry.Fence->IsComplete(entry.LastSubmittedValue))
+		{
+			entry.PendingObjects.push({ entry.LastSubmittedValue, object });
+		}
+	}
+
+	// With every queue idle nothing can use the object, it's dropped with the argument.
+}
+
+void Core::DeferredReleaseQueue::Enqueue(IFence* fence, uint64_t fenceValue, std::shared_ptr<void> object)
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+	this->GetFenceEntry(fence).PendingObjects.push({ fenceValue, std::move(object) });
+}
+
+DeferredReleaseQueue::FenceEntry& Core::DeferredReleaseQueue::GetFenceEntry(IFence* fence)
+{
+	auto iter = std::find_if(
+		this->m_fences.begin(),
+		this->m_fences.end(),
+		[fence](FenceEntry const& entry) { return entry.Fence == fence; });
+
+	LOG_CORE_ASSERT(iter != this->m_fences.end(), "Fence isn't registered");
+
+	return *iter;
+}
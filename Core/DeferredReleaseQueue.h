@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include "Fence.h"
+
+namespace Core
+{
+	/**
+	 * Keeps objects the GPU may still use alive until the fences of the queues that could
+	 * reference them have passed, e.g. descriptors, committed resources, upload pages or
+	 * pipeline states. An object is keyed either by an explicit (fence, value) pair, or by
+	 * the last value every registered queue submitted. A queue that has already reached
+	 * its last submitted value can't be using the object and doesn't hold on to it, so idle
+	 * queues that rarely signal never keep objects alive. Work submitted after the release
+	 * isn't waited on, command lists keep the objects they record alive themselves.
+	 * The queues drain it from their fence completion callbacks.
+	 * Kept free of any graphics API so the ordering can be checked with SoftwareFence.
+	 */
+	class DeferredReleaseQueue
+	{
+	public:
+		// Objects released from now on wait for the fence to reach lastSubmittedValue.
+		void RegisterFence(IFence* fence, uint64_t lastSubmittedValue);
+
+		// Called before the queue signals, with the value it signals.
+		void SetLastSubmittedValue(IFence* fence, uint64_t lastSubmittedValue);
+
+		// Destroys the object once every registered fence reaches its last submitted value.
+		template<typename T>
+		void Release(T&& object)
+		{
+			this->Enqueue(std::make_shared<std::decay_t<T>>(std::forward<T>(object)));
+		}
+
+		// Destroys the object once the fence reaches fenceValue.
+		template<typename T>
+		void Release(IFence* fence, uint64_t fenceValue, T&& object)
+		{
+			this->Enqueue(fence, fenceValue, std::make_shared<std::decay_t<T>>(std::forward<T>(object)));
+		}
+
+		// Runs onReleased once every registered fence reaches its last submitted value.
+		void Defer(std::function<void()> onReleased);
+
+		// Releases the objects whose fence values the fence has reached.
+		void ReleaseCompleted(IFence* fence);
+
+		// Releases the completed objects of every fence.
+		void ReleaseCompleted();
+
+		// Objects waiting, counted once per fence they wait on.
+		size_t GetNumPending() const;
+
+	private:
+		struct PendingObject
+		{
+			uint64_t FenceValue;
+
+			// Shared between the fences the object waits on, destroyed once the last drops it.
+			std::shared_ptr<void> Object;
+		};
+
+		struct FenceEntry
+		{
+			IFence* Fence;
+			uint64_t LastSubmittedValue;
+
+			// In release order. Submitted values only grow, an explicit value lower than the
+			// one ahead of it just waits a little longer.
+			std::queue<PendingObject> PendingObjects;
+		};
+
+		void Enqueue(std::shared_ptr<void> object);
+		void Enqueue(IFence* fence, uint64_t fenceValue, std::shared_ptr<void> object);
+
+		// Expects the mutex to be held.
+		FenceEntry& GetFenceEntry(IFence* fence);
+
+	private:
+		std::vector<FenceEntry> m_fences;
+
+		mutable std::mutex m_mutex;
+	};
+}
@@ -0,0 +1,123 @@
+#include "pch.h"
+
+#include "DescriptorTableHashCache.h"
+
+#include <cstring>
+
+using namespace Core;
+
+Core::DescriptorTableHashCache::DescriptorTableHashCache()
+	: m_buckets(InitialNumBuckets, InvalidEntry)
+	, m_numHits(0)
+	, m_numMisses(0)
+{
+}
+
+uint64_t Core::DescriptorTableHashCache::Hash(std::size_t const* handles, uint32_t numHandles)
+{
+	// FNV-1a over whole handles, handles are multiples of the increment size so the
+	// result is mixed once more before it picks a bucket.
+	uint64_t hash = 14695981039346656037ull ^ numHandles;
+	for (uint32_t i = 0; i < numHandles; ++i)
+	{
+		hash ^= static_cast<uint64_t>(handles[i]);
+		hash *= 1099511628211ull;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+uint64_t Core::DescriptorTableHashCache::Find(uint64_t hash, std::size_t const* handles, uint32_t numHandles)
+{
+	const uint64_t mask = this->m_buckets.size() - 1;
+	for (uint64_t bucket = hash & mask; this->m_buckets[bucket] != InvalidEntry; bucket = (bucket + 1) & mask)
+	{
+		Entry const& entry = this->m_entries[this->m_buckets[bucket]];
+		if (this->Matches(entry, hash, handles, numHandles))
+		{
+			this->m_numHits++;
+			return entry.Range;
+		}
+	}
+
+	this->m_numMisses++;
+	return NotFound;
+}
+
+void Core::DescriptorTableHashCache::Insert(uint64_t hash, std::size_t const* handles, uint32_t numHandles, uint64_t range)
+{
+	// Keep the load factor at or below a half so probes stay short.
+	if ((this->m_entries.size() + 1) * 2 > this->m_buckets.size())
+	{
+		this->Grow();
+	}
+
+	Entry entry = {};
+	entry.Hash = hash;
+	entry.HandlesOffset = static_cast<uint32_t>(this->m_handles.size());
+	entry.NumHandles = numHandles;
+	entry.Range = range;
+
+	this->m_handles.insert(this->m_handles.end(), handles, handles + numHandles);
+
+	const uint64_t mask = this->m_buckets.size() - 1;
+	uint64_t bucket = hash & mask;
+	while (this->m_buckets[bucket] != InvalidEntry)
+	{
+		bucket = (bucket + 1) & mask;
+	}
+
+	this->m_buckets[bucket] = static_cast<uint32_t>(this->m_entries.size());
+	this->m_entries.push_back(entry);
+}
+
+void Core::DescriptorTableHashCache::Clear()
+{
+	if (this->m_entries.empty())
+	{
+		return;
+	}
+
+	std::fill(this->m_buckets.begin(), this->m_buckets.end(), InvalidEntry);
+	this->m_entries.clear();
+	this->m_handles.clear();
+}
+
+void Core::DescriptorTableHashCache::ResetCounters()
+{
+	this->m_numHits = 0;
+	this->m_numMisses = 0;
+}
+
+bool Core::DescriptorTableHashCache::Matches(
+	Entry const& entry,
+	uint64_t hash,
+	std::size_t const* handles,
+	uint32_t numHandles) const
+{
+	return
+		entry.Hash == hash &&
+		entry.NumHandles == numHandles &&
+		std::memcmp(this->m_handles.data() + entry.HandlesOffset, handles, numHandles * sizeof(std::size_t)) == 0;
+}
+
+void Core::DescriptorTableHashCache::Grow()
+{
+	this->m_buckets.assign(this->m_buckets.size() * 2, InvalidEntry);
+
+	const uint64_t mask = this->m_buckets.size() - 1;
+	for (uint32_t i = 0; i < this->m_entries.size(); ++i)
+	{
+		uint64_t bucket = this->m_entries[i].Hash & mask;
+		while (this->m_buckets[bucket] != InvalidEntry)
+		{
+			bucket = (bucket + 1) & mask;
+		}
+
+		this->m_buckets[bucket] = i;
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+namespace Core
+{
+	/**
+	 * Maps sets of CPU descriptor handles to the GPU range they were already copied to, so a
+	 * table staged with the same descriptors again, e.g. meshes sharing a material, reuses
+	 * the range instead of being copied. Entries are only valid as long as the ranges they
+	 * point to, clear the cache when the heap is reset. Handles are compared by value, a
+	 * descriptor written in place while the cache is in use isn't noticed.
+	 * Not thread safe.
+	 */
+	class DescriptorTableHashCache
+	{
+	public:
+		static constexpr uint64_t NotFound = ~0ull;
+
+	public:
+		DescriptorTableHashCache();
+
+		static uint64_t Hash(std::size_t const* handles, uint32_t numHandles);
+
+		// Returns the range the handles were copied to, or NotFound. Counts a hit or a miss.
+		uint64_t Find(uint64_t hash, std::size_t const* handles, uint32_t numHandles);
+
+		void Insert(uint64_t hash, std::size_t const* handles, uint32_t numHandles, uint64_t range);
+
+		// Drops every entry, the counters are kept.
+		void Clear();
+
+		uint32_t GetNumEntries() const { return static_cast<uint32_t>(this->m_entries.size()); }
+
+		uint64_t GetNumHits() const { return this->m_numHits; }
+		uint64_t GetNumMisses() const { return this->m_numMisses; }
+		void ResetCounters();
+
+	private:
+		static constexpr uint32_t InvalidEntry = ~0u;
+		static constexpr uint32_t InitialNumBuckets = 256;
+
+		struct Entry
+		{
+			uint64_t Hash;
+			uint32_t HandlesOffset;
+			uint32_t NumHandles;
+			uint64_t Range;
+		};
+
+		bool Matches(Entry const& entry, uint64_t hash, std::size_t const* handles, uint32_t numHandles) const;
+
+		// Doubles the bucket count and reinserts the entries.
+		void Grow();
+
+	private:
+		// Open addressing with linear probing, a power of two of entry indices.
+		std::vector<uint32_t> m_buckets;
+		std::vector<Entry> m_entries;
+
+		// The handles of all entries back to back.
+		std::vector<std::size_t> m_handles;
+
+		uint64_t m_numHits;
+		uint64_t m_numMisses;
+	};
+}
@@ -4,51 +4,90 @@
 
 using namespace Core;
 
+namespace
+{
+	// Once a thread holds more discarded allocators than this, the oldest half is moved to the shared pool.
+	constexpr size_t MaxThreadLocalAllocators = 8;
+}
+
 CommandAllocatorPool::CommandAllocatorPool(
 	Microsoft::WRL::ComPtr<ID3D12Device2> device,
 	D3D12_COMMAND_LIST_TYPE type)
 	: m_type(type)
 	, m_dx12Device(device)
+	, m_numAllocators(0)
+	, m_numInUse(0)
+	, m_highWaterMark(0)
+	, m_numThreadLocalHits(0)
+	, m_numSharedHits(0)
+	, m_threadLocalAllocators([this](std::vector<DiscardedAllocator>& allocators) {
+		// The exiting thread's allocators would be stranded in its cache.
+		std::lock_guard<std::mutex> lockGuard(this->m_allocatonMutex);
+		this->m_availableAllocators.insert(
+			this->m_availableAllocators.end(),
+			allocators.begin(),
+			allocators.end());
+
+		allocators.clear();
+		})
 {
 }
 
 CommandAllocatorPool::~CommandAllocatorPool()
 {
-	std::queue<std::pair<uint64_t, ID3D12CommandAllocator*>> clearQueue;
-	std::swap(this->m_availableAllocators, clearQueue);
-
+	this->m_availableAllocators.clear();
 	this->m_allocatorPool.clear();
 }
 
 ID3D12CommandAllocator* CommandAllocatorPool::RequestAllocator(uint64_t completedFenceValue)
 {
-	std::lock_guard<std::mutex> lockGuard(this->m_allocatonMutex);
+	ID3D12CommandAllocator* pAllocator =
+		TakeCompletedAllocator(this->m_threadLocalAllocators.Get(), completedFenceValue);
 
-	ID3D12CommandAllocator* pAllocator = nullptr;
-	if (!this->m_availableAllocators.empty())
+	if (pAllocator)
 	{
-		auto& allocatorPair = this->m_availableAllocators.front();
-		if (allocatorPair.first <= completedFenceValue)
-		{
-			pAllocator = allocatorPair.second;
-			ThrowIfFailed(
-				pAllocator->Reset());
+		this->m_numThreadLocalHits++;
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lockGuard(this->m_allocatonMutex);
+		pAllocator = TakeCompletedAllocator(this->m_availableAllocators, completedFenceValue);
 
-			this->m_availableAllocators.pop();
+		if (pAllocator)
+		{
+			this->m_numSharedHits++;
 		}
 	}
 
-	if (!pAllocator)
+	if (pAllocator)
 	{
+		ThrowIfFailed(
+			pAllocator->Reset());
+	}
+	else
+	{
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
 		ThrowIfFailed(
 			this->m_dx12Device->CreateCommandAllocator(
 				this->m_type,
-				IID_PPV_ARGS(&pAllocator)));
+				IID_PPV_ARGS(&allocator)));
+
+		std::lock_guard<std::mutex> lockGuard(this->m_allocatonMutex);
 
 		wchar_t allocatorName[32];
-		swprintf(allocatorName, 32, L"CommandAllocator %zu", this->Size());
-		pAllocator->SetName(allocatorName);
-		this->m_allocatorPool.emplace_back(pAllocator);
+		swprintf(allocatorName, 32, L"CommandAllocator %zu", this->m_allocatorPool.size());
+		allocator->SetName(allocatorName);
+
+		pAllocator = allocator.Get();
+		this->m_allocatorPool.emplace_back(std::move(allocator));
+		this->m_numAllocators = this->m_allocatorPool.size();
+	}
+
+	size_t numInUse = ++this->m_numInUse;
+	size_t highWaterMark = this->m_highWaterMark;
+	while (numInUse > highWaterMark &&
+		!this->m_highWaterMark.compare_exchange_weak(highWaterMark, numInUse))
+	{
 	}
 
 	return pAllocator;
@@ -56,7 +95,55 @@ ID3D12CommandAllocator* CommandAllocatorPool::RequestAllocator(uint64_t complete
 
 void CommandAllocatorPool::DiscardAllocator(uint64_t fence, ID3D12CommandAllocator* allocator)
 {
-	std::lock_guard<std::mutex> lockGuard(this->m_allocatonMutex);
+	this->m_numInUse--;
+
+	auto& threadLocalAllocators = this->m_threadLocalAllocators.Get();
+	threadLocalAllocators.push_back({ fence, allocator });
+
+	if (threadLocalAllocators.size() > MaxThreadLocalAllocators)
+	{
+		// Hand the oldest half to the other threads.
+		auto spillEnd = threadLocalAllocators.begin() + threadLocalAllocators.size() / 2;
+
+		std::lock_guard<std::mutex> lockGuard(this->m_allocatonMutex);
+		this->m_availableAllocators.insert(
+			this->m_availableAllocators.end(),
+			threadLocalAllocators.begin(),
+			spillEnd);
+
+		threadLocalAllocators.erase(threadLocalAllocators.begin(), spillEnd);
+	}
+}
+
+CommandAllocatorPool::Statistics CommandAllocatorPool::GetStatistics() const
+{
+	Statistics statistics = {};
+	statistics.NumAllocators = this->m_numAllocators;
+	statistics.NumInUse = this->m_numInUse;
+	statistics.HighWaterMark = this->m_highWaterMark;
+	statistics.NumThreadLocalHits = this->m_numThreadLocalHits;
+	statistics.NumSharedHits = this->m_numSharedHits;
+
+	return statistics;
+}
+
+ID3D12CommandAllocator* CommandAllocatorPool::TakeCompletedAllocator(
+	std::vector<DiscardedAllocator>& allocators,
+	uint64_t completedFenceValue)
+{
+	// Any completed allocator will do, so a late fence doesn't hold back the ones behind it.
+	for (size_t i = 0; i < allocators.size(); i++)
+	{
+		if (allocators[i].FenceValue <= completedFenceValue)
+		{
+			ID3D12CommandAllocator* allocator = allocators[i].Allocator;
+
+			allocators[i] = allocators.back();
+			allocators.pop_back();
+
+			return allocator;
+		}
+	}
 
-	this->m_availableAllocators.push(std::make_pair(fence, allocator));
+	return nullptr;
 }
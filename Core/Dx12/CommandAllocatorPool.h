@@ -3,17 +3,34 @@
 #include <memory>
 
 #include <vector>
-#include <queue>
+#include <atomic>
 #include <mutex>
 #include <wrl.h>
 
 #include "d3dx12.h"
 
+#include "InstanceThreadLocal.h"
 
 namespace Core
 {
+	/**
+	 * Command allocators discarded by a thread are kept in a per thread cache and handed back
+	 * to the same thread without locking. The shared pool is only used on a miss, when a
+	 * thread's cache overflows or when the thread exits. Any allocator whose fence has
+	 * completed can be reused, not only the oldest one.
+	 */
 	class CommandAllocatorPool
 	{
+	public:
+		struct Statistics
+		{
+			size_t NumAllocators;       // Allocators created by the pool.
+			size_t NumInUse;            // Allocators requested and not yet discarded.
+			size_t HighWaterMark;       // Most allocators that were in use at once.
+			uint64_t NumThreadLocalHits;
+			uint64_t NumSharedHits;
+		};
+
 	public:
 		CommandAllocatorPool(
 			Microsoft::WRL::ComPtr<ID3D12Device2> device,
@@ -23,16 +40,36 @@ namespace Core
 		ID3D12CommandAllocator* RequestAllocator(uint64_t completedFenceValue);
 		void DiscardAllocator(uint64_t fence, ID3D12CommandAllocator* allocator);
 
+		Statistics GetStatistics() const;
+
+		inline size_t Size() { return this->m_numAllocators; }
+
+	private:
+		struct DiscardedAllocator
+		{
+			uint64_t FenceValue;
+			ID3D12CommandAllocator* Allocator;
+		};
 
-		inline size_t Size() { return this->m_allocatorPool.size(); }
+		static ID3D12CommandAllocator* TakeCompletedAllocator(
+			std::vector<DiscardedAllocator>& allocators,
+			uint64_t completedFenceValue);
 
 	private:
 		const D3D12_COMMAND_LIST_TYPE m_type;
 		Microsoft::WRL::ComPtr<ID3D12Device2> m_dx12Device;
 
 		std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> m_allocatorPool;
-		std::queue<std::pair<uint64_t, ID3D12CommandAllocator*>> m_availableAllocators;
-		std::mutex m_allocatonMutex;
+		std::vector<DiscardedAllocator> m_availableAllocators;
+		mutable std::mutex m_allocatonMutex;
+
+		std::atomic_size_t m_numAllocators;
+		std::atomic_size_t m_numInUse;
+		std::atomic_size_t m_highWaterMark;
+		std::atomic_uint64_t m_numThreadLocalHits;
+		std::atomic_uint64_t m_numSharedHits;
+
+		// Declared last so it's destroyed first, a thread exiting meanwhile still finds the shared pool.
+		InstanceThreadLocal<std::vector<DiscardedAllocator>> m_threadLocalAllocators;
 	};
 }
-
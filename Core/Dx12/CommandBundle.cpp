@@ -0,0 +1,141 @@
+#include "pch.h"
+
+#include "CommandBundle.h"
+
+#include "Dx12RenderDevice.h"
+#include "GraphicResourceTypes.h"
+
+using namespace Core;
+using namespace Microsoft::WRL;
+
+Core::CommandBundle::CommandBundle(
+	std::shared_ptr<Dx12RenderDevice> renderDevice,
+	ComPtr<ID3D12PipelineState> initialPipelineState)
+	: m_renderDevice(renderDevice)
+	, m_initialPipelineState(initialPipelineState)
+	, m_isClosed(false)
+{
+	this->Begin();
+}
+
+void Core::CommandBundle::Begin()
+{
+	auto device = this->m_renderDevice->GetD3DDevice();
+
+	ThrowIfFailed(
+		device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_BUNDLE, IID_PPV_ARGS(&this->m_allocator)));
+
+	ThrowIfFailed(
+		device->CreateCommandList(
+			0,
+			D3D12_COMMAND_LIST_TYPE_BUNDLE,
+			this->m_allocator.Get(),
+			this->m_initialPipelineState.Get(),
+			IID_PPV_ARGS(&this->m_commandList)));
+
+	this->m_commandList->SetName(L"Command Bundle");
+
+	this->m_pipelineStates.clear();
+	this->m_boundResources.clear();
+	this->m_isClosed = false;
+}
+
+void Core::CommandBundle::Close()
+{
+	LOG_CORE_ASSERT(!this->m_isClosed, "Bundle is already closed");
+
+	ThrowIfFailed(
+		this->m_commandList->Close());
+
+	this->m_isClosed = true;
+}
+
+bool Core::CommandBundle::IsValid() const
+{
+	if (!this->m_isClosed)
+	{
+		return false;
+	}
+
+	for (auto& boundResource : this->m_boundResources)
+	{
+		// The bundle holds the resource it recorded, its address can't be handed out again.
+		if (!boundResource.Owner->GetDx12Resource() ||
+			boundResource.Owner->GetGpuVirtualAddress() != boundResource.GpuVirtualAddress)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void Core::CommandBundle::SetPipelineState(ComPtr<ID3D12PipelineState> pipelineState)
+{
+	this->m_commandList->SetPipelineState(pipelineState.Get());
+	this->m_pipelineStates.push_back(pipelineState);
+}
+
+void Core::CommandBundle::SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY topology)
+{
+	this->m_commandList->IASetPrimitiveTopology(topology);
+}
+
+void Core::CommandBundle::SetGraphics32BitConstants(uint32_t rootParameterIndex, uint32_t numConstants, const void* constants)
+{
+	this->m_commandList->SetGraphicsRoot32BitConstants(rootParameterIndex, numConstants, constants, 0);
+}
+
+void Core::CommandBundle::SetVertexBuffer(Dx12Buffer const& vertexBuffer)
+{
+	LOG_CORE_ASSERT(vertexBuffer.GetBindings() & BIND_VERTEX_BUFFER, "Unable to bind non vertex buffer");
+
+	D3D12_VERTEX_BUFFER_VIEW view = {};
+	view.BufferLocation = vertexBuffer.GetGpuVirtualAddress();
+	view.SizeInBytes = static_cast<UINT>(vertexBuffer.GetSizeInBytes());
+	view.StrideInBytes = vertexBuffer.GetElementByteStride();
+
+	this->m_commandList->IASetVertexBuffers(0, 1, &view);
+	this->BindResource(
+		vertexBuffer,
+		vertexBuffer.IsSubAllocated() ? StaticBufferAllocator::ReadState : D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+}
+
+void Core::CommandBundle::SetIndexBuffer(Dx12Buffer const& indexBuffer)
+{
+	LOG_CORE_ASSERT(indexBuffer.GetBindings() & BIND_INDEX_BUFFER, "Unable to bind non index buffer");
+
+	D3D12_INDEX_BUFFER_VIEW view = {};
+	view.BufferLocation = indexBuffer.GetGpuVirtualAddress();
+	view.SizeInBytes = static_cast<UINT>(indexBuffer.GetSizeInBytes());
+	view.Format = indexBuffer.GetElementByteStride() == sizeof(uint32_t) ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+
+	this->m_commandList->IASetIndexBuffer(&view);
+	this->BindResource(
+		indexBuffer,
+		indexBuffer.IsSubAllocated() ? StaticBufferAllocator::ReadState : D3D12_RESOURCE_STATE_INDEX_BUFFER);
+}
+
+void Core::CommandBundle::Draw(
+	uint32_t vertexCount,
+	uint32_t instanceCount,
+	uint32_t startVertex,
+	uint32_t startInstance)
+{
+	this->m_commandList->DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+}
+
+void Core::CommandBundle::DrawIndexed(
+	uint32_t indexCount,
+	uint32_t instanceCount,
+	uint32_t startIndex,
+	int32_t baseVertex,
+	uint32_t startInstance)
+{
+	this->m_commandList->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+void Core::CommandBundle::BindResource(Dx12Buffer const& owner, D3D12_RESOURCE_STATES state)
+{
+	this->m_boundResources.push_back({ &owner, owner.GetDx12Resource(), owner.GetGpuVirtualAddress(), state });
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "d3dx12.h"
+
+#include <wrl.h>
+#include <memory>
+#include <vector>
+
+namespace Core
+{
+	class Dx12RenderDevice;
+	class Dx12Buffer;
+
+	/**
+	 * A D3D12 bundle recorded once and replayed with CommandList::ExecuteBundle.
+	 * Bundles can't place barriers, so the resources bound while recording are remembered
+	 * along with the state they need; the executing command list transitions them.
+	 * The bundle becomes invalid once a bound buffer is reallocated, even within the same
+	 * shared resource, it has to be recorded again. Bound buffers must outlive the bundle.
+	 */
+	class CommandBundle
+	{
+	public:
+		struct BoundResource
+		{
+			// The buffer the resource was bound through, and the resource and address it had
+			// at the time. Sub-allocated buffers move within their resource, the address tells.
+			Dx12Buffer const* Owner;
+			Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+			D3D12_GPU_VIRTUAL_ADDRESS GpuVirtualAddress;
+			D3D12_RESOURCE_STATES State;
+		};
+
+	public:
+		CommandBundle(
+			std::shared_ptr<Dx12RenderDevice> renderDevice,
+			Microsoft::WRL::ComPtr<ID3D12PipelineState> initialPipelineState = nullptr);
+
+		/**
+		 * Starts a new recording. The previous bundle may still be in flight, so a new
+		 * allocator and command list are created; command lists that executed the old
+		 * bundle keep it alive.
+		 */
+		void Begin();
+		void Close();
+
+		// Closed and none of the bound resources has been reallocated since recording.
+		bool IsValid() const;
+
+		void SetPipelineState(Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineState);
+		void SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY topology);
+		void SetGraphics32BitConstants(uint32_t rootParameterIndex, uint32_t numConstants, const void* constants);
+
+		void SetVertexBuffer(Dx12Buffer const& vertexBuffer);
+		void SetIndexBuffer(Dx12Buffer const& indexBuffer);
+
+		void Draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t startVertex = 0, uint32_t startInstance = 0);
+		void DrawIndexed(
+			uint32_t indexCount,
+			uint32_t instanceCount = 1,
+			uint32_t startIndex = 0,
+			int32_t baseVertex = 0,
+			uint32_t startInstance = 0);
+
+		ID3D12GraphicsCommandList2* GetD3D12Impl() const { return this->m_commandList.Get(); }
+		ID3D12CommandAllocator* GetCommandAllocator() const { return this->m_allocator.Get(); }
+		ID3D12PipelineState* GetInitialPipelineState() const { return this->m_initialPipelineState.Get(); }
+
+		// The pipeline state that is still set once the bundle has executed, or nullptr.
+		ID3D12PipelineState* GetFinalPipelineState() const
+		{
+			return this->m_pipelineStates.empty()
+				? this->m_initialPipelineState.Get()
+				: this->m_pipelineStates.back().Get();
+		}
+
+		std::vector<BoundResource> const& GetBoundResources() const { return this->m_boundResources; }
+
+	private:
+		void BindResource(Dx12Buffer const& owner, D3D12_RESOURCE_STATES state);
+
+	private:
+		std::shared_ptr<Dx12RenderDevice> m_renderDevice;
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> m_initialPipelineState;
+
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_allocator;
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> m_commandList;
+
+		// Pipeline states set while recording, the bundle references them.
+		std::vector<Microsoft::WRL::ComPtr<ID3D12PipelineState>> m_pipelineStates;
+		std::vector<BoundResource> m_boundResources;
+
+		bool m_isClosed;
+	};
+}
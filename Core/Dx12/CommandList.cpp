@@ -6,7 +6,9 @@
 #include "d3dx12.h"
 
 #include "ResourceStateTracker.h"
+#include "CommandBundle.h"
 #include "UploadBuffer.h"
+#include "StaticBufferAllocator.h"
 #include "DynamicDescriptorHeap.h"
 
 #include "DirectXTex/DirectXTex.h"
@@ -32,22 +34,29 @@ Core::CommandList::CommandList(
 	, m_commandList(commandList)
 	, m_allocator(allocator)
 	, m_resourceStateTracker(std::make_unique<ResourceStateTracker>())
-	, m_uploadBuffer(std::make_unique<UploadBuffer>(renderDevice->GetD3DDevice()))
+	, m_uploadBuffer(std::make_unique<UploadBuffer>(renderDevice->GetUploadRing()))
+	, m_rootSignature(nullptr)
+	, m_pipelineState(nullptr)
 {
-	for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i)
+	// RTVs and DSVs are never shader visible, only the CBV_SRV_UAV and SAMPLER types are staged.
+	for (uint32_t i = 0; i < GpuDescriptorHeap::NumShaderVisibleHeapTypes; ++i)
 	{
 		this->m_dynamicDescriptorHeap[i] =
 			std::make_unique<DynamicDescriptorHeap>(
-				static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(i),
-				this->m_renderDevice->GetD3DDevice());
+				this->m_renderDevice->GetD3DDevice(),
+				this->m_renderDevice->GetGpuDescriptorHeap(static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(i)));
+	}
 
+	for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i)
+	{
 		this->m_descriptorHeaps[i] = nullptr;
 	}
 }
 
-void Core::CommandList::Reset()
+void Core::CommandList::Reset(ID3D12CommandAllocator* allocator)
 {
-	ThrowIfFailed(this->m_allocator->Reset());
+	// The allocator is reset by the pool before it is handed out again.
+	this->m_allocator = allocator;
 
 	ThrowIfFailed(
 		this->m_commandList->Reset(this->m_allocator, nullptr));
@@ -55,40 +64,64 @@ void Core::CommandList::Reset()
 	this->m_resourceStateTracker->Reset();
 	this->m_uploadBuffer->Reset();
 	this->m_trackedObjects.clear();
+	this->m_rootSignature = nullptr;
+	this->m_pipelineState = nullptr;
+	this->m_boundRenderTargets.clear();
+
+	this->ReleaseDynamicDescriptors();
 
 	for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i)
 	{
-		this->m_dynamicDescriptorHeap[i]->Reset();
 		this->m_descriptorHeaps[i] = nullptr;
 	}
 
 }
 
-bool Core::CommandList::Close(CommandList& pendingCommandList)
+void Core::CommandList::ReleaseDynamicDescriptors()
 {
-	// Flush any remaining barriers.
-	this->FlushResourceBarriers();
-	this->m_commandList->Close();
+	for (uint32_t i = 0; i < GpuDescriptorHeap::NumShaderVisibleHeapTypes; ++i)
+	{
+		this->m_dynamicDescriptorHeap[i]->Reset();
+	}
+}
 
-	// Flush pending resource barriers.
-	uint32_t numPendingBarriers = 
-		this->m_resourceStateTracker->FlushPendingResourceBarriers(pendingCommandList);
+std::vector<Microsoft::WRL::ComPtr<ID3D12Object>> Core::CommandList::TakeTrackedObjects()
+{
+	TrackedObjects trackedObjects;
+	trackedObjects.swap(this->m_trackedObjects);
 
-	// Commit the final resource state to the global state.
-	this->m_resourceStateTracker->CommitFinalResourceStates();
+	return trackedObjects;
+}
 
-	return numPendingBarriers > 0;
+void Core::CommandList::RetireUploads(IFence* fence, uint64_t fenceValue)
+{
+	this->m_uploadBuffer->Retire(fence, fenceValue);
 }
 
 void Core::CommandList::Close()
 {
+	this->m_resourceStateTracker->EndSplitTransitions();
 	this->FlushResourceBarriers();
 	this->m_commandList->Close();
 }
 
+void Core::CommandList::ResolveResourceStates(PendingBarrierBatch& batch, std::vector<D3D12_RESOURCE_BARRIER>& orderedBarriers)
+{
+	// Resolve pending resource barriers.
+	this->m_resourceStateTracker->ResolvePendingResourceBarriers(batch, orderedBarriers);
+
+	// Commit the final resource state to the global state.
+	this->m_resourceStateTracker->CommitFinalResourceStates();
+}
+
 void Core::CommandList::FlushResourceBarriers()
 {
-	this->m_resourceStateTracker->FlushResourceBarriers(*this);
+	this->m_resourceStateTracker->FlushResourceBarriers(this->m_commandList.Get());
+}
+
+ResourceBarrierOptimizer::Statistics const& Core::CommandList::GetBarrierStatistics() const
+{
+	return this->m_resourceStateTracker->GetBarrierStatistics();
 }
 
 void Core::CommandList::TransitionBarrier(Microsoft::WRL::ComPtr<ID3D12Resource> resource, D3D12_RESOURCE_STATES stateAfter, uint32_t subresource, bool flushBarriers)
@@ -110,6 +143,24 @@ void Core::CommandList::TransitionBarrier(Microsoft::WRL::ComPtr<ID3D12Resource>
 	}
 }
 
+void Core::CommandList::AliasBarrier(
+	Microsoft::WRL::ComPtr<ID3D12Resource> resourceBefore,
+	Microsoft::WRL::ComPtr<ID3D12Resource> resourceAfter,
+	bool flushBarriers)
+{
+	this->m_resourceStateTracker->AliasBarrier(resourceBefore.Get(), resourceAfter.Get());
+
+	if (resourceAfter)
+	{
+		this->TrackResource(resourceAfter);
+	}
+
+	if (flushBarriers)
+	{
+		this->FlushResourceBarriers();
+	}
+}
+
 void Core::CommandList::LoadTextureFromFile(Dx12Texture& texture, std::wstring const& filename)
 {
 	fs::path filePath(filename);
@@ -352,7 +403,7 @@ void Core::CommandList::PanoToCubemap(Dx12Texture& cubemap, Dx12Texture const& p
 
 	this->TransitionBarrier(stagingTexture.GetDx12Resource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 
-	this->m_commandList->SetPipelineState(this->m_panoToCubeMapPso->GetPipelineState().Get());
+	this->SetPipelineState(this->m_panoToCubeMapPso->GetPipelineState());
 	this->SetComputeRootSignature(this->m_panoToCubeMapPso->GetRootSignature());
 
 	PanoToCubemapCB panoToCubemapCB;
@@ -467,7 +518,7 @@ void Core::CommandList::GenerateIrradianceMap(Dx12Texture& irmapTexture, Dx12Tex
 
 	this->TransitionBarrier(stagingTexture.GetDx12Resource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 
-	this->m_commandList->SetPipelineState(this->m_cubemapToIrradianceMapPso->GetPipelineState().Get());
+	this->SetPipelineState(this->m_cubemapToIrradianceMapPso->GetPipelineState());
 	this->SetComputeRootSignature(this->m_cubemapToIrradianceMapPso->GetRootSignature());
 
 	D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
@@ -551,7 +602,7 @@ void Core::CommandList::GenerateSpecularMap(Dx12Texture& specTexture, Dx12Textur
 
 	this->TransitionBarrier(stagingTexture.GetDx12Resource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 
-	this->m_commandList->SetPipelineState(this->m_cubemapToSpecularMapPso->GetPipelineState().Get());
+	this->SetPipelineState(this->m_cubemapToSpecularMapPso->GetPipelineState());
 	this->SetComputeRootSignature(this->m_cubemapToSpecularMapPso->GetRootSignature());
 
 	D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
@@ -634,7 +685,7 @@ void Core::CommandList::GenerateSpecularBrdfLut(Dx12Texture& specBrdfLutTexture)
 
 	this->TransitionBarrier(stagingTexture.GetDx12Resource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 
-	this->m_commandList->SetPipelineState(this->m_cubemapToIrradianceMapPso->GetPipelineState().Get());
+	this->SetPipelineState(this->m_cubemapToIrradianceMapPso->GetPipelineState());
 	this->SetComputeRootSignature(this->m_cubemapToIrradianceMapPso->GetRootSignature());
 
 	D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
@@ -698,6 +749,8 @@ void Core::CommandList::CopyTextureSubresource(
 		numSubresources,
 		subresourceData);
 
+	this->m_resourceStateTracker->BeginSplitTransition(destinationResource.Get());
+
 	this->TrackResource(intermediateResource);
 	this->TrackResource(destinationResource);
 }
@@ -754,6 +807,56 @@ void Core::CommandList::CopyBuffer(
 	this->TrackResource(buffer);
 }
 
+void Core::CommandList::CopyBuffer(Dx12Buffer& buffer, const void* data)
+{
+	const BindFlags staticBindings = static_cast<BindFlags>(BIND_VERTEX_BUFFER | BIND_INDEX_BUFFER);
+	const bool isStatic = buffer.GetBindings() != BIND_NONE && (buffer.GetBindings() & ~staticBindings) == 0;
+
+	if (!isStatic)
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+		this->CopyBuffer(
+			resource,
+			buffer.GetNumElements(),
+			buffer.GetElementByteStride(),
+			data);
+
+		buffer.SetDx12Resource(resource);
+		buffer.SetAllocation(nullptr);
+		return;
+	}
+
+	size_t bufferSize = buffer.GetSizeInBytes();
+	auto allocation = this->m_renderDevice->GetStaticBufferAllocator()->Allocate(bufferSize);
+	auto resource = allocation->GetResource();
+
+	if (data)
+	{
+		auto upload = this->m_uploadBuffer->Allocate(bufferSize, buffer.GetElementByteStride());
+		memcpy(upload.Cpu, data, bufferSize);
+
+		// Other buffers in the resource may be in use, so it's only in COPY_DEST for the copy.
+		this->m_resourceStateTracker->TransitionResource(resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+		this->FlushResourceBarriers();
+
+		this->m_commandList->CopyBufferRegion(
+			resource.Get(), allocation->GetOffset(),
+			upload.Resource, upload.Offset,
+			bufferSize);
+
+		// Copy and compute lists can't use the vertex, index and pixel shader states. There the
+		// buffer decays to COMMON after the copy and is promoted by the direct list that reads it.
+		if (this->m_type == D3D12_COMMAND_LIST_TYPE_DIRECT)
+		{
+			this->m_resourceStateTracker->TransitionResource(resource.Get(), StaticBufferAllocator::ReadState);
+		}
+	}
+
+	this->TrackResource(resource);
+
+	buffer.SetAllocation(allocation);
+}
+
 void Core::CommandList::CopyResource(Microsoft::WRL::ComPtr<ID3D12Resource> dstRes, Microsoft::WRL::ComPtr<ID3D12Resource> srcRes)
 {
 	this->TransitionBarrier(dstRes, D3D12_RESOURCE_STATE_COPY_DEST);
@@ -762,6 +865,7 @@ void Core::CommandList::CopyResource(Microsoft::WRL::ComPtr<ID3D12Resource> dstR
 	this->FlushResourceBarriers();
 
 	this->m_commandList->CopyResource(dstRes.Get(), srcRes.Get());
+	this->m_resourceStateTracker->BeginSplitTransition(dstRes.Get());
 
 	this->TrackResource(dstRes);
 	this->TrackResource(srcRes);
@@ -784,6 +888,7 @@ void Core::CommandList::ResolveSubresource(
 		srcRes.GetDx12Resource().Get(),
 		srcSubresource,
 		dstRes.GetDx12Resource()->GetDesc().Format);
+	this->m_resourceStateTracker->BeginSplitTransition(dstRes.GetDx12Resource().Get());
 
 	TrackResource(srcRes.GetDx12Resource());
 	TrackResource(dstRes.GetDx12Resource());
@@ -791,7 +896,7 @@ void Core::CommandList::ResolveSubresource(
 
 void Core::CommandList::ClearDepthStencilTexture(Dx12Texture const& texture, D3D12_CLEAR_FLAGS clearFlags, float depth, uint8_t stencil)
 {
-	this->TransitionBarrier(texture.GetDx12Resource(), D3D12_RESOURCE_STATE_DEPTH_WRITE);
+	this->TransitionBarrier(texture.GetDx12Resource(), D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, true);
 	this->m_commandList->ClearDepthStencilView(
 		texture.GetDepthStencilView(),
 		clearFlags,
@@ -810,7 +915,7 @@ void Core::CommandList::ClearRenderTarget(Dx12Texture const& texture, std::array
 
 void Core::CommandList::ClearRenderTarget(Microsoft::WRL::ComPtr<ID3D12Resource> resource, D3D12_CPU_DESCRIPTOR_HANDLE rtv, std::array<FLOAT, 4> clearColour)
 {
-	this->TransitionBarrier(resource, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	this->TransitionBarrier(resource, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, true);
 	this->m_commandList->ClearRenderTargetView(rtv, clearColour.data(), 0, nullptr);
 
 }
@@ -851,6 +956,8 @@ void Core::CommandList::SetRenderTarget(RenderTarget const& renderTarget)
 {
 	std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> renderTargetDescriptors;
 	renderTargetDescriptors.reserve(AttachmentPoint::NumAttachmentPoints);
+	std::vector<ID3D12Resource*> renderTargetResources;
+	renderTargetResources.reserve(AttachmentPoint::NumAttachmentPoints);
 	const auto& textures = renderTarget.GetTextures();
 
 	// Bind color targets (max of 8 render targets can be bound to the rendering pipeline.
@@ -862,6 +969,7 @@ void Core::CommandList::SetRenderTarget(RenderTarget const& renderTarget)
 		{
 			TransitionBarrier(texture.GetDx12Resource(), D3D12_RESOURCE_STATE_RENDER_TARGET);
 			renderTargetDescriptors.push_back(texture.GetRenderTargetView());
+			renderTargetResources.push_back(texture.GetDx12Resource().Get());
 
 			TrackResource(texture.GetDx12Resource());
 		}
@@ -873,10 +981,13 @@ void Core::CommandList::SetRenderTarget(RenderTarget const& renderTarget)
 	{
 		TransitionBarrier(depthTexture.GetDx12Resource(), D3D12_RESOURCE_STATE_DEPTH_WRITE);
 		depthStencilDescriptor = depthTexture.GetDepthStencilView();
+		renderTargetResources.push_back(depthTexture.GetDx12Resource().Get());
 
 		TrackResource(depthTexture.GetDx12Resource());
 	}
 
+	this->SetBoundRenderTargets(renderTargetResources);
+
 	D3D12_CPU_DESCRIPTOR_HANDLE* pDSV = depthStencilDescriptor.ptr != 0 ? &depthStencilDescriptor : nullptr;
 
 	this->m_commandList->OMSetRenderTargets(
@@ -889,11 +1000,25 @@ void Core::CommandList::SetRenderTarget(RenderTarget const& renderTarget)
 void Core::CommandList::SetRenderTarget(Microsoft::WRL::ComPtr<ID3D12Resource> resource, D3D12_CPU_DESCRIPTOR_HANDLE& rtv)
 {
 	TransitionBarrier(resource, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	this->SetBoundRenderTargets({ resource.Get() });
 
 	this->m_commandList->OMSetRenderTargets(1, &rtv, false, nullptr);
 	TrackResource(resource);
 }
 
+void Core::CommandList::SetBoundRenderTargets(std::vector<ID3D12Resource*> const& renderTargets)
+{
+	for (auto boundRenderTarget : this->m_boundRenderTargets)
+	{
+		if (std::find(renderTargets.begin(), renderTargets.end(), boundRenderTarget) == renderTargets.end())
+		{
+			this->m_resourceStateTracker->BeginSplitTransition(boundRenderTarget);
+		}
+	}
+
+	this->m_boundRenderTargets = renderTargets;
+}
+
 void Core::CommandList::SetGraphics32BitConstants(uint32_t rootParameterIndex, uint32_t numConstants, const void* constants)
 {
 	this->m_commandList->SetGraphicsRoot32BitConstants(rootParameterIndex, numConstants, constants, 0);
@@ -971,7 +1096,7 @@ void Core::CommandList::SetGraphicsRootSignature(RootSignature const& rootSignat
 
 	this->m_rootSignature = d3d12RootSignature;
 
-	for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i)
+	for (uint32_t i = 0; i < GpuDescriptorHeap::NumShaderVisibleHeapTypes; ++i)
 	{
 		this->m_dynamicDescriptorHeap[i]->ParseRootSignature(rootSignature);
 	}
@@ -990,7 +1115,7 @@ void Core::CommandList::SetComputeRootSignature(RootSignature const& rootSignatu
 
 	this->m_rootSignature = d3d12RootSignature;
 
-	for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i)
+	for (uint32_t i = 0; i < GpuDescriptorHeap::NumShaderVisibleHeapTypes; ++i)
 	{
 		this->m_dynamicDescriptorHeap[i]->ParseRootSignature(rootSignature);
 	}
@@ -999,6 +1124,22 @@ void Core::CommandList::SetComputeRootSignature(RootSignature const& rootSignatu
 	this->TrackResource(this->m_rootSignature);
 }
 
+void Core::CommandList::SetGraphicsBindlessTable(uint32_t rootParameterIndex)
+{
+	auto bindlessHeap = this->m_renderDevice->GetBindlessDescriptorHeap();
+
+	this->SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, bindlessHeap->GetD3D12Heap());
+	this->m_commandList->SetGraphicsRootDescriptorTable(rootParameterIndex, bindlessHeap->GetGpuHandle());
+}
+
+void Core::CommandList::SetComputeBindlessTable(uint32_t rootParameterIndex)
+{
+	auto bindlessHeap = this->m_renderDevice->GetBindlessDescriptorHeap();
+
+	this->SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, bindlessHeap->GetD3D12Heap());
+	this->m_commandList->SetComputeRootDescriptorTable(rootParameterIndex, bindlessHeap->GetGpuHandle());
+}
+
 void Core::CommandList::SetGraphicsRootSignature(Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature)
 {
 	this->m_commandList->SetGraphicsRootSignature(rootSignature.Get());
@@ -1032,6 +1173,7 @@ void Core::CommandList::SetShaderResourceView(uint32_t rootParameterIndex, uint3
 void Core::CommandList::SetPipelineState(Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineState)
 {
 	this->m_commandList->SetPipelineState(pipelineState.Get());
+	this->m_pipelineState = pipelineState.Get();
 	this->TrackResource(pipelineState);
 }
 
@@ -1044,10 +1186,18 @@ void Core::CommandList::SetVertexBuffer(Dx12Buffer& vertexBuffer)
 {
 	LOG_CORE_ASSERT(vertexBuffer.GetBindings() & BIND_VERTEX_BUFFER, "Unable to bind non vertex buffer");
 	D3D12_VERTEX_BUFFER_VIEW view = {};
-	view.BufferLocation = vertexBuffer.GetDx12Resource()->GetGPUVirtualAddress();
+	view.BufferLocation = vertexBuffer.GetGpuVirtualAddress();
 	view.SizeInBytes = vertexBuffer.GetSizeInBytes();
 	view.StrideInBytes = vertexBuffer.GetElementByteStride();
 
+	if (vertexBuffer.IsSubAllocated())
+	{
+		this->TransitionBarrier(vertexBuffer.GetDx12Resource(), StaticBufferAllocator::ReadState);
+		this->TrackResource(vertexBuffer.GetDx12Resource());
+		this->m_commandList->IASetVertexBuffers(0, 1, &view);
+		return;
+	}
+
 	this->SetVertexBuffer(
 		vertexBuffer.GetDx12Resource(),
 		view);
@@ -1082,10 +1232,18 @@ void Core::CommandList::SetIndexBuffer(Dx12Buffer& indexBuffer)
 	LOG_CORE_ASSERT(indexBuffer.GetElementByteStride() == sizeof(uint32_t) || indexBuffer.GetElementByteStride() == sizeof(uint16_t), "Invalid Index stride");
 
 	D3D12_INDEX_BUFFER_VIEW view = {};
-	view.BufferLocation = indexBuffer.GetDx12Resource()->GetGPUVirtualAddress();
+	view.BufferLocation = indexBuffer.GetGpuVirtualAddress();
 	view.SizeInBytes = indexBuffer.GetSizeInBytes();
 	view.Format = indexBuffer.GetElementByteStride() == sizeof(uint32_t) ? DXGI_FORMAT_R32_UINT: DXGI_FORMAT_R16_UINT;
 
+	if (indexBuffer.IsSubAllocated())
+	{
+		this->TransitionBarrier(indexBuffer.GetDx12Resource(), StaticBufferAllocator::ReadState);
+		this->TrackResource(indexBuffer.GetDx12Resource());
+		this->m_commandList->IASetIndexBuffer(&view);
+		return;
+	}
+
 	this->SetIndexBuffer(
 		indexBuffer.GetDx12Resource(),
 		view);
@@ -1124,10 +1282,7 @@ void Core::CommandList::Draw(
 {
 	this->FlushResourceBarriers();
 	
-	for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i)
-	{
-		this->m_dynamicDescriptorHeap[i]->CommitStagedDescriptorsForDraw(*this);
-	}
+	this->CommitStagedDescriptorsForDraw();
 
 	this->m_commandList->DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
 }
@@ -1141,23 +1296,46 @@ void Core::CommandList::DrawIndexed(
 {
 	this->FlushResourceBarriers();
 
-	for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i)
-	{
-		this->m_dynamicDescriptorHeap[i]->CommitStagedDescriptorsForDraw(*this);
-	}
+	this->CommitStagedDescriptorsForDraw();
 
 	this->m_commandList->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
 }
 
-void Core::CommandList::Dispatch(uint32_t numGroupsX, uint32_t numGroupsY, uint32_t numGroupsZ)
+void Core::CommandList::ExecuteBundle(CommandBundle const& bundle)
 {
+	LOG_CORE_ASSERT(this->m_type == D3D12_COMMAND_LIST_TYPE_DIRECT, "Bundles can only be executed on direct command lists");
+	LOG_CORE_ASSERT(bundle.IsValid(), "Bundle has to be recorded again");
+
+	// Bundles can't place barriers, the resources they bind have to be in the right state already.
+	for (auto& boundResource : bundle.GetBoundResources())
+	{
+		this->TransitionBarrier(boundResource.Resource, boundResource.State);
+		this->TrackResource(boundResource.Resource);
+	}
+
 	this->FlushResourceBarriers();
 
-	for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i)
+	// Root arguments are inherited by the bundle, so staged descriptors are committed as for a draw.
+	this->CommitStagedDescriptorsForDraw();
+
+	this->m_commandList->ExecuteBundle(bundle.GetD3D12Impl());
+
+	// The pipeline state set by the bundle carries over to this command list.
+	if (bundle.GetFinalPipelineState())
 	{
-		this->m_dynamicDescriptorHeap[i]->CommitStagedDescriptorsForDispatch(*this);
+		this->m_pipelineState = bundle.GetFinalPipelineState();
 	}
 
+	this->TrackResource(bundle.GetD3D12Impl());
+	this->TrackResource(bundle.GetCommandAllocator());
+}
+
+void Core::CommandList::Dispatch(uint32_t numGroupsX, uint32_t numGroupsY, uint32_t numGroupsZ)
+{
+	this->FlushResourceBarriers();
+
+	this->CommitStagedDescriptorsForDispatch();
+
 	this->m_commandList->Dispatch(numGroupsX, numGroupsY, numGroupsZ);
 }
 
@@ -1172,6 +1350,34 @@ void Core::CommandList::SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE heapType, I
 	this->BindDescriptorHeaps();
 }
 
+void Core::CommandList::CommitStagedDescriptorsForDraw()
+{
+	for (uint32_t i = 0; i < GpuDescriptorHeap::NumShaderVisibleHeapTypes; ++i)
+	{
+		auto& dynamicDescriptorHeap = this->m_dynamicDescriptorHeap[i];
+		if (dynamicDescriptorHeap->HasStaleDescriptors())
+		{
+			auto heapType = static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(i);
+			this->SetDescriptorHeap(heapType, this->m_renderDevice->GetGpuDescriptorHeap(heapType)->GetD3D12Heap());
+			dynamicDescriptorHeap->CommitStagedDescriptorsForDraw(this->m_commandList.Get());
+		}
+	}
+}
+
+void Core::CommandList::CommitStagedDescriptorsForDispatch()
+{
+	for (uint32_t i = 0; i < GpuDescriptorHeap::NumShaderVisibleHeapTypes; ++i)
+	{
+		auto& dynamicDescriptorHeap = this->m_dynamicDescriptorHeap[i];
+		if (dynamicDescriptorHeap->HasStaleDescriptors())
+		{
+			auto heapType = static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(i);
+			this->SetDescriptorHeap(heapType, this->m_renderDevice->GetGpuDescriptorHeap(heapType)->GetD3D12Heap());
+			dynamicDescriptorHeap->CommitStagedDescriptorsForDispatch(this->m_commandList.Get());
+		}
+	}
+}
+
 void Core::CommandList::TrackResource(Microsoft::WRL::ComPtr<ID3D12Object> object)
 {
 	this->m_trackedObjects.push_back(object);
@@ -9,9 +9,11 @@
 #include "d3dx12.h"
 
 #include "Dx12/DynamicDescriptorHeap.h"
+#include "Dx12/GpuDescriptorHeap.h"
 #include "Dx12/UploadBuffer.h"
 #include "Dx12/GraphicResourceTypes.h"
 #include "Dx12/RootSignature.h"
+#include "Dx12/ResourceBarrierOptimizer.h"
 #include "Dx12/PanoToCubemapPSO.h"
 #include "Dx12/CubemapToIrradianceMapPSO.h"
 #include "Dx12/GenerateSpecBrdfLutPso.h"
@@ -23,6 +25,8 @@ namespace Core
 {
 	class ResourceStateTracker;
 	class Dx12RenderDevice;
+	struct PendingBarrierBatch;
+	class CommandBundle;
 
 	class CommandList
 	{
@@ -33,12 +37,33 @@ namespace Core
 			Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> commandList,
 			ID3D12CommandAllocator* allocator);
 
-		void Reset();
+		// Reset the command list to record with a new allocator.
+		void Reset(ID3D12CommandAllocator* allocator);
+
+		// Return the chunks of the shader visible heaps, once the command list has completed on the GPU.
+		void ReleaseDynamicDescriptors();
+
+		// Hands over the objects the recorded commands reference, to be kept alive until they've executed.
+		std::vector<Microsoft::WRL::ComPtr<ID3D12Object>> TakeTrackedObjects();
+
+		// The upload blocks the recorded commands read can be reused once the fence reaches fenceValue.
+		void RetireUploads(IFence* fence, uint64_t fenceValue);
 
-		bool Close(CommandList& pendingCommandList);
 		void Close();
 
+		/**
+		 * Resolve the pending barriers of the closed command list as part of a batched submission,
+		 * into the batch, or into orderedBarriers when they have to run right before this command list.
+		 * The final resource states are committed to the global state, which has to be locked.
+		 */
+		void ResolveResourceStates(PendingBarrierBatch& batch, std::vector<D3D12_RESOURCE_BARRIER>& orderedBarriers);
+
 		ID3D12GraphicsCommandList2* GetD3D12Impl() { return this->m_commandList.Get(); }
+		ID3D12CommandAllocator* GetCommandAllocator() const { return this->m_allocator; }
+		D3D12_COMMAND_LIST_TYPE GetType() const { return this->m_type; }
+
+		// How many of the barriers recorded by this command list were coalesced away.
+		ResourceBarrierOptimizer::Statistics const& GetBarrierStatistics() const;
 
 		void FlushResourceBarriers();
 		void TransitionBarrier(
@@ -47,6 +72,12 @@ namespace Core
 			uint32_t subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
 			bool flushBarriers = false);
 
+		// A null resourceBefore stands for any resource placed in the same memory.
+		void AliasBarrier(
+			Microsoft::WRL::ComPtr<ID3D12Resource> resourceBefore,
+			Microsoft::WRL::ComPtr<ID3D12Resource> resourceAfter,
+			bool flushBarriers = false);
+
 	public:
 		void LoadTextureFromFile(Dx12Texture& texture, std::wstring const& filename);
 
@@ -73,20 +104,20 @@ namespace Core
 			const void* data,
 			D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE);
 
+		/**
+		 * Creates the buffer's memory and copies the data to it. Buffers only bound as vertex
+		 * or index buffers are carved out of the device's StaticBufferAllocator, others get a
+		 * committed resource.
+		 */
+		void CopyBuffer(Dx12Buffer& buffer, const void* data);
+
 		template<typename T>
 		void CopyBuffer(Dx12Buffer& buffer, const std::vector<T>& bufferData)
 		{
 			LOG_CORE_ASSERT(buffer.GetNumElements() == bufferData.size(), "Invalid Buffer Data size");
 			LOG_CORE_ASSERT(buffer.GetElementByteStride() == sizeof(T), "Invalid Buffer Element Stride");
 
-			Microsoft::WRL::ComPtr<ID3D12Resource> resource;
-			this->CopyBuffer(
-				resource,
-				buffer.GetNumElements(),
-				buffer.GetElementByteStride(),
-				bufferData.data());
-
-			buffer.SetDx12Resource(resource);
+			this->CopyBuffer(buffer, static_cast<const void*>(bufferData.data()));
 		}
 
 		void CommandList::CopyResource(
@@ -206,8 +237,20 @@ namespace Core
 		void SetGraphicsRootSignature(RootSignature const& rootSignature);
 		void SetComputeRootSignature(RootSignature const& rootSignature);
 
+		/**
+		 * Bind the device's bindless heap to an unbounded descriptor table, see
+		 * GpuDescriptorHeap::GetBindlessDescriptorRanges. Shaders index it with the views'
+		 * bindless indices, passed through root constants. Resources accessed this way aren't
+		 * transitioned. Staged tables are copied into the same heap, so both can be mixed.
+		 */
+		void SetGraphicsBindlessTable(uint32_t rootParameterIndex);
+		void SetComputeBindlessTable(uint32_t rootParameterIndex);
+
 		void SetPipelineState(Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineState);
 
+		// The pipeline state last set on the command list, or nullptr.
+		ID3D12PipelineState* GetPipelineState() const { return this->m_pipelineState; }
+
 		void SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY topology);
 
 		void SetVertexBuffer(Dx12Buffer& vertexBuffer);
@@ -252,12 +295,25 @@ namespace Core
 		 */
 		void Dispatch(uint32_t numGroupsX, uint32_t numGroupsY = 1, uint32_t numGroupsZ = 1);
 
+		/**
+		 * Replay a recorded bundle. The resources the bundle binds are transitioned first,
+		 * and the root signature and arguments set on this command list are inherited.
+		 */
+		void ExecuteBundle(CommandBundle const& bundle);
+
 		void SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE heapType, ID3D12DescriptorHeap* heap);
 
 	private:
 		void TrackResource(Microsoft::WRL::ComPtr<ID3D12Object> object);
 		void BindDescriptorHeaps();
 
+		// Binds the shader visible heaps the staged tables are copied into and commits them.
+		void CommitStagedDescriptorsForDraw();
+		void CommitStagedDescriptorsForDispatch();
+
+		// Begins split transitions for the render targets the new binding no longer includes.
+		void SetBoundRenderTargets(std::vector<ID3D12Resource*> const& renderTargets);
+
 	private:
 		D3D12_COMMAND_LIST_TYPE m_type;
 		std::shared_ptr<Dx12RenderDevice> m_renderDevice;
@@ -272,7 +328,7 @@ namespace Core
 		std::unique_ptr<ResourceStateTracker> m_resourceStateTracker;
 		std::unique_ptr<UploadBuffer> m_uploadBuffer;
 
-		std::unique_ptr<DynamicDescriptorHeap> m_dynamicDescriptorHeap[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
+		std::unique_ptr<DynamicDescriptorHeap> m_dynamicDescriptorHeap[GpuDescriptorHeap::NumShaderVisibleHeapTypes];
 
 		// Keep track of the currently bound descriptor heaps. Only change descriptor 
 		// heaps if they are different than the currently bound descriptor heaps.
@@ -282,6 +338,12 @@ namespace Core
 		// signature changes.
 		ID3D12RootSignature* m_rootSignature;
 
+		// The pipeline state last set, bundles are recorded against it.
+		ID3D12PipelineState* m_pipelineState;
+
+		// Colour and depth targets of the last SetRenderTarget.
+		std::vector<ID3D12Resource*> m_boundRenderTargets;
+
 		std::unique_ptr<PanoToCubemapPso> m_panoToCubeMapPso;
 		std::unique_ptr<CubemapToIrradianceMapPso> m_cubemapToIrradianceMapPso;
 		std::unique_ptr<GenerateSpecBrdfLutPso> m_generateSpecularBrdfLutPso;
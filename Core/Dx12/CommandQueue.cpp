@@ -5,10 +5,19 @@
 #include "ResourceStateTracker.h"
 
 #include "Dx12RenderDevice.h"
+#include "DeferredReleaseQueue.h"
+#include "FenceCompletionService.h"
+#include "QueueDependencyTracker.h"
+#include "TaskScheduler.h"
 
 using namespace Core;
 using namespace Microsoft::WRL;
 
+namespace
+{
+	constexpr size_t MaxAvailableCommandLists = 256;
+}
+
 CommandQueue::CommandQueue(
 	std::shared_ptr<Dx12RenderDevice> renderDevice,
 	D3D12_COMMAND_LIST_TYPE type)
@@ -16,7 +25,10 @@ CommandQueue::CommandQueue(
 	, m_renderDevice(renderDevice)
 	, m_fenceValue(0)
 	, m_commandAllocatorPool(renderDevice->GetD3DDevice(), type)
-	, m_bProcessInflightCommandLists(true)
+	, m_fenceCompletionService(renderDevice->GetFenceCompletionService())
+	, m_queueDependencyTracker(renderDevice->GetQueueDependencyTracker())
+	, m_deferredReleaseQueue(renderDevice->GetDeferredReleaseQueue())
+	, m_availableCommandList(MaxAvailableCommandLists)
 {
 	// Create Command Queue
 	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
@@ -30,9 +42,11 @@ CommandQueue::CommandQueue(
 		device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&this->m_commandQueue)));
 
 	// Create Fence
-	ThrowIfFailed(
-		device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&this->m_fence)));
-	this->m_fence->SetName(L"Dx12CommandQueue::Dx12CommandQueue::Fence");
+	this->m_fence = std::make_unique<Dx12Fence>(device);
+	this->m_fence->GetImpl()->SetName(L"Dx12CommandQueue::Dx12CommandQueue::Fence");
+
+	this->m_queueDependencyTracker->RegisterQueue(this->m_type, this->m_fence.get());
+	this->m_deferredReleaseQueue->RegisterFence(this->m_fence.get(), this->m_fenceValue);
 
 	switch (type)
 	{
@@ -47,24 +61,21 @@ CommandQueue::CommandQueue(
 		break;
 
 	}
-
-	this->m_processInflightCommnadListsThread = 
-		std::thread(&CommandQueue::ProccessInFlightCommandLists, this);
 }
 
 CommandQueue::~CommandQueue()
 {
-	this->m_bProcessInflightCommandLists = false;
-	this->m_processInflightCommnadListsThread.join();
+	// Recycle callbacks reference this queue.
+	this->m_fenceCompletionService->Flush(this->m_fence.get());
 }
 
 std::shared_ptr<CommandList> Core::CommandQueue::GetCommandList()
 {
 	std::shared_ptr<CommandList> commandList;
 
-	if (!this->m_availableCommandList.Empty())
+	if (this->m_availableCommandList.TryPop(commandList))
 	{
-		this->m_availableCommandList.TryPop(commandList);
+		commandList->Reset(this->RequestAllocator());
 	}
 	else
 	{
@@ -82,48 +93,152 @@ std::shared_ptr<CommandList> Core::CommandQueue::GetCommandList()
 
 uint64_t Core::CommandQueue::ExecuteCommandList(std::shared_ptr<CommandList> commandList)
 {
-	ResourceStateTracker::Lock();
+	return this->ExecuteCommandLists({ commandList });
+}
+
+uint64_t Core::CommandQueue::ExecuteCommandLists(std::vector<std::shared_ptr<CommandList>> const& commandLists)
+{
+	// Closing doesn't touch the global state, do it before taking any lock.
+	for (auto& commandList : commandLists)
+	{
+		commandList->Close();
+	}
+
+	// Keeps the order of the committed resource states, the fence values and the GPU
+	// execution the same for concurrent submissions to this queue.
+	std::lock_guard<std::mutex> submitLock(this->m_submitMutex);
 
 	// Command lists that need to put back on the command list queue.
 	std::vector<std::shared_ptr<CommandList> > toBeQueued;
-	toBeQueued.reserve(1 * 2);        // 2x since each command list will have a pending command list.
+	toBeQueued.reserve(commandLists.size() + 1);        // +1 for the pending command list.
 
 	// Command lists that need to be executed.
 	std::vector<ID3D12CommandList*> d3d12CommandLists;
-	d3d12CommandLists.reserve(1 * 2); // 2x since each command list will have a pending command list.
+	d3d12CommandLists.reserve(commandLists.size() + 1); // +1 for the pending command list.
 
+	// A single pending command list carries the pending barriers of the whole batch.
 	auto pendingCommandList = this->GetCommandList();
+	toBeQueued.push_back(pendingCommandList);
+	d3d12CommandLists.push_back(pendingCommandList->GetD3D12Impl());
 
-	bool hasPendingBarrieris = commandList->Close(*pendingCommandList);
+	// The fence value is reserved up front so the submission can be recorded with the states it commits.
+	uint64_t fenceValue = this->m_fenceValue + 1;
 
-	pendingCommandList->Close();
+	PendingBarrierBatch pendingBarrierBatch;
+	std::vector<std::vector<D3D12_RESOURCE_BARRIER>> orderedBarriers(commandLists.size());
+	std::vector<QueueDependencyTracker::ResourceUsage> resourceUsages;
+	std::vector<QueueDependencyTracker::QueueWait> queueWaits;
 
-	if (hasPendingBarrieris)
+	// Only barrier resolution is serialized across queues and threads.
+	ResourceStateTracker::Lock();
+	for (size_t i = 0; i < commandLists.size(); i++)
 	{
-		d3d12CommandLists.push_back(pendingCommandList->GetD3D12Impl());
+		commandLists[i]->ResolveResourceStates(pendingBarrierBatch, orderedBarriers[i]);
 	}
-	d3d12CommandLists.push_back(commandList->GetD3D12Impl());
 
-	toBeQueued.push_back(pendingCommandList);
-	toBeQueued.push_back(commandList);
+	ResourceStateTracker::DecayResourceStates(pendingBarrierBatch, this->m_type);
 
-	this->m_commandQueue->ExecuteCommandLists(
-		static_cast<UINT>(d3d12CommandLists.size()),
-		d3d12CommandLists.data());
-
-	uint64_t fenceValue = this->Signal();
+	// Wait on the other queues that last wrote, or are still reading, the resources of the batch.
+	resourceUsages.reserve(pendingBarrierBatch.BatchResources.size());
+	for (const auto& batchResource : pendingBarrierBatch.BatchResources)
+	{
+		resourceUsages.push_back({ batchResource.first, batchResource.second });
+	}
 
+	queueWaits = this->m_queueDependencyTracker->ResolveWaits(this->m_type, resourceUsages);
+	this->m_queueDependencyTracker->RecordSubmission(this->m_type, fenceValue, resourceUsages);
 	ResourceStateTracker::Unlock();
 
-	// Queue command lists for reuse.
+	for (size_t i = 0; i < commandLists.size(); i++)
+	{
+		// A resource that an earlier command list of the batch left in a different state
+		// has to be fixed up in between the two.
+		if (!orderedBarriers[i].empty())
+		{
+			auto orderedCommandList = this->GetCommandList();
+			orderedCommandList->GetD3D12Impl()->ResourceBarrier(
+				static_cast<UINT>(orderedBarriers[i].size()),
+				orderedBarriers[i].data());
+			orderedCommandList->Close();
+
+			toBeQueued.push_back(orderedCommandList);
+			d3d12CommandLists.push_back(orderedCommandList->GetD3D12Impl());
+		}
+
+		toBeQueued.push_back(commandLists[i]);
+		d3d12CommandLists.push_back(commandLists[i]->GetD3D12Impl());
+	}
+
+	auto& leadingBarriers = pendingBarrierBatch.LeadingBarriers;
+	if (!leadingBarriers.empty())
+	{
+		pendingCommandList->GetD3D12Impl()->ResourceBarrier(
+			static_cast<UINT>(leadingBarriers.size()),
+			leadingBarriers.data());
+	}
+
+	pendingCommandList->Close();
+
+	// Another queue may not have signaled the value yet, the GPU waits for it.
+	for (auto& queueWait : queueWaits)
+	{
+		ThrowIfFailed(
+			this->m_commandQueue->Wait(
+				static_cast<Dx12Fence*>(queueWait.Fence)->GetImpl(),
+				queueWait.FenceValue));
+	}
+
+	// Skip the pending command list if there was nothing to resolve.
+	size_t firstCommandList = leadingBarriers.empty() ? 1 : 0;
+	this->m_commandQueue->ExecuteCommandLists(
+		static_cast<UINT>(d3d12CommandLists.size() - firstCommandList),
+		d3d12CommandLists.data() + firstCommandList);
+
+	uint64_t signaledValue = this->SignalLocked();
+	LOG_CORE_ASSERT(signaledValue == fenceValue, "Fence value changed during submission");
+
+	// Queue command lists for reuse once the GPU is done with them. The allocators go back
+	// to the pool straight away, it checks the fence before handing them out again.
 	for (auto commandList : toBeQueued)
 	{
-		this->m_inflightCommandLists.Push({ fenceValue, commandList });
+		this->DiscardAllocator(fenceValue, commandList->GetCommandAllocator());
+
+		// Released with the submission rather than the command list, a pooled command list
+		// doesn't keep resources or pipeline states alive until it's reused.
+		this->m_deferredReleaseQueue->Release(this->m_fence.get(), fenceValue, commandList->TakeTrackedObjects());
+		commandList->RetireUploads(this->m_fence.get(), fenceValue);
+
+		this->m_fenceCompletionService->Enqueue(
+			this->m_fence.get(),
+			fenceValue,
+			[this, commandList]() {
+				// Idle command lists in the pool don't hold on to shader visible descriptors.
+				commandList->ReleaseDynamicDescriptors();
+
+				if (!this->m_availableCommandList.TryPush(commandList))
+				{
+					LOG_CORE_WARN("Command list pool is full, releasing command list");
+				}
+			});
 	}
 
 	return fenceValue;
 }
 
+uint64_t Core::CommandQueue::ExecuteParallel(
+	TaskScheduler& taskScheduler,
+	uint32_t numChunks,
+	std::function<void(CommandList&, uint32_t)> const& recordChunk)
+{
+	// Indexed by chunk so the submission order doesn't depend on which worker finishes first.
+	std::vector<std::shared_ptr<CommandList>> commandLists(numChunks);
+	taskScheduler.ParallelFor(numChunks, [&](uint32_t chunk) {
+		commandLists[chunk] = this->GetCommandList();
+		recordChunk(*commandLists[chunk], chunk);
+		});
+
+	return this->ExecuteCommandLists(commandLists);
+}
 
 ID3D12CommandAllocator* CommandQueue::RequestAllocator()
 {
@@ -137,37 +252,58 @@ void CommandQueue::DiscardAllocator(uint64_t fence, ID3D12CommandAllocator* allo
 }
 
 uint64_t CommandQueue::Signal()
+{
+	std::lock_guard<std::mutex> submitLock(this->m_submitMutex);
+	return this->SignalLocked();
+}
+
+uint64_t CommandQueue::SignalLocked()
 {
 	// This is the value that should be signaled when the GPU is finished the command queue.
 	uint64_t fenceValue = ++this->m_fenceValue;
+
+	// Objects released from here on may be used by the work this signal follows.
+	this->m_deferredReleaseQueue->SetLastSubmittedValue(this->m_fence.get(), fenceValue);
+
 	ThrowIfFailed(
-		this->m_commandQueue->Signal(this->m_fence.Get(), fenceValue));
+		this->m_commandQueue->Signal(this->m_fence->GetImpl(), fenceValue));
+
+	this->m_fenceCompletionService->Enqueue(
+		this->m_fence.get(),
+		fenceValue,
+		[deferredReleaseQueue = this->m_deferredReleaseQueue, fence = this->m_fence.get()]() {
+			deferredReleaseQueue->ReleaseCompleted(fence);
+		});
 
 	return fenceValue;
 }
 
-void CommandQueue::WaitForFenceValue(uint64_t fenceValue)
+void CommandQueue::Wait(CommandQueue const& other, uint64_t fenceValue)
 {
-	if (!this->IsFenceComplete(fenceValue))
+	// A queue executes in order, it never has to wait on itself.
+	if (&other == this)
 	{
-		auto fenceEvent = ::CreateEvent(NULL, FALSE, FALSE, NULL);
-		LOG_CORE_ASSERT(fenceEvent, "Failed to create fence event.");
+		return;
+	}
 
-		this->m_fence->SetEventOnCompletion(fenceValue, fenceEvent);
-		::WaitForSingleObject(fenceEvent, DWORD_MAX);
+	std::lock_guard<std::mutex> submitLock(this->m_submitMutex);
+	ThrowIfFailed(
+		this->m_commandQueue->Wait(other.m_fence->GetImpl(), fenceValue));
 
-		::CloseHandle(fenceEvent);
-	}
+	this->m_queueDependencyTracker->RecordWait(this->m_type, other.m_type, fenceValue);
 }
 
-void CommandQueue::Flush()
+void CommandQueue::WaitForFenceValue(uint64_t fenceValue)
 {
-	std::unique_lock<std::mutex> lock(this->m_processInFlightCommandListsThreadMutex);
-	this->m_processInflightCommandListThreadCv.wait(
-		lock, 
-		[this] { return this->m_inflightCommandLists.Empty(); });
+	this->m_fence->WaitForValue(fenceValue);
+}
 
+void CommandQueue::Flush()
+{
 	this->WaitForFenceValue(this->Signal());
+
+	// Make sure every in flight command list has been recycled.
+	this->m_fenceCompletionService->Flush(this->m_fence.get());
 }
 
 Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CommandQueue::CreateCommandAllocator()
@@ -194,30 +330,3 @@ Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> CommandQueue::CreateCommandLi
 
 	return commandList;
 }
-
-void Core::CommandQueue::ProccessInFlightCommandLists()
-{
-	std::unique_lock<std::mutex> lock(this->m_processInFlightCommandListsThreadMutex, std::defer_lock);
-
-	while (this->m_bProcessInflightCommandLists)
-	{
-		CommandListEntry commandListEntry;
-
-		lock.lock();
-		while (this->m_inflightCommandLists.TryPop(commandListEntry))
-		{
-			auto fenceValue = std::get<0>(commandListEntry);
-			auto commandList = std::get<1>(commandListEntry);
-
-			this->WaitForFenceValue(fenceValue);
-
-			commandList->Reset();
-
-			this->m_availableCommandList.Push(commandList);
-		}
-		lock.unlock();
-		this->m_processInflightCommandListThreadCv.notify_one();
-
-		std::this_thread::yield();
-	}
-}
@@ -4,17 +4,21 @@
 #include <wrl.h>    // For Microsoft::WRL::ComPtr
 
 #include <queue>    // For std::queue
-
-#include <thread>
-#include <condition_variable>
+#include <functional>
+#include <mutex>
 
 #include "CommandAllocatorPool.h"
-#include "ThreadSafePool.h"
+#include "MpmcQueue.h"
+#include "Dx12Fence.h"
 
 namespace Core
 {
 	class CommandList;
+	class DeferredReleaseQueue;
 	class Dx12RenderDevice;
+	class FenceCompletionService;
+	class QueueDependencyTracker;
+	class TaskScheduler;
 
 	// TODO: Should be non copyable
 	class CommandQueue
@@ -29,16 +33,43 @@ namespace Core
 		std::shared_ptr<CommandList> GetCommandList();
 
 		uint64_t ExecuteCommandList(std::shared_ptr<CommandList> commandList);
+
+		/**
+		 * Submit the command lists in order with a single ExecuteCommandLists call and signal the
+		 * fence once. Pending barriers of the whole batch are resolved into one fix-up command list.
+		 */
+		uint64_t ExecuteCommandLists(std::vector<std::shared_ptr<CommandList>> const& commandLists);
+
+		/**
+		 * Records numChunks command lists on the task scheduler and submits them in chunk
+		 * order. Each chunk starts from a reset command list, so it has to bind its own render
+		 * targets, root signature and pipeline state.
+		 */
+		uint64_t ExecuteParallel(
+			TaskScheduler& taskScheduler,
+			uint32_t numChunks,
+			std::function<void(CommandList&, uint32_t)> const& recordChunk);
+
 		uint64_t Signal();
 
+		/**
+		 * Makes this queue wait on the GPU until the other queue's fence reaches fenceValue,
+		 * without blocking the CPU.
+		 */
+		void Wait(CommandQueue const& other, uint64_t fenceValue);
 
-		bool IsFenceComplete(uint64_t fenceValue) { return this->m_fence->GetCompletedValue() >= fenceValue; };
+		bool IsFenceComplete(uint64_t fenceValue) { return this->m_fence->IsComplete(fenceValue); };
 		void WaitForFenceValue(uint64_t fenceValue);
 		void Flush();
 
 		ID3D12CommandQueue* GetImpl() const { return this->m_commandQueue.Get(); }
+		IFence* GetFence() const { return this->m_fence.get(); }
+
+		CommandAllocatorPool::Statistics GetAllocatorStatistics() const { return this->m_commandAllocatorPool.GetStatistics(); }
 
 	protected:
+		// Expects the submit mutex to be held.
+		uint64_t SignalLocked();
 
 		ID3D12CommandAllocator* RequestAllocator();
 		void DiscardAllocator(uint64_t fence, ID3D12CommandAllocator* allocator);
@@ -48,16 +79,16 @@ namespace Core
 		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> CreateCommandList(
 			ID3D12CommandAllocator* commandAllocator);
 
-	private:
-		void ProccessInFlightCommandLists();
-
 	private:
 		const D3D12_COMMAND_LIST_TYPE m_type;
 
 		std::shared_ptr<Dx12RenderDevice> m_renderDevice;
 
 		Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_commandQueue;
-		Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
+		std::unique_ptr<Dx12Fence> m_fence;
+		std::shared_ptr<FenceCompletionService> m_fenceCompletionService;
+		std::shared_ptr<QueueDependencyTracker> m_queueDependencyTracker;
+		std::shared_ptr<DeferredReleaseQueue> m_deferredReleaseQueue;
 
 		CommandAllocatorPool m_commandAllocatorPool;
 
@@ -65,14 +96,12 @@ namespace Core
 
 		std::atomic_uint64_t m_fenceValue;
 
-		using CommandListEntry = std::tuple<uint64_t, std::shared_ptr<CommandList>>;
-		ThreadSafePool<CommandListEntry> m_inflightCommandLists;
-		ThreadSafePool<std::shared_ptr<CommandList>> m_availableCommandList;
+		// Serializes submissions, signals and waits on this queue. Submissions to different
+		// queues only contend on the resource state lock while resolving barriers.
+		std::mutex m_submitMutex;
 
-		std::thread m_processInflightCommnadListsThread;
-		std::atomic_bool m_bProcessInflightCommandLists;
-		std::mutex m_processInFlightCommandListsThreadMutex;
-		std::condition_variable m_processInflightCommandListThreadCv;
+		// Command lists are handed back here by the fence completion service once their fence signals.
+		MpmcQueue<std::shared_ptr<CommandList>> m_availableCommandList;
 	};
 }
 
@@ -66,8 +66,7 @@ void Core::DescriptorAllocation::Free()
 {
     if (!this->IsNull() && this->m_page)
     {
-        // TODO: GetFrameCount some how?
-        this->m_page->Free(std::move(*this), 1);
+        this->m_page->Free(std::move(*this));
 
         this->m_descriptor.ptr = 0;
         this->m_numHandles = 0;
@@ -42,7 +42,7 @@ namespace Core
 
         // Get the heap that this allocation came from.
         // (For internal use only).
-        std::shared_ptr<DescriptorAllocatorPage> GetDescriptorAllocatorPage() const { this->m_page; }
+        std::shared_ptr<DescriptorAllocatorPage> GetDescriptorAllocatorPage() const { return this->m_page; }
 
     private:
         // Free the descriptor back to the heap it came from.
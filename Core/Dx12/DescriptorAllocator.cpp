@@ -1,14 +1,22 @@
 #include "pch.h"
-#include "Dx12\DescriptorAllocator.h"
+#include "Dx12/DescriptorAllocator.h"
 
-#include "Dx12\DescriptorAllocatorPage.h"
+#include "Dx12/DescriptorAllocatorPage.h"
 using namespace Core;
 
+namespace
+{
+	// The number of single descriptors a thread reserves at once.
+	constexpr uint32_t MagazineSize = 32;
+}
+
 DescriptorAllocator::DescriptorAllocator(
 	Microsoft::WRL::ComPtr<ID3D12Device2> device,
+	std::shared_ptr<DeferredReleaseQueue> deferredReleaseQueue,
 	D3D12_DESCRIPTOR_HEAP_TYPE heapType,
 	uint32_t numDescriptorsPerHeap)
 	: m_device(device)
+	, m_deferredReleaseQueue(deferredReleaseQueue)
 	, m_heapType(heapType)
 	, m_numDescriptorsPerHeap(numDescriptorsPerHeap)
 {
@@ -16,11 +24,30 @@ DescriptorAllocator::DescriptorAllocator(
 
 DescriptorAllocation Core::DescriptorAllocator::Allocate(uint32_t numDescriptors)
 {
+	if (numDescriptors == 1)
+	{
+		auto& magazine = this->m_threadLocalMagazines.Get();
+		if (magazine.Descriptors.empty())
+		{
+			this->RefillMagazine(magazine);
+		}
+
+		ReservedDescriptor reserved = std::move(magazine.Descriptors.back());
+		magazine.Descriptors.pop_back();
+
+		return reserved.Page->CreateAllocation(reserved.Offset);
+	}
+
 	std::lock_guard<std::mutex> lock(this->m_allocationMutex);
 
+	if (this->m_availableHeaps.empty())
+	{
+		this->RefreshAvailableHeaps();
+	}
+
 	DescriptorAllocation allocation;
 
-	for (auto iter = m_availableHeaps.begin(); iter != this->m_availableHeaps.end(); ++iter)
+	for (auto iter = m_availableHeaps.begin(); iter != this->m_availableHeaps.end();)
 	{
 		auto allocatorPage = this->m_heapPool[*iter];
 		
@@ -31,6 +58,10 @@ DescriptorAllocation Core::DescriptorAllocator::Allocate(uint32_t numDescriptors
 		{
 			iter = this->m_availableHeaps.erase(iter);
 		}
+		else
+		{
+			++iter;
+		}
 
 		// A valid allocation has been found.
 		if (!allocation.IsNull())
@@ -55,19 +86,91 @@ DescriptorAllocation Core::DescriptorAllocator::Allocate()
 	return this->Allocate(1);
 }
 
-void Core::DescriptorAllocator::ReleaseStaleDescriptors(uint64_t frameNumber)
+void Core::DescriptorAllocator::RefillMagazine(DescriptorMagazine& magazine)
+{
+	std::lock_guard<std::mutex> lock(this->m_allocationMutex);
+
+	if (this->m_availableHeaps.empty())
+	{
+		this->RefreshAvailableHeaps();
+	}
+
+	std::vector<uint32_t> offsets;
+	offsets.reserve(MagazineSize);
+
+	for (auto iter = m_availableHeaps.begin(); iter != this->m_availableHeaps.end() && offsets.size() < MagazineSize;)
+	{
+		auto allocatorPage = this->m_heapPool[*iter];
+
+		uint32_t numReserved = allocatorPage->ReserveDescriptors(
+			MagazineSize - static_cast<uint32_t>(offsets.size()),
+			offsets);
+
+		for (size_t i = offsets.size() - numReserved; i < offsets.size(); i++)
+		{
+			magazine.Descriptors.push_back({ allocatorPage, offsets[i] });
+		}
+
+		// Allocator page is full
+		if (allocatorPage->NumFreeHandles() == 0)
+		{
+			iter = this->m_availableHeaps.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+
+	if (offsets.empty())
+	{
+		auto newPage = this->CreateAllocatorPage();
+		newPage->ReserveDescriptors(MagazineSize, offsets);
+
+		for (uint32_t offset : offsets)
+		{
+			magazine.Descriptors.push_back({ newPage, offset });
+		}
+	}
+}
+
+Core::DescriptorAllocator::DescriptorMagazine::~DescriptorMagazine()
+{
+	// Descriptors reserved together are next to each other, return them per page.
+	std::vector<uint32_t> offsets;
+	for (size_t i = 0; i < this->Descriptors.size(); i++)
+	{
+		offsets.push_back(this->Descriptors[i].Offset);
+
+		if (i + 1 == this->Descriptors.size() || this->Descriptors[i + 1].Page != this->Descriptors[i].Page)
+		{
+			this->Descriptors[i].Page->ReleaseReservedDescriptors(offsets);
+			offsets.clear();
+		}
+	}
+}
+
+void Core::DescriptorAllocator::FlushStaleDescriptors()
 {
 	std::lock_guard<std::mutex> lock(this->m_allocationMutex); 
 	
-	for (size_t i = 0; i < m_heapPool.size(); ++i)
+	for (auto const& page : this->m_heapPool)
 	{
-		auto page = m_heapPool[i];
+		page->FlushStaleDescriptors();
+	}
 
-		page->ReleaseStaleDescriptors(frameNumber);
+	this->RefreshAvailableHeaps();
+}
 
-		if (page->NumFreeHandles() > 0)
+void Core::DescriptorAllocator::RefreshAvailableHeaps()
+{
+	// Stale descriptors are freed on the fence completion thread, the pages don't tell the
+	// allocator when they have space again.
+	for (size_t i = 0; i < this->m_heapPool.size(); ++i)
+	{
+		if (this->m_heapPool[i]->NumFreeHandles() > 0)
 		{
-			m_availableHeaps.insert(i);
+			this->m_availableHeaps.insert(i);
 		}
 	}
 }
@@ -78,7 +181,8 @@ std::shared_ptr<DescriptorAllocatorPage> Core::DescriptorAllocator::CreateAlloca
 		std::make_shared<DescriptorAllocatorPage>(
 			this->m_heapType,
 			this->m_numDescriptorsPerHeap,
-			this->m_device);
+			this->m_device,
+			this->m_deferredReleaseQueue);
 
 	this->m_heapPool.emplace_back(newPage);
 	this->m_availableHeaps.insert(this->m_heapPool.size() - 1);
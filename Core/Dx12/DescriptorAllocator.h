@@ -7,29 +7,59 @@
 #include <set>
 #include <mutex>
 
+#include "DeferredReleaseQueue.h"
+#include "InstanceThreadLocal.h"
+
 namespace Core
 {
 	class DescriptorAllocatorPage;
 	class DescriptorAllocation;
 
+	/**
+	 * Single descriptors are handed out from a per thread magazine without locking. An empty
+	 * magazine is refilled with a batch reserved from the pages under the allocator's lock,
+	 * so threads creating views at the same time rarely contend.
+	 */
 	class DescriptorAllocator
 	{
 	public:
 		DescriptorAllocator(
 			Microsoft::WRL::ComPtr<ID3D12Device2> device,
+			std::shared_ptr<DeferredReleaseQueue> deferredReleaseQueue,
 			D3D12_DESCRIPTOR_HEAP_TYPE heapType,
 			uint32_t numDescriptorsPerHeap = 256);
 
 		DescriptorAllocation Allocate(uint32_t numDescriptors);
 		DescriptorAllocation Allocate();
 
-		void ReleaseStaleDescriptors(uint64_t frameNumber);
+		// Defers the calling thread's gathered frees, and picks up pages that have free space again.
+		void FlushStaleDescriptors();
 
 	private:
 		std::shared_ptr<DescriptorAllocatorPage> CreateAllocatorPage();
 
+		struct ReservedDescriptor
+		{
+			std::shared_ptr<DescriptorAllocatorPage> Page;
+			uint32_t Offset;
+		};
+
+		// Descriptors left in a thread's magazine go back to their pages when the thread exits.
+		struct DescriptorMagazine
+		{
+			~DescriptorMagazine();
+
+			std::vector<ReservedDescriptor> Descriptors;
+		};
+
+		void RefillMagazine(DescriptorMagazine& magazine);
+
+		// Expects the allocation mutex to be held.
+		void RefreshAvailableHeaps();
+
 	private:
 		Microsoft::WRL::ComPtr<ID3D12Device2> m_device;
+		std::shared_ptr<DeferredReleaseQueue> m_deferredReleaseQueue;
 		const D3D12_DESCRIPTOR_HEAP_TYPE m_heapType;
 		uint32_t m_numDescriptorsPerHeap;
 
@@ -38,6 +68,8 @@ namespace Core
 
 		std::set<size_t> m_availableHeaps;
 
+		InstanceThreadLocal<DescriptorMagazine> m_threadLocalMagazines;
+
 		std::mutex m_allocationMutex;
 	};
 }
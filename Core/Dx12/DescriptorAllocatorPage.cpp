@@ -3,12 +3,21 @@
 
 using namespace Core;
 
+namespace
+{
+	// A thread defers its frees once it has gathered this many.
+	constexpr size_t StaleDescriptorBatchSize = 32;
+}
+
 Core::DescriptorAllocatorPage::DescriptorAllocatorPage(
 	D3D12_DESCRIPTOR_HEAP_TYPE type,
 	uint32_t numDescriptors,
-	Microsoft::WRL::ComPtr<ID3D12Device2> device)
-	: m_heapType(type)
+	Microsoft::WRL::ComPtr<ID3D12Device2> device,
+	std::shared_ptr<DeferredReleaseQueue> deferredReleaseQueue)
+	: m_allocator(numDescriptors)
+	, m_heapType(type)
 	, m_numDescriptorsInHeap(numDescriptors)
+	, m_deferredReleaseQueue(deferredReleaseQueue)
 {
 
 	D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
@@ -21,9 +30,6 @@ Core::DescriptorAllocatorPage::DescriptorAllocatorPage(
 	this->m_baseDescriptor = m_d3d12DescriptorHeap->GetCPUDescriptorHandleForHeapStart();
 	this->m_descriptorHandleIncrementSize = device->GetDescriptorHandleIncrementSize(m_heapType);
 	this->m_numFreeHandles = m_numDescriptorsInHeap;
-
-	// Initialize the free lists
-	this->AddNewBlock(0, m_numFreeHandles);
 }
 
 DescriptorAllocation Core::DescriptorAllocatorPage::Allocate(uint32_t numDescriptors)
@@ -37,37 +43,14 @@ DescriptorAllocation Core::DescriptorAllocatorPage::Allocate(uint32_t numDescrip
 		return DescriptorAllocation();
 	}
 
-	// Get the first block that is large enough to satisfy the request.
-	auto smallestBlockIt = this->m_freeListBySize.lower_bound(numDescriptors);
-	if (smallestBlockIt == this->m_freeListBySize.end())
+	// Get a free block that is large enough to satisfy the request.
+	uint32_t offset = this->m_allocator.Allocate(numDescriptors);
+	if (offset == TlsfAllocator::InvalidOffset)
 	{
 		// There was no free block that could satisfy the request.
 		return DescriptorAllocation();
 	}
 
-	// The size of the smallest block that satisfies the request.
-	auto blockSize = smallestBlockIt->first;
-
-	// The pointer to the same entry in the FreeListByOffset map.
-	auto offsetIt = smallestBlockIt->second;
-
-	// The offset in the descriptor heap.
-	auto offset = offsetIt->first;
-
-	// Remove the existing free block from the free list.
-	m_freeListBySize.erase(smallestBlockIt);
-	m_freeListByOffset.erase(offsetIt);
-
-	// Compute the new free block that results from splitting this block.
-	auto newOffset = offset + numDescriptors;
-	auto newSize = blockSize - numDescriptors;
-
-	if (newSize > 0)
-	{
-		// If the allocation didn't exactly match the requested size,
-		// return the left-over to the free list.
-		this->AddNewBlock(newOffset, newSize);
-	}
 	// Decrement free handles.
 	this->m_numFreeHandles -= numDescriptors;
 
@@ -81,110 +64,112 @@ DescriptorAllocation Core::DescriptorAllocatorPage::Allocate(uint32_t numDescrip
 		shared_from_this());
 }
 
-void Core::DescriptorAllocatorPage::Free(DescriptorAllocation&& descriptor, uint64_t frameNumber)
+uint32_t Core::DescriptorAllocatorPage::ReserveDescriptors(uint32_t count, std::vector<uint32_t>& offsets)
 {
-	// Compute the offset of the descriptor within the descriptor heap.
-	auto offset = ComputeOffset(descriptor.GetDescriptorHandle());
-
 	std::lock_guard<std::mutex> lock(this->m_allocationMutex);
 
-	// Don't add the block directly to the free list until the frame has completed.
-	this->m_staleDescriptors.emplace(offset, descriptor.GetNumHandles(), frameNumber);
-}
-
-void Core::DescriptorAllocatorPage::ReleaseStaleDescriptors(uint64_t frameNumber)
-{
-	std::lock_guard<std::mutex> lock(this->m_allocationMutex);
-
-	while (!this->m_staleDescriptors.empty() && this->m_staleDescriptors.front().FrameNumber <= frameNumber)
+	uint32_t numReserved = 0;
+	for (; numReserved < count; numReserved++)
 	{
-		auto& staleDescriptor = m_staleDescriptors.front();
+		uint32_t offset = this->m_allocator.Allocate(1);
+		if (offset == TlsfAllocator::InvalidOffset)
+		{
+			break;
+		}
 
-		// The offset of the descriptor in the heap.
-		auto offset = staleDescriptor.Offset;
-		// The number of descriptors that were allocated.
-		auto numDescriptors = staleDescriptor.Size;
+		offsets.push_back(offset);
+	}
 
-		FreeBlock(offset, numDescriptors);
+	this->m_numFreeHandles -= numReserved;
 
-		this->m_staleDescriptors.pop();
-	}
+	return numReserved;
 }
 
-uint32_t Core::DescriptorAllocatorPage::ComputeOffset(D3D12_CPU_DESCRIPTOR_HANDLE handle)
+DescriptorAllocation Core::DescriptorAllocatorPage::CreateAllocation(uint32_t offset)
 {
-	return static_cast<uint32_t>(handle.ptr - this->m_baseDescriptor.ptr) / this->m_descriptorHandleIncrementSize;
+	return DescriptorAllocation(
+		CD3DX12_CPU_DESCRIPTOR_HANDLE(
+			this->m_baseDescriptor,
+			offset,
+			this->m_descriptorHandleIncrementSize),
+		1,
+		this->m_descriptorHandleIncrementSize,
+		shared_from_this());
 }
 
-void Core::DescriptorAllocatorPage::AddNewBlock(uint32_t offset, uint32_t numDescritpors)
+void Core::DescriptorAllocatorPage::ReleaseReservedDescriptors(std::vector<uint32_t> const& offsets)
 {
-	auto offsetItr = this->m_freeListByOffset.emplace(offset, numDescritpors);
-	auto sizeItr = this->m_freeListBySize.emplace(numDescritpors, offsetItr.first);
-	offsetItr.first->second.FreeListBySizeIter = sizeItr;
+	std::lock_guard<std::mutex> lock(this->m_allocationMutex);
+
+	for (uint32_t offset : offsets)
+	{
+		this->m_allocator.Free(offset);
+	}
+
+	this->m_numFreeHandles += static_cast<uint32_t>(offsets.size());
 }
 
-void Core::DescriptorAllocatorPage::FreeBlock(uint32_t offset, uint32_t numDescriptors)
+void Core::DescriptorAllocatorPage::Free(DescriptorAllocation&& descriptor)
 {
-	// Find the first element whose offset is greater than the specified offset.
-	// This is the block that should appear after the block that is being freed.
-	auto nextBlockIt = this->m_freeListByOffset.upper_bound(offset);
+	// Compute the offset of the descriptor within the descriptor heap.
+	auto offset = ComputeOffset(descriptor.GetDescriptorHandle());
+
+	auto& threadStaleDescriptors = this->m_threadLocalStaleDescriptors.Get();
+	if (threadStaleDescriptors.Descriptors.empty())
+	{
+		threadStaleDescriptors.Page = weak_from_this();
+	}
 
-	// Find the block that appears before the block being freed.
-	auto prevBlockIt = nextBlockIt;
+	// Don't add the block directly to the free list until the queues are done with it.
+	threadStaleDescriptors.Descriptors.emplace_back(offset, descriptor.GetNumHandles());
 
-	// If it's not the first block in the list.
-	if (prevBlockIt != this->m_freeListByOffset.begin())
+	if (threadStaleDescriptors.Descriptors.size() >= StaleDescriptorBatchSize)
 	{
-		// Go to the previous block in the list.
-		--prevBlockIt;
+		this->QueueStaleDescriptors(threadStaleDescriptors.Descriptors);
 	}
-	else
+}
+
+void Core::DescriptorAllocatorPage::QueueStaleDescriptors(std::vector<StaleDescriptorInfo>& staleDescriptors)
+{
+	if (staleDescriptors.empty())
 	{
-		// Otherwise, just set it to the end of the list to indicate that no
-		// block comes before the one being freed.
-		prevBlockIt = this->m_freeListByOffset.end();
+		return;
 	}
 
-	// Add the number of free handles back to the heap.
-	// This needs to be done before merging any blocks since merging
-	// blocks modifies the numDescriptors variable.
-	this->m_numFreeHandles += numDescriptors;
+	// The batch keeps the page alive until it's released.
+	this->m_deferredReleaseQueue->Defer([page = shared_from_this(), batch = std::move(staleDescriptors)]() {
+		page->FreeStaleDescriptors(batch);
+		});
 
-	if (prevBlockIt != this->m_freeListByOffset.end() &&
-		offset == prevBlockIt->first + prevBlockIt->second.Size)
+	staleDescriptors.clear();
+}
+
+Core::DescriptorAllocatorPage::ThreadStaleDescriptors::~ThreadStaleDescriptors()
+{
+	if (auto page = this->Page.lock())
 	{
-		// The previous block is exactly behind the block that is to be freed.
-		//
-		// PrevBlock.Offset           Offset
-		// |                          |
-		// |<-----PrevBlock.Size----->|<------Size-------->|
-		//
-
-		// Increase the block size by the size of merging with the previous block.
-		offset = prevBlockIt->first;
-		numDescriptors += prevBlockIt->second.Size;
-
-		// Remove the previous block from the free list.
-		this->m_freeListBySize.erase(prevBlockIt->second.FreeListBySizeIter);
-		this->m_freeListByOffset.erase(prevBlockIt);
+		page->QueueStaleDescriptors(this->Descriptors);
 	}
+}
+
+void Core::DescriptorAllocatorPage::FlushStaleDescriptors()
+{
+	this->QueueStaleDescriptors(this->m_threadLocalStaleDescriptors.Get().Descriptors);
+}
 
-	if (nextBlockIt != this->m_freeListByOffset.end() &&
-		offset + numDescriptors == nextBlockIt->first)
+void Core::DescriptorAllocatorPage::FreeStaleDescriptors(std::vector<StaleDescriptorInfo> const& staleDescriptors)
+{
+	std::lock_guard<std::mutex> lock(this->m_allocationMutex);
+
+	for (auto const& staleDescriptor : staleDescriptors)
 	{
-		// The next block is exactly in front of the block that is to be freed.
-		//
-		// Offset               NextBlock.Offset 
-		// |                    |
-		// |<------Size-------->|<-----NextBlock.Size----->|
-
-		// Increase the block size by the size of merging with the next block.
-		numDescriptors += nextBlockIt->second.Size;
-
-		// Remove the next block from the free list.
-		this->m_freeListBySize.erase(nextBlockIt->second.FreeListBySizeIter);
-		this->m_freeListByOffset.erase(nextBlockIt);
+		// Coalesced with the neighbouring free blocks.
+		this->m_allocator.Free(staleDescriptor.Offset);
+		this->m_numFreeHandles += staleDescriptor.Size;
 	}
+}
 
-	this->AddNewBlock(offset, numDescriptors);
+uint32_t Core::DescriptorAllocatorPage::ComputeOffset(D3D12_CPU_DESCRIPTOR_HANDLE handle)
+{
+	return static_cast<uint32_t>(handle.ptr - this->m_baseDescriptor.ptr) / this->m_descriptorHandleIncrementSize;
 }
@@ -4,12 +4,15 @@
 
 #include <wrl.h>
 
-#include <map>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <atomic>
+#include <vector>
 
+#include "DeferredReleaseQueue.h"
 #include "DescriptorAllocation.h"
+#include "InstanceThreadLocal.h"
+#include "TlsfAllocator.h"
 
 namespace Core
 {
@@ -19,80 +22,89 @@ namespace Core
 		DescriptorAllocatorPage(
 			D3D12_DESCRIPTOR_HEAP_TYPE type,
 			uint32_t numDescriptors,
-			Microsoft::WRL::ComPtr<ID3D12Device2> device);
+			Microsoft::WRL::ComPtr<ID3D12Device2> device,
+			std::shared_ptr<DeferredReleaseQueue> deferredReleaseQueue);
 
 		D3D12_DESCRIPTOR_HEAP_TYPE GetHeapType() const { return this->m_heapType; }
 
 		bool HasSpace(uint32_t numDescriptors) const 
 		{ 
-			return this->m_freeListBySize.lower_bound(numDescriptors) != this->m_freeListBySize.end();
+			std::lock_guard<std::mutex> lock(this->m_allocationMutex);
+			return this->m_allocator.HasSpace(numDescriptors);
 		}
 
 		uint32_t NumFreeHandles() const { return this->m_numFreeHandles; }
 
 		DescriptorAllocation Allocate(uint32_t numDescriptors);
 
-		void Free(DescriptorAllocation&& descriptor, uint64_t frameNumber);
+		// Reserves up to count single descriptors under one lock, returns the number reserved.
+		uint32_t ReserveDescriptors(uint32_t count, std::vector<uint32_t>& offsets);
 
-		void ReleaseStaleDescriptors(uint64_t frameNumber);
+		// Wraps a reserved descriptor, it's freed like any other allocation.
+		DescriptorAllocation CreateAllocation(uint32_t offset);
 
-	protected:
-		uint32_t ComputeOffset(D3D12_CPU_DESCRIPTOR_HANDLE handle);
+		// Returns reserved descriptors that were never handed out, they're free straight away.
+		void ReleaseReservedDescriptors(std::vector<uint32_t> const& offsets);
+
+		/**
+		 * The descriptors are released once the queues have passed the work submitted so far.
+		 * Frees are gathered per thread and deferred in batches, a thread's last few frees are
+		 * deferred when it frees again, calls FlushStaleDescriptors or exits.
+		 */
+		void Free(DescriptorAllocation&& descriptor);
 
-		void AddNewBlock(uint32_t offset, uint32_t numDescritpors);
+		// Defers the calling thread's gathered frees.
+		void FlushStaleDescriptors();
 
-		void FreeBlock(uint32_t offset, uint32_t numDescriptors);
+	protected:
+		uint32_t ComputeOffset(D3D12_CPU_DESCRIPTOR_HANDLE handle);
 
 	private:
 		// The offset in descritpors within the descriptor heap
 		using OffsetType = uint32_t;
 		using SizeType = uint32_t;
-		
-		struct FreeBlockInfo;
-		using FreeListByOffset = std::map<OffsetType, FreeBlockInfo>;
-		using FreeListBySize = std::multimap<SizeType, FreeListByOffset::iterator>;
-
-		struct FreeBlockInfo
-		{
-			FreeBlockInfo(SizeType size)
-				: Size(size)
-			{}
-
-			SizeType Size;
-			FreeListBySize::iterator FreeListBySizeIter;
-		};
 
 		struct StaleDescriptorInfo
 		{
-			StaleDescriptorInfo(OffsetType offset, SizeType size, uint64_t frameNumber)
+			StaleDescriptorInfo(OffsetType offset, SizeType size)
 				: Offset(offset)
 				, Size(size)
-				, FrameNumber(frameNumber)
 			{}
 
 			OffsetType Offset;
 			SizeType Size;
-			uint64_t FrameNumber;
 		};
 
-		// Stale descriptors are queued for release until the frame that they were freed
-		// has completed.
-		using StaleDescriptorQueue = std::queue<StaleDescriptorInfo>;
+		// A thread's frees that haven't been deferred yet, deferred when the thread exits.
+		struct ThreadStaleDescriptors
+		{
+			~ThreadStaleDescriptors();
+
+			std::weak_ptr<DescriptorAllocatorPage> Page;
+			std::vector<StaleDescriptorInfo> Descriptors;
+		};
+
+		void QueueStaleDescriptors(std::vector<StaleDescriptorInfo>& staleDescriptors);
+
+		// Called by the deferred release queue once no queue can reference the descriptors.
+		void FreeStaleDescriptors(std::vector<StaleDescriptorInfo> const& staleDescriptors);
 
 
 	private:
-		FreeListByOffset m_freeListByOffset;
-		FreeListBySize m_freeListBySize;
-		StaleDescriptorQueue m_staleDescriptors;
+		// Constant time allocation and coalescing of the free ranges in the heap.
+		TlsfAllocator m_allocator;
+		InstanceThreadLocal<ThreadStaleDescriptors> m_threadLocalStaleDescriptors;
 
 		const D3D12_DESCRIPTOR_HEAP_TYPE m_heapType;
 		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_d3d12DescriptorHeap;
 		CD3DX12_CPU_DESCRIPTOR_HANDLE m_baseDescriptor;
 		uint32_t m_descriptorHandleIncrementSize;
 		uint32_t m_numDescriptorsInHeap;
-		uint32_t m_numFreeHandles;
+		std::atomic_uint32_t m_numFreeHandles;
+
+		std::shared_ptr<DeferredReleaseQueue> m_deferredReleaseQueue;
 
-		std::mutex m_allocationMutex;
+		mutable std::mutex m_allocationMutex;
 	};
 }
 
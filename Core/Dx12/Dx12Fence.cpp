@@ -0,0 +1,74 @@
+#include "pch.h"
+#include "Dx12Fence.h"
+
+using namespace Core;
+
+Core::Dx12Fence::Dx12Fence(Microsoft::WRL::ComPtr<ID3D12Device2> device, uint64_t initialValue)
+{
+	ThrowIfFailed(
+		device->CreateFence(initialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&this->m_fence)));
+}
+
+void Core::Dx12Fence::WaitForValue(uint64_t value)
+{
+	if (!this->IsComplete(value))
+	{
+		auto fenceEvent = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+		LOG_CORE_ASSERT(fenceEvent, "Failed to create fence event.");
+
+		this->m_fence->SetEventOnCompletion(value, fenceEvent);
+		::WaitForSingleObject(fenceEvent, DWORD_MAX);
+
+		::CloseHandle(fenceEvent);
+	}
+}
+
+Core::Dx12FenceEvent::Dx12FenceEvent(Microsoft::WRL::ComPtr<ID3D12Device2> device)
+	: m_device(device)
+{
+	this->m_fenceEvent = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+	LOG_CORE_ASSERT(this->m_fenceEvent, "Failed to create fence event.");
+
+	this->m_wakeEvent = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+	LOG_CORE_ASSERT(this->m_wakeEvent, "Failed to create wake event.");
+}
+
+Core::Dx12FenceEvent::~Dx12FenceEvent()
+{
+	::CloseHandle(this->m_fenceEvent);
+	::CloseHandle(this->m_wakeEvent);
+}
+
+void Core::Dx12FenceEvent::WaitForAny(std::vector<WaitEntry> const& entries)
+{
+	DWORD numHandles = 1;
+	HANDLE handles[] = { this->m_wakeEvent, this->m_fenceEvent };
+
+	if (!entries.empty())
+	{
+		this->m_fences.clear();
+		this->m_fenceValues.clear();
+		for (auto& entry : entries)
+		{
+			this->m_fences.push_back(static_cast<Dx12Fence*>(entry.Fence)->GetImpl());
+			this->m_fenceValues.push_back(entry.Value);
+		}
+
+		ThrowIfFailed(
+			this->m_device->SetEventOnMultipleFenceCompletion(
+				this->m_fences.data(),
+				this->m_fenceValues.data(),
+				static_cast<UINT>(this->m_fences.size()),
+				D3D12_MULTIPLE_FENCE_WAIT_FLAG_ANY,
+				this->m_fenceEvent));
+
+		numHandles = 2;
+	}
+
+	::WaitForMultipleObjects(numHandles, handles, FALSE, INFINITE);
+}
+
+void Core::Dx12FenceEvent::Wake()
+{
+	::SetEvent(this->m_wakeEvent);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <d3d12.h>
+#include <wrl.h>
+
+#include "Fence.h"
+
+namespace Core
+{
+	class Dx12Fence : public IFence
+	{
+	public:
+		Dx12Fence(Microsoft::WRL::ComPtr<ID3D12Device2> device, uint64_t initialValue = 0);
+
+		uint64_t GetCompletedValue() const override { return this->m_fence->GetCompletedValue(); }
+		void WaitForValue(uint64_t value) override;
+
+		ID3D12Fence* GetImpl() const { return this->m_fence.Get(); }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
+	};
+
+	/**
+	 * Waits on any number of Dx12Fences with a single event through
+	 * ID3D12Device1::SetEventOnMultipleFenceCompletion.
+	 */
+	class Dx12FenceEvent : public IFenceEvent
+	{
+	public:
+		Dx12FenceEvent(Microsoft::WRL::ComPtr<ID3D12Device2> device);
+		~Dx12FenceEvent();
+
+		void WaitForAny(std::vector<WaitEntry> const& entries) override;
+		void Wake() override;
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12Device2> m_device;
+
+		HANDLE m_fenceEvent;
+		HANDLE m_wakeEvent;
+
+		std::vector<ID3D12Fence*> m_fences;
+		std::vector<UINT64> m_fenceValues;
+	};
+}
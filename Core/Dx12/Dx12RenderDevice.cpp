@@ -4,9 +4,31 @@
 #include "DescriptorAllocator.h"
 
 #include "DescriptorHeap.h"
+#include "Dx12Fence.h"
 
 using namespace Core;
 
+namespace
+{
+	// Well below the one million descriptors resource binding tier 1 allows.
+	constexpr uint32_t NumBindlessDescriptors = 1 << 16;
+
+	// The ring shared by the command lists' dynamic descriptor heaps, in chunks big enough
+	// for all tables of a root signature.
+	constexpr uint32_t NumDynamicDescriptors = 1 << 17;
+	constexpr uint32_t NumDescriptorsPerChunk = 1024;
+
+	// Shader visible sampler heaps are limited to 2048 descriptors.
+	constexpr uint32_t NumDynamicSamplers = D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE;
+	constexpr uint32_t NumSamplersPerChunk = 64;
+
+	// Shared by every command list, a few frames of dynamic constant, vertex and index data.
+	constexpr size_t UploadRingSize = _32MB;
+
+	// Meshes larger than this get a buffer of their own.
+	constexpr size_t StaticBufferSize = _32MB;
+}
+
 Core::Dx12RenderDevice::Dx12RenderDevice()
 {
 }
@@ -35,6 +57,9 @@ void Core::Dx12RenderDevice::Flush()
 	this->m_computeQueue->Flush();
 	this->m_copyQueue->Flush();
 	this->m_directQueue->Flush();
+
+	// Objects released to every queue wait on the queues flushed before their release too.
+	this->m_deferredReleaseQueue->ReleaseCompleted();
 }
 
 DescriptorAllocation Dx12RenderDevice::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t numDescritpors)
@@ -42,11 +67,11 @@ DescriptorAllocation Dx12RenderDevice::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP
 	return this->m_descriptorAllocators[type]->Allocate(numDescritpors);
 }
 
-void Core::Dx12RenderDevice::ReleaseStaleDescriptors(uint64_t finishedFrame)
+void Core::Dx12RenderDevice::FlushStaleDescriptors()
 {
 	for (int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i)
 	{
-		this->m_descriptorAllocators[i]->ReleaseStaleDescriptors(finishedFrame);
+		this->m_descriptorAllocators[i]->FlushStaleDescriptors();
 	}
 }
 
@@ -129,8 +154,39 @@ void Core::Dx12RenderDevice::Initialize(Microsoft::WRL::ComPtr<IDXGIFactory6> dx
 		this->m_descriptorAllocators[i] =
 			std::make_unique<DescriptorAllocator>(
 				this->m_d3d12Device,
+				this->m_deferredReleaseQueue,
 				static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(i));
 	}
+
+	this->m_gpuDescriptorHeaps[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV] =
+		std::make_shared<GpuDescriptorHeap>(
+			this->m_d3d12Device,
+			this->m_deferredReleaseQueue,
+			D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+			NumBindlessDescriptors,
+			NumDynamicDescriptors,
+			NumDescriptorsPerChunk);
+
+	this->m_gpuDescriptorHeaps[D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER] =
+		std::make_shared<GpuDescriptorHeap>(
+			this->m_d3d12Device,
+			this->m_deferredReleaseQueue,
+			D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER,
+			0,
+			NumDynamicSamplers,
+			NumSamplersPerChunk);
+
+	this->m_uploadRing =
+		std::make_shared<UploadRing>(
+			this->m_d3d12Device,
+			this->m_deferredReleaseQueue,
+			UploadRingSize);
+
+	this->m_staticBufferAllocator =
+		std::make_shared<StaticBufferAllocator>(
+			this->m_d3d12Device,
+			this->m_deferredReleaseQueue,
+			StaticBufferSize);
 }
 
 void Core::Dx12RenderDevice::CreateDevice(Microsoft::WRL::ComPtr<IDXGIFactory6> dxgiFactory)
@@ -290,6 +346,17 @@ Microsoft::WRL::ComPtr<IDXGIAdapter1> Core::Dx12RenderDevice::FindCompatibleAdap
 
 void Core::Dx12RenderDevice::CreateCommandQueues()
 {
+	// One thread waits on the fences of every queue.
+	this->m_fenceCompletionService =
+		std::make_shared<FenceCompletionService>(
+			std::make_unique<Dx12FenceEvent>(this->m_d3d12Device));
+
+	// Inserts the GPU waits between queues that share resources.
+	this->m_queueDependencyTracker = std::make_shared<QueueDependencyTracker>();
+
+	// Each queue registers its fence, and drains it as the fence completes.
+	this->m_deferredReleaseQueue = std::make_shared<DeferredReleaseQueue>();
+
 	this->m_directQueue =
 		std::make_shared<CommandQueue>(
 			this->shared_from_this(),
@@ -15,9 +15,15 @@
 #include <memory>
 
 #include "Dx12/CommandQueue.h"
+#include "DeferredReleaseQueue.h"
+#include "FenceCompletionService.h"
+#include "QueueDependencyTracker.h"
 
 #include "DescriptorAllocation.h"
 #include "DescriptorAllocator.h"
+#include "GpuDescriptorHeap.h"
+#include "StaticBufferAllocator.h"
+#include "UploadRing.h"
 
 namespace Core
 {
@@ -36,10 +42,29 @@ namespace Core
 		std::shared_ptr<CommandQueue> GetQueue(
 			D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT);
 
+		std::shared_ptr<FenceCompletionService> GetFenceCompletionService() { return this->m_fenceCompletionService; }
+		std::shared_ptr<QueueDependencyTracker> GetQueueDependencyTracker() { return this->m_queueDependencyTracker; }
+
+		// Keeps objects alive until every queue that may use them has passed them.
+		std::shared_ptr<DeferredReleaseQueue> GetDeferredReleaseQueue() { return this->m_deferredReleaseQueue; }
+
 		void Flush();
 
 		DescriptorAllocation AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t numDescritpors = 1);
-		void ReleaseStaleDescriptors(uint64_t finishedFrame);
+		// Defers the descriptors the calling thread has freed but not yet handed to the deferred release queue.
+		void FlushStaleDescriptors();
+
+		// The shader visible heap of a CBV_SRV_UAV or SAMPLER type, bound by every command list.
+		std::shared_ptr<GpuDescriptorHeap> GetGpuDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE type) { return this->m_gpuDescriptorHeaps[type]; }
+
+		// The shader visible CBV_SRV_UAV heap views get their bindless indices from.
+		std::shared_ptr<GpuDescriptorHeap> GetBindlessDescriptorHeap() { return this->GetGpuDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV); }
+
+		// The persistently mapped ring the command lists' dynamic uploads come from.
+		std::shared_ptr<UploadRing> GetUploadRing() { return this->m_uploadRing; }
+
+		// Static vertex and index buffers are carved out of its buffers.
+		std::shared_ptr<StaticBufferAllocator> GetStaticBufferAllocator() { return this->m_staticBufferAllocator; }
 
 		std::unique_ptr<DescriptorHeap> CreateDescriptorHeap(UINT numDescriptors, D3D12_DESCRIPTOR_HEAP_TYPE type);
 
@@ -69,12 +94,21 @@ namespace Core
 		Microsoft::WRL::ComPtr<ID3D12Device2> m_d3d12Device;
 
 		// -- Queues ---
+		// Declared ahead of the queues so it outlives them.
+		std::shared_ptr<FenceCompletionService> m_fenceCompletionService;
+		std::shared_ptr<QueueDependencyTracker> m_queueDependencyTracker;
+		std::shared_ptr<DeferredReleaseQueue> m_deferredReleaseQueue;
 		std::shared_ptr<CommandQueue> m_directQueue;
 		std::shared_ptr<CommandQueue> m_computeQueue;
 		std::shared_ptr<CommandQueue> m_copyQueue;
 
 		// -- Heaps ---
 		std::unique_ptr<DescriptorAllocator> m_descriptorAllocators[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
+		std::shared_ptr<GpuDescriptorHeap> m_gpuDescriptorHeaps[GpuDescriptorHeap::NumShaderVisibleHeapTypes];
+
+		// -- Uploads ---
+		std::shared_ptr<UploadRing> m_uploadRing;
+		std::shared_ptr<StaticBufferAllocator> m_staticBufferAllocator;
 	};
 }
 
@@ -1,15 +1,17 @@
 #include "pch.h"
 #include "DynamicDescriptorHeap.h"
 
-#include "CommandList.h"
+#include "BitOperations.h"
+#include "GpuDescriptorHeap.h"
+#include "RootSignature.h"
 
 Core::DynamicDescriptorHeap::DynamicDescriptorHeap(
-	D3D12_DESCRIPTOR_HEAP_TYPE heapType,
     Microsoft::WRL::ComPtr<ID3D12Device> device,
-	uint32_t numDescriptorsPerHeap) 
-    : m_descriptorHeapType(heapType)
+    std::shared_ptr<GpuDescriptorHeap> gpuDescriptorHeap)
+    : m_descriptorHeapType(gpuDescriptorHeap->GetHeapType())
     , m_device(device)
-    , m_numDescriptorsPerHeap(numDescriptorsPerHeap)
+    , m_gpuDescriptorHeap(gpuDescriptorHeap)
+    , m_numDescriptorsPerHeap(gpuDescriptorHeap->GetNumDescriptorsPerChunk())
     , m_descriptorTableBitMask(0)
     , m_staleDescriptorTableBitMask(0)
     , m_currentCPUDescriptorHandle(D3D12_DEFAULT)
@@ -30,8 +32,11 @@ Core::DynamicDescriptorHeap::~DynamicDescriptorHeap()
 
 void Core::DynamicDescriptorHeap::Reset()
 {
-    this->m_availableDescriptorHeaps = this->m_descriptorHeapPool;
-    this->m_currentDescriptorHeap.Reset();
+    this->m_gpuDescriptorHeap->FreeDynamicChunks(this->m_usedChunks);
+    this->m_usedChunks.clear();
+
+    // The cached ranges point into the chunks that were just released.
+    this->m_tableHashCache.Clear();
     this->m_currentCPUDescriptorHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(D3D12_DEFAULT);
     this->m_currentGPUDescriptorHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(D3D12_DEFAULT);
     this->m_numFreeHandles = 0;
@@ -78,96 +83,121 @@ void Core::DynamicDescriptorHeap::StageDescriptors(
     this->m_staleDescriptorTableBitMask |= (1 << rootParameterIndex);
 }
 
-void Core::DynamicDescriptorHeap::CommitStagedDescriptors(CommandList& commandList, std::function<void(ID3D12GraphicsCommandList*, UINT, D3D12_GPU_DESCRIPTOR_HANDLE)> setFunc)
-{ 
-    // Compute the number of descriptors that need to be copied 
-    uint32_t numDescriptorsToCommit = ComputeStaleDescriptorCount();
+namespace
+{
+    struct GraphicsTableSetter
+    {
+        static void Set(ID3D12GraphicsCommandList* commandList, UINT rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor)
+        {
+            commandList->SetGraphicsRootDescriptorTable(rootIndex, baseDescriptor);
+        }
+    };
+
+    struct ComputeTableSetter
+    {
+        static void Set(ID3D12GraphicsCommandList* commandList, UINT rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor)
+        {
+            commandList->SetComputeRootDescriptorTable(rootIndex, baseDescriptor);
+        }
+    };
+}
 
-    if (numDescriptorsToCommit <= 0)
+template<typename TTableSetter>
+void Core::DynamicDescriptorHeap::CommitStagedDescriptors(ID3D12GraphicsCommandList* commandList)
+{ 
+    if (this->m_staleDescriptorTableBitMask == 0)
     {
         return;
     }
 
-	auto d3d12GraphicsCommandList = commandList.GetD3D12Impl();
-	LOG_CORE_ASSERT(d3d12GraphicsCommandList != nullptr, "Invalid Command List");
-
-	if (!this->m_currentDescriptorHeap || this->m_numFreeHandles < numDescriptorsToCommit)
-	{
-		this->m_currentDescriptorHeap = RequestDescriptorHeap();
-		this->m_currentCPUDescriptorHandle = this->m_currentDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-		this->m_currentGPUDescriptorHandle = this->m_currentDescriptorHeap->GetGPUDescriptorHandleForHeapStart();
-		this->m_numFreeHandles = this->m_numDescriptorsPerHeap;
+	LOG_CORE_ASSERT(commandList != nullptr, "Invalid Command List");
 
-		commandList.SetDescriptorHeap(this->m_descriptorHeapType, this->m_currentDescriptorHeap.Get());
+	static_assert(
+		sizeof(D3D12_CPU_DESCRIPTOR_HANDLE) == sizeof(std::size_t),
+		"The table cache hashes CPU descriptor handles as size_t");
 
-		// When updating the descriptor heap on the command list, all descriptor
-		// tables must be (re)recopied to the new descriptor heap (not just
-		// the stale descriptor tables).
-		this->m_staleDescriptorTableBitMask = this->m_descriptorTableBitMask;
-	}
+	this->m_copyDestRangeStarts.clear();
+	this->m_copyDestRangeSizes.clear();
+	this->m_copySrcDescriptors.clear();
 
-	DWORD rootIndex;
 	// Scan from LSB to MSB for a bit set in staleDescriptorsBitMask
-	while (_BitScanForward(&rootIndex, this->m_staleDescriptorTableBitMask))
+	while (this->m_staleDescriptorTableBitMask != 0)
 	{
+		uint32_t rootIndex = BitOperations::FindLowestBit(this->m_staleDescriptorTableBitMask);
 		UINT numSrcDescriptors = this->m_descriptorTableCache[rootIndex].NumDescriptors;
 		D3D12_CPU_DESCRIPTOR_HANDLE* pSrcDescriptorHandles = this->m_descriptorTableCache[rootIndex].BaseDescriptor;
 
-		D3D12_CPU_DESCRIPTOR_HANDLE pDestDescriptorRangeStarts[] =
+		// Tables staged with the same descriptors as one copied since the last reset reuse its range.
+		auto srcHandles = reinterpret_cast<std::size_t const*>(pSrcDescriptorHandles);
+		uint64_t hash = DescriptorTableHashCache::Hash(srcHandles, numSrcDescriptors);
+		uint64_t cachedRange = this->m_tableHashCache.Find(hash, srcHandles, numSrcDescriptors);
+
+		if (cachedRange != DescriptorTableHashCache::NotFound)
 		{
-			this->m_currentCPUDescriptorHandle
-		};
-		UINT pDestDescriptorRangeSizes[] =
+			TTableSetter::Set(commandList, rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE{ cachedRange });
+		}
+		else
 		{
-			numSrcDescriptors
-		};
-
-		// Copy the staged CPU visible descriptors to the GPU visible descriptor heap.
-		this->m_device->CopyDescriptors(1, pDestDescriptorRangeStarts, pDestDescriptorRangeSizes,
-			numSrcDescriptors, pSrcDescriptorHandles, nullptr, this->m_descriptorHeapType);
-
-		// Set the descriptors on the command list using the passed-in setter function.
-		setFunc(d3d12GraphicsCommandList, rootIndex, this->m_currentGPUDescriptorHandle);
-
-		// Offset current CPU and GPU descriptor handles.
-		this->m_currentCPUDescriptorHandle.Offset(numSrcDescriptors, this->m_descriptorHandleIncrementSize);
-		this->m_currentGPUDescriptorHandle.Offset(numSrcDescriptors, this->m_descriptorHandleIncrementSize);
-		this->m_numFreeHandles -= numSrcDescriptors;
+			// Ranges copied into earlier chunks stay valid, so only this table needs to fit.
+			if (this->m_numFreeHandles < numSrcDescriptors)
+			{
+				this->RequestChunk();
+			}
+
+			// Queue the table for the batched copy, the GPU doesn't read it before the draw.
+			this->m_copyDestRangeStarts.push_back(this->m_currentCPUDescriptorHandle);
+			this->m_copyDestRangeSizes.push_back(numSrcDescriptors);
+			this->m_copySrcDescriptors.insert(
+				this->m_copySrcDescriptors.end(),
+				pSrcDescriptorHandles,
+				pSrcDescriptorHandles + numSrcDescriptors);
+
+			TTableSetter::Set(commandList, rootIndex, this->m_currentGPUDescriptorHandle);
+
+			this->m_tableHashCache.Insert(hash, srcHandles, numSrcDescriptors, this->m_currentGPUDescriptorHandle.ptr);
+
+			// Offset current CPU and GPU descriptor handles.
+			this->m_currentCPUDescriptorHandle.Offset(numSrcDescriptors, this->m_descriptorHandleIncrementSize);
+			this->m_currentGPUDescriptorHandle.Offset(numSrcDescriptors, this->m_descriptorHandleIncrementSize);
+			this->m_numFreeHandles -= numSrcDescriptors;
+		}
 
 		// Flip the stale bit so the descriptor table is not recopied again unless it is updated with a new descriptor.
 		this->m_staleDescriptorTableBitMask ^= (1 << rootIndex);
 	}
+
+	if (this->m_copyDestRangeStarts.empty())
+	{
+		return;
+	}
+
+	// Copy the staged CPU visible descriptors of all tables to the GPU visible descriptor
+	// heap. The source ranges are all of size one, the staged handles aren't contiguous.
+	this->m_device->CopyDescriptors(
+		static_cast<UINT>(this->m_copyDestRangeStarts.size()),
+		this->m_copyDestRangeStarts.data(),
+		this->m_copyDestRangeSizes.data(),
+		static_cast<UINT>(this->m_copySrcDescriptors.size()),
+		this->m_copySrcDescriptors.data(),
+		nullptr,
+		this->m_descriptorHeapType);
 }
 
-void Core::DynamicDescriptorHeap::CommitStagedDescriptorsForDraw(CommandList& commandList)
+void Core::DynamicDescriptorHeap::CommitStagedDescriptorsForDraw(ID3D12GraphicsCommandList* commandList)
 {
-    this->CommitStagedDescriptors(
-        commandList,
-        &ID3D12GraphicsCommandList::SetGraphicsRootDescriptorTable);
+    this->CommitStagedDescriptors<GraphicsTableSetter>(commandList);
 }
 
-void Core::DynamicDescriptorHeap::CommitStagedDescriptorsForDispatch(CommandList& commandList)
+void Core::DynamicDescriptorHeap::CommitStagedDescriptorsForDispatch(ID3D12GraphicsCommandList* commandList)
 {
-    this->CommitStagedDescriptors(
-        commandList,
-        &ID3D12GraphicsCommandList::SetComputeRootDescriptorTable);
+    this->CommitStagedDescriptors<ComputeTableSetter>(commandList);
 }
 
-D3D12_GPU_DESCRIPTOR_HANDLE Core::DynamicDescriptorHeap::CopyDescriptor(CommandList& comandList, D3D12_CPU_DESCRIPTOR_HANDLE cpuDescriptor)
+D3D12_GPU_DESCRIPTOR_HANDLE Core::DynamicDescriptorHeap::CopyDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE cpuDescriptor)
 {
-    if (!this->m_currentDescriptorHeap || this->m_numFreeHandles < 1)
+    if (this->m_numFreeHandles < 1)
     {
-        this->m_currentDescriptorHeap = RequestDescriptorHeap();
-        this->m_currentCPUDescriptorHandle = this->m_currentDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-        this->m_currentGPUDescriptorHandle = this->m_currentDescriptorHeap->GetGPUDescriptorHandleForHeapStart();
-        this->m_numFreeHandles = this->m_numDescriptorsPerHeap;
-
-        comandList.SetDescriptorHeap(this->m_descriptorHeapType, this->m_currentDescriptorHeap.Get());
-
-        // When updating the descriptor heap on the command list, all descriptor
-        // tables must be (re)recopied to the new descriptor heap (not just
-        // the stale descriptor tables).
-        this->m_staleDescriptorTableBitMask = this->m_descriptorTableBitMask;
+        this->RequestChunk();
     }
 
     D3D12_GPU_DESCRIPTOR_HANDLE hGPU = this->m_currentGPUDescriptorHandle;
@@ -195,9 +225,14 @@ void Core::DynamicDescriptorHeap::ParseRootSignature(RootSignature const& rootSi
     uint32_t descriptorTableBitMask = this->m_descriptorTableBitMask;
 
     uint32_t currentOffset = 0;
-    DWORD rootIndex;
-    while (_BitScanForward(&rootIndex, descriptorTableBitMask) && rootIndex < rootSignatureDesc.NumParameters)
+    while (descriptorTableBitMask != 0)
     {
+        uint32_t rootIndex = BitOperations::FindLowestBit(descriptorTableBitMask);
+        if (rootIndex >= rootSignatureDesc.NumParameters)
+        {
+            break;
+        }
+
         uint32_t numDescriptors = rootSignature.GetNumDescriptors(rootIndex);
 
         DescriptorTableCache& descriptorTableCache = this->m_descriptorTableCache[rootIndex];
@@ -215,48 +250,14 @@ void Core::DynamicDescriptorHeap::ParseRootSignature(RootSignature const& rootSi
         "The root signature requires more than the maximum number of descriptors per descriptor heap. Consider increasing the maximum number of descriptors per descriptor heap.");
 }
 
-Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> Core::DynamicDescriptorHeap::RequestDescriptorHeap()
-{
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> descriptorHeap;
-    if (!this->m_availableDescriptorHeaps.empty())
-    {
-        descriptorHeap = this->m_availableDescriptorHeaps.front();
-        this->m_availableDescriptorHeaps.pop();
-    }
-    else
-    {
-        descriptorHeap = CreateDescriptorHeap();
-        this->m_descriptorHeapPool.push(descriptorHeap);
-    }
-
-    return descriptorHeap;
-}
-
-Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> Core::DynamicDescriptorHeap::CreateDescriptorHeap()
+void Core::DynamicDescriptorHeap::RequestChunk()
 {
-    D3D12_DESCRIPTOR_HEAP_DESC descriptorHeapDesc = {};
-    descriptorHeapDesc.Type = m_descriptorHeapType;
-    descriptorHeapDesc.NumDescriptors = m_numDescriptorsPerHeap;
-    descriptorHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> descriptorHeap;
-    ThrowIfFailed(
-        this->m_device->CreateDescriptorHeap(&descriptorHeapDesc, IID_PPV_ARGS(&descriptorHeap)));
-
-    return descriptorHeap;
-}
-
-uint32_t Core::DynamicDescriptorHeap::ComputeStaleDescriptorCount() const
-{
-    uint32_t numStaleDescriptors = 0;
-    DWORD i;
-    DWORD staleDescriptorsBitMask = this->m_staleDescriptorTableBitMask;
-
-    while (_BitScanForward(&i, staleDescriptorsBitMask))
-    {
-        numStaleDescriptors += this->m_descriptorTableCache[i].NumDescriptors;
-        staleDescriptorsBitMask ^= (1 << i);
-    }
-
-    return numStaleDescriptors;
+    // Every chunk lives in the same heap, the one the command list has bound, so the tables
+    // copied into the previous chunk stay valid.
+    uint32_t chunk = this->m_gpuDescriptorHeap->AllocateDynamicChunk();
+    this->m_usedChunks.push_back(chunk);
+
+    this->m_currentCPUDescriptorHandle = this->m_gpuDescriptorHeap->GetCpuHandle(chunk);
+    this->m_currentGPUDescriptorHandle = this->m_gpuDescriptorHeap->GetGpuHandle(chunk);
+    this->m_numFreeHandles = this->m_numDescriptorsPerHeap;
 }
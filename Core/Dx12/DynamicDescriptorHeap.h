@@ -6,28 +6,31 @@
 
 #include <cstdint>
 #include <memory>
-#include <queue>
+#include <vector>
 
-#include <functional>
+#include "DescriptorTableHashCache.h"
 
 namespace Core
 {
-    class CommandList;
+    class GpuDescriptorHeap;
     class RootSignature;
 
+    /**
+      * Stages descriptor tables on a command list and copies them into chunks of the
+      * device's shader visible heap when a draw or dispatch is recorded.
+      */
 	class DynamicDescriptorHeap
 	{
     public:
         DynamicDescriptorHeap(
-            D3D12_DESCRIPTOR_HEAP_TYPE heapType,
             Microsoft::WRL::ComPtr<ID3D12Device> device,
-            uint32_t numDescriptorsPerHeap = 1024);
+            std::shared_ptr<GpuDescriptorHeap> gpuDescriptorHeap);
 
         virtual ~DynamicDescriptorHeap();
         /**
-         * Reset used descriptors. This should only be done if any descriptors
-         * that are being referenced by a command list has finished executing on the
-         * command queue.
+         * Reset used descriptors and return the chunks to the shader visible heap.
+         * This should only be done if any descriptors that are being referenced by a
+         * command list has finished executing on the command queue.
          */
         void Reset();
 
@@ -43,21 +46,16 @@ namespace Core
             const D3D12_CPU_DESCRIPTOR_HANDLE srcDescriptors);
         /**
           * Copy all of the staged descriptors to the GPU visible descriptor heap and
-          * bind the descriptor heap and the descriptor tables to the command list.
-          * The passed-in function object is used to set the GPU visible descriptors
-          * on the command list. Two possible functions are:
-          *   * Before a draw    : ID3D12GraphicsCommandList::SetGraphicsRootDescriptorTable
-          *   * Before a dispatch: ID3D12GraphicsCommandList::SetComputeRootDescriptorTable
-          *
-          * Since the DynamicDescriptorHeap can't know which function will be used, it must
-          * be passed as an argument to the function.
+          * bind the descriptor tables to the command list. The command list has to have
+          * the GpuDescriptorHeap's heap bound already.
+          * Before a draw the tables are set with SetGraphicsRootDescriptorTable, before
+          * a dispatch with SetComputeRootDescriptorTable.
           */
-        void CommitStagedDescriptors(
-            CommandList& commandList,
-            std::function<void(ID3D12GraphicsCommandList*, UINT, D3D12_GPU_DESCRIPTOR_HANDLE)>
-            setFunc);
-        void CommitStagedDescriptorsForDraw(CommandList& commandList);
-        void CommitStagedDescriptorsForDispatch(CommandList& commandList);
+        void CommitStagedDescriptorsForDraw(ID3D12GraphicsCommandList* commandList);
+        void CommitStagedDescriptorsForDispatch(ID3D12GraphicsCommandList* commandList);
+
+        // True if a table was staged or the root signature changed since the last commit.
+        bool HasStaleDescriptors() const { return this->m_staleDescriptorTableBitMask != 0; }
 
         /**
           * Copies a single CPU visible descriptor to a GPU visible descriptor heap.
@@ -67,14 +65,12 @@ namespace Core
           * methods which require both a CPU and GPU visible descriptors for a UAV
           * resource.
           *
-          * @param commandList The command list is required in case the GPU visible
-          * descriptor heap needs to be updated on the command list.
           * @param cpuDescriptor The CPU descriptor to copy into a GPU visible
           * descriptor heap.
           *
           * @return The GPU visible descriptor.
           */
-        D3D12_GPU_DESCRIPTOR_HANDLE CopyDescriptor(CommandList& comandList, D3D12_CPU_DESCRIPTOR_HANDLE cpuDescriptor);
+        D3D12_GPU_DESCRIPTOR_HANDLE CopyDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE cpuDescriptor);
 
         /**
           * Parse the root signature to determine which root parameters contain
@@ -83,16 +79,20 @@ namespace Core
           */
          void ParseRootSignature(RootSignature const& rootSignature);
 
-    private:
-        // Request a descriptor heap if one is available.
-        Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> RequestDescriptorHeap();
+        // Hit and miss counters of the tables reused instead of copied.
+        DescriptorTableHashCache const& GetTableHashCache() const { return this->m_tableHashCache; }
 
-        // Create a new descriptor heap of no descriptor heap is available.
-        Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> CreateDescriptorHeap();
+    private:
+        /**
+          * Copies the stale tables that aren't cached with a single CopyDescriptors call.
+          * TTableSetter::Set binds a table, it's resolved at compile time so a draw doesn't
+          * go through a function object.
+          */
+        template<typename TTableSetter>
+        void CommitStagedDescriptors(ID3D12GraphicsCommandList* commandList);
 
-        // Compute the number of stale descriptors that need to be copied
-        // to GPU visible descriptor heap.
-        uint32_t ComputeStaleDescriptorCount() const;
+        // Take a new chunk of the shader visible heap once the current one is used up.
+        void RequestChunk();
 
     private:
         /**
@@ -131,12 +131,13 @@ namespace Core
         //   * D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV
         //   * D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER
         // This parameter also determines the type of GPU visible descriptor heap to 
-        // create.
+        // copy into.
         D3D12_DESCRIPTOR_HEAP_TYPE m_descriptorHeapType;
 
         Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+        std::shared_ptr<GpuDescriptorHeap> m_gpuDescriptorHeap;
 
-        // The number of descriptors to allocate in new GPU visible descriptor heaps.
+        // The number of descriptors in a chunk of the GPU visible descriptor heap.
         uint32_t m_numDescriptorsPerHeap;
 
         // The increment size of a descriptor.
@@ -157,16 +158,21 @@ namespace Core
         // descriptors were copied.
         uint32_t m_staleDescriptorTableBitMask;
 
-        using DescriptorHeapPool = std::queue< Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>>;
-
-        DescriptorHeapPool m_descriptorHeapPool;
-        DescriptorHeapPool m_availableDescriptorHeaps;
+        // The chunks used since the last reset, the last one is the current chunk.
+        std::vector<uint32_t> m_usedChunks;
 
-        Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_currentDescriptorHeap;
         CD3DX12_GPU_DESCRIPTOR_HANDLE m_currentGPUDescriptorHandle;
         CD3DX12_CPU_DESCRIPTOR_HANDLE m_currentCPUDescriptorHandle;
 
         uint32_t m_numFreeHandles;
+
+        // The ranges copied since the last reset, by their staged CPU descriptors.
+        DescriptorTableHashCache m_tableHashCache;
+
+        // The arguments of the batched copy, kept to not allocate per commit.
+        std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_copyDestRangeStarts;
+        std::vector<UINT> m_copyDestRangeSizes;
+        std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_copySrcDescriptors;
 	};
 }
 
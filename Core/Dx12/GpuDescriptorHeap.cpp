@@ -0,0 +1,209 @@
+#include "pch.h"
+
+#include "GpuDescriptorHeap.h"
+
+using namespace Core;
+
+namespace
+{
+	// Far longer than any frame takes to retire, only reached when the chunks never come back.
+	constexpr std::chrono::milliseconds DynamicChunkTimeout(5000);
+}
+
+Core::BindlessDescriptor::BindlessDescriptor()
+	: m_index(BindlessIndexAllocator::InvalidIndex)
+	, m_heap(nullptr)
+{
+}
+
+Core::BindlessDescriptor::BindlessDescriptor(uint32_t index, std::shared_ptr<GpuDescriptorHeap> heap)
+	: m_index(index)
+	, m_heap(heap)
+{
+}
+
+Core::BindlessDescriptor::~BindlessDescriptor()
+{
+	this->Free();
+}
+
+Core::BindlessDescriptor::BindlessDescriptor(BindlessDescriptor&& other)
+	: m_index(other.m_index)
+	, m_heap(std::move(other.m_heap))
+{
+	other.m_index = BindlessIndexAllocator::InvalidIndex;
+}
+
+BindlessDescriptor& Core::BindlessDescriptor::operator=(BindlessDescriptor&& other)
+{
+	this->Free();
+
+	this->m_index = other.m_index;
+	this->m_heap = std::move(other.m_heap);
+
+	other.m_index = BindlessIndexAllocator::InvalidIndex;
+
+	return *this;
+}
+
+void Core::BindlessDescriptor::Free()
+{
+	if (!this->IsNull() && this->m_heap)
+	{
+		this->m_heap->Free(this->m_index);
+	}
+
+	this->m_index = BindlessIndexAllocator::InvalidIndex;
+	this->m_heap.reset();
+}
+
+Core::GpuDescriptorHeap::GpuDescriptorHeap(
+	Microsoft::WRL::ComPtr<ID3D12Device2> device,
+	std::shared_ptr<DeferredReleaseQueue> deferredReleaseQueue,
+	D3D12_DESCRIPTOR_HEAP_TYPE type,
+	uint32_t numPersistentDescriptors,
+	uint32_t numDynamicDescriptors,
+	uint32_t numDescriptorsPerChunk)
+	: m_heapType(type)
+	, m_device(device)
+	, m_deferredReleaseQueue(deferredReleaseQueue)
+	, m_numDescriptors(numPersistentDescriptors + numDynamicDescriptors)
+	, m_indexAllocator(numPersistentDescriptors)
+	, m_numDescriptorsPerChunk(numDescriptorsPerChunk)
+	, m_numDynamicChunks(numDynamicDescriptors / numDescriptorsPerChunk)
+{
+	LOG_CORE_ASSERT(
+		type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV || type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER,
+		"Only CBV_SRV_UAV and SAMPLER heaps can be shader visible");
+	LOG_CORE_ASSERT(
+		numDynamicDescriptors % numDescriptorsPerChunk == 0,
+		"The dynamic descriptors have to be a multiple of the chunk size");
+
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+	heapDesc.Type = type;
+	heapDesc.NumDescriptors = this->m_numDescriptors;
+	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+	ThrowIfFailed(
+		device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&this->m_d3d12DescriptorHeap)));
+
+	this->m_d3d12DescriptorHeap->SetName(
+		type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV
+			? L"Shader Visible CBV_SRV_UAV Heap"
+			: L"Shader Visible Sampler Heap");
+
+	this->m_baseCpuDescriptor = this->m_d3d12DescriptorHeap->GetCPUDescriptorHandleForHeapStart();
+	this->m_baseGpuDescriptor = this->m_d3d12DescriptorHeap->GetGPUDescriptorHandleForHeapStart();
+	this->m_descriptorHandleIncrementSize = device->GetDescriptorHandleIncrementSize(type);
+
+	// The ring follows the persistent descriptors.
+	for (uint32_t i = 0; i < this->m_numDynamicChunks; ++i)
+	{
+		this->m_freeDynamicChunks.push(numPersistentDescriptors + i * numDescriptorsPerChunk);
+	}
+}
+
+BindlessDescriptor Core::GpuDescriptorHeap::Allocate(D3D12_CPU_DESCRIPTOR_HANDLE srcDescriptor)
+{
+	uint32_t index = this->m_indexAllocator.Allocate();
+	if (index == BindlessIndexAllocator::InvalidIndex)
+	{
+		LOG_CORE_ERROR("Bindless descriptor heap is full ({0} descriptors)", this->m_indexAllocator.GetCapacity());
+		return BindlessDescriptor();
+	}
+
+	this->m_device->CopyDescriptorsSimple(
+		1,
+		CD3DX12_CPU_DESCRIPTOR_HANDLE(this->m_baseCpuDescriptor, index, this->m_descriptorHandleIncrementSize),
+		srcDescriptor,
+		this->m_heapType);
+
+	return BindlessDescriptor(index, shared_from_this());
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE Core::GpuDescriptorHeap::GetGpuHandle(uint32_t index) const
+{
+	LOG_CORE_ASSERT(index < this->m_numDescriptors, "Index out of range");
+	return CD3DX12_GPU_DESCRIPTOR_HANDLE(this->m_baseGpuDescriptor, index, this->m_descriptorHandleIncrementSize);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE Core::GpuDescriptorHeap::GetCpuHandle(uint32_t index) const
+{
+	LOG_CORE_ASSERT(index < this->m_numDescriptors, "Index out of range");
+	return CD3DX12_CPU_DESCRIPTOR_HANDLE(this->m_baseCpuDescriptor, index, this->m_descriptorHandleIncrementSize);
+}
+
+uint32_t Core::GpuDescriptorHeap::AllocateDynamicChunk()
+{
+	std::unique_lock<std::mutex> lock(this->m_dynamicChunkMutex);
+
+	LOG_CORE_ASSERT(this->m_numDynamicChunks > 0, "Heap has no dynamic descriptors");
+	if (this->m_freeDynamicChunks.empty())
+	{
+		// Chunks come back as the fence completion service retires command lists. If none do in
+		// time the ring is held by lists that were never submitted, waiting longer would hang.
+		LOG_CORE_WARN("All dynamic descriptor chunks are in flight, waiting for the GPU");
+		bool isChunkFreed = this->m_dynamicChunkFreed.wait_for(
+			lock,
+			DynamicChunkTimeout,
+			[this]() { return !this->m_freeDynamicChunks.empty(); });
+
+		if (!isChunkFreed)
+		{
+			LOG_CORE_ERROR(
+				"No dynamic descriptor chunk was freed in {0} ms, all {1} chunks are held by unsubmitted or stalled command lists",
+				DynamicChunkTimeout.count(),
+				this->m_numDynamicChunks);
+			throw std::runtime_error("Dynamic descriptor ring exhausted");
+		}
+	}
+
+	uint32_t chunk = this->m_freeDynamicChunks.front();
+	this->m_freeDynamicChunks.pop();
+
+	return chunk;
+}
+
+void Core::GpuDescriptorHeap::FreeDynamicChunks(std::vector<uint32_t> const& chunks)
+{
+	if (chunks.empty())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->m_dynamicChunkMutex);
+		for (uint32_t chunk : chunks)
+		{
+			this->m_freeDynamicChunks.push(chunk);
+		}
+	}
+
+	this->m_dynamicChunkFreed.notify_all();
+}
+
+uint32_t Core::GpuDescriptorHeap::GetNumFreeDynamicChunks() const
+{
+	std::lock_guard<std::mutex> lock(this->m_dynamicChunkMutex);
+	return static_cast<uint32_t>(this->m_freeDynamicChunks.size());
+}
+
+void Core::GpuDescriptorHeap::GetBindlessDescriptorRanges(CD3DX12_DESCRIPTOR_RANGE1 (&ranges)[NumBindlessRanges])
+{
+	constexpr D3D12_DESCRIPTOR_RANGE_FLAGS flags =
+		D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE;
+
+	// Texture2D, TextureCube, ByteAddressBuffer and RWTexture2D arrays.
+	ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0, BindlessRegisterSpace + 0, flags, 0);
+	ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0, BindlessRegisterSpace + 1, flags, 0);
+	ranges[2].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0, BindlessRegisterSpace + 2, flags, 0);
+	ranges[3].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, UINT_MAX, 0, BindlessRegisterSpace + 3, flags, 0);
+}
+
+void Core::GpuDescriptorHeap::Free(uint32_t index)
+{
+	// Shaders in flight on any queue may still index the descriptor.
+	this->m_deferredReleaseQueue->Defer([heap = shared_from_this(), index]() {
+		heap->m_indexAllocator.Free(index);
+		});
+}
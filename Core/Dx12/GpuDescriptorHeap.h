@@ -0,0 +1,141 @@
+#pragma once
+
+#include "d3dx12.h"
+
+#include <wrl.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include "BindlessIndexAllocator.h"
+#include "DeferredReleaseQueue.h"
+
+namespace Core
+{
+	class GpuDescriptorHeap;
+
+	/**
+	 * A descriptor copied into the shader visible heap. The index stays the same for the
+	 * lifetime of the object, and is released once the queues in flight have passed it.
+	 */
+	class BindlessDescriptor
+	{
+	public:
+		// Creates a NULL descriptor.
+		BindlessDescriptor();
+
+		BindlessDescriptor(uint32_t index, std::shared_ptr<GpuDescriptorHeap> heap);
+
+		~BindlessDescriptor();
+
+		BindlessDescriptor(const BindlessDescriptor&) = delete;
+		BindlessDescriptor& operator=(const BindlessDescriptor&) = delete;
+
+		BindlessDescriptor(BindlessDescriptor&& other);
+		BindlessDescriptor& operator=(BindlessDescriptor&& other);
+
+		bool IsNull() const { return this->m_index == BindlessIndexAllocator::InvalidIndex; }
+
+		// The index shaders use to look up the descriptor.
+		uint32_t GetIndex() const { return this->m_index; }
+
+	private:
+		void Free();
+
+	private:
+		uint32_t m_index;
+		std::shared_ptr<GpuDescriptorHeap> m_heap;
+	};
+
+	/**
+	 * The device wide shader visible heap. Views copied into it keep a stable index, so
+	 * shaders index an unbounded descriptor array instead of having tables copied per draw.
+	 * Include Bindless.hlsli and bind the table with CommandList::SetGraphicsBindlessTable.
+	 *
+	 * The descriptors after the persistent ones form a ring of fixed size chunks, which the
+	 * command lists' dynamic descriptor heaps copy their tables into. Every command list
+	 * binds the same heap, so it never has to be switched while recording.
+	 */
+	class GpuDescriptorHeap : public std::enable_shared_from_this<GpuDescriptorHeap>
+	{
+	public:
+		// The register spaces of the unbounded arrays in Bindless.hlsli, one per view type.
+		static constexpr uint32_t BindlessRegisterSpace = 100;
+		static constexpr uint32_t NumBindlessRanges = 4;
+
+		// Only CBV_SRV_UAV and SAMPLER heaps can be shader visible, they are the first two types.
+		static constexpr uint32_t NumShaderVisibleHeapTypes = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER + 1;
+
+	public:
+		GpuDescriptorHeap(
+			Microsoft::WRL::ComPtr<ID3D12Device2> device,
+			std::shared_ptr<DeferredReleaseQueue> deferredReleaseQueue,
+			D3D12_DESCRIPTOR_HEAP_TYPE type,
+			uint32_t numPersistentDescriptors,
+			uint32_t numDynamicDescriptors,
+			uint32_t numDescriptorsPerChunk);
+
+		// Copies a CPU visible descriptor into the heap. Returns a NULL descriptor if the heap is full.
+		BindlessDescriptor Allocate(D3D12_CPU_DESCRIPTOR_HANDLE srcDescriptor);
+
+		ID3D12DescriptorHeap* GetD3D12Heap() const { return this->m_d3d12DescriptorHeap.Get(); }
+		D3D12_DESCRIPTOR_HEAP_TYPE GetHeapType() const { return this->m_heapType; }
+
+		// The start of the bindless table, the descriptor tables' base.
+		D3D12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(uint32_t index = 0) const;
+		D3D12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(uint32_t index) const;
+
+		BindlessIndexAllocator const& GetIndexAllocator() const { return this->m_indexAllocator; }
+
+		/**
+		 * Takes the oldest free chunk of the ring and returns the index of its first descriptor.
+		 * Waits for a chunk to be freed if all of them are in use by command lists in flight, and
+		 * throws if none is freed within a few seconds.
+		 */
+		uint32_t AllocateDynamicChunk();
+
+		// Returns chunks to the ring, only once the command list that used them has completed.
+		void FreeDynamicChunks(std::vector<uint32_t> const& chunks);
+
+		uint32_t GetNumDescriptorsPerChunk() const { return this->m_numDescriptorsPerChunk; }
+		uint32_t GetNumDynamicChunks() const { return this->m_numDynamicChunks; }
+		uint32_t GetNumFreeDynamicChunks() const;
+
+		/**
+		 * Fills the descriptor table ranges matching Bindless.hlsli. Every range starts at
+		 * the beginning of the heap and is unbounded, the descriptors are volatile since
+		 * unused indices hold no view.
+		 */
+		static void GetBindlessDescriptorRanges(CD3DX12_DESCRIPTOR_RANGE1 (&ranges)[NumBindlessRanges]);
+
+	private:
+		friend class BindlessDescriptor;
+		void Free(uint32_t index);
+
+	private:
+		const D3D12_DESCRIPTOR_HEAP_TYPE m_heapType;
+		Microsoft::WRL::ComPtr<ID3D12Device2> m_device;
+		std::shared_ptr<DeferredReleaseQueue> m_deferredReleaseQueue;
+		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_d3d12DescriptorHeap;
+
+		CD3DX12_CPU_DESCRIPTOR_HANDLE m_baseCpuDescriptor;
+		CD3DX12_GPU_DESCRIPTOR_HANDLE m_baseGpuDescriptor;
+		uint32_t m_descriptorHandleIncrementSize;
+
+		uint32_t m_numDescriptors;
+
+		BindlessIndexAllocator m_indexAllocator;
+
+		// The ring of dynamic chunks, the first descriptor index of each free chunk in the
+		// order they were freed in.
+		const uint32_t m_numDescriptorsPerChunk;
+		const uint32_t m_numDynamicChunks;
+		std::queue<uint32_t> m_freeDynamicChunks;
+		mutable std::mutex m_dynamicChunkMutex;
+		std::condition_variable m_dynamicChunkFreed;
+	};
+}
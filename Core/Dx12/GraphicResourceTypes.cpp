@@ -4,37 +4,42 @@
 #include "Dx12RenderDevice.h"
 
 #include "ResourceStateTracker.h"
+#include "StaticBufferAllocator.h"
 
 using namespace Core;
 
-Core::Dx12Texture::Dx12Texture(const Dx12Texture& copy)
-    : Dx12Resrouce(copy)
+void Core::Dx12Texture::CreateViews()
 {
-    this->CreateViews();
+    std::atomic_store(&this->m_views, this->CreateViewSet());
 }
 
-Core::Dx12Texture::Dx12Texture(Dx12Texture&& copy)
-    : Dx12Resrouce(copy)
+std::shared_ptr<Dx12Texture::ViewSet> Core::Dx12Texture::GetViews() const
 {
-    this->CreateViews();
-}
+    auto views = std::atomic_load(&this->m_views);
+    if (views && views->Resource == this->m_d3dResouce)
+    {
+        return views;
+    }
 
-Dx12Texture& Core::Dx12Texture::operator=(const Dx12Texture& other)
-{
-    Dx12Resrouce::operator=(other);
-    this->CreateViews();
-    return *this;
-}
+    auto newViews = this->CreateViewSet();
 
-Dx12Texture& Core::Dx12Texture::operator=(Dx12Texture&& other)
-{
-    Dx12Resrouce::operator=(other);
-    this->CreateViews();
-    return *this;
+    // Another thread may have created the views first, use theirs so the handles stay the same.
+    while (!std::atomic_compare_exchange_strong(&this->m_views, &views, newViews))
+    {
+        if (views && views->Resource == this->m_d3dResouce)
+        {
+            return views;
+        }
+    }
+
+    return newViews;
 }
 
-void Core::Dx12Texture::CreateViews()
+std::shared_ptr<Dx12Texture::ViewSet> Core::Dx12Texture::CreateViewSet() const
 {
+    auto views = std::make_shared<ViewSet>();
+    views->Resource = this->m_d3dResouce;
+
     if (this->m_d3dResouce)
     {
         auto device = this->m_renderDevice->GetD3DDevice();
@@ -43,28 +48,24 @@ void Core::Dx12Texture::CreateViews()
 
         if ((desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET) != 0)
         {
-            this->m_renderTargetView = this->m_renderDevice->AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+            views->RenderTargetView = this->m_renderDevice->AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
             device->CreateRenderTargetView(
                 this->m_d3dResouce.Get(),
                 nullptr,
-                this->m_renderTargetView.GetDescriptorHandle());
+                views->RenderTargetView.GetDescriptorHandle());
         }
         if ((desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL) != 0)
         {
-            this->m_depthStencilView = this->m_renderDevice->AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+            views->DepthStencilView = this->m_renderDevice->AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
             device->CreateDepthStencilView(
                 this->m_d3dResouce.Get(),
                 nullptr,
-                this->m_depthStencilView.GetDescriptorHandle());
+                views->DepthStencilView.GetDescriptorHandle());
         }
     }
 
-    std::lock_guard<std::mutex> lock(this->m_shaderResourceViewsMutex);
-    std::lock_guard<std::mutex> guard(this->m_unorderedAccessViewsMutex);
-
     // SRVs and UAVs will be created as needed.
-    this->m_shaderResourceViews.clear();
-    this->m_unorderedAccessViews.clear();
+    return views;
 }
 
 D3D12_CPU_DESCRIPTOR_HANDLE Core::Dx12Texture::GetShaderResourceView(
@@ -76,19 +77,59 @@ D3D12_CPU_DESCRIPTOR_HANDLE Core::Dx12Texture::GetShaderResourceView(
         hash = std::hash<D3D12_SHADER_RESOURCE_VIEW_DESC>{}(*srvDesc);
     }
 
-    std::lock_guard<std::mutex> lock(this->m_shaderResourceViewsMutex);
+    auto views = this->GetViews();
+    std::lock_guard<std::mutex> lock(views->ShaderResourceViewsMutex);
 
-    auto iter = this->m_shaderResourceViews.find(hash);
-    if (iter == m_shaderResourceViews.end())
+    return this->FindOrCreateShaderResourceView(*views, hash, srvDesc).GetDescriptorHandle();
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE Core::Dx12Texture::GetUnorderedAccessView(const D3D12_UNORDERED_ACCESS_VIEW_DESC* uavDesc) const
+{
+    std::size_t hash = 0;
+    if (uavDesc)
     {
-        auto srv = this->CreateShaderResourceView(srvDesc);
-        iter = this->m_shaderResourceViews.insert({ hash, std::move(srv) }).first;
+        hash = std::hash<D3D12_UNORDERED_ACCESS_VIEW_DESC>{}(*uavDesc);
     }
 
-    return iter->second.GetDescriptorHandle();
+    auto views = this->GetViews();
+    std::lock_guard<std::mutex> guard(views->UnorderedAccessViewsMutex);
+
+    return this->FindOrCreateUnorderedAccessView(*views, hash, uavDesc).GetDescriptorHandle();
 }
 
-D3D12_CPU_DESCRIPTOR_HANDLE Core::Dx12Texture::GetUnorderedAccessView(const D3D12_UNORDERED_ACCESS_VIEW_DESC* uavDesc) const
+D3D12_CPU_DESCRIPTOR_HANDLE Core::Dx12Texture::GetRenderTargetView() const
+{
+    return this->GetViews()->RenderTargetView.GetDescriptorHandle();
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE Core::Dx12Texture::GetDepthStencilView() const
+{
+    return this->GetViews()->DepthStencilView.GetDescriptorHandle();
+}
+
+uint32_t Core::Dx12Texture::GetBindlessShaderResourceIndex(const D3D12_SHADER_RESOURCE_VIEW_DESC* srvDesc) const
+{
+    std::size_t hash = 0;
+    if (srvDesc)
+    {
+        hash = std::hash<D3D12_SHADER_RESOURCE_VIEW_DESC>{}(*srvDesc);
+    }
+
+    auto views = this->GetViews();
+    std::lock_guard<std::mutex> lock(views->ShaderResourceViewsMutex);
+
+    auto iter = views->BindlessShaderResourceViews.find(hash);
+    if (iter == views->BindlessShaderResourceViews.end())
+    {
+        auto const& srv = this->FindOrCreateShaderResourceView(*views, hash, srvDesc);
+        auto descriptor = this->m_renderDevice->GetBindlessDescriptorHeap()->Allocate(srv.GetDescriptorHandle());
+        iter = views->BindlessShaderResourceViews.insert({ hash, std::move(descriptor) }).first;
+    }
+
+    return iter->second.GetIndex();
+}
+
+uint32_t Core::Dx12Texture::GetBindlessUnorderedAccessIndex(const D3D12_UNORDERED_ACCESS_VIEW_DESC* uavDesc) const
 {
     std::size_t hash = 0;
     if (uavDesc)
@@ -96,26 +137,48 @@ D3D12_CPU_DESCRIPTOR_HANDLE Core::Dx12Texture::GetUnorderedAccessView(const D3D1
         hash = std::hash<D3D12_UNORDERED_ACCESS_VIEW_DESC>{}(*uavDesc);
     }
 
-    std::lock_guard<std::mutex> guard(this->m_unorderedAccessViewsMutex);
+    auto views = this->GetViews();
+    std::lock_guard<std::mutex> guard(views->UnorderedAccessViewsMutex);
 
-    auto iter = this->m_unorderedAccessViews.find(hash);
-    if (iter == this->m_unorderedAccessViews.end())
+    auto iter = views->BindlessUnorderedAccessViews.find(hash);
+    if (iter == views->BindlessUnorderedAccessViews.end())
     {
-        auto uav = CreateUnorderedAccessView(uavDesc);
-        iter = this->m_unorderedAccessViews.insert({ hash, std::move(uav) }).first;
+        auto const& uav = this->FindOrCreateUnorderedAccessView(*views, hash, uavDesc);
+        auto descriptor = this->m_renderDevice->GetBindlessDescriptorHeap()->Allocate(uav.GetDescriptorHandle());
+        iter = views->BindlessUnorderedAccessViews.insert({ hash, std::move(descriptor) }).first;
     }
 
-    return iter->second.GetDescriptorHandle();
+    return iter->second.GetIndex();
 }
 
-D3D12_CPU_DESCRIPTOR_HANDLE Core::Dx12Texture::GetRenderTargetView() const
+DescriptorAllocation const& Core::Dx12Texture::FindOrCreateShaderResourceView(
+    ViewSet& views,
+    size_t hash,
+    const D3D12_SHADER_RESOURCE_VIEW_DESC* srvDesc) const
 {
-    return this->m_renderTargetView.GetDescriptorHandle();
+    auto iter = views.ShaderResourceViews.find(hash);
+    if (iter == views.ShaderResourceViews.end())
+    {
+        auto srv = this->CreateShaderResourceView(srvDesc);
+        iter = views.ShaderResourceViews.insert({ hash, std::move(srv) }).first;
+    }
+
+    return iter->second;
 }
 
-D3D12_CPU_DESCRIPTOR_HANDLE Core::Dx12Texture::GetDepthStencilView() const
+DescriptorAllocation const& Core::Dx12Texture::FindOrCreateUnorderedAccessView(
+    ViewSet& views,
+    size_t hash,
+    const D3D12_UNORDERED_ACCESS_VIEW_DESC* uavDesc) const
 {
-    return this->m_depthStencilView.GetDescriptorHandle();
+    auto iter = views.UnorderedAccessViews.find(hash);
+    if (iter == views.UnorderedAccessViews.end())
+    {
+        auto uav = CreateUnorderedAccessView(uavDesc);
+        iter = views.UnorderedAccessViews.insert({ hash, std::move(uav) }).first;
+    }
+
+    return iter->second;
 }
 
 DescriptorAllocation Core::Dx12Texture::CreateShaderResourceView(const D3D12_SHADER_RESOURCE_VIEW_DESC* srvDesc) const
@@ -139,6 +202,65 @@ DescriptorAllocation Core::Dx12Texture::CreateUnorderedAccessView(const D3D12_UN
     return uav;
 }
 
+void Core::Dx12Buffer::SetAllocation(std::shared_ptr<BufferAllocation> allocation)
+{
+    this->m_allocation = allocation;
+    if (allocation)
+    {
+        this->m_d3dResouce = allocation->GetResource();
+        this->m_offset = allocation->GetOffset();
+    }
+    else
+    {
+        this->m_offset = 0;
+    }
+}
+
+uint32_t Core::Dx12Buffer::GetBindlessShaderResourceIndex() const
+{
+    auto bindlessView = std::atomic_load(&this->m_bindlessView);
+    if (bindlessView && bindlessView->Resource == this->m_d3dResouce && bindlessView->Offset == this->m_offset)
+    {
+        return bindlessView->Descriptor.GetIndex();
+    }
+
+    LOG_CORE_ASSERT(this->m_d3dResouce, "Buffer has no resource");
+    LOG_CORE_ASSERT(this->GetSizeInBytes() % 4 == 0, "Raw buffer views need a multiple of 4 bytes");
+    LOG_CORE_ASSERT(this->m_offset % 4 == 0, "Raw buffer views need to start on 4 bytes");
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Buffer.FirstElement = this->m_offset / 4;
+    srvDesc.Buffer.NumElements = static_cast<UINT>(this->GetSizeInBytes() / 4);
+    srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
+
+    auto newView = std::make_shared<BindlessView>();
+    newView->Resource = this->m_d3dResouce;
+    newView->Offset = this->m_offset;
+    newView->ShaderResourceView = this->m_renderDevice->AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    this->m_renderDevice->GetD3DDevice()->CreateShaderResourceView(
+        this->m_d3dResouce.Get(),
+        &srvDesc,
+        newView->ShaderResourceView.GetDescriptorHandle());
+
+    newView->Descriptor = this->m_renderDevice->GetBindlessDescriptorHeap()->Allocate(
+        newView->ShaderResourceView.GetDescriptorHandle());
+
+    // Another thread may have created the view first, use theirs so the index stays the same.
+    while (!std::atomic_compare_exchange_strong(&this->m_bindlessView, &bindlessView, newView))
+    {
+        if (bindlessView && bindlessView->Resource == this->m_d3dResouce && bindlessView->Offset == this->m_offset)
+        {
+            return bindlessView->Descriptor.GetIndex();
+        }
+    }
+
+    return newView->Descriptor.GetIndex();
+}
+
 Core::Dx12Resrouce::Dx12Resrouce(
     std::shared_ptr<Dx12RenderDevice> renderDevice,
     D3D12_RESOURCE_DESC const& resourceDesc,
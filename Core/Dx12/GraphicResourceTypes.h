@@ -4,6 +4,7 @@
 #include <wrl.h>
 
 #include "DescriptorAllocation.h"
+#include "GpuDescriptorHeap.h"
 
 namespace Core
 {
@@ -38,6 +39,7 @@ namespace Core
 	};
 
 	class Dx12RenderDevice;
+	class BufferAllocation;
 
 	class Dx12Resrouce
 	{
@@ -129,6 +131,15 @@ namespace Core
 		uint32_t GetElementByteStride() const { return this->m_bufferDesc.ElementByteStride; }
 		BindFlags GetBindings() const { return this->m_bufferDesc.BindFlags; }
 
+		// Where the buffer starts in its resource, buffers carved out of a shared resource don't start at zero.
+		uint64_t GetOffset() const { return this->m_offset; }
+		D3D12_GPU_VIRTUAL_ADDRESS GetGpuVirtualAddress() const { return this->m_d3dResouce->GetGPUVirtualAddress() + this->m_offset; }
+
+		bool IsSubAllocated() const { return this->m_allocation != nullptr; }
+
+		// Takes the resource and offset of the allocation, a null allocation resets the offset.
+		void SetAllocation(std::shared_ptr<BufferAllocation> allocation);
+
 		D3D12_CPU_DESCRIPTOR_HANDLE GetShaderResourceView(const D3D12_SHADER_RESOURCE_VIEW_DESC* srvDesc = nullptr) const override
 		{
 			throw std::runtime_error("This functions should never be called on buffers");
@@ -139,10 +150,37 @@ namespace Core
 			throw std::runtime_error("This functions should never be called on buffers");
 		}
 
+		/**
+		 * The index of a raw (ByteAddressBuffer) SRV of the whole buffer in the bindless heap.
+		 * Copies of the buffer share the view. The buffer isn't transitioned, it has to be in
+		 * a shader resource state when it's read.
+		 */
+		uint32_t GetBindlessShaderResourceIndex() const;
+
+	private:
+		struct BindlessView
+		{
+			Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+			uint64_t Offset;
+			DescriptorAllocation ShaderResourceView;
+			BindlessDescriptor Descriptor;
+		};
+
 	private:
 		BufferDesc m_bufferDesc;
+
+		// Shared between copies, the range is freed once the last copy has gone.
+		std::shared_ptr<BufferAllocation> m_allocation;
+		uint64_t m_offset = 0;
+
+		// Created on first use, replaced once the buffer's resource has changed.
+		mutable std::shared_ptr<BindlessView> m_bindlessView;
 	};
 
+	/**
+	 * A texture handle. The views live in a ref-counted view set created for the texture's
+	 * resource, so copying or moving a texture shares them instead of creating new ones.
+	 */
 	class Dx12Texture : public Dx12Resrouce
 	{
 	public:
@@ -165,12 +203,17 @@ namespace Core
 			: Dx12Resrouce(renderDevice, resource)
 		{}
 
-		Dx12Texture(const Dx12Texture& copy);
-		Dx12Texture(Dx12Texture&& copy);
+		Dx12Texture(const Dx12Texture& copy) = default;
+		Dx12Texture(Dx12Texture&& copy) = default;
 
-		Dx12Texture& operator=(const Dx12Texture& other);
-		Dx12Texture& operator=(Dx12Texture&& other);
+		Dx12Texture& operator=(const Dx12Texture& other) = default;
+		Dx12Texture& operator=(Dx12Texture&& other) = default;
 
+		/**
+		 * Replaces the views with a new set for the current resource, other copies of the
+		 * texture keep the old set. The views are also created on first use, or when the
+		 * resource has been changed since.
+		 */
 		void CreateViews();
 
 		/*
@@ -205,19 +248,56 @@ namespace Core
 
 		D3D12_CPU_DESCRIPTOR_HANDLE GetDepthStencilView() const;
 
+		/**
+		 * The index of the view in the bindless heap, valid while a texture refers to the view set.
+		 * The texture isn't transitioned, it has to be in a matching state when it's accessed.
+		 */
+		uint32_t GetBindlessShaderResourceIndex(const D3D12_SHADER_RESOURCE_VIEW_DESC* srvDesc = nullptr) const;
+		uint32_t GetBindlessUnorderedAccessIndex(const D3D12_UNORDERED_ACCESS_VIEW_DESC* uavDesc = nullptr) const;
+
 	private:
-		DescriptorAllocation CreateShaderResourceView(const D3D12_SHADER_RESOURCE_VIEW_DESC* srvDesc) const;
-		DescriptorAllocation CreateUnorderedAccessView(const D3D12_UNORDERED_ACCESS_VIEW_DESC* uavDesc) const;
+		struct ViewSet
+		{
+			// The resource the views were created for.
+			Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+
+			std::unordered_map<size_t, DescriptorAllocation> ShaderResourceViews;
+			std::unordered_map<size_t, DescriptorAllocation> UnorderedAccessViews;
+
+			// Keyed like the views they were copied from.
+			std::unordered_map<size_t, BindlessDescriptor> BindlessShaderResourceViews;
+			std::unordered_map<size_t, BindlessDescriptor> BindlessUnorderedAccessViews;
+
+			std::mutex ShaderResourceViewsMutex;
+			std::mutex UnorderedAccessViewsMutex;
+
+			DescriptorAllocation RenderTargetView;
+			DescriptorAllocation DepthStencilView;
+		};
 
 	private:
-		mutable std::unordered_map<size_t, DescriptorAllocation> m_shaderResourceViews;
-		mutable std::unordered_map<size_t, DescriptorAllocation> m_unorderedAccessViews;
+		// The view set of the current resource, created if there is none yet.
+		std::shared_ptr<ViewSet> GetViews() const;
 
-		mutable std::mutex m_shaderResourceViewsMutex;
-		mutable std::mutex m_unorderedAccessViewsMutex;
+		// Creates the RTV and DSV right away, SRVs and UAVs are created as needed.
+		std::shared_ptr<ViewSet> CreateViewSet() const;
 
-		DescriptorAllocation m_renderTargetView;
-		DescriptorAllocation m_depthStencilView;
+		DescriptorAllocation CreateShaderResourceView(const D3D12_SHADER_RESOURCE_VIEW_DESC* srvDesc) const;
+		DescriptorAllocation CreateUnorderedAccessView(const D3D12_UNORDERED_ACCESS_VIEW_DESC* uavDesc) const;
+
+		// Expect the view's mutex to be held.
+		DescriptorAllocation const& FindOrCreateShaderResourceView(
+			ViewSet& views,
+			size_t hash,
+			const D3D12_SHADER_RESOURCE_VIEW_DESC* srvDesc) const;
+		DescriptorAllocation const& FindOrCreateUnorderedAccessView(
+			ViewSet& views,
+			size_t hash,
+			const D3D12_UNORDERED_ACCESS_VIEW_DESC* uavDesc) const;
+
+	private:
+		// Shared between copies, replaced once the texture's resource has changed.
+		mutable std::shared_ptr<ViewSet> m_views;
 	};
 }
 
@@ -0,0 +1,172 @@
+#include "pch.h"
+
+#include "ResourceBarrierOptimizer.h"
+
+using namespace Core;
+
+namespace
+{
+	constexpr D3D12_RESOURCE_STATES ReadOnlyStates =
+		D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER |
+		D3D12_RESOURCE_STATE_INDEX_BUFFER |
+		D3D12_RESOURCE_STATE_DEPTH_READ |
+		D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE |
+		D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE |
+		D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT |
+		D3D12_RESOURCE_STATE_COPY_SOURCE |
+		D3D12_RESOURCE_STATE_RESOLVE_SOURCE;
+
+	bool IsSeparator(D3D12_RESOURCE_BARRIER const& barrier)
+	{
+		return barrier.Type != D3D12_RESOURCE_BARRIER_TYPE_TRANSITION ||
+			barrier.Flags != D3D12_RESOURCE_BARRIER_FLAG_NONE;
+	}
+}
+
+Core::ResourceBarrierOptimizer::ResourceBarrierOptimizer(NumSubresourcesFunction numSubresources)
+	: m_numSubresources(numSubresources)
+	, m_statistics{}
+{
+}
+
+bool Core::ResourceBarrierOptimizer::IsReadOnlyState(D3D12_RESOURCE_STATES state)
+{
+	// COMMON is zero, it isn't a read state a resource can be combined with.
+	return state != D3D12_RESOURCE_STATE_COMMON && (state & ~ReadOnlyStates) == 0;
+}
+
+uint32_t Core::ResourceBarrierOptimizer::Optimize(std::vector<D3D12_RESOURCE_BARRIER>& barriers)
+{
+	this->m_output.clear();
+	this->m_isRemoved.clear();
+
+	size_t segmentBegin = 0;
+	for (size_t i = 0; i <= barriers.size(); i++)
+	{
+		if (i < barriers.size() && !IsSeparator(barriers[i]))
+		{
+			continue;
+		}
+
+		this->OptimizeSegment(barriers, segmentBegin, i);
+
+		if (i < barriers.size())
+		{
+			this->m_output.push_back(barriers[i]);
+			this->m_isRemoved.push_back(false);
+		}
+
+		segmentBegin = i + 1;
+	}
+
+	size_t numInput = barriers.size();
+	barriers.clear();
+	for (size_t i = 0; i < this->m_output.size(); i++)
+	{
+		if (!this->m_isRemoved[i])
+		{
+			barriers.push_back(this->m_output[i]);
+		}
+	}
+
+	this->m_statistics.NumInputBarriers += numInput;
+	this->m_statistics.NumOutputBarriers += barriers.size();
+
+	return static_cast<uint32_t>(numInput - barriers.size());
+}
+
+void Core::ResourceBarrierOptimizer::OptimizeSegment(std::vector<D3D12_RESOURCE_BARRIER> const& barriers, size_t first, size_t last)
+{
+	if (first == last)
+	{
+		return;
+	}
+
+	this->m_openTransitions.clear();
+
+	size_t segmentOutputBegin = this->m_output.size();
+	for (size_t i = first; i < last; i++)
+	{
+		auto const& transition = barriers[i].Transition;
+		auto& openTransitions = this->m_openTransitions[transition.pResource];
+
+		// Whole resource and per-subresource transitions aren't folded into each other, the
+		// earlier ones are closed and stay ahead of this one.
+		bool isAllSubresources = transition.Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+		if (!openTransitions.empty() &&
+			(openTransitions.front().Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES) != isAllSubresources)
+		{
+			openTransitions.clear();
+		}
+
+		auto openTransition = std::find_if(
+			openTransitions.begin(),
+			openTransitions.end(),
+			[&](OpenTransition const& open) { return open.Subresource == transition.Subresource; });
+
+		if (openTransition == openTransitions.end())
+		{
+			openTransitions.push_back({ transition.Subresource, this->m_output.size() });
+			this->m_output.push_back(barriers[i]);
+			this->m_isRemoved.push_back(false);
+			continue;
+		}
+
+		auto& collapsed = this->m_output[openTransition->OutputIndex].Transition;
+		collapsed.StateAfter = IsReadOnlyState(collapsed.StateAfter) && IsReadOnlyState(transition.StateAfter)
+			? collapsed.StateAfter | transition.StateAfter
+			: transition.StateAfter;
+
+		this->m_statistics.NumCollapsed++;
+	}
+
+	for (size_t i = segmentOutputBegin; i < this->m_output.size(); i++)
+	{
+		auto const& transition = this->m_output[i].Transition;
+		if (transition.StateBefore == transition.StateAfter)
+		{
+			this->m_isRemoved[i] = true;
+			this->m_statistics.NumDropped++;
+		}
+	}
+
+	if (!this->m_numSubresources)
+	{
+		return;
+	}
+
+	for (auto& openTransitions : this->m_openTransitions)
+	{
+		if (openTransitions.second.size() < 2 ||
+			openTransitions.second.front().Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES)
+		{
+			continue;
+		}
+
+		auto const& front = this->m_output[openTransitions.second.front().OutputIndex].Transition;
+		bool canMerge = std::all_of(
+			openTransitions.second.begin(),
+			openTransitions.second.end(),
+			[&](OpenTransition const& open) {
+				auto const& transition = this->m_output[open.OutputIndex].Transition;
+				return !this->m_isRemoved[open.OutputIndex] &&
+					transition.StateBefore == front.StateBefore &&
+					transition.StateAfter == front.StateAfter;
+			});
+
+		if (!canMerge || openTransitions.second.size() != this->m_numSubresources(openTransitions.first))
+		{
+			continue;
+		}
+
+		this->m_output[openTransitions.second.front().OutputIndex].Transition.Subresource =
+			D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+		for (size_t i = 1; i < openTransitions.second.size(); i++)
+		{
+			this->m_isRemoved[openTransitions.second[i].OutputIndex] = true;
+		}
+
+		this->m_statistics.NumMerged += openTransitions.second.size() - 1;
+	}
+}
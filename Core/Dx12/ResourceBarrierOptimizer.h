@@ -0,0 +1,69 @@
+#pragma once
+
+#include <d3d12.h>
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace Core
+{
+	/**
+	 * Rewrites a batch of barriers that is about to be submitted with a single ResourceBarrier
+	 * call, no work runs in between them:
+	 *   - A->B->C transition chains on the same subresource collapse into A->C. Trailing read
+	 *     states are combined, B|C, since the following work may read the resource as either.
+	 *   - Transitions that end in the state they started from are dropped.
+	 *   - Per-subresource transitions that cover every subresource with the same before and
+	 *     after states are merged into one ALL_SUBRESOURCES transition.
+	 * UAV, aliasing and split barriers are kept in place and nothing is moved across them.
+	 * Doesn't touch the device, so it can run on recorded barrier streams.
+	 */
+	class ResourceBarrierOptimizer
+	{
+	public:
+		// Returns zero if the number of subresources is unknown, those resources aren't merged.
+		using NumSubresourcesFunction = std::function<uint32_t(ID3D12Resource*)>;
+
+		struct Statistics
+		{
+			uint64_t NumInputBarriers;
+			uint64_t NumOutputBarriers;
+
+			uint64_t NumCollapsed;          // Transitions folded into an earlier one on the same subresource.
+			uint64_t NumDropped;            // No-op transitions.
+			uint64_t NumMerged;             // Per-subresource transitions replaced by ALL_SUBRESOURCES ones.
+		};
+
+	public:
+		explicit ResourceBarrierOptimizer(NumSubresourcesFunction numSubresources = nullptr);
+
+		// Optimizes the barriers in place, returns the number of barriers removed.
+		uint32_t Optimize(std::vector<D3D12_RESOURCE_BARRIER>& barriers);
+
+		Statistics const& GetStatistics() const { return this->m_statistics; }
+		void ResetStatistics() { this->m_statistics = {}; }
+
+		static bool IsReadOnlyState(D3D12_RESOURCE_STATES state);
+
+	private:
+		// Optimizes the transitions in [first, last) into m_output.
+		void OptimizeSegment(std::vector<D3D12_RESOURCE_BARRIER> const& barriers, size_t first, size_t last);
+
+	private:
+		NumSubresourcesFunction m_numSubresources;
+
+		struct OpenTransition
+		{
+			uint32_t Subresource;
+			size_t OutputIndex;
+		};
+
+		// Reused between calls to avoid allocating on every flush.
+		std::vector<D3D12_RESOURCE_BARRIER> m_output;
+		std::vector<bool> m_isRemoved;
+		std::unordered_map<ID3D12Resource*, std::vector<OpenTransition>> m_openTransitions;
+
+		Statistics m_statistics;
+	};
+}
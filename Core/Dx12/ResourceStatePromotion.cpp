@@ -0,0 +1,85 @@
+#include "pch.h"
+
+#include "ResourceStatePromotion.h"
+
+using namespace Core;
+
+namespace
+{
+	constexpr D3D12_RESOURCE_STATES ReadStates =
+		D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER |
+		D3D12_RESOURCE_STATE_INDEX_BUFFER |
+		D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE |
+		D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE |
+		D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT |
+		D3D12_RESOURCE_STATE_COPY_SOURCE |
+		D3D12_RESOURCE_STATE_RESOLVE_SOURCE;
+
+	constexpr D3D12_RESOURCE_STATES DepthStates =
+		D3D12_RESOURCE_STATE_DEPTH_WRITE |
+		D3D12_RESOURCE_STATE_DEPTH_READ;
+
+	// The only states a texture without simultaneous access can be promoted to.
+	constexpr D3D12_RESOURCE_STATES TexturePromotableStates =
+		D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE |
+		D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE |
+		D3D12_RESOURCE_STATE_COPY_DEST |
+		D3D12_RESOURCE_STATE_COPY_SOURCE;
+
+	bool IsSingleBit(uint32_t value)
+	{
+		return value != 0 && (value & (value - 1)) == 0;
+	}
+}
+
+ResourceStatePromotion::ResourceKind Core::ResourceStatePromotion::GetResourceKind(D3D12_RESOURCE_DESC const& desc)
+{
+	if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+	{
+		return ResourceKind::Buffer;
+	}
+
+	return (desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS) != 0
+		? ResourceKind::SimultaneousAccessTexture
+		: ResourceKind::Texture;
+}
+
+bool Core::ResourceStatePromotion::CanPromote(
+	ResourceKind kind,
+	D3D12_RESOURCE_STATES stateBefore,
+	D3D12_RESOURCE_STATES stateAfter)
+{
+	if (stateBefore != D3D12_RESOURCE_STATE_COMMON || stateAfter == D3D12_RESOURCE_STATE_COMMON)
+	{
+		return false;
+	}
+
+	// Either any combination of read states, or a single write state.
+	bool isReadOnly = (stateAfter & ~ReadStates) == 0;
+	if (!isReadOnly && !IsSingleBit(static_cast<uint32_t>(stateAfter)))
+	{
+		return false;
+	}
+
+	if (kind == ResourceKind::Texture)
+	{
+		return (stateAfter & ~TexturePromotableStates) == 0 &&
+			(stateAfter == D3D12_RESOURCE_STATE_COPY_DEST || (stateAfter & D3D12_RESOURCE_STATE_COPY_DEST) == 0);
+	}
+
+	return (stateAfter & DepthStates) == 0;
+}
+
+bool Core::ResourceStatePromotion::DecaysToCommon(
+	ResourceKind kind,
+	D3D12_COMMAND_LIST_TYPE queueType,
+	D3D12_RESOURCE_STATES finalState,
+	bool isPromotedReadOnly)
+{
+	if (queueType == D3D12_COMMAND_LIST_TYPE_COPY || kind != ResourceKind::Texture)
+	{
+		return true;
+	}
+
+	return isPromotedReadOnly && (finalState & ~ReadStates) == 0;
+}
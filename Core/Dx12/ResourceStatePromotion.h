@@ -0,0 +1,41 @@
+#pragma once
+
+#include <d3d12.h>
+
+namespace Core
+{
+	/**
+	 * The D3D12 implicit state promotion and decay rules.
+	 * A resource in the COMMON state is promoted by the GPU on first use, no barrier is needed:
+	 *   - Buffers and simultaneous-access textures to any state but the depth states.
+	 *   - Other textures only to the shader resource and copy states.
+	 * Promoted read states can be combined, a promoted write state can't.
+	 * Once ExecuteCommandLists completes, buffers, simultaneous-access textures, resources used
+	 * on a copy queue and resources only promoted to read states decay back to COMMON.
+	 * @source: https://docs.microsoft.com/en-us/windows/win32/direct3d12/using-resource-barriers-to-synchronize-resource-states-in-direct3d-12#implicit-state-transitions
+	 */
+	namespace ResourceStatePromotion
+	{
+		enum class ResourceKind : uint8_t
+		{
+			Buffer,
+			SimultaneousAccessTexture,
+			Texture,
+		};
+
+		ResourceKind GetResourceKind(D3D12_RESOURCE_DESC const& desc);
+
+		// Whether the GPU promotes the resource from stateBefore to stateAfter without a barrier.
+		bool CanPromote(ResourceKind kind, D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter);
+
+		/**
+		 * Whether the resource is back in COMMON after the ExecuteCommandLists that left it in
+		 * finalState. isPromotedReadOnly is true if the submission only promoted it to read states.
+		 */
+		bool DecaysToCommon(
+			ResourceKind kind,
+			D3D12_COMMAND_LIST_TYPE queueType,
+			D3D12_RESOURCE_STATES finalState,
+			bool isPromotedReadOnly);
+	}
+}
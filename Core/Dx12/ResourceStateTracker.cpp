@@ -6,8 +6,116 @@ using namespace Core;
 
 // Static definitions.
 std::mutex ResourceStateTracker::ms_globalMutex;
-bool ResourceStateTracker::ms_isLocked = false;
-ResourceStateTracker::ResourceStateMap ResourceStateTracker::ms_globalResourceState;
+std::atomic_bool ResourceStateTracker::ms_isLocked(false);
+std::atomic_bool ResourceStateTracker::ms_useSplitBarriers(false);
+ChunkedTable<ResourceStateTracker::GlobalResourceState> ResourceStateTracker::ms_globalResourceState;
+
+namespace
+{
+	constexpr D3D12_RESOURCE_STATES WriteStates =
+		D3D12_RESOURCE_STATE_RENDER_TARGET |
+		D3D12_RESOURCE_STATE_UNORDERED_ACCESS |
+		D3D12_RESOURCE_STATE_DEPTH_WRITE |
+		D3D12_RESOURCE_STATE_STREAM_OUT |
+		D3D12_RESOURCE_STATE_COPY_DEST |
+		D3D12_RESOURCE_STATE_RESOLVE_DEST;
+
+	uint64_t PackTransition(D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter)
+	{
+		return (static_cast<uint64_t>(stateBefore) << 32) | static_cast<uint32_t>(stateAfter);
+	}
+
+	uint32_t GetNumSubresources(ID3D12Resource* resource)
+	{
+		auto desc = resource->GetDesc();
+		if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+		{
+			return 1;
+		}
+
+		// Planar formats have a subresource per plane, leave them unmerged.
+		switch (desc.Format)
+		{
+		case DXGI_FORMAT_R32G8X24_TYPELESS:
+		case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+		case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+		case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+		case DXGI_FORMAT_R24G8_TYPELESS:
+		case DXGI_FORMAT_D24_UNORM_S8_UINT:
+		case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+		case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+		case DXGI_FORMAT_NV12:
+		case DXGI_FORMAT_P010:
+		case DXGI_FORMAT_P016:
+		case DXGI_FORMAT_420_OPAQUE:
+		case DXGI_FORMAT_NV11:
+			return 0;
+		default:
+			break;
+		}
+
+		uint32_t arraySize = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : desc.DepthOrArraySize;
+		return desc.MipLevels * arraySize;
+	}
+
+	// {6C1F8A9E-3B52-4D7A-9E0C-58A4D2F1B7C3}
+	constexpr GUID ResourceIdGuid =
+	{ 0x6c1f8a9e, 0x3b52, 0x4d7a, { 0x9e, 0xc, 0x58, 0xa4, 0xd2, 0xf1, 0xb7, 0xc3 } };
+
+	// {A83D5E27-91C4-4F6B-B2D8-0E7F63C94A15}
+	constexpr GUID ResourceIdOwnerGuid =
+	{ 0xa83d5e27, 0x91c4, 0x4f6b, { 0xb2, 0xd8, 0xe, 0x7f, 0x63, 0xc9, 0x4a, 0x15 } };
+}
+
+Core::ResourceStateTracker::ResourceStateTracker()
+	: m_barrierOptimizer(GetNumSubresources)
+	, m_splitBarrierStatistics{}
+{
+}
+
+class Core::ResourceStateTracker::ResourceIdOwner final : public IUnknown
+{
+public:
+	explicit ResourceIdOwner(uint32_t resourceId)
+		: m_resourceId(resourceId)
+		, m_refCount(1)
+	{
+	}
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override
+	{
+		if (riid == __uuidof(IUnknown))
+		{
+			*object = static_cast<IUnknown*>(this);
+			this->AddRef();
+			return S_OK;
+		}
+
+		*object = nullptr;
+		return E_NOINTERFACE;
+	}
+
+	ULONG STDMETHODCALLTYPE AddRef() override
+	{
+		return ++this->m_refCount;
+	}
+
+	ULONG STDMETHODCALLTYPE Release() override
+	{
+		ULONG refCount = --this->m_refCount;
+		if (refCount == 0)
+		{
+			ms_globalResourceState.Free(this->m_resourceId);
+			delete this;
+		}
+
+		return refCount;
+	}
+
+private:
+	const uint32_t m_resourceId;
+	std::atomic<ULONG> m_refCount;
+};
 
 void Core::ResourceStateTracker::Lock()
 {
@@ -23,24 +131,85 @@ void Core::ResourceStateTracker::Unlock()
 
 void Core::ResourceStateTracker::AddGlobalResourceState(ID3D12Resource* resource, D3D12_RESOURCE_STATES state)
 {
-	if (resource != nullptr)
+	if (resource == nullptr)
 	{
-		std::lock_guard<std::mutex> lock(ms_globalMutex);
-		ms_globalResourceState[resource].SetSubresourceState(D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, state);
+		return;
 	}
+
+	uint32_t resourceId = GetResourceId(resource);
+	if (resourceId == InvalidResourceId)
+	{
+		// A new resource isn't known to any command list yet, no need to lock.
+		RegisterResource(resource, state);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(ms_globalMutex);
+	ms_globalResourceState[resourceId].State.SetSubresourceState(D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, state);
 }
 
 void Core::ResourceStateTracker::RemoveGlobalResourceState(ID3D12Resource* resource)
 {
-	if (resource != nullptr)
+	if (resource != nullptr && GetResourceId(resource) != InvalidResourceId)
 	{
-		std::lock_guard<std::mutex> lock(ms_globalMutex);
-		ms_globalResourceState.erase(resource);
+		// Dropping the owner frees the id.
+		resource->SetPrivateData(ResourceIdGuid, 0, nullptr);
+		resource->SetPrivateDataInterface(ResourceIdOwnerGuid, nullptr);
 	}
 }
 
+uint32_t Core::ResourceStateTracker::GetResourceId(ID3D12Resource* resource)
+{
+	uint32_t resourceId = InvalidResourceId;
+	UINT dataSize = sizeof(resourceId);
+	if (FAILED(resource->GetPrivateData(ResourceIdGuid, &dataSize, &resourceId)))
+	{
+		return InvalidResourceId;
+	}
+
+	return resourceId;
+}
+
+uint32_t Core::ResourceStateTracker::RegisterResource(ID3D12Resource* resource, D3D12_RESOURCE_STATES state)
+{
+	GlobalResourceState globalState{ ResourceState(state) };
+	globalState.Kind = ResourceStatePromotion::GetResourceKind(resource->GetDesc());
+
+	uint32_t resourceId = ms_globalResourceState.Allocate(globalState);
+	LOG_CORE_ASSERT(resourceId != InvalidResourceId, "Resource state table is full");
+
+	ThrowIfFailed(
+		resource->SetPrivateData(ResourceIdGuid, sizeof(resourceId), &resourceId));
+
+	// The resource holds the only reference once this goes out of scope.
+	Microsoft::WRL::ComPtr<ResourceIdOwner> owner;
+	owner.Attach(new ResourceIdOwner(resourceId));
+	ThrowIfFailed(
+		resource->SetPrivateDataInterface(ResourceIdOwnerGuid, owner.Get()));
+
+	return resourceId;
+}
+
 void Core::ResourceStateTracker::ResourceBarrier(D3D12_RESOURCE_BARRIER const& barrier)
 {
+	// A resource with a begun split transition can't be used until it is ended.
+	if (!this->m_splitBarriers.empty())
+	{
+		switch (barrier.Type)
+		{
+		case D3D12_RESOURCE_BARRIER_TYPE_TRANSITION:
+			this->EndSplitTransition(barrier.Transition.pResource, &barrier);
+			break;
+		case D3D12_RESOURCE_BARRIER_TYPE_UAV:
+			this->EndSplitTransition(barrier.UAV.pResource, &barrier);
+			break;
+		case D3D12_RESOURCE_BARRIER_TYPE_ALIASING:
+			this->EndSplitTransition(barrier.Aliasing.pResourceBefore, &barrier);
+			this->EndSplitTransition(barrier.Aliasing.pResourceAfter, &barrier);
+			break;
+		}
+	}
+
 	// Transition barriers are the only barrier that needs to know the before state.
 	if (barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION)
 	{
@@ -50,23 +219,22 @@ void Core::ResourceStateTracker::ResourceBarrier(D3D12_RESOURCE_BARRIER const& b
 		const auto iter = this->m_finalResourceState.find(transitionBarrier.pResource);
 		if (iter != this->m_finalResourceState.end())
 		{
-			auto resourceState = iter->second;
+			auto const& resourceState = iter->second;
 
 			// if we know the final state of the resouce is different
 			if (transitionBarrier.Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES &&
-				!resourceState.SubresourceState.empty())
+				!resourceState.SubresourceState.Empty())
 			{
 				// First transition all of the subresources if they are different than the StateAfter.
-				for (auto subresourceState : resourceState.SubresourceState)
-				{
-					if (transitionBarrier.StateAfter != subresourceState.second)
+				resourceState.SubresourceState.ForEach([&](uint32_t subresource, D3D12_RESOURCE_STATES state) {
+					if (transitionBarrier.StateAfter != state)
 					{
 						D3D12_RESOURCE_BARRIER newBarrier = barrier;
-						newBarrier.Transition.Subresource = subresourceState.first;
-						newBarrier.Transition.StateBefore = subresourceState.second;
+						newBarrier.Transition.Subresource = subresource;
+						newBarrier.Transition.StateBefore = state;
 						this->m_resourceBarriers.push_back(newBarrier);
 					}
-				}
+					});
 			}
 			else
 			{
@@ -77,6 +245,13 @@ void Core::ResourceStateTracker::ResourceBarrier(D3D12_RESOURCE_BARRIER const& b
 					D3D12_RESOURCE_BARRIER newBarrier = barrier;
 					newBarrier.Transition.StateBefore = finalState;
 					this->m_resourceBarriers.push_back(newBarrier);
+
+					if (ms_useSplitBarriers &&
+						(finalState & WriteStates) &&
+						transitionBarrier.Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES)
+					{
+						LearnSplitTransition(transitionBarrier.pResource, finalState, transitionBarrier.StateAfter);
+					}
 				}
 			}
 		}
@@ -87,10 +262,20 @@ void Core::ResourceStateTracker::ResourceBarrier(D3D12_RESOURCE_BARRIER const& b
 			this->m_pendingResourceBarriers.push_back(barrier);
 		}
 
+		if (transitionBarrier.StateAfter & WriteStates)
+		{
+			this->m_writtenResources.insert(transitionBarrier.pResource);
+		}
+
 		this->m_finalResourceState[transitionBarrier.pResource].SetSubresourceState(transitionBarrier.Subresource, transitionBarrier.StateAfter);
 		return;
 	}
 
+	if (barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_UAV && barrier.UAV.pResource)
+	{
+		this->m_writtenResources.insert(barrier.UAV.pResource);
+	}
+
 	this->m_resourceBarriers.push_back(barrier);
 }
 
@@ -116,29 +301,198 @@ void Core::ResourceStateTracker::AliasBarrier(ID3D12Resource* resourceBefore, ID
 {
 	this->ResourceBarrier(
 		CD3DX12_RESOURCE_BARRIER::Aliasing(resourceBefore, resourceAfter));
+
+	if (resourceAfter == nullptr || this->m_finalResourceState.count(resourceAfter) != 0)
+	{
+		return;
+	}
+
+	uint32_t resourceId = GetResourceId(resourceAfter);
+	if (resourceId == InvalidResourceId)
+	{
+		return;
+	}
+
+	// A pending transition would be resolved ahead of the command list, before the barrier
+	// activated the resource. Starting from the global state records it after the barrier.
+	std::lock_guard<std::mutex> lock(ms_globalMutex);
+	this->m_finalResourceState.emplace(resourceAfter, ms_globalResourceState[resourceId].State);
+}
+
+void Core::ResourceStateTracker::BeginSplitTransition(ID3D12Resource* resource)
+{
+	if (!ms_useSplitBarriers || resource == nullptr || this->m_splitBarriers.count(resource) != 0)
+	{
+		return;
+	}
+
+	// Only whole resources the command list left in a write state.
+	const auto iter = this->m_finalResourceState.find(resource);
+	if (iter == this->m_finalResourceState.end() ||
+		!iter->second.SubresourceState.Empty() ||
+		(iter->second.State & WriteStates) == 0)
+	{
+		return;
+	}
+
+	uint32_t resourceId = GetResourceId(resource);
+	if (resourceId == InvalidResourceId)
+	{
+		return;
+	}
+
+	// Read without the global lock: the entry's chunk never moves and the prediction is atomic.
+	// A submission on another thread may be learning it right now, so it's only a hint, a wrong
+	// guess costs a full transition when the split is ended.
+	auto const& prediction = ms_globalResourceState[resourceId].Prediction;
+	uint64_t transition = prediction.Transition.load(std::memory_order_relaxed);
+	auto stateBefore = static_cast<D3D12_RESOURCE_STATES>(transition >> 32);
+	auto stateAfter = static_cast<D3D12_RESOURCE_STATES>(transition & 0xffffffff);
+	if (stateBefore != iter->second.State ||
+		stateAfter == stateBefore ||
+		prediction.Confidence.load(std::memory_order_relaxed) < SplitPrediction::MinConfidence)
+	{
+		return;
+	}
+
+	auto beginBarrier = CD3DX12_RESOURCE_BARRIER::Transition(
+		resource,
+		stateBefore,
+		stateAfter,
+		D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+		D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY);
+
+	this->m_resourceBarriers.push_back(beginBarrier);
+	this->m_splitBarriers.emplace(resource, beginBarrier);
+	this->m_splitBarrierStatistics.NumBegun++;
+}
+
+void Core::ResourceStateTracker::EndSplitTransitions()
+{
+	while (!this->m_splitBarriers.empty())
+	{
+		this->EndSplitTransition(this->m_splitBarriers.begin()->first, nullptr);
+	}
 }
 
-uint32_t Core::ResourceStateTracker::FlushResourceBarriers(CommandList& commandList)
+void Core::ResourceStateTracker::EndSplitTransition(ID3D12Resource* resource, D3D12_RESOURCE_BARRIER const* nextBarrier)
 {
+	const auto iter = this->m_splitBarriers.find(resource);
+	if (iter == this->m_splitBarriers.end())
+	{
+		return;
+	}
+
+	auto const& beginTransition = iter->second.Transition;
+	bool isTransition = nextBarrier != nullptr && nextBarrier->Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+	bool isPredicted = isTransition && nextBarrier->Transition.StateAfter == beginTransition.StateAfter;
+
+	// The begin hasn't been flushed yet, no work could overlap it. Drop it and let the
+	// next barrier transition the resource in full.
+	auto pendingBegin = std::find_if(
+		this->m_resourceBarriers.begin(),
+		this->m_resourceBarriers.end(),
+		[&](D3D12_RESOURCE_BARRIER const& barrier) {
+			return barrier.Flags == D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY && barrier.Transition.pResource == resource;
+		});
+
+	if (pendingBegin != this->m_resourceBarriers.end())
+	{
+		this->m_resourceBarriers.erase(pendingBegin);
+	}
+	else
+	{
+		D3D12_RESOURCE_BARRIER endBarrier = iter->second;
+		endBarrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+		this->m_resourceBarriers.push_back(endBarrier);
+
+		this->m_finalResourceState[resource].SetSubresourceState(
+			D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+			beginTransition.StateAfter);
+
+		// The next barrier starts from the predicted state, so it can't learn the transition itself.
+		if (isTransition)
+		{
+			LearnSplitTransition(resource, beginTransition.StateBefore, nextBarrier->Transition.StateAfter);
+		}
+	}
+
+	if (isPredicted)
+	{
+		this->m_splitBarrierStatistics.NumHits++;
+	}
+	else
+	{
+		this->m_splitBarrierStatistics.NumMisses++;
+	}
+
+	this->m_splitBarriers.erase(iter);
+}
+
+void Core::ResourceStateTracker::LearnSplitTransition(
+	ID3D12Resource* resource,
+	D3D12_RESOURCE_STATES stateBefore,
+	D3D12_RESOURCE_STATES stateAfter)
+{
+	uint32_t resourceId = GetResourceId(resource);
+	if (resourceId == InvalidResourceId)
+	{
+		return;
+	}
+
+	// Called while recording as well as under the global lock, the update isn't atomic as a
+	// whole. Racing threads may lose a step of confidence or mix their transitions for a
+	// frame, BeginSplitTransition only takes it as a hint.
+	auto& prediction = ms_globalResourceState[resourceId].Prediction;
+	uint64_t transition = PackTransition(stateBefore, stateAfter);
+	if (prediction.Transition.load(std::memory_order_relaxed) == transition)
+	{
+		uint32_t confidence = prediction.Confidence.load(std::memory_order_relaxed);
+		prediction.Confidence.store(std::min(confidence + 1, SplitPrediction::MinConfidence + 1), std::memory_order_relaxed);
+	}
+	else
+	{
+		prediction.Transition.store(transition, std::memory_order_relaxed);
+		prediction.Confidence.store(0, std::memory_order_relaxed);
+	}
+}
+
+uint32_t Core::ResourceStateTracker::FlushResourceBarriers(ID3D12GraphicsCommandList* commandList)
+{
+	this->m_barrierOptimizer.Optimize(this->m_resourceBarriers);
+
+	// Combined read states become the known final states, the next transition has to start from them.
+	for (auto const& barrier : this->m_resourceBarriers)
+	{
+		if (barrier.Type != D3D12_RESOURCE_BARRIER_TYPE_TRANSITION ||
+			barrier.Flags != D3D12_RESOURCE_BARRIER_FLAG_NONE)
+		{
+			continue;
+		}
+
+		auto& finalState = this->m_finalResourceState[barrier.Transition.pResource];
+		if (finalState.GetSubresourceState(barrier.Transition.Subresource) != barrier.Transition.StateAfter)
+		{
+			finalState.SetSubresourceState(barrier.Transition.Subresource, barrier.Transition.StateAfter);
+		}
+	}
+
 	uint32_t numOfBarriers = static_cast<uint32_t>(this->m_resourceBarriers.size());
 
 	if (numOfBarriers > 0)
 	{
-		auto d3d12CommandList = commandList.GetD3D12Impl();
-		d3d12CommandList->ResourceBarrier(numOfBarriers, this->m_resourceBarriers.data());
+		commandList->ResourceBarrier(numOfBarriers, this->m_resourceBarriers.data());
 		this->m_resourceBarriers.clear();
 	}
 
 	return numOfBarriers;
 }
 
-uint32_t Core::ResourceStateTracker::FlushPendingResourceBarriers(CommandList& commandList)
+void Core::ResourceStateTracker::ResolvePendingResourceBarriers(PendingBarrierBatch& batch, std::vector<D3D12_RESOURCE_BARRIER>& orderedBarriers)
 {
 	// Assert is locked
 	LOG_CORE_ASSERT(ms_isLocked, "Global state isn't locked");
-
-	ResourceBarriers resourceBarriers;
-	resourceBarriers.reserve(this->m_pendingResourceBarriers.size());
+	LOG_CORE_ASSERT(this->m_splitBarriers.empty(), "Command list closed with open split barriers");
 
 	for (auto pendingBarrier : this->m_pendingResourceBarriers)
 	{
@@ -148,32 +502,49 @@ uint32_t Core::ResourceStateTracker::FlushPendingResourceBarriers(CommandList& c
 		}
 
 		auto pendingTransition = pendingBarrier.Transition;
-		const auto& iter = ms_globalResourceState.find(pendingTransition.pResource);
-		if (iter == ms_globalResourceState.end())
+		uint32_t resourceId = GetResourceId(pendingTransition.pResource);
+		if (resourceId == InvalidResourceId)
 		{
 			continue;
 		}
+
+		// The global state is only untouched by the batch if no earlier command list used the resource.
+		auto& resourceBarriers =
+			batch.BatchResources.find(pendingTransition.pResource) == batch.BatchResources.end()
+			? batch.LeadingBarriers
+			: orderedBarriers;
+
 		// If all subresources are being transitioned, and there are multiple
 		// subresources of the resource that are in a different state...
-		auto& resourceState = iter->second;
+		auto& globalResourceState = ms_globalResourceState[resourceId];
+		auto& resourceState = globalResourceState.State;
 		if (pendingTransition.Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES &&
-			!resourceState.SubresourceState.empty())
+			!resourceState.SubresourceState.Empty())
 		{
 			// Transition all subresources
-			for (auto subresourceState : resourceState.SubresourceState)
-			{
-				if (pendingTransition.StateAfter != subresourceState.second)
+			resourceState.SubresourceState.ForEach([&](uint32_t subresource, D3D12_RESOURCE_STATES state) {
+				if (pendingTransition.StateAfter != state &&
+					!ResourceStatePromotion::CanPromote(globalResourceState.Kind, state, pendingTransition.StateAfter))
 				{
 					D3D12_RESOURCE_BARRIER newBarrier = pendingBarrier;
-					newBarrier.Transition.Subresource = subresourceState.first;
-					newBarrier.Transition.StateBefore = subresourceState.second;
+					newBarrier.Transition.Subresource = subresource;
+					newBarrier.Transition.StateBefore = state;
 					resourceBarriers.push_back(newBarrier);
 				}
-			}
+				});
 			continue;
 		}
 		// No (sub)resources need to be transitioned. Just add a single transition barrier (if needed).
-		auto globalState = (iter->second).GetSubresourceState(pendingTransition.Subresource);
+		auto globalState = resourceState.GetSubresourceState(pendingTransition.Subresource);
+		if (ResourceStatePromotion::CanPromote(globalResourceState.Kind, globalState, pendingTransition.StateAfter))
+		{
+			if (pendingTransition.Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES)
+			{
+				batch.PromotedStates[pendingTransition.pResource] = pendingTransition.StateAfter;
+			}
+			continue;
+		}
+
 		if (pendingTransition.StateAfter != globalState)
 		{
 			// Fix-up the before state based on current global state of the resource.
@@ -182,29 +553,67 @@ uint32_t Core::ResourceStateTracker::FlushPendingResourceBarriers(CommandList& c
 		}
 	}
 
-	uint32_t numBarriers = static_cast<uint32_t>(resourceBarriers.size());
-	if (numBarriers > 0)
+	this->m_pendingResourceBarriers.clear();
+
+	// Command lists later in the batch will see the final states of this one.
+	for (const auto& resourceState : this->m_finalResourceState)
 	{
-		auto d3d12CommandList = commandList.GetD3D12Impl();
-		d3d12CommandList->ResourceBarrier(numBarriers, resourceBarriers.data());
+		batch.BatchResources.emplace(resourceState.first, false);
 	}
 
-	this->m_pendingResourceBarriers.clear();
+	for (auto resource : this->m_writtenResources)
+	{
+		batch.BatchResources[resource] = true;
+	}
+}
+
+void Core::ResourceStateTracker::DecayResourceStates(PendingBarrierBatch const& batch, D3D12_COMMAND_LIST_TYPE queueType)
+{
+	LOG_CORE_ASSERT(ms_isLocked, "Global Resource tracker isn't locked");
 
-	return numBarriers;
+	for (const auto& batchResource : batch.BatchResources)
+	{
+		uint32_t resourceId = GetResourceId(batchResource.first);
+		if (resourceId == InvalidResourceId)
+		{
+			continue;
+		}
+
+		auto& globalResourceState = ms_globalResourceState[resourceId];
+		auto& resourceState = globalResourceState.State;
+
+		// Only counts as promoted if nothing transitioned the resource after the promotion.
+		const auto promotedState = batch.PromotedStates.find(batchResource.first);
+		bool isPromotedReadOnly =
+			promotedState != batch.PromotedStates.end() &&
+			resourceState.SubresourceState.Empty() &&
+			resourceState.State == promotedState->second;
+
+		if (ResourceStatePromotion::DecaysToCommon(globalResourceState.Kind, queueType, resourceState.State, isPromotedReadOnly))
+		{
+			resourceState.SetSubresourceState(D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_COMMON);
+		}
+	}
 }
 
 void Core::ResourceStateTracker::CommitFinalResourceStates()
 {
 	LOG_CORE_ASSERT(ms_isLocked, "Global Resource tracker isn't locked");
 
-	// Commit final resource states to the global resource state array (map).
+	// Commit final resource states to the global resource state table.
 	for (const auto& resourceState : m_finalResourceState)
 	{
-		ms_globalResourceState[resourceState.first] = resourceState.second;
+		uint32_t resourceId = GetResourceId(resourceState.first);
+		if (resourceId == InvalidResourceId)
+		{
+			resourceId = RegisterResource(resourceState.first, resourceState.second.State);
+		}
+
+		ms_globalResourceState[resourceId].State = resourceState.second;
 	}
 
 	m_finalResourceState.clear();
+	m_writtenResources.clear();
 }
 
 void Core::ResourceStateTracker::Reset()
@@ -213,4 +622,6 @@ void Core::ResourceStateTracker::Reset()
 	m_pendingResourceBarriers.clear();
 	m_resourceBarriers.clear();
 	m_finalResourceState.clear();
+	m_writtenResources.clear();
+	m_splitBarriers.clear();
 }
@@ -1,29 +1,73 @@
 #pragma once
 
 #include "d3dx12.h"
-#include "CommandList.h"
+#include "ChunkedTable.h"
+#include "SubresourceRunList.h"
+#include "ResourceBarrierOptimizer.h"
+#include "ResourceStatePromotion.h"
 
-#include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
+#include <atomic>
 
 namespace Core
 {
-	class CommandList;
+	/**
+	 * Pending barriers of all the command lists submitted by one ExecuteCommandLists call.
+	 */
+	struct PendingBarrierBatch
+	{
+		// Barriers that can be executed ahead of the first command list in the batch.
+		std::vector<D3D12_RESOURCE_BARRIER> LeadingBarriers;
+
+		// Resources used by the command lists already resolved in the batch, and whether any of them wrote to it.
+		std::unordered_map<ID3D12Resource*, bool> BatchResources;
+
+		// Whole resources the batch implicitly promoted from COMMON to a read state, and that state.
+		std::unordered_map<ID3D12Resource*, D3D12_RESOURCE_STATES> PromotedStates;
+	};
 
 	class ResourceStateTracker
 	{
 	public:
-		ResourceStateTracker() = default;
+		ResourceStateTracker();
 		~ResourceStateTracker() = default;
 
 		/** Global State Trackers */
+		static constexpr uint32_t InvalidResourceId = ~0u;
+
+		/**
+		  * Guards barrier resolution against the global state. Submitting threads only hold it
+		  * while resolving and committing, registering resources doesn't take it.
+		  */
 		static void Lock();
 		static void Unlock();
 
+		/**
+		  * Registers the resource under a dense id stored in its private data. The id is
+		  * recycled when the resource is destroyed.
+		  */
 		static void AddGlobalResourceState(ID3D12Resource* resource, D3D12_RESOURCE_STATES state);
 		static void RemoveGlobalResourceState(ID3D12Resource* resource);
 
+		/**
+		  * Applies the implicit decay to COMMON the GPU does once the batch's ExecuteCommandLists
+		  * completes. Called after every command list of the batch has been resolved.
+		  */
+		static void DecayResourceStates(PendingBarrierBatch const& batch, D3D12_COMMAND_LIST_TYPE queueType);
+
+		static uint32_t GetResourceId(ID3D12Resource* resource);
+		static uint32_t GetNumTrackedResources() { return ms_globalResourceState.Size(); }
+
+		/**
+		  * Split barrier mode. Once a command list is done writing to a resource the transition
+		  * to the state the resource went to the last times is begun right away (BEGIN_ONLY),
+		  * and ended (END_ONLY) when the resource is used next.
+		  */
+		static void SetSplitBarriers(bool enable) { ms_useSplitBarriers = enable; }
+		static bool IsUsingSplitBarriers() { return ms_useSplitBarriers; }
+
 		/** Global State Trackers End */
 		void ResourceBarrier(D3D12_RESOURCE_BARRIER const& barrier);
 
@@ -31,16 +75,46 @@ namespace Core
 
 		void UAVBarrier(ID3D12Resource* resource = nullptr);
 
+		/**
+		  * The resource activated by the barrier continues from its global state, the transitions
+		  * that follow are recorded after the barrier instead of resolved ahead of the command list.
+		  * The command lists that used the resource before have to be submitted already.
+		  */
 		void AliasBarrier(ID3D12Resource* resourceBefore, ID3D12Resource* resourceAfter = nullptr);
 
-		// Flush any pending resource parriers to the command list
-		uint32_t FlushPendingResourceBarriers(CommandList& commandList);
+		/**
+		  * Resolve the pending resource barriers against the global state. Barriers on resources
+		  * that no earlier command list of the batch used are hoisted into the batch's leading
+		  * barriers, the others are added to orderedBarriers and have to be executed right before
+		  * this command list. Transitions the GPU does through implicit promotion are skipped.
+		  */
+		void ResolvePendingResourceBarriers(PendingBarrierBatch& batch, std::vector<D3D12_RESOURCE_BARRIER>& orderedBarriers);
 
 		/**
 		  * Flush any (non-pending) resource barriers that have been pushed to the resource state
-		  * tracker.
+		  * tracker. They are coalesced first, returns the number of barriers submitted.
 		  */
-		uint32_t FlushResourceBarriers(CommandList& commandList);
+		uint32_t FlushResourceBarriers(ID3D12GraphicsCommandList* commandList);
+
+		ResourceBarrierOptimizer::Statistics const& GetBarrierStatistics() const { return this->m_barrierOptimizer.GetStatistics(); }
+
+		struct SplitBarrierStatistics
+		{
+			uint64_t NumBegun;
+			uint64_t NumHits;               // The resource was next used in the predicted state.
+			uint64_t NumMisses;             // Needed in another state, or still open when the command list closed.
+		};
+
+		/**
+		  * The command list stopped writing to the resource, e.g. after a copy or when it is no
+		  * longer bound as a render target. Begins a split transition if the next state is predictable.
+		  */
+		void BeginSplitTransition(ID3D12Resource* resource);
+
+		// Ends every begun split transition, a command list can't close with one open.
+		void EndSplitTransitions();
+
+		SplitBarrierStatistics const& GetSplitBarrierStatistics() const { return this->m_splitBarrierStatistics; }
 
 		void CommitFinalResourceStates();
 
@@ -53,6 +127,8 @@ namespace Core
 		ResourceBarriers m_resourceBarriers;
 		ResourceBarriers m_pendingResourceBarriers;
 
+		ResourceBarrierOptimizer m_barrierOptimizer;
+
 		struct ResourceState
 		{
 			explicit ResourceState(D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON)
@@ -63,45 +139,88 @@ namespace Core
 				if (subResource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES)
 				{
 					State = state;
-					SubresourceState.clear();
+					SubresourceState.Clear();
 				}
 				else
 				{
-					SubresourceState[subResource] = state;
+					SubresourceState.Set(subResource, state);
 				}
 			}
 
 			D3D12_RESOURCE_STATES GetSubresourceState(uint32_t subResource) const
 			{
 				D3D12_RESOURCE_STATES state = State;
-				const auto itr = SubresourceState.find(subResource);
-				if (itr != SubresourceState.end())
-				{
-					state = itr->second;
-				}
-
+				SubresourceState.Find(subResource, state);
 				return state;
 			}
 
-			// If the SubresourceState array (map) is empty, then the State variable defines 
-			// the state of all of the subresources.
+			// If the SubresourceState list is empty, then the State variable defines 
+			// the state of all of the subresources. Common mip and slice patterns fit
+			// the list's inline runs, so copying a state doesn't allocate.
 			D3D12_RESOURCE_STATES State;
-			std::map<uint32_t, D3D12_RESOURCE_STATES> SubresourceState;
+			SubresourceRunList<D3D12_RESOURCE_STATES> SubresourceState;
 		};
 
 		using ResourceStateMap = std::unordered_map<ID3D12Resource*, ResourceState>;
 
+		// The transition a resource last made out of a write state, and how often it repeated.
+		struct SplitPrediction
+		{
+			static constexpr uint32_t MinConfidence = 2;
+
+			SplitPrediction() = default;
+			SplitPrediction(SplitPrediction const& other) { *this = other; }
+
+			SplitPrediction& operator=(SplitPrediction const& other)
+			{
+				Transition.store(other.Transition.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				Confidence.store(other.Confidence.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				return *this;
+			}
+
+			// Relaxed, a command list recording on another thread may race the update. It's only a hint.
+			std::atomic_uint64_t Transition{ 0 };
+			std::atomic_uint32_t Confidence{ 0 };
+		};
+
+		struct GlobalResourceState
+		{
+			explicit GlobalResourceState(ResourceState state = ResourceState())
+				: State(state) {}
+
+			ResourceState State;
+			SplitPrediction Prediction;
+			ResourceStatePromotion::ResourceKind Kind = ResourceStatePromotion::ResourceKind::Texture;
+		};
+
+		// nextBarrier is the barrier that needs the resource, or nullptr when closing.
+		void EndSplitTransition(ID3D12Resource* resource, D3D12_RESOURCE_BARRIER const* nextBarrier);
+		static void LearnSplitTransition(ID3D12Resource* resource, D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter);
+
+		// Held by the resource's private data, frees the resource id when the resource is destroyed.
+		class ResourceIdOwner;
+
+		static uint32_t RegisterResource(ID3D12Resource* resource, D3D12_RESOURCE_STATES state);
+
+		// Begun split transitions by resource, ended before the resource is used again.
+		std::unordered_map<ID3D12Resource*, D3D12_RESOURCE_BARRIER> m_splitBarriers;
+		SplitBarrierStatistics m_splitBarrierStatistics;
+
+		// Resources the command list transitioned to a writable state or placed a UAV barrier on.
+		std::unordered_set<ID3D12Resource*> m_writtenResources;
+
 		// The final (last known state) of the resources within a command list.
 		// The final resource state is committed to the global resource state when the 
 		// command list is closed but before it is executed on the command queue.
 		ResourceStateMap m_finalResourceState;
 
 		/** Global State */
-		// The global resource state array (map) stores the state of a resource
-	// between command list execution.
-		static ResourceStateMap ms_globalResourceState;
+		// The global resource state table stores the state of a resource between command
+		// list execution, indexed by resource id.
+		static ChunkedTable<GlobalResourceState> ms_globalResourceState;
 		static std::mutex ms_globalMutex;
-		static bool ms_isLocked;
+		static std::atomic_bool ms_isLocked;
+		static std::atomic_bool ms_useSplitBarriers;
 	};
 }
 
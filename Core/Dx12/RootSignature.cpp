@@ -91,6 +91,17 @@ void Core::RootSignature::SetRootSignatureDesc(
 			parameters[i].DescriptorTable.NumDescriptorRanges = numDescriptorRanges;
 			parameters[i].DescriptorTable.pDescriptorRanges = pDescriptorRanges;
 
+			// Unbounded tables point at the bindless heap, nothing is staged for them.
+			bool isBindlessTable = std::any_of(
+				pDescriptorRanges,
+				pDescriptorRanges + numDescriptorRanges,
+				[](D3D12_DESCRIPTOR_RANGE1 const& range) { return range.NumDescriptors == UINT_MAX; });
+
+			if (isBindlessTable)
+			{
+				continue;
+			}
+
 			// Set the bit mask depending on the type of descriptor table.
 			if (numDescriptorRanges > 0)
 			{
@@ -0,0 +1,87 @@
+#include "pch.h"
+#include "StaticBufferAllocator.h"
+
+#include "ResourceStateTracker.h"
+
+#include "d3dx12.h"
+
+using namespace Core;
+
+namespace
+{
+	// Covers vertex and index buffers, and the 16 byte alignment raw buffer views prefer.
+	constexpr uint32_t BufferGranularity = 256;
+}
+
+Core::BufferAllocation::BufferAllocation(
+	std::shared_ptr<StaticBufferAllocator> allocator,
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource,
+	PagedRangeAllocator::Range range)
+	: m_allocator(allocator)
+	, m_resource(resource)
+	, m_range(range)
+{
+}
+
+Core::BufferAllocation::~BufferAllocation()
+{
+	this->m_allocator->Free(this->m_range);
+}
+
+Core::StaticBufferAllocator::StaticBufferAllocator(
+	Microsoft::WRL::ComPtr<ID3D12Device> device,
+	std::shared_ptr<DeferredReleaseQueue> deferredReleaseQueue,
+	size_t bufferSize)
+	: m_device(device)
+	, m_deferredReleaseQueue(deferredReleaseQueue)
+	, m_rangeAllocator(bufferSize, BufferGranularity)
+{
+}
+
+std::shared_ptr<BufferAllocation> Core::StaticBufferAllocator::Allocate(size_t sizeInBytes)
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+
+	auto range = this->m_rangeAllocator.Allocate(sizeInBytes);
+
+	// The range allocator added a page.
+	if (range.Page == this->m_buffers.size())
+	{
+		this->m_buffers.push_back(this->CreateBuffer(this->m_rangeAllocator.GetPageSize(range.Page)));
+	}
+
+	return std::make_shared<BufferAllocation>(shared_from_this(), this->m_buffers[range.Page], range);
+}
+
+PagedRangeAllocator::Statistics Core::StaticBufferAllocator::GetStatistics() const
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+	return this->m_rangeAllocator.GetStatistics();
+}
+
+void Core::StaticBufferAllocator::Free(PagedRangeAllocator::Range const& range)
+{
+	this->m_deferredReleaseQueue->Defer([allocator = shared_from_this(), range]() {
+		std::lock_guard<std::mutex> lock(allocator->m_mutex);
+		allocator->m_rangeAllocator.Free(range);
+		});
+}
+
+Microsoft::WRL::ComPtr<ID3D12Resource> Core::StaticBufferAllocator::CreateBuffer(uint64_t sizeInBytes)
+{
+	Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
+	ThrowIfFailed(
+		this->m_device->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Buffer(sizeInBytes),
+			D3D12_RESOURCE_STATE_COMMON,
+			nullptr,
+			IID_PPV_ARGS(&buffer)));
+
+	buffer->SetName(L"Static Buffer");
+
+	ResourceStateTracker::AddGlobalResourceState(buffer.Get(), D3D12_RESOURCE_STATE_COMMON);
+
+	return buffer;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <d3d12.h>
+#include <wrl.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Defines.h"
+#include "DeferredReleaseQueue.h"
+#include "PagedRangeAllocator.h"
+
+namespace Core
+{
+	class StaticBufferAllocator;
+
+	// A range of one of the allocator's buffers, freed once the queues have passed it.
+	class BufferAllocation
+	{
+	public:
+		BufferAllocation(
+			std::shared_ptr<StaticBufferAllocator> allocator,
+			Microsoft::WRL::ComPtr<ID3D12Resource> resource,
+			PagedRangeAllocator::Range range);
+		~BufferAllocation();
+
+		BufferAllocation(const BufferAllocation&) = delete;
+		BufferAllocation& operator=(const BufferAllocation&) = delete;
+
+		Microsoft::WRL::ComPtr<ID3D12Resource> GetResource() const { return this->m_resource; }
+		uint64_t GetOffset() const { return this->m_range.Offset; }
+		uint64_t GetSize() const { return this->m_range.Size; }
+
+	private:
+		std::shared_ptr<StaticBufferAllocator> m_allocator;
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_resource;
+		PagedRangeAllocator::Range m_range;
+	};
+
+	/**
+	 * Carves static vertex and index buffers out of large default heap buffers, so a mesh
+	 * doesn't cost a committed resource per buffer. Buffers that share a resource share its
+	 * state, they're used in ReadState and only leave it to be copied to.
+	 * Thread safe.
+	 */
+	class StaticBufferAllocator : public std::enable_shared_from_this<StaticBufferAllocator>
+	{
+	public:
+		static constexpr D3D12_RESOURCE_STATES ReadState =
+			D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER |
+			D3D12_RESOURCE_STATE_INDEX_BUFFER |
+			D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE |
+			D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+
+	public:
+		StaticBufferAllocator(
+			Microsoft::WRL::ComPtr<ID3D12Device> device,
+			std::shared_ptr<DeferredReleaseQueue> deferredReleaseQueue,
+			size_t bufferSize = _32MB);
+
+		std::shared_ptr<BufferAllocation> Allocate(size_t sizeInBytes);
+
+		PagedRangeAllocator::Statistics GetStatistics() const;
+
+	private:
+		friend class BufferAllocation;
+
+		// The GPU may still read the range, it's reused once every queue has passed it.
+		void Free(PagedRangeAllocator::Range const& range);
+
+		Microsoft::WRL::ComPtr<ID3D12Resource> CreateBuffer(uint64_t sizeInBytes);
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+		std::shared_ptr<DeferredReleaseQueue> m_deferredReleaseQueue;
+
+		PagedRangeAllocator m_rangeAllocator;
+
+		// One per page of the range allocator.
+		std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_buffers;
+
+		mutable std::mutex m_mutex;
+	};
+}
@@ -0,0 +1,275 @@
+#include "pch.h"
+#include "TransientTexturePool.h"
+
+#include "CommandList.h"
+#include "Dx12RenderDevice.h"
+#include "ResourceStateTracker.h"
+
+#include "d3dx12.h"
+
+using namespace Core;
+
+namespace
+{
+	// Heaps grow in steps so a frame that adds a small texture doesn't replace them.
+	constexpr uint64_t HeapGranularity = _4MB;
+
+	uint64_t AlignUp(uint64_t size, uint64_t alignment)
+	{
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+	D3D12_RESOURCE_STATES GetInitialState(D3D12_RESOURCE_DESC const& desc)
+	{
+		if (desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET)
+		{
+			return D3D12_RESOURCE_STATE_RENDER_TARGET;
+		}
+
+		if (desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)
+		{
+			return D3D12_RESOURCE_STATE_DEPTH_WRITE;
+		}
+
+		return D3D12_RESOURCE_STATE_COMMON;
+	}
+}
+
+Core::TransientTexturePool::TransientTexturePool(std::shared_ptr<Dx12RenderDevice> renderDevice)
+	: m_renderDevice(renderDevice)
+	, m_heaps{}
+	, m_isCompiled(false)
+	, m_numCreatedTextures(0)
+	, m_frameStatistics{}
+{
+}
+
+TransientTexturePool::Handle Core::TransientTexturePool::Declare(
+	D3D12_RESOURCE_DESC const& resourceDesc,
+	const D3D12_CLEAR_VALUE* clearValue,
+	uint32_t firstPass,
+	uint32_t lastPass)
+{
+	LOG_CORE_ASSERT(!this->m_isCompiled, "Textures can't be declared once the frame is compiled");
+
+	Declaration declaration = {};
+	declaration.Desc.ResourceDesc = resourceDesc;
+	declaration.Desc.HasClearValue = clearValue != nullptr;
+	if (clearValue)
+	{
+		declaration.Desc.ClearValue = *clearValue;
+	}
+
+	const bool isRenderTarget =
+		(resourceDesc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) != 0;
+	declaration.Kind = isRenderTarget ? RenderTargetHeap : TextureHeap;
+
+	auto allocationInfo = this->m_renderDevice->GetD3DDevice()->GetResourceAllocationInfo(0, 1, &resourceDesc);
+	declaration.Block = this->m_heaps[declaration.Kind].Allocator.Add(
+		allocationInfo.SizeInBytes,
+		allocationInfo.Alignment,
+		firstPass,
+		lastPass);
+
+	this->m_declarations.push_back(std::move(declaration));
+	return static_cast<Handle>(this->m_declarations.size() - 1);
+}
+
+void Core::TransientTexturePool::Compile()
+{
+	LOG_CORE_ASSERT(!this->m_isCompiled, "The frame is already compiled");
+
+	for (uint32_t kind = 0; kind < NumHeapKinds; kind++)
+	{
+		auto& heap = this->m_heaps[kind];
+		uint64_t packedBytes = heap.Allocator.Pack();
+		if (packedBytes > heap.Size)
+		{
+			this->GrowHeap(static_cast<HeapKind>(kind), packedBytes);
+		}
+	}
+
+	std::vector<PlacedTexture> placedTextures;
+	placedTextures.reserve(this->m_declarations.size());
+
+	for (auto& declaration : this->m_declarations)
+	{
+		auto const& heap = this->m_heaps[declaration.Kind];
+
+		PlacedTexture placed = {};
+		placed.Desc = declaration.Desc;
+		placed.D3DHeap = heap.D3DHeap.Get();
+		placed.Offset = heap.Allocator.GetOffset(declaration.Block);
+
+		auto reused = std::find_if(this->m_placedTextures.begin(), this->m_placedTextures.end(), [&](PlacedTexture const& other) {
+			return other.D3DHeap == placed.D3DHeap && other.Offset == placed.Offset && IsSameDesc(other.Desc, placed.Desc);
+			});
+
+		if (reused != this->m_placedTextures.end())
+		{
+			placed.Texture = std::move(reused->Texture);
+			this->m_placedTextures.erase(reused);
+		}
+		else
+		{
+			placed.Texture = this->CreatePlacedTexture(placed.Desc, placed.D3DHeap, placed.Offset);
+			this->m_numCreatedTextures++;
+		}
+
+		declaration.Texture = placed.Texture;
+		placedTextures.push_back(std::move(placed));
+	}
+
+	// The GPU may still use the ones this frame didn't ask for.
+	auto deferredReleaseQueue = this->m_renderDevice->GetDeferredReleaseQueue();
+	for (auto& placed : this->m_placedTextures)
+	{
+		deferredReleaseQueue->Release(std::move(placed.Texture));
+	}
+
+	this->m_placedTextures = std::move(placedTextures);
+	this->m_isCompiled = true;
+}
+
+Dx12Texture const& Core::TransientTexturePool::Acquire(CommandList& commandList, Handle handle)
+{
+	auto const& texture = this->GetTexture(handle);
+
+	// Any texture placed in the same memory is done with it. The texture is left in whatever
+	// state its last frame ended in, it's only transitioned once the memory is its own.
+	commandList.AliasBarrier(nullptr, texture.GetDx12Resource());
+	commandList.TransitionBarrier(
+		texture.GetDx12Resource(),
+		GetInitialState(this->m_declarations[handle].Desc.ResourceDesc));
+
+	return texture;
+}
+
+Dx12Texture const& Core::TransientTexturePool::GetTexture(Handle handle) const
+{
+	LOG_CORE_ASSERT(this->m_isCompiled, "The frame has to be compiled before its textures are used");
+	return this->m_declarations[handle].Texture;
+}
+
+void Core::TransientTexturePool::EndFrame()
+{
+	Statistics statistics = {};
+	statistics.NumTextures = static_cast<uint32_t>(this->m_declarations.size());
+	statistics.NumCreatedTextures = this->m_numCreatedTextures;
+	statistics.MaxPackedBytes = this->m_frameStatistics.MaxPackedBytes;
+
+	for (auto& heap : this->m_heaps)
+	{
+		auto const& heapStatistics = heap.Allocator.GetStatistics();
+		statistics.PackedBytes += heapStatistics.PackedBytes;
+		statistics.PeakLiveBytes += heapStatistics.PeakLiveBytes;
+		statistics.UnaliasedBytes += heapStatistics.UnaliasedBytes;
+		statistics.HeapBytes += heap.Size;
+
+		heap.Allocator.Reset();
+	}
+
+	statistics.MaxPackedBytes = std::max(statistics.MaxPackedBytes, statistics.PackedBytes);
+	this->m_frameStatistics = statistics;
+
+	this->m_declarations.clear();
+	this->m_isCompiled = false;
+	this->m_numCreatedTextures = 0;
+}
+
+bool Core::TransientTexturePool::IsSameDesc(TextureDesc const& a, TextureDesc const& b)
+{
+	auto const& descA = a.ResourceDesc;
+	auto const& descB = b.ResourceDesc;
+	if (descA.Dimension != descB.Dimension ||
+		descA.Alignment != descB.Alignment ||
+		descA.Width != descB.Width ||
+		descA.Height != descB.Height ||
+		descA.DepthOrArraySize != descB.DepthOrArraySize ||
+		descA.MipLevels != descB.MipLevels ||
+		descA.Format != descB.Format ||
+		descA.SampleDesc.Count != descB.SampleDesc.Count ||
+		descA.SampleDesc.Quality != descB.SampleDesc.Quality ||
+		descA.Layout != descB.Layout ||
+		descA.Flags != descB.Flags)
+	{
+		return false;
+	}
+
+	if (a.HasClearValue != b.HasClearValue)
+	{
+		return false;
+	}
+
+	if (!a.HasClearValue)
+	{
+		return true;
+	}
+
+	if (a.ClearValue.Format != b.ClearValue.Format)
+	{
+		return false;
+	}
+
+	// The clear value is a union, depth textures only set the depth and stencil values.
+	if (descA.Flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)
+	{
+		return a.ClearValue.DepthStencil.Depth == b.ClearValue.DepthStencil.Depth &&
+			a.ClearValue.DepthStencil.Stencil == b.ClearValue.DepthStencil.Stencil;
+	}
+
+	return std::memcmp(a.ClearValue.Color, b.ClearValue.Color, sizeof(a.ClearValue.Color)) == 0;
+}
+
+void Core::TransientTexturePool::GrowHeap(HeapKind kind, uint64_t size)
+{
+	auto& heap = this->m_heaps[kind];
+
+	// Textures placed in the old heap aren't found at their offsets anymore and are released by the compile.
+	if (heap.D3DHeap)
+	{
+		this->m_renderDevice->GetDeferredReleaseQueue()->Release(std::move(heap.D3DHeap));
+	}
+
+	heap.Size = AlignUp(size, HeapGranularity);
+
+	const D3D12_HEAP_FLAGS flags = kind == RenderTargetHeap
+		? D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES
+		: D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+
+	// MSAA alignment, so multisampled targets can be placed too.
+	auto heapDesc = CD3DX12_HEAP_DESC(
+		heap.Size,
+		D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT,
+		flags);
+
+	ThrowIfFailed(
+		this->m_renderDevice->GetD3DDevice()->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap.D3DHeap)));
+
+	SetD3DDebugName(heap.D3DHeap, kind == RenderTargetHeap ? L"Transient Render Target Heap" : L"Transient Texture Heap");
+}
+
+Dx12Texture Core::TransientTexturePool::CreatePlacedTexture(TextureDesc const& desc, ID3D12Heap* heap, uint64_t offset)
+{
+	auto initialState = GetInitialState(desc.ResourceDesc);
+
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+	ThrowIfFailed(
+		this->m_renderDevice->GetD3DDevice()->CreatePlacedResource(
+			heap,
+			offset,
+			&desc.ResourceDesc,
+			initialState,
+			desc.HasClearValue ? &desc.ClearValue : nullptr,
+			IID_PPV_ARGS(&resource)));
+
+	SetD3DDebugName(resource, L"Transient Texture");
+
+	ResourceStateTracker::AddGlobalResourceState(resource.Get(), initialState);
+
+	Dx12Texture texture(this->m_renderDevice, resource);
+	texture.CreateViews();
+
+	return texture;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <d3d12.h>
+#include <wrl.h>
+
+#include <memory>
+#include <vector>
+
+#include "IntervalAllocator.h"
+#include "GraphicResourceTypes.h"
+
+namespace Core
+{
+	class CommandList;
+	class Dx12RenderDevice;
+
+	/**
+	 * Textures that only live for part of a frame, e.g. intermediate render targets, depth
+	 * buffers or staging copies. Each frame the textures are declared with the passes they're
+	 * used in, then compiled at once: textures whose passes don't overlap are placed in the
+	 * same memory of a heap. Placed resources are kept for the next frame if a texture with
+	 * the same description lands at the same offset.
+	 * A texture's content doesn't survive the frame, or other textures using its memory.
+	 * Render targets and depth textures have to be cleared, discarded or fully written after
+	 * they're acquired.
+	 * Not thread safe, a frame's textures are declared and compiled from one thread.
+	 */
+	class TransientTexturePool
+	{
+	public:
+		using Handle = uint32_t;
+
+		struct Statistics
+		{
+			uint32_t NumTextures;
+			uint32_t NumCreatedTextures;    // Placed resources that couldn't be kept from the frame before.
+			uint64_t PackedBytes;           // The heap memory the frame's textures needed.
+			uint64_t PeakLiveBytes;         // The most bytes alive in one pass, per heap and summed.
+			uint64_t UnaliasedBytes;        // What the textures would need without aliasing.
+			uint64_t HeapBytes;
+			uint64_t MaxPackedBytes;        // The highest PackedBytes of any frame so far.
+		};
+
+	public:
+		explicit TransientTexturePool(std::shared_ptr<Dx12RenderDevice> renderDevice);
+
+		// The texture is used from firstPass to lastPass, both included.
+		Handle Declare(
+			D3D12_RESOURCE_DESC const& resourceDesc,
+			const D3D12_CLEAR_VALUE* clearValue,
+			uint32_t firstPass,
+			uint32_t lastPass);
+
+		// Places the declared textures, growing the heaps if they don't fit.
+		void Compile();
+
+		/**
+		 * Activates the texture's memory with an aliasing barrier, then transitions the texture
+		 * to its initial state: render target, depth write or common. Call it once before the
+		 * texture's first pass.
+		 */
+		Dx12Texture const& Acquire(CommandList& commandList, Handle handle);
+
+		Dx12Texture const& GetTexture(Handle handle) const;
+
+		// Drops the frame's declarations and starts counting a new frame.
+		void EndFrame();
+
+		// The counters of the last frame that ended.
+		Statistics const& GetFrameStatistics() const { return this->m_frameStatistics; }
+
+	private:
+		enum HeapKind
+		{
+			RenderTargetHeap = 0,   // Tier 1 heaps can't mix render target and depth textures with others.
+			TextureHeap,
+			NumHeapKinds,
+		};
+
+		struct Heap
+		{
+			Microsoft::WRL::ComPtr<ID3D12Heap> D3DHeap;
+			uint64_t Size;
+			IntervalAllocator Allocator;
+		};
+
+		struct TextureDesc
+		{
+			D3D12_RESOURCE_DESC ResourceDesc;
+			D3D12_CLEAR_VALUE ClearValue;
+			bool HasClearValue;
+		};
+
+		struct Declaration
+		{
+			TextureDesc Desc;
+			HeapKind Kind;
+			uint32_t Block;
+			Dx12Texture Texture;
+		};
+
+		struct PlacedTexture
+		{
+			TextureDesc Desc;
+			ID3D12Heap* D3DHeap;
+			uint64_t Offset;
+			Dx12Texture Texture;
+		};
+
+		static bool IsSameDesc(TextureDesc const& a, TextureDesc const& b);
+
+		void GrowHeap(HeapKind kind, uint64_t size);
+
+		Dx12Texture CreatePlacedTexture(TextureDesc const& desc, ID3D12Heap* heap, uint64_t offset);
+
+	private:
+		std::shared_ptr<Dx12RenderDevice> m_renderDevice;
+
+		Heap m_heaps[NumHeapKinds];
+
+		std::vector<Declaration> m_declarations;
+		bool m_isCompiled;
+
+		// Kept from the last compile.
+		std::vector<PlacedTexture> m_placedTextures;
+
+		uint32_t m_numCreatedTextures;
+		Statistics m_frameStatistics;
+	};
+}
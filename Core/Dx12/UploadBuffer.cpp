@@ -1,127 +1,83 @@
 #include "pch.h"
 #include "UploadBuffer.h"
 
-#include "MathHelpers.h"
-
-#include "d3dx12.h"
-
-#include <new> // for std::bad_alloc
-
 using namespace Core;
 
-Core::UploadBuffer::UploadBuffer(
-	Microsoft::WRL::ComPtr<ID3D12Device> device, 
-	size_t pageSize)
-	: m_device(device)
-	, m_pageSize(pageSize)
+namespace
 {
-}
+	// Enough for constant buffers and texture data.
+	constexpr size_t BlockAlignment = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
 
-UploadBuffer::Allocation UploadBuffer::Allocate(size_t sizeInBytes, size_t alignment)
-{
-	if (sizeInBytes > this->m_pageSize)
+	// Vertex and structured buffer uploads are aligned to their element size, which doesn't
+	// have to be a power of two.
+	size_t AlignOffset(size_t offset, size_t alignment)
 	{
-		throw std::bad_alloc();
+		return (offset + alignment - 1) / alignment * alignment;
 	}
-
-	if (!this->m_currentPage || this->m_currentPage->HasSpace(sizeInBytes, alignment))
-	{
-		this->m_currentPage = this->RequestPage();
-	}
-
-	return this->m_currentPage->Allocate(sizeInBytes, alignment);
 }
 
-void Core::UploadBuffer::Reset()
+Core::UploadBuffer::UploadBuffer(
+	std::shared_ptr<UploadRing> uploadRing,
+	size_t blockSize)
+	: m_uploadRing(uploadRing)
+	, m_currentBlock{}
+	, m_offset(0)
+	, m_blockSize(blockSize)
 {
-	this->m_currentPage = nullptr;
-	this->m_availablePages = this->m_pagePool;
+}
 
-	for (auto& page : this->m_availablePages)
-	{
-		page->Reset();
-	}
+Core::UploadBuffer::~UploadBuffer()
+{
+	this->Reset();
 }
 
-std::shared_ptr<UploadBuffer::Page> UploadBuffer::RequestPage()
+UploadBuffer::Allocation UploadBuffer::Allocate(size_t sizeInBytes, size_t alignment)
 {
-	std::shared_ptr<Page> page;
+	UploadBuffer::Allocation allocation = {};
 
-	if (this->m_availablePages.empty())
+	if (sizeInBytes > this->m_blockSize)
 	{
-		Microsoft::WRL::ComPtr<ID3D12Resource> uploadBuffer;
-		ThrowIfFailed(
-			this->m_device->CreateCommittedResource(
-				&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-				D3D12_HEAP_FLAG_NONE,
-				&CD3DX12_RESOURCE_DESC::Buffer(m_pageSize),
-				D3D12_RESOURCE_STATE_GENERIC_READ,
-				nullptr,
-				IID_PPV_ARGS(&uploadBuffer)
-			));
-
-		uploadBuffer->SetName(L"Upload Buffer (Page)");
-
-		page = std::make_shared<UploadBuffer::Page>(uploadBuffer, this->m_pageSize);
-		this->m_pagePool.push_back(page);
+		// Starts on a block boundary, so the rest of the current block is still used.
+		auto block = this->m_uploadRing->Allocate(sizeInBytes, BlockAlignment);
+		this->m_blocks.push_back(block);
+
+		allocation.Cpu = block.Cpu;
+		allocation.Gpu = block.Gpu;
+		allocation.Resource = block.Resource;
+		allocation.Offset = block.ResourceOffset;
+		return allocation;
 	}
-	else
+
+	size_t offset = AlignOffset(this->m_offset, alignment);
+	if (!this->m_currentBlock.Cpu || offset + sizeInBytes > this->m_currentBlock.Size)
 	{
-		page = this->m_availablePages.front();
-		this->m_availablePages.pop_front();
+		this->m_currentBlock = this->m_uploadRing->Allocate(this->m_blockSize, BlockAlignment);
+		this->m_blocks.push_back(this->m_currentBlock);
+		offset = 0;
 	}
 
-	return page;
-}
-
-Core::UploadBuffer::Page::Page(
-	Microsoft::WRL::ComPtr<ID3D12Resource> resource,
-	size_t sizeInBytes)
-	: m_pageSize(sizeInBytes)
-	, m_d3d12Resource(resource)
-	, m_offset(0)
-	, m_cpuPtr(nullptr)
-	, m_gpuPtr(resource->GetGPUVirtualAddress())
-{
-	this->m_d3d12Resource->Map(0, nullptr, &this->m_cpuPtr);
-}
-
-Core::UploadBuffer::Page::~Page()
-{
-	this->m_d3d12Resource->Unmap(0, nullptr);
-	this->m_cpuPtr = nullptr;
-	this->m_gpuPtr = D3D12_GPU_VIRTUAL_ADDRESS(0);
-}
-
-bool Core::UploadBuffer::Page::HasSpace(size_t sizeInBytes, size_t alignment)
-{
-	size_t alignedSize = Math::AlignUp(sizeInBytes, alignment);
-	size_t alignmentOffset = Math::AlignUp(this->m_offset, alignment);
+	allocation.Cpu = static_cast<uint8_t*>(this->m_currentBlock.Cpu) + offset;
+	allocation.Gpu = this->m_currentBlock.Gpu + offset;
+	allocation.Resource = this->m_currentBlock.Resource;
+	allocation.Offset = this->m_currentBlock.ResourceOffset + offset;
 
-	return alignmentOffset + alignedSize <= this->m_pageSize;
+	this->m_offset = offset + sizeInBytes;
+	return allocation;
 }
 
-UploadBuffer::Allocation UploadBuffer::Page::Allocate(size_t sizeInBytes, size_t alignment)
+void Core::UploadBuffer::Retire(IFence* fence, uint64_t fenceValue)
 {
-	if (!this->HasSpace(sizeInBytes, alignment))
+	for (auto const& block : this->m_blocks)
 	{
-		throw std::bad_alloc();
+		this->m_uploadRing->Retire(block, fence, fenceValue);
 	}
 
-	size_t alignedSize = Math::AlignUp(sizeInBytes, alignment);
-	this->m_offset = Math::AlignUp(sizeInBytes, alignment);
-
-	UploadBuffer::Allocation allocation = {};
-	allocation.Cpu = static_cast<uint8_t*>(this->m_cpuPtr) + this->m_offset;
-	allocation.Gpu = this->m_gpuPtr + this->m_offset;
-
-	this->m_offset += alignedSize;
-	return allocation;
+	this->m_blocks.clear();
+	this->m_currentBlock = {};
+	this->m_offset = 0;
 }
 
-void Core::UploadBuffer::Page::Reset()
+void Core::UploadBuffer::Reset()
 {
-	this->m_offset = 0;
+	this->Retire(nullptr, 0);
 }
-
-
@@ -3,12 +3,18 @@
 #include <d3d12.h>
 #include <wrl.h>
 
-#include <deque>
 #include <memory>
+#include <vector>
 
 #include "Defines.h"
+#include "UploadRing.h"
+
 namespace Core
 {
+	/**
+	 * Sub-allocates a command list's uploads from blocks of the device's upload ring. The
+	 * blocks are retired with the fence value of the submission that reads them.
+	 */
 	class UploadBuffer
 	{
 	public:
@@ -16,57 +22,40 @@ namespace Core
 		{
 			void* Cpu;
 			D3D12_GPU_VIRTUAL_ADDRESS Gpu;
+
+			// Where the data lives, for copies that take a resource and offset.
+			ID3D12Resource* Resource;
+			uint64_t Offset;
 		};
 
 	public:
 		explicit UploadBuffer(
+			std::shared_ptr<UploadRing> uploadRing,
+			size_t blockSize = _64KB);
+		~UploadBuffer();
 
-			Microsoft::WRL::ComPtr<ID3D12Device> device,
-			size_t pageSize = _2MB);
-
+		// Uploads larger than a block get a block of their own.
 		Allocation Allocate(size_t sizeInBytes, size_t alignment);
 
+		// The blocks can be reused once the fence reaches fenceValue.
+		void Retire(IFence* fence, uint64_t fenceValue);
+
+		// Blocks that were never submitted are reused straight away.
 		void Reset();
 							
 	public:
-		size_t GetPageSize() const { return this->m_pageSize; }
-
-	private:
-		struct Page
-		{
-			Page(
-				Microsoft::WRL::ComPtr<ID3D12Resource> resource,
-				size_t sizeInBytes);
-			~Page();
-
-			bool HasSpace(size_t sizeInBytes, size_t alignment);
-			Allocation Allocate(size_t sizeInBytes, size_t alignment);
-			void Reset();
-
-		private:
-			Microsoft::WRL::ComPtr<ID3D12Resource> m_d3d12Resource;
-			Microsoft::WRL::ComPtr<ID3D12Device> m_device;
-
-			// Base Pointers
-			void* m_cpuPtr;
-			D3D12_GPU_VIRTUAL_ADDRESS m_gpuPtr;
-
-			size_t m_pageSize;
-			size_t m_offset;
-		};
-
-		std::shared_ptr<UploadBuffer::Page> RequestPage();
+		size_t GetBlockSize() const { return this->m_blockSize; }
 
 	private:
-		Microsoft::WRL::ComPtr<ID3D12Device> m_device;
-		using PagePool = std::deque<std::shared_ptr<Page>>;
+		std::shared_ptr<UploadRing> m_uploadRing;
 
-		PagePool m_pagePool;
-		PagePool m_availablePages;
+		// Taken since the last submission.
+		std::vector<UploadRing::Block> m_blocks;
 
-		std::shared_ptr<Page> m_currentPage;
+		// Small uploads are packed into the current block.
+		UploadRing::Block m_currentBlock;
+		size_t m_offset;
 
-		size_t m_pageSize;
+		size_t m_blockSize;
 	};
 }
-
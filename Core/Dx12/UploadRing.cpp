@@ -0,0 +1,146 @@
+#include "pch.h"
+#include "UploadRing.h"
+
+#include "d3dx12.h"
+
+using namespace Core;
+
+namespace
+{
+	// Anything larger would force the ring to drain too often.
+	constexpr size_t MaxRingAllocationDivisor = 4;
+}
+
+Core::UploadRing::UploadRing(
+	Microsoft::WRL::ComPtr<ID3D12Device> device,
+	std::shared_ptr<DeferredReleaseQueue> deferredReleaseQueue,
+	size_t capacity)
+	: m_device(device)
+	, m_deferredReleaseQueue(deferredReleaseQueue)
+	, m_cpuPtr(nullptr)
+	, m_gpuPtr(0)
+	, m_capacity(capacity)
+	, m_ringAllocator(capacity)
+	, m_bytesDedicated(0)
+	, m_numDedicatedAllocations(0)
+	, m_frameStatistics{}
+{
+	ThrowIfFailed(
+		this->m_device->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Buffer(this->m_capacity),
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(&this->m_d3d12Resource)));
+
+	this->m_d3d12Resource->SetName(L"Upload Ring");
+
+	// Stays mapped for the lifetime of the ring.
+	ThrowIfFailed(
+		this->m_d3d12Resource->Map(0, nullptr, &this->m_cpuPtr));
+
+	this->m_gpuPtr = this->m_d3d12Resource->GetGPUVirtualAddress();
+}
+
+Core::UploadRing::~UploadRing()
+{
+	this->m_d3d12Resource->Unmap(0, nullptr);
+	this->m_cpuPtr = nullptr;
+}
+
+UploadRing::Block Core::UploadRing::Allocate(size_t sizeInBytes, size_t alignment)
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+
+	uint64_t offset = RingAllocator::InvalidOffset;
+	if (sizeInBytes <= this->m_capacity / MaxRingAllocationDivisor)
+	{
+		offset = this->m_ringAllocator.Allocate(sizeInBytes, alignment);
+	}
+
+	if (offset == RingAllocator::InvalidOffset)
+	{
+		return this->AllocateDedicated(sizeInBytes);
+	}
+
+	Block block = {};
+	block.Cpu = static_cast<uint8_t*>(this->m_cpuPtr) + offset;
+	block.Gpu = this->m_gpuPtr + offset;
+	block.Size = sizeInBytes;
+	block.Resource = this->m_d3d12Resource.Get();
+	block.ResourceOffset = offset;
+	block.RingOffset = offset;
+
+	return block;
+}
+
+void Core::UploadRing::Retire(Block const& block, IFence* fence, uint64_t fenceValue)
+{
+	if (block.DedicatedResource)
+	{
+		if (fence)
+		{
+			this->m_deferredReleaseQueue->Release(fence, fenceValue, block.DedicatedResource);
+		}
+
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+	this->m_ringAllocator.Retire(block.RingOffset, fence, fenceValue);
+}
+
+void Core::UploadRing::EndFrame()
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+
+	auto const& ringStatistics = this->m_ringAllocator.GetStatistics();
+
+	this->m_frameStatistics.BytesAllocated = ringStatistics.BytesAllocated;
+	this->m_frameStatistics.BytesDedicated = this->m_bytesDedicated;
+	this->m_frameStatistics.NumDedicatedAllocations = this->m_numDedicatedAllocations;
+	this->m_frameStatistics.NumStalls = ringStatistics.NumStalls;
+	this->m_frameStatistics.TotalStallSeconds = ringStatistics.TotalStallSeconds;
+
+	this->m_ringAllocator.ResetStatistics();
+	this->m_bytesDedicated = 0;
+	this->m_numDedicatedAllocations = 0;
+}
+
+UploadRing::Statistics Core::UploadRing::GetFrameStatistics() const
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+	return this->m_frameStatistics;
+}
+
+UploadRing::Block Core::UploadRing::AllocateDedicated(size_t sizeInBytes)
+{
+	// Committed buffers are 64KB aligned, which covers any upload alignment.
+	Block block = {};
+	ThrowIfFailed(
+		this->m_device->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Buffer(sizeInBytes),
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(&block.DedicatedResource)));
+
+	block.DedicatedResource->SetName(L"Upload Ring (Dedicated)");
+
+	// Unmapped when the resource is released.
+	ThrowIfFailed(
+		block.DedicatedResource->Map(0, nullptr, &block.Cpu));
+
+	block.Gpu = block.DedicatedResource->GetGPUVirtualAddress();
+	block.Size = sizeInBytes;
+	block.Resource = block.DedicatedResource.Get();
+	block.ResourceOffset = 0;
+	block.RingOffset = RingAllocator::InvalidOffset;
+
+	this->m_bytesDedicated += sizeInBytes;
+	this->m_numDedicatedAllocations++;
+
+	return block;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <d3d12.h>
+#include <wrl.h>
+
+#include <memory>
+#include <mutex>
+
+#include "Defines.h"
+#include "DeferredReleaseQueue.h"
+#include "RingAllocator.h"
+
+namespace Core
+{
+	/**
+	 * A persistently mapped upload buffer shared by the command lists of the device. Blocks
+	 * are retired with the fence value of the submission that reads them, and reused once the
+	 * fence has completed. Blocks too large for the ring, or requested while the ring is held
+	 * up by a block that hasn't been submitted, get a dedicated committed resource instead.
+	 * Thread safe.
+	 */
+	class UploadRing
+	{
+	public:
+		struct Block
+		{
+			void* Cpu;
+			D3D12_GPU_VIRTUAL_ADDRESS Gpu;
+			size_t Size;
+
+			// The ring or the dedicated resource, for copies that take a resource and offset.
+			ID3D12Resource* Resource;
+			uint64_t ResourceOffset;
+
+			// RingAllocator::InvalidOffset for a dedicated block.
+			uint64_t RingOffset;
+			Microsoft::WRL::ComPtr<ID3D12Resource> DedicatedResource;
+		};
+
+		struct Statistics
+		{
+			uint64_t BytesAllocated;            // From the ring, alignment padding included.
+			uint64_t BytesDedicated;
+			uint64_t NumDedicatedAllocations;
+			uint64_t NumStalls;                 // Allocations that waited on the GPU for ring space.
+			double TotalStallSeconds;
+		};
+
+	public:
+		UploadRing(
+			Microsoft::WRL::ComPtr<ID3D12Device> device,
+			std::shared_ptr<DeferredReleaseQueue> deferredReleaseQueue,
+			size_t capacity = _32MB);
+		~UploadRing();
+
+		Block Allocate(size_t sizeInBytes, size_t alignment);
+
+		// The block can be reused once the fence reaches fenceValue, a null fence releases it right away.
+		void Retire(Block const& block, IFence* fence, uint64_t fenceValue);
+
+		// Starts counting a new frame.
+		void EndFrame();
+
+		// The counters of the last frame that ended.
+		Statistics GetFrameStatistics() const;
+
+		size_t GetCapacity() const { return this->m_capacity; }
+
+	private:
+		Block AllocateDedicated(size_t sizeInBytes);
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+		std::shared_ptr<DeferredReleaseQueue> m_deferredReleaseQueue;
+
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_d3d12Resource;
+		void* m_cpuPtr;
+		D3D12_GPU_VIRTUAL_ADDRESS m_gpuPtr;
+		size_t m_capacity;
+
+		RingAllocator m_ringAllocator;
+
+		uint64_t m_bytesDedicated;
+		uint64_t m_numDedicatedAllocations;
+		Statistics m_frameStatistics;
+
+		mutable std::mutex m_mutex;
+	};
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+namespace Core
+{
+	/**
+	 * A monotonically increasing fence value shared between a producer (usually the GPU)
+	 * and the CPU. Kept free of any graphics API so the code waiting on fences can run headless.
+	 */
+	class IFence
+	{
+	public:
+		virtual uint64_t GetCompletedValue() const = 0;
+
+		// Blocks the calling thread until the fence reaches the value.
+		virtual void WaitForValue(uint64_t value) = 0;
+
+		bool IsComplete(uint64_t value) const { return this->GetCompletedValue() >= value; }
+
+		virtual ~IFence() = default;
+	};
+
+	/**
+	 * Lets a single thread block until any fence of a set reaches its value.
+	 */
+	class IFenceEvent
+	{
+	public:
+		struct WaitEntry
+		{
+			IFence* Fence;
+			uint64_t Value;
+		};
+
+		// Returns once any entry is complete or Wake() is called. Spurious returns are allowed.
+		virtual void WaitForAny(std::vector<WaitEntry> const& entries) = 0;
+		virtual void Wake() = 0;
+
+		virtual ~IFenceEvent() = default;
+	};
+
+	/**
+	 * CPU stand-in for IFenceEvent, used together with SoftwareFence.
+	 */
+	class SoftwareFenceEvent : public IFenceEvent
+	{
+	public:
+		void WaitForAny(std::vector<WaitEntry> const& entries) override
+		{
+			std::unique_lock<std::mutex> lock(this->m_mutex);
+			this->m_cv.wait(lock, [this, &entries] {
+				if (this->m_isSignaled)
+				{
+					return true;
+				}
+
+				for (auto& entry : entries)
+				{
+					if (entry.Fence->IsComplete(entry.Value))
+					{
+						return true;
+					}
+				}
+
+				return false;
+				});
+
+			this->m_isSignaled = false;
+		}
+
+		void Wake() override
+		{
+			{
+				std::lock_guard<std::mutex> lock(this->m_mutex);
+				this->m_isSignaled = true;
+			}
+
+			this->m_cv.notify_all();
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		bool m_isSignaled = false;
+	};
+
+	/**
+	 * CPU stand-in for a GPU fence. Signal() plays the role of the GPU.
+	 */
+	class SoftwareFence : public IFence
+	{
+	public:
+		SoftwareFence(std::shared_ptr<SoftwareFenceEvent> fenceEvent = nullptr, uint64_t initialValue = 0)
+			: m_fenceEvent(fenceEvent)
+			, m_completedValue(initialValue)
+		{}
+
+		void Signal(uint64_t value)
+		{
+			{
+				std::lock_guard<std::mutex> lock(this->m_mutex);
+				this->m_completedValue = value;
+			}
+
+			this->m_cv.notify_all();
+
+			if (this->m_fenceEvent)
+			{
+				this->m_fenceEvent->Wake();
+			}
+		}
+
+		uint64_t GetCompletedValue() const override { return this->m_completedValue; }
+
+		void WaitForValue(uint64_t value) override
+		{
+			std::unique_lock<std::mutex> lock(this->m_mutex);
+			this->m_cv.wait(lock, [this, value] { return this->m_completedValue >= value; });
+		}
+
+	private:
+		std::shared_ptr<SoftwareFenceEvent> m_fenceEvent;
+		std::atomic_uint64_t m_completedValue;
+
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+	};
+}
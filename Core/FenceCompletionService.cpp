@@ -0,0 +1,133 @@
+#include "pch.h"
+#include "FenceCompletionService.h"
+
+using namespace Core;
+
+namespace
+{
+	constexpr size_t MaxSubmittedEntries = 4096;
+}
+
+Core::FenceCompletionService::FenceCompletionService(std::unique_ptr<IFenceEvent> fenceEvent)
+	: m_fenceEvent(std::move(fenceEvent))
+	, m_submittedEntries(MaxSubmittedEntries)
+	, m_numSubmitted(0)
+	, m_numDrained(0)
+	, m_isRunningCallbacks(false)
+	, m_isRunning(true)
+{
+	this->m_thread = std::thread(&FenceCompletionService::ProcessCompletions, this);
+}
+
+Core::FenceCompletionService::~FenceCompletionService()
+{
+	this->m_isRunning = false;
+	this->m_fenceEvent->Wake();
+
+	this->m_thread.join();
+}
+
+void Core::FenceCompletionService::Enqueue(IFence* fence, uint64_t fenceValue, std::function<void()> onCompleted)
+{
+	this->m_submittedEntries.Push({ fence, fenceValue, std::move(onCompleted) });
+	this->m_numSubmitted++;
+
+	this->m_fenceEvent->Wake();
+}
+
+void Core::FenceCompletionService::Flush(IFence* fence)
+{
+	LOG_CORE_ASSERT(std::this_thread::get_id() != this->m_thread.get_id(), "Flushing from the completion thread would dead lock");
+
+	const uint64_t numSubmitted = this->m_numSubmitted;
+
+	std::unique_lock<std::mutex> lock(this->m_mutex);
+	this->m_completedCv.wait(lock, [this, fence, numSubmitted] {
+		return
+			this->m_numDrained >= numSubmitted &&
+			!this->m_isRunningCallbacks &&
+			std::none_of(
+				this->m_pendingEntries.begin(),
+				this->m_pendingEntries.end(),
+				[fence](PendingEntry const& entry) { return entry.Fence == fence; });
+		});
+}
+
+size_t Core::FenceCompletionService::GetNumPending() const
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+	return this->m_pendingEntries.size() + this->m_submittedEntries.Size();
+}
+
+void Core::FenceCompletionService::ProcessCompletions()
+{
+	std::vector<PendingEntry> completedEntries;
+	std::vector<IFenceEvent::WaitEntry> waitEntries;
+
+	std::unique_lock<std::mutex> lock(this->m_mutex);
+	for (;;)
+	{
+		size_t numDrained = this->m_submittedEntries.TryPopBatch(this->m_pendingEntries, MaxSubmittedEntries);
+		this->m_numDrained += numDrained;
+
+		if (!this->m_isRunning && this->m_pendingEntries.empty() && this->m_submittedEntries.Empty())
+		{
+			break;
+		}
+
+		// Move completed entries to the back, keeping submission order on both sides.
+		auto completedBegin = std::stable_partition(
+			this->m_pendingEntries.begin(),
+			this->m_pendingEntries.end(),
+			[](PendingEntry const& entry) { return !entry.Fence->IsComplete(entry.FenceValue); });
+
+		if (completedBegin != this->m_pendingEntries.end())
+		{
+			std::move(completedBegin, this->m_pendingEntries.end(), std::back_inserter(completedEntries));
+			this->m_pendingEntries.erase(completedBegin, this->m_pendingEntries.end());
+
+			this->m_isRunningCallbacks = true;
+			lock.unlock();
+
+			for (auto& entry : completedEntries)
+			{
+				entry.OnCompleted();
+			}
+			completedEntries.clear();
+
+			lock.lock();
+			this->m_isRunningCallbacks = false;
+			this->m_completedCv.notify_all();
+			continue;
+		}
+
+		if (numDrained > 0)
+		{
+			this->m_completedCv.notify_all();
+		}
+
+		// Wait on the lowest outstanding value of every fence. With nothing pending
+		// this only returns once Enqueue wakes the service.
+		waitEntries.clear();
+		for (auto& entry : this->m_pendingEntries)
+		{
+			auto iter = std::find_if(
+				waitEntries.begin(),
+				waitEntries.end(),
+				[&entry](IFenceEvent::WaitEntry const& waitEntry) { return waitEntry.Fence == entry.Fence; });
+
+			if (iter == waitEntries.end())
+			{
+				waitEntries.push_back({ entry.Fence, entry.FenceValue });
+			}
+			else
+			{
+				iter->Value = std::min(iter->Value, entry.FenceValue);
+			}
+		}
+
+		lock.unlock();
+		this->m_fenceEvent->WaitForAny(waitEntries);
+		lock.lock();
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+
+#include "Fence.h"
+#include "MpmcQueue.h"
+
+namespace Core
+{
+	/**
+	 * Device wide service that runs callbacks once a fence reaches a value.
+	 * A single thread blocks on every outstanding fence at once through IFenceEvent,
+	 * so nothing spins while the GPU is busy or idle.
+	 */
+	class FenceCompletionService
+	{
+	public:
+		FenceCompletionService(std::unique_ptr<IFenceEvent> fenceEvent);
+		~FenceCompletionService();
+
+		// Invokes onCompleted on the service thread once fence reaches fenceValue.
+		void Enqueue(IFence* fence, uint64_t fenceValue, std::function<void()> onCompleted);
+
+		// Blocks until every callback queued against the fence has run.
+		void Flush(IFence* fence);
+
+		size_t GetNumPending() const;
+
+	private:
+		void ProcessCompletions();
+
+	private:
+		struct PendingEntry
+		{
+			IFence* Fence;
+			uint64_t FenceValue;
+			std::function<void()> OnCompleted;
+		};
+
+		std::unique_ptr<IFenceEvent> m_fenceEvent;
+
+		// Submitting threads only touch this queue, the service thread drains it.
+		MpmcQueue<PendingEntry> m_submittedEntries;
+		std::atomic_uint64_t m_numSubmitted;
+
+		// Owned by the service thread, published under m_mutex for Flush.
+		std::vector<PendingEntry> m_pendingEntries;
+		uint64_t m_numDrained;
+		bool m_isRunningCallbacks;
+
+		mutable std::mutex m_mutex;
+		std::condition_variable m_completedCv;
+
+		std::atomic_bool m_isRunning;
+		std::thread m_thread;
+	};
+}
@@ -0,0 +1,67 @@
+#include "pch.h"
+#include "FramePacer.h"
+
+#include <chrono>
+
+using namespace Core;
+
+Core::FramePacer::FramePacer(IFence* fence, uint32_t maxFramesInFlight)
+	: m_fence(fence)
+	, m_slots(std::max(maxFramesInFlight, 1u))
+	, m_frameNumber(0)
+	, m_completedFrameNumber(0)
+	, m_statistics{}
+	, m_totalFrameLatency(0)
+{
+}
+
+uint32_t Core::FramePacer::BeginFrame()
+{
+	this->m_frameNumber++;
+
+	auto& slot = this->m_slots[this->GetFrameSlot()];
+	if (!this->m_fence->IsComplete(slot.FenceValue))
+	{
+		auto t0 = std::chrono::high_resolution_clock::now();
+		this->m_fence->WaitForValue(slot.FenceValue);
+		auto t1 = std::chrono::high_resolution_clock::now();
+
+		this->m_statistics.NumStalledFrames++;
+		this->m_statistics.TotalStallSeconds += std::chrono::duration<double>(t1 - t0).count();
+	}
+
+	uint64_t completedFrameNumber = this->GetCompletedFrameNumber();
+
+	this->m_statistics.NumFrames++;
+	this->m_statistics.FrameLatency = static_cast<uint32_t>(this->m_frameNumber - 1 - completedFrameNumber);
+	this->m_totalFrameLatency += this->m_statistics.FrameLatency;
+	this->m_statistics.AverageFrameLatency =
+		static_cast<double>(this->m_totalFrameLatency) / this->m_statistics.NumFrames;
+
+	slot.FrameNumber = this->m_frameNumber;
+	slot.FenceValue = 0;
+
+	return this->GetFrameSlot();
+}
+
+void Core::FramePacer::EndFrame(uint64_t fenceValue)
+{
+	auto& slot = this->m_slots[this->GetFrameSlot()];
+	slot.FenceValue = std::max(slot.FenceValue, fenceValue);
+}
+
+uint64_t Core::FramePacer::GetCompletedFrameNumber()
+{
+	uint64_t completedValue = this->m_fence->GetCompletedValue();
+	for (auto& slot : this->m_slots)
+	{
+		// The current frame hasn't been submitted until EndFrame.
+		bool isSubmitted = slot.FrameNumber != this->m_frameNumber || slot.FenceValue != 0;
+		if (isSubmitted && slot.FenceValue <= completedValue)
+		{
+			this->m_completedFrameNumber = std::max(this->m_completedFrameNumber, slot.FrameNumber);
+		}
+	}
+
+	return this->m_completedFrameNumber;
+}
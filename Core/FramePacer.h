@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "Fence.h"
+
+namespace Core
+{
+	/**
+	 * Limits how many frames the CPU can record ahead of the GPU, independent of the
+	 * swap chain's buffer count. Every frame in flight owns a frame slot, BeginFrame
+	 * blocks until the GPU has retired the frame that last used the slot.
+	 * Only depends on IFence so the pacing can be simulated with SoftwareFence.
+	 */
+	class FramePacer
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t NumFrames;
+			uint64_t NumStalledFrames;        // Frames that had to wait on the GPU in BeginFrame.
+			double TotalStallSeconds;
+
+			// Frames the GPU was behind the CPU when the last frame began.
+			uint32_t FrameLatency;
+			double AverageFrameLatency;
+		};
+
+	public:
+		FramePacer(IFence* fence, uint32_t maxFramesInFlight);
+
+		// Returns the frame slot of the new frame, in [0, GetMaxFramesInFlight()).
+		uint32_t BeginFrame();
+
+		// The GPU has finished the frame once the fence reaches fenceValue.
+		void EndFrame(uint64_t fenceValue);
+
+		// Frame numbers start at 1, zero means no frame.
+		uint64_t GetFrameNumber() const { return this->m_frameNumber; }
+		uint64_t GetCompletedFrameNumber();
+
+		uint32_t GetFrameSlot() const { return static_cast<uint32_t>(this->m_frameNumber % this->m_slots.size()); }
+		uint32_t GetMaxFramesInFlight() const { return static_cast<uint32_t>(this->m_slots.size()); }
+
+		Statistics const& GetStatistics() const { return this->m_statistics; }
+
+	private:
+		struct FrameSlot
+		{
+			uint64_t FrameNumber = 0;
+			uint64_t FenceValue = 0;
+		};
+
+		IFence* m_fence;
+		std::vector<FrameSlot> m_slots;
+
+		uint64_t m_frameNumber;
+		uint64_t m_completedFrameNumber;
+
+		Statistics m_statistics;
+		uint64_t m_totalFrameLatency;
+	};
+}
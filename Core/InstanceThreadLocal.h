@@ -0,0 +1,170 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Core
+{
+	/**
+	 * Gives every thread its own Type_ per instance of the owning object, without locking
+	 * once the thread has its value. Each instance gets a unique id, so a thread never picks
+	 * up the value of a destroyed owner that lived at the same address.
+	 * When a thread exits, its values are handed to the owners' thread exit functions, e.g.
+	 * to move cached objects back to a shared pool, then destroyed. When an owner is destroyed
+	 * the values every thread holds for it are destroyed with it. The thread's entry for it
+	 * is dropped the next time the thread adds a value, or when the thread exits.
+	 */
+	template<class Type_>
+	class InstanceThreadLocal
+	{
+	public:
+		/**
+		 * Called with the value of a thread that exits while the owner is still alive. Runs on
+		 * the exiting thread under a lock shared by all instances of this Type_, so it must not
+		 * use another InstanceThreadLocal<Type_>.
+		 */
+		using ThreadExitFunction = std::function<void(Type_&)>;
+
+	public:
+		explicit InstanceThreadLocal(ThreadExitFunction onThreadExit = nullptr)
+			: m_instanceId(NextInstanceId())
+			, m_onThreadExit(std::move(onThreadExit))
+		{}
+
+		~InstanceThreadLocal();
+
+		InstanceThreadLocal(InstanceThreadLocal const&) = delete;
+		InstanceThreadLocal& operator=(InstanceThreadLocal const&) = delete;
+
+		Type_& Get()
+		{
+			auto& threadSlots = GetThreadSlots().Slots;
+			auto iter = threadSlots.find(this->m_instanceId);
+			if (iter != threadSlots.end())
+			{
+				return *iter->second->Value;
+			}
+
+			return this->AddThreadSlot();
+		}
+
+	private:
+		// Shared by the thread that uses the value and the owner, guarded by the registry mutex
+		// except for the value, which only its thread uses while the owner is alive.
+		struct Slot
+		{
+			std::unique_ptr<Type_> Value;
+			InstanceThreadLocal* Owner;
+		};
+
+		// The values of one thread by instance id, handed back when the thread exits.
+		struct ThreadSlots
+		{
+			~ThreadSlots();
+
+			std::unordered_map<uint64_t, std::shared_ptr<Slot>> Slots;
+		};
+
+		static ThreadSlots& GetThreadSlots()
+		{
+			thread_local ThreadSlots threadSlots;
+			return threadSlots;
+		}
+
+		static std::mutex& GetRegistryMutex()
+		{
+			static std::mutex registryMutex;
+			return registryMutex;
+		}
+
+		static uint64_t NextInstanceId()
+		{
+			static std::atomic_uint64_t nextInstanceId(0);
+			return ++nextInstanceId;
+		}
+
+		Type_& AddThreadSlot();
+
+	private:
+		const uint64_t m_instanceId;
+		const ThreadExitFunction m_onThreadExit;
+
+		// The slots of every thread that has a value, guarded by the registry mutex.
+		std::vector<std::shared_ptr<Slot>> m_slots;
+	};
+
+	template<class Type_>
+	inline InstanceThreadLocal<Type_>::~InstanceThreadLocal()
+	{
+		// Destroyed after unlocking, a value's destructor may use other thread locals.
+		std::vector<std::unique_ptr<Type_>> values;
+		{
+			std::lock_guard<std::mutex> lock(GetRegistryMutex());
+			for (auto& slot : this->m_slots)
+			{
+				slot->Owner = nullptr;
+				values.push_back(std::move(slot->Value));
+			}
+
+			this->m_slots.clear();
+		}
+	}
+
+	template<class Type_>
+	inline Type_& InstanceThreadLocal<Type_>::AddThreadSlot()
+	{
+		auto slot = std::make_shared<Slot>();
+		slot->Value = std::make_unique<Type_>();
+		slot->Owner = this;
+
+		auto& threadSlots = GetThreadSlots().Slots;
+
+		std::lock_guard<std::mutex> lock(GetRegistryMutex());
+
+		// Drop the entries of owners destroyed since the last time.
+		for (auto iter = threadSlots.begin(); iter != threadSlots.end();)
+		{
+			iter = iter->second->Owner ? std::next(iter) : threadSlots.erase(iter);
+		}
+
+		this->m_slots.push_back(slot);
+		threadSlots.emplace(this->m_instanceId, slot);
+
+		return *slot->Value;
+	}
+
+	template<class Type_>
+	inline InstanceThreadLocal<Type_>::ThreadSlots::~ThreadSlots()
+	{
+		std::vector<std::unique_ptr<Type_>> values;
+		{
+			std::lock_guard<std::mutex> lock(GetRegistryMutex());
+			for (auto& threadSlot : this->Slots)
+			{
+				auto& slot = threadSlot.second;
+				InstanceThreadLocal* owner = slot->Owner;
+				if (!owner)
+				{
+					continue;
+				}
+
+				if (owner->m_onThreadExit)
+				{
+					owner->m_onThreadExit(*slot->Value);
+				}
+
+				auto& ownerSlots = owner->m_slots;
+				ownerSlots.erase(std::find(ownerSlots.begin(), ownerSlots.end(), slot));
+
+				slot->Owner = nullptr;
+				values.push_back(std::move(slot->Value));
+			}
+		}
+	}
+}
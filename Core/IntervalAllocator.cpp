@@ -0,0 +1,126 @@
+#include "pch.h"
+
+#include "IntervalAllocator.h"
+
+using namespace Core;
+
+namespace
+{
+	uint64_t AlignUp(uint64_t offset, uint64_t alignment)
+	{
+		return (offset + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+uint32_t Core::IntervalAllocator::Add(uint64_t size, uint64_t alignment, uint32_t firstPass, uint32_t lastPass)
+{
+	LOG_CORE_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+	LOG_CORE_ASSERT(firstPass <= lastPass, "A block can't be released before it is first used");
+
+	Block block = {};
+	block.Size = size;
+	block.Alignment = alignment;
+	block.FirstPass = firstPass;
+	block.LastPass = lastPass;
+
+	this->m_blocks.push_back(block);
+	return static_cast<uint32_t>(this->m_blocks.size() - 1);
+}
+
+uint64_t Core::IntervalAllocator::Pack()
+{
+	// Large blocks first, so the small ones fill the gaps between them.
+	std::vector<uint32_t> order(this->m_blocks.size());
+	for (uint32_t i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+
+	std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+		auto const& blockA = this->m_blocks[a];
+		auto const& blockB = this->m_blocks[b];
+		if (blockA.Size != blockB.Size)
+		{
+			return blockA.Size > blockB.Size;
+		}
+
+		return blockA.FirstPass < blockB.FirstPass;
+		});
+
+	this->m_packedBytes = 0;
+
+	std::vector<uint32_t> placed;
+	std::vector<uint32_t> conflicts;
+	placed.reserve(order.size());
+
+	for (uint32_t index : order)
+	{
+		auto& block = this->m_blocks[index];
+
+		// The placed blocks alive at the same time, by offset.
+		conflicts.clear();
+		for (uint32_t other : placed)
+		{
+			if (IsAliveTogether(block, this->m_blocks[other]))
+			{
+				conflicts.push_back(other);
+			}
+		}
+
+		std::sort(conflicts.begin(), conflicts.end(), [this](uint32_t a, uint32_t b) {
+			return this->m_blocks[a].Offset < this->m_blocks[b].Offset;
+			});
+
+		// The first gap it fits in, past the last conflict if there is none.
+		uint64_t offset = 0;
+		for (uint32_t other : conflicts)
+		{
+			auto const& otherBlock = this->m_blocks[other];
+			if (AlignUp(offset, block.Alignment) + block.Size <= otherBlock.Offset)
+			{
+				break;
+			}
+
+			offset = std::max(offset, otherBlock.Offset + otherBlock.Size);
+		}
+
+		block.Offset = AlignUp(offset, block.Alignment);
+		this->m_packedBytes = std::max(this->m_packedBytes, block.Offset + block.Size);
+
+		placed.push_back(index);
+	}
+
+	return this->m_packedBytes;
+}
+
+IntervalAllocator::Statistics Core::IntervalAllocator::GetStatistics() const
+{
+	Statistics statistics = {};
+	statistics.NumBlocks = this->GetNumBlocks();
+	statistics.PackedBytes = this->m_packedBytes;
+
+	for (auto const& block : this->m_blocks)
+	{
+		statistics.UnaliasedBytes += block.Size;
+
+		// The live bytes only grow when a block starts.
+		uint64_t liveBytes = 0;
+		for (auto const& other : this->m_blocks)
+		{
+			if (other.FirstPass <= block.FirstPass && block.FirstPass <= other.LastPass)
+			{
+				liveBytes += other.Size;
+			}
+		}
+
+		statistics.PeakLiveBytes = std::max(statistics.PeakLiveBytes, liveBytes);
+	}
+
+	return statistics;
+}
+
+void Core::IntervalAllocator::Reset()
+{
+	this->m_blocks.clear();
+	this->m_packedBytes = 0;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace Core
+{
+	/**
+	 * Packs blocks that are each alive for an interval of passes into one range of memory,
+	 * e.g. the transient textures of a frame placed in one heap. Blocks whose intervals
+	 * overlap never overlap in memory, blocks with disjoint intervals may share it. Blocks
+	 * are added for the frame, then packed at once, largest first at the lowest offset that
+	 * is free for their whole interval.
+	 * Kept free of any graphics API so the packing can be checked without a GPU.
+	 * Not thread safe.
+	 */
+	class IntervalAllocator
+	{
+	public:
+		struct Statistics
+		{
+			uint32_t NumBlocks;
+			uint64_t PackedBytes;       // The memory the packing needs.
+			uint64_t PeakLiveBytes;     // The most bytes alive in any one pass, a lower bound for PackedBytes.
+			uint64_t UnaliasedBytes;    // What the blocks would need without sharing memory.
+		};
+
+	public:
+		/**
+		 * The block is alive from firstPass to lastPass, both included. The alignment has to
+		 * be a power of two. Returns the block's index, valid until Reset.
+		 */
+		uint32_t Add(uint64_t size, uint64_t alignment, uint32_t firstPass, uint32_t lastPass);
+
+		// Places every block added since the last Reset, returns the memory the packing needs.
+		uint64_t Pack();
+
+		// Only valid after Pack.
+		uint64_t GetOffset(uint32_t block) const { return this->m_blocks[block].Offset; }
+		uint64_t GetSize(uint32_t block) const { return this->m_blocks[block].Size; }
+
+		uint32_t GetNumBlocks() const { return static_cast<uint32_t>(this->m_blocks.size()); }
+
+		Statistics GetStatistics() const;
+
+		void Reset();
+
+	private:
+		struct Block
+		{
+			uint64_t Size;
+			uint64_t Alignment;
+			uint32_t FirstPass;
+			uint32_t LastPass;
+			uint64_t Offset;
+		};
+
+		static bool IsAliveTogether(Block const& a, Block const& b)
+		{
+			return a.FirstPass <= b.LastPass && b.FirstPass <= a.LastPass;
+		}
+
+	private:
+		std::vector<Block> m_blocks;
+		uint64_t m_packedBytes = 0;
+	};
+}
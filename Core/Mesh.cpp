@@ -2,6 +2,7 @@
 #include "Mesh.h"
 
 #include "Dx12/CommandList.h"
+#include "Dx12/CommandBundle.h"
 #include "Dx12/GraphicResourceTypes.h"
 
 #include <DirectXMath.h>
@@ -16,25 +17,122 @@ const D3D12_INPUT_ELEMENT_DESC VertexPositionNormalTexture::InputElements[] =
     { "TEXCOORD",   0, DXGI_FORMAT_R32G32_FLOAT,    0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
 };
 
+namespace
+{
+    // A mesh is rarely drawn with more pipeline states than this, the oldest bundle is dropped.
+    constexpr size_t MaxCachedBundles = 4;
+
+    // Shared by the immediate and the bundled path, CommandList and CommandBundle have the same setters.
+    template<class Target_>
+    void RecordDraw(
+        Target_& target,
+        Dx12Buffer& vertexBuffer,
+        Dx12Buffer& indexBuffer,
+        uint32_t indexCount,
+        uint32_t numVertices,
+        uint32_t instanceCount,
+        uint32_t firstInstance)
+    {
+        target.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        target.SetVertexBuffer(vertexBuffer);
+        if (indexCount > 0)
+        {
+            target.SetIndexBuffer(indexBuffer);
+            target.DrawIndexed(indexCount, instanceCount, 0, 0, firstInstance);
+        }
+        else
+        {
+            target.Draw(numVertices, instanceCount, 0, firstInstance);
+        }
+    }
+}
+
 Core::Mesh::Mesh()
     : m_indexCount(0)
     , m_numVertices(0)
+    , m_useBundles(true)
 {
 }
 
 void Mesh::Draw(CommandList& commandList, uint32_t instanceCount, uint32_t firstInstance)
 {
-	commandList.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	commandList.SetVertexBuffer(this->m_vertexBuffer);
-	if (this->m_indexCount > 0)
-	{
-		commandList.SetIndexBuffer(this->m_indexBuffer);
-		commandList.DrawIndexed(this->m_indexCount, instanceCount, 0, 0, firstInstance);
-	}
-	else
-	{
-		commandList.Draw(this->m_numVertices, instanceCount, 0, firstInstance);
-	}
+    {
+        // Chunks recorded in parallel draw the same mesh, the cache can't change under a replay.
+        std::lock_guard<std::mutex> bundleLock(this->m_bundleMutex);
+        CommandBundle* bundle = this->GetBundle(commandList, instanceCount, firstInstance);
+        if (bundle)
+        {
+            commandList.ExecuteBundle(*bundle);
+            return;
+        }
+    }
+
+    RecordDraw(
+        commandList,
+        this->m_vertexBuffer,
+        this->m_indexBuffer,
+        this->m_indexCount,
+        this->m_numVertices,
+        instanceCount,
+        firstInstance);
+}
+
+CommandBundle* Core::Mesh::GetBundle(CommandList& commandList, uint32_t instanceCount, uint32_t firstInstance)
+{
+    // Bundles are recorded against the pipeline state, without one the draw is issued directly.
+    ID3D12PipelineState* pipelineState = commandList.GetPipelineState();
+    if (!this->m_useBundles ||
+        !this->m_renderDevice ||
+        !pipelineState ||
+        commandList.GetType() != D3D12_COMMAND_LIST_TYPE_DIRECT)
+    {
+        return nullptr;
+    }
+
+    auto iter = std::find_if(this->m_bundles.begin(), this->m_bundles.end(), [&](CachedBundle const& cachedBundle) {
+        return cachedBundle.PipelineState == pipelineState &&
+            cachedBundle.InstanceCount == instanceCount &&
+            cachedBundle.FirstInstance == firstInstance;
+        });
+
+    if (iter != this->m_bundles.end() && iter->Bundle->IsValid())
+    {
+        return iter->Bundle.get();
+    }
+
+    if (iter == this->m_bundles.end())
+    {
+        if (this->m_bundles.size() >= MaxCachedBundles)
+        {
+            this->m_bundles.erase(this->m_bundles.begin());
+        }
+
+        this->m_bundles.push_back({
+            pipelineState,
+            instanceCount,
+            firstInstance,
+            std::make_unique<CommandBundle>(this->m_renderDevice, pipelineState) });
+
+        iter = this->m_bundles.end() - 1;
+    }
+    else
+    {
+        // A buffer has been reallocated since the bundle was recorded.
+        iter->Bundle->Begin();
+    }
+
+    RecordDraw(
+        *iter->Bundle,
+        this->m_vertexBuffer,
+        this->m_indexBuffer,
+        this->m_indexCount,
+        this->m_numVertices,
+        instanceCount,
+        firstInstance);
+
+    iter->Bundle->Close();
+
+    return iter->Bundle.get();
 }
 
 
@@ -72,6 +170,7 @@ void Core::Mesh::Initialize(
         ReverseWinding(indices, vertices);
     }
 
+    this->m_renderDevice = renderDevice;
     this->m_indexCount = indices.size();
     this->m_numVertices = vertices.size();
     {
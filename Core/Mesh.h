@@ -2,8 +2,11 @@
 
 #include "Dx12/GraphicResourceTypes.h"
 
+#include "Dx12/CommandBundle.h"
+
 #include "Drawable.h"
 #include <DirectXMath.h>
+#include <mutex>
 namespace Core
 {
 	// Forward Declares
@@ -57,7 +60,13 @@ namespace Core
 			uint32_t instanceCount = 1,
 			uint32_t firstInstance = 0) override;
 
+		// Draws on direct command lists are recorded into bundles once per pipeline state and replayed.
+		void SetUseBundles(bool useBundles) { this->m_useBundles = useBundles; }
+
 	private:
+		// Called under m_bundleMutex.
+		CommandBundle* GetBundle(CommandList& commandList, uint32_t instanceCount, uint32_t firstInstance);
+
 		void Initialize(
 			std::shared_ptr<Dx12RenderDevice> renderDevice,
 			CommandList& commandList,
@@ -71,6 +80,19 @@ namespace Core
 
 		Dx12Buffer m_vertexBuffer;
 		Dx12Buffer m_indexBuffer;
+
+		struct CachedBundle
+		{
+			ID3D12PipelineState* PipelineState;
+			uint32_t InstanceCount;
+			uint32_t FirstInstance;
+			std::unique_ptr<CommandBundle> Bundle;
+		};
+
+		std::shared_ptr<Dx12RenderDevice> m_renderDevice;
+		std::mutex m_bundleMutex;
+		std::vector<CachedBundle> m_bundles;
+		bool m_useBundles;
 	};
 
 	class MeshPrefabs
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Core
+{
+	/**
+	 * Lock-free bounded multi-producer/multi-consumer ring queue.
+	 * Every cell carries a sequence number that tells producers and consumers whether
+	 * it is free or holds a value for the current lap of the ring.
+	 * @source: http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+	 */
+	template<class Type_>
+	class MpmcQueue
+	{
+	public:
+		// The capacity is rounded up to the next power of two.
+		explicit MpmcQueue(size_t capacity = 1024);
+		~MpmcQueue();
+
+		MpmcQueue(MpmcQueue const&) = delete;
+		MpmcQueue& operator=(MpmcQueue const&) = delete;
+
+		// Returns false if the queue is full.
+		bool TryPush(Type_ value);
+
+		// Yields until there is room in the queue.
+		void Push(Type_ value);
+
+		bool TryPop(Type_& value);
+
+		// Pops up to maxCount values and appends them to values. Returns the number popped.
+		size_t TryPopBatch(std::vector<Type_>& values, size_t maxCount);
+
+		// Empty and Size are only a snapshot while other threads use the queue.
+		bool Empty() const { return this->Size() == 0; }
+		size_t Size() const;
+
+		size_t Capacity() const { return this->m_mask + 1; }
+
+	private:
+		struct alignas(64) Cell
+		{
+			std::atomic<size_t> Sequence;
+			typename std::aligned_storage<sizeof(Type_), alignof(Type_)>::type Storage;
+		};
+
+		Type_* GetValue(Cell& cell) { return std::launder(reinterpret_cast<Type_*>(&cell.Storage)); }
+
+		// Only moves from value when it succeeds.
+		bool TryMoveIn(Type_& value);
+
+	private:
+		std::unique_ptr<Cell[]> m_cells;
+		size_t m_mask;
+
+		// Kept on separate cache lines so producers and consumers don't false share.
+		alignas(64) std::atomic<size_t> m_enqueuePosition;
+		alignas(64) std::atomic<size_t> m_dequeuePosition;
+	};
+
+	template<class Type_>
+	inline MpmcQueue<Type_>::MpmcQueue(size_t capacity)
+		: m_enqueuePosition(0)
+		, m_dequeuePosition(0)
+	{
+		size_t roundedCapacity = 2;
+		while (roundedCapacity < capacity)
+		{
+			roundedCapacity <<= 1;
+		}
+
+		this->m_mask = roundedCapacity - 1;
+		this->m_cells = std::make_unique<Cell[]>(roundedCapacity);
+		for (size_t i = 0; i < roundedCapacity; i++)
+		{
+			this->m_cells[i].Sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	template<class Type_>
+	inline MpmcQueue<Type_>::~MpmcQueue()
+	{
+		Type_ value;
+		while (this->TryPop(value))
+		{
+		}
+	}
+
+	template<class Type_>
+	inline bool MpmcQueue<Type_>::TryPush(Type_ value)
+	{
+		return this->TryMoveIn(value);
+	}
+
+	template<class Type_>
+	inline void MpmcQueue<Type_>::Push(Type_ value)
+	{
+		while (!this->TryMoveIn(value))
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	template<class Type_>
+	inline bool MpmcQueue<Type_>::TryMoveIn(Type_& value)
+	{
+		Cell* cell;
+		size_t position = this->m_enqueuePosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			cell = &this->m_cells[position & this->m_mask];
+			size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+			if (difference == 0)
+			{
+				if (this->m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				// The cell still holds a value from the previous lap.
+				return false;
+			}
+			else
+			{
+				position = this->m_enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		new (&cell->Storage) Type_(std::move(value));
+		cell->Sequence.store(position + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	template<class Type_>
+	inline bool MpmcQueue<Type_>::TryPop(Type_& value)
+	{
+		Cell* cell;
+		size_t position = this->m_dequeuePosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			cell = &this->m_cells[position & this->m_mask];
+			size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+			if (difference == 0)
+			{
+				if (this->m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				// Nothing has been written to the cell yet.
+				return false;
+			}
+			else
+			{
+				position = this->m_dequeuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		Type_* storedValue = this->GetValue(*cell);
+		value = std::move(*storedValue);
+		storedValue->~Type_();
+
+		cell->Sequence.store(position + this->m_mask + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	template<class Type_>
+	inline size_t MpmcQueue<Type_>::TryPopBatch(std::vector<Type_>& values, size_t maxCount)
+	{
+		size_t position = this->m_dequeuePosition.load(std::memory_order_relaxed);
+		size_t count;
+		for (;;)
+		{
+			// Count the consecutive cells that are ready, then claim them all with a single CAS.
+			count = 0;
+			while (count < maxCount)
+			{
+				Cell& cell = this->m_cells[(position + count) & this->m_mask];
+				if (cell.Sequence.load(std::memory_order_acquire) != position + count + 1)
+				{
+					break;
+				}
+
+				count++;
+			}
+
+			if (count == 0)
+			{
+				// Either empty or another consumer moved on, retry only in the latter case.
+				size_t currentPosition = this->m_dequeuePosition.load(std::memory_order_relaxed);
+				if (currentPosition == position)
+				{
+					return 0;
+				}
+
+				position = currentPosition;
+				continue;
+			}
+
+			if (this->m_dequeuePosition.compare_exchange_weak(position, position + count, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+
+		values.reserve(values.size() + count);
+		for (size_t i = 0; i < count; i++)
+		{
+			Cell& cell = this->m_cells[(position + i) & this->m_mask];
+
+			Type_* storedValue = this->GetValue(cell);
+			values.push_back(std::move(*storedValue));
+			storedValue->~Type_();
+
+			cell.Sequence.store(position + i + this->m_mask + 1, std::memory_order_release);
+		}
+
+		return count;
+	}
+
+	template<class Type_>
+	inline size_t MpmcQueue<Type_>::Size() const
+	{
+		size_t dequeuePosition = this->m_dequeuePosition.load(std::memory_order_relaxed);
+		size_t enqueuePosition = this->m_enqueuePosition.load(std::memory_order_relaxed);
+
+		return enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0;
+	}
+}
@@ -0,0 +1,93 @@
+#include "pch.h"
+
+#include "PagedRangeAllocator.h"
+
+using namespace Core;
+
+Core::PagedRangeAllocator::PagedRangeAllocator(uint64_t pageSize, uint32_t granularity)
+	: m_pageSize(pageSize)
+	, m_granularity(granularity)
+	, m_numAllocations(0)
+{
+	LOG_CORE_ASSERT(pageSize % granularity == 0, "The page size must be a multiple of the granularity");
+}
+
+PagedRangeAllocator::Range Core::PagedRangeAllocator::Allocate(uint64_t size)
+{
+	uint32_t numGranules = static_cast<uint32_t>(std::max<uint64_t>((size + this->m_granularity - 1) / this->m_granularity, 1));
+
+	Range range = {};
+	range.Size = static_cast<uint64_t>(numGranules) * this->m_granularity;
+
+	// Earlier pages first, so later pages drain and stay free for large ranges.
+	for (uint32_t page = 0; page < this->m_pages.size(); page++)
+	{
+		uint32_t offset = this->m_pages[page]->Allocate(numGranules);
+		if (offset != TlsfAllocator::InvalidOffset)
+		{
+			range.Page = page;
+			range.Offset = static_cast<uint64_t>(offset) * this->m_granularity;
+			this->m_numAllocations++;
+			return range;
+		}
+	}
+
+	uint32_t pageGranules = static_cast<uint32_t>(this->m_pageSize / this->m_granularity);
+	this->m_pages.push_back(std::make_unique<TlsfAllocator>(std::max(pageGranules, numGranules)));
+
+	range.Page = this->GetNumPages() - 1;
+	range.Offset = static_cast<uint64_t>(this->m_pages.back()->Allocate(numGranules)) * this->m_granularity;
+	this->m_numAllocations++;
+
+	return range;
+}
+
+void Core::PagedRangeAllocator::Free(Range const& range)
+{
+	LOG_CORE_ASSERT(range.Page < this->m_pages.size(), "Range doesn't belong to this allocator");
+
+	this->m_pages[range.Page]->Free(static_cast<uint32_t>(range.Offset / this->m_granularity));
+	this->m_numAllocations--;
+}
+
+uint64_t Core::PagedRangeAllocator::GetPageSize(uint32_t page) const
+{
+	return static_cast<uint64_t>(this->m_pages[page]->GetCapacity()) * this->m_granularity;
+}
+
+PagedRangeAllocator::Statistics Core::PagedRangeAllocator::GetStatistics() const
+{
+	Statistics statistics = {};
+	statistics.NumPages = this->GetNumPages();
+	statistics.NumAllocations = this->m_numAllocations;
+
+	uint64_t numFree = 0;
+	uint64_t numFreeOutsideLargest = 0;
+	for (auto const& page : this->m_pages)
+	{
+		uint64_t largestFreeBlock = page->GetLargestFreeBlock();
+
+		statistics.Capacity += page->GetCapacity();
+		statistics.NumFreeBlocks += page->GetNumFreeBlocks();
+		statistics.LargestFreeBlock = std::max(statistics.LargestFreeBlock, largestFreeBlock);
+
+		numFree += page->GetNumFree();
+		numFreeOutsideLargest += page->GetNumFree() - largestFreeBlock;
+	}
+
+	statistics.BytesAllocated = (statistics.Capacity - numFree) * this->m_granularity;
+	statistics.Capacity *= this->m_granularity;
+	statistics.LargestFreeBlock *= this->m_granularity;
+
+	if (statistics.Capacity > 0)
+	{
+		statistics.Occupancy = static_cast<double>(statistics.BytesAllocated) / statistics.Capacity;
+	}
+
+	if (numFree > 0)
+	{
+		statistics.Fragmentation = static_cast<double>(numFreeOutsideLargest) / numFree;
+	}
+
+	return statistics;
+}
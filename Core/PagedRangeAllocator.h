@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "TlsfAllocator.h"
+
+namespace Core
+{
+	/**
+	 * Sub-allocates byte ranges from pages, e.g. vertex and index buffers carved out of large
+	 * GPU buffers. Sizes are rounded up to the granularity, which is also the alignment every
+	 * range gets, and placed with a TlsfAllocator per page. A range larger than the page size
+	 * gets a page of its own. Pages are kept once they've been added.
+	 * Kept free of any graphics API so the placement can be checked without a GPU.
+	 * Not thread safe.
+	 */
+	class PagedRangeAllocator
+	{
+	public:
+		struct Range
+		{
+			uint32_t Page;
+			uint64_t Offset;
+			uint64_t Size;          // Rounded up to the granularity.
+		};
+
+		struct Statistics
+		{
+			uint32_t NumPages;
+			uint64_t NumAllocations;
+			uint64_t Capacity;          // Bytes across all pages.
+			uint64_t BytesAllocated;
+			uint64_t LargestFreeBlock;
+			uint64_t NumFreeBlocks;
+
+			// The share of the capacity that is allocated.
+			double Occupancy;
+
+			// The share of the free bytes outside of their page's largest free block, zero
+			// when every page's free space is in one piece.
+			double Fragmentation;
+		};
+
+	public:
+		PagedRangeAllocator(uint64_t pageSize, uint32_t granularity);
+
+		// Adds a page if no page has room, the caller creates the memory for pages it hasn't seen yet.
+		Range Allocate(uint64_t size);
+
+		void Free(Range const& range);
+
+		uint32_t GetNumPages() const { return static_cast<uint32_t>(this->m_pages.size()); }
+		uint64_t GetPageSize(uint32_t page) const;
+
+		uint32_t GetGranularity() const { return this->m_granularity; }
+
+		Statistics GetStatistics() const;
+
+	private:
+		const uint64_t m_pageSize;
+		const uint32_t m_granularity;
+
+		// Counted in granules.
+		std::vector<std::unique_ptr<TlsfAllocator>> m_pages;
+
+		uint64_t m_numAllocations;
+	};
+}
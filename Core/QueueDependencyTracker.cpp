@@ -0,0 +1,159 @@
+#include "pch.h"
+#include "QueueDependencyTracker.h"
+
+using namespace Core;
+
+namespace
+{
+	// Resources whose accesses have all completed are dropped every so many submissions.
+	constexpr size_t PruneInterval = 256;
+}
+
+Core::QueueDependencyTracker::QueueDependencyTracker()
+	: m_fences{}
+	, m_waitedValue{}
+	, m_numSubmissionsSincePrune(0)
+{
+}
+
+void Core::QueueDependencyTracker::RegisterQueue(QueueId queue, IFence* fence)
+{
+	LOG_CORE_ASSERT(queue < MaxQueues, "Invalid queue id");
+
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+	this->m_fences[queue] = fence;
+}
+
+std::vector<QueueDependencyTracker::QueueWait> Core::QueueDependencyTracker::ResolveWaits(
+	QueueId queue,
+	std::vector<ResourceUsage> const& usages)
+{
+	LOG_CORE_ASSERT(queue < MaxQueues, "Invalid queue id");
+
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+
+	uint64_t requiredValue[MaxQueues] = {};
+	for (auto& usage : usages)
+	{
+		auto iter = this->m_resourceAccess.find(usage.Resource);
+		if (iter == this->m_resourceAccess.end())
+		{
+			continue;
+		}
+
+		auto& access = iter->second;
+		if (access.LastWriteValue > 0 && access.LastWriteQueue != queue)
+		{
+			auto& value = requiredValue[access.LastWriteQueue];
+			value = std::max(value, access.LastWriteValue);
+		}
+
+		if (usage.IsWrite)
+		{
+			for (QueueId readQueue = 0; readQueue < MaxQueues; readQueue++)
+			{
+				if (readQueue != queue)
+				{
+					auto& value = requiredValue[readQueue];
+					value = std::max(value, access.LastReadValue[readQueue]);
+				}
+			}
+		}
+	}
+
+	std::vector<QueueWait> waits;
+	for (QueueId signalQueue = 0; signalQueue < MaxQueues; signalQueue++)
+	{
+		uint64_t value = requiredValue[signalQueue];
+		if (value == 0 || value <= this->m_waitedValue[queue][signalQueue])
+		{
+			continue;
+		}
+
+		IFence* fence = this->m_fences[signalQueue];
+		LOG_CORE_ASSERT(fence, "Resource was used on a queue that isn't registered");
+
+		if (fence->IsComplete(value))
+		{
+			continue;
+		}
+
+		this->m_waitedValue[queue][signalQueue] = value;
+		waits.push_back({ signalQueue, fence, value });
+	}
+
+	return waits;
+}
+
+void Core::QueueDependencyTracker::RecordSubmission(
+	QueueId queue,
+	uint64_t fenceValue,
+	std::vector<ResourceUsage> const& usages)
+{
+	LOG_CORE_ASSERT(queue < MaxQueues, "Invalid queue id");
+
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+
+	for (auto& usage : usages)
+	{
+		auto& access = this->m_resourceAccess[usage.Resource];
+		if (usage.IsWrite)
+		{
+			// Later users wait on this write, which already waited on the earlier reads.
+			access.LastWriteQueue = queue;
+			access.LastWriteValue = fenceValue;
+			std::fill(std::begin(access.LastReadValue), std::end(access.LastReadValue), 0);
+		}
+		else
+		{
+			access.LastReadValue[queue] = fenceValue;
+		}
+	}
+
+	if (++this->m_numSubmissionsSincePrune >= PruneInterval)
+	{
+		this->PruneCompleted();
+		this->m_numSubmissionsSincePrune = 0;
+	}
+}
+
+void Core::QueueDependencyTracker::RecordWait(QueueId queue, QueueId signalQueue, uint64_t fenceValue)
+{
+	LOG_CORE_ASSERT(queue < MaxQueues && signalQueue < MaxQueues, "Invalid queue id");
+
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+
+	auto& waitedValue = this->m_waitedValue[queue][signalQueue];
+	waitedValue = std::max(waitedValue, fenceValue);
+}
+
+size_t Core::QueueDependencyTracker::GetNumTrackedResources() const
+{
+	std::lock_guard<std::mutex> lock(this->m_mutex);
+	return this->m_resourceAccess.size();
+}
+
+void Core::QueueDependencyTracker::PruneCompleted()
+{
+	// Read the fences once, a resource is only dropped if every access to it has completed.
+	uint64_t completedValue[MaxQueues] = {};
+	for (QueueId queue = 0; queue < MaxQueues; queue++)
+	{
+		if (this->m_fences[queue])
+		{
+			completedValue[queue] = this->m_fences[queue]->GetCompletedValue();
+		}
+	}
+
+	for (auto iter = this->m_resourceAccess.begin(); iter != this->m_resourceAccess.end();)
+	{
+		auto& access = iter->second;
+		bool isComplete = access.LastWriteValue <= completedValue[access.LastWriteQueue];
+		for (QueueId queue = 0; queue < MaxQueues && isComplete; queue++)
+		{
+			isComplete = access.LastReadValue[queue] <= completedValue[queue];
+		}
+
+		iter = isComplete ? this->m_resourceAccess.erase(iter) : std::next(iter);
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Fence.h"
+
+namespace Core
+{
+	/**
+	 * Works out which queue has to wait on which before a submission can use its resources.
+	 * A read has to wait for the last write from another queue, a write also has to wait for
+	 * the reads other queues made since then. Waits that are already covered by an earlier
+	 * wait, or by a fence that has completed, are skipped.
+	 * Kept free of any graphics API so the ordering can be checked with SoftwareFence.
+	 */
+	class QueueDependencyTracker
+	{
+	public:
+		using QueueId = uint32_t;
+
+		// Enough for every D3D12_COMMAND_LIST_TYPE up to COPY.
+		static constexpr QueueId MaxQueues = 4;
+
+		struct ResourceUsage
+		{
+			const void* Resource;
+			bool IsWrite;
+		};
+
+		struct QueueWait
+		{
+			QueueId Queue;
+			IFence* Fence;
+			uint64_t FenceValue;
+		};
+
+	public:
+		QueueDependencyTracker();
+
+		void RegisterQueue(QueueId queue, IFence* fence);
+
+		/**
+		 * Returns the waits queue has to execute before a submission with these usages,
+		 * at most one per other queue. The waits are recorded as issued.
+		 */
+		std::vector<QueueWait> ResolveWaits(QueueId queue, std::vector<ResourceUsage> const& usages);
+
+		// Called once the submission has been signaled with fenceValue on queue.
+		void RecordSubmission(QueueId queue, uint64_t fenceValue, std::vector<ResourceUsage> const& usages);
+
+		// Records a wait that was issued outside of ResolveWaits.
+		void RecordWait(QueueId queue, QueueId signalQueue, uint64_t fenceValue);
+
+		size_t GetNumTrackedResources() const;
+
+	private:
+		void PruneCompleted();
+
+	private:
+		struct ResourceAccess
+		{
+			QueueId LastWriteQueue = 0;
+			uint64_t LastWriteValue = 0;     // 0 when the resource hasn't been written.
+			uint64_t LastReadValue[MaxQueues] = {};
+		};
+
+		IFence* m_fences[MaxQueues];
+
+		// Highest fence value of the second queue the first queue has waited on.
+		uint64_t m_waitedValue[MaxQueues][MaxQueues];
+
+		std::unordered_map<const void*, ResourceAccess> m_resourceAccess;
+		size_t m_numSubmissionsSincePrune;
+
+		mutable std::mutex m_mutex;
+	};
+}
@@ -14,9 +14,10 @@ void Core::RenderTarget::AttachTexture(AttachmentPoint attachmentPoint, Dx12Text
 {
 	this->m_textures[attachmentPoint] = std::move(texture);
 
-	if (texture.GetDx12Resource())
+	auto const& attachedTexture = this->m_textures[attachmentPoint];
+	if (attachedTexture.GetDx12Resource())
 	{
-		auto desc = texture.GetDx12Resource()->GetDesc();
+		auto desc = attachedTexture.GetDx12Resource()->GetDesc();
 		this->m_size.x = static_cast<uint32_t>(desc.Width);
 		this->m_size.y = static_cast<uint32_t>(desc.Height);
 	}
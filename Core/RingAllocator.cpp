@@ -0,0 +1,166 @@
+#include "pch.h"
+
+#include "RingAllocator.h"
+
+#include <chrono>
+
+using namespace Core;
+
+Core::RingAllocator::RingAllocator(uint64_t capacity)
+	: m_capacity(capacity)
+	, m_head(0)
+	, m_tail(0)
+	, m_numUsed(0)
+	, m_statistics{}
+{
+}
+
+uint64_t Core::RingAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+	LOG_CORE_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+
+	// Every block takes up space so its offset identifies it.
+	size = std::max<uint64_t>(size, 1);
+	if (size > this->m_capacity)
+	{
+		return InvalidOffset;
+	}
+
+	uint64_t offset = this->TryAllocate(size, alignment);
+	if (offset != InvalidOffset)
+	{
+		return offset;
+	}
+
+	this->ReleaseCompleted();
+	offset = this->TryAllocate(size, alignment);
+	if (offset != InvalidOffset)
+	{
+		return offset;
+	}
+
+	// The GPU is behind, wait for the oldest blocks until there is room.
+	auto t0 = std::chrono::high_resolution_clock::now();
+	bool hasStalled = false;
+	while (offset == InvalidOffset && this->WaitForOldestBlock())
+	{
+		hasStalled = true;
+		this->ReleaseCompleted();
+		offset = this->TryAllocate(size, alignment);
+	}
+
+	if (hasStalled)
+	{
+		auto t1 = std::chrono::high_resolution_clock::now();
+		this->m_statistics.NumStalls++;
+		this->m_statistics.TotalStallSeconds += std::chrono::duration<double>(t1 - t0).count();
+	}
+
+	return offset;
+}
+
+void Core::RingAllocator::Retire(uint64_t offset, IFence* fence, uint64_t fenceValue)
+{
+	// Blocks are usually retired shortly after they're allocated.
+	auto iter = std::find_if(
+		this->m_blocks.rbegin(),
+		this->m_blocks.rend(),
+		[offset](Block const& block) { return block.Offset == offset && !block.IsRetired; });
+
+	LOG_CORE_ASSERT(iter != this->m_blocks.rend(), "Block isn't allocated");
+
+	iter->Fence = fence;
+	iter->FenceValue = fenceValue;
+	iter->IsRetired = true;
+}
+
+void Core::RingAllocator::ReleaseCompleted()
+{
+	// A block that is still in use holds back the blocks allocated after it.
+	while (!this->m_blocks.empty())
+	{
+		Block const& block = this->m_blocks.front();
+		if (!block.IsRetired || (block.Fence && !block.Fence->IsComplete(block.FenceValue)))
+		{
+			break;
+		}
+
+		this->m_tail = block.End;
+		this->m_numUsed -= block.Size;
+		this->m_blocks.pop_front();
+	}
+}
+
+uint64_t Core::RingAllocator::TryAllocate(uint64_t size, uint64_t alignment)
+{
+	// Start over at the beginning once everything has been reclaimed, so large blocks fit again.
+	if (this->m_numUsed == 0)
+	{
+		this->m_head = 0;
+		this->m_tail = 0;
+	}
+	else if (this->m_numUsed == this->m_capacity)
+	{
+		return InvalidOffset;
+	}
+
+	uint64_t offset = (this->m_head + alignment - 1) & ~(alignment - 1);
+	uint64_t padding = 0;
+
+	if (this->m_head >= this->m_tail)
+	{
+		// Free space is [head, capacity) followed by [0, tail).
+		if (offset + size <= this->m_capacity)
+		{
+			padding = offset - this->m_head;
+		}
+		else if (size <= this->m_tail)
+		{
+			// The end of the ring is skipped, and reclaimed with this block.
+			offset = 0;
+			padding = this->m_capacity - this->m_head;
+		}
+		else
+		{
+			return InvalidOffset;
+		}
+	}
+	else
+	{
+		// Free space is [head, tail).
+		if (offset + size > this->m_tail)
+		{
+			return InvalidOffset;
+		}
+
+		padding = offset - this->m_head;
+	}
+
+	Block block = {};
+	block.Offset = offset;
+	block.End = offset + size;
+	block.Size = padding + size;
+	this->m_blocks.push_back(block);
+
+	this->m_head = block.End;
+	this->m_numUsed += block.Size;
+	this->m_statistics.BytesAllocated += block.Size;
+
+	return offset;
+}
+
+bool Core::RingAllocator::WaitForOldestBlock()
+{
+	if (this->m_blocks.empty() || !this->m_blocks.front().IsRetired)
+	{
+		return false;
+	}
+
+	Block const& block = this->m_blocks.front();
+	if (block.Fence)
+	{
+		block.Fence->WaitForValue(block.FenceValue);
+	}
+
+	return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+
+#include "Fence.h"
+
+namespace Core
+{
+	/**
+	 * Hands out blocks of [0, capacity) in ring order, e.g. ranges of a persistently mapped
+	 * upload buffer. A block is retired with the fence value of the submission that reads it,
+	 * the tail only moves past blocks in allocation order once they're retired and their
+	 * fences have completed. When the ring is full Allocate waits on the oldest block.
+	 * Kept free of any graphics API so the ring arithmetic can be checked with SoftwareFence.
+	 * Not thread safe.
+	 */
+	class RingAllocator
+	{
+	public:
+		static constexpr uint64_t InvalidOffset = ~0ull;
+
+		struct Statistics
+		{
+			uint64_t BytesAllocated;    // Alignment and wrap padding included.
+			uint64_t NumStalls;         // Allocations that had to wait on a fence for space.
+			double TotalStallSeconds;
+		};
+
+	public:
+		explicit RingAllocator(uint64_t capacity);
+
+		/**
+		 * The alignment has to be a power of two. Returns InvalidOffset if the block is larger
+		 * than the ring, or if the oldest block hasn't been retired yet so there is nothing to
+		 * wait on.
+		 */
+		uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+		// The block can be reused once the fence reaches fenceValue, a null fence reclaims it right away.
+		void Retire(uint64_t offset, IFence* fence, uint64_t fenceValue);
+
+		// Moves the tail past the retired blocks whose fences have completed.
+		void ReleaseCompleted();
+
+		uint64_t GetCapacity() const { return this->m_capacity; }
+		uint64_t GetNumUsed() const { return this->m_numUsed; }
+		size_t GetNumBlocks() const { return this->m_blocks.size(); }
+
+		Statistics const& GetStatistics() const { return this->m_statistics; }
+		void ResetStatistics() { this->m_statistics = {}; }
+
+	private:
+		struct Block
+		{
+			uint64_t Offset;
+			uint64_t End;
+
+			// Includes the padding in front of the block, which is reclaimed with it.
+			uint64_t Size;
+
+			IFence* Fence;
+			uint64_t FenceValue;
+			bool IsRetired;
+		};
+
+		// Returns InvalidOffset without waiting if there is no room.
+		uint64_t TryAllocate(uint64_t size, uint64_t alignment);
+
+		// Returns false if the oldest block isn't retired yet.
+		bool WaitForOldestBlock();
+
+	private:
+		const uint64_t m_capacity;
+
+		// Allocations start at the head, the tail is the end of the oldest reclaimed block.
+		uint64_t m_head;
+		uint64_t m_tail;
+		uint64_t m_numUsed;
+
+		// In allocation order.
+		std::deque<Block> m_blocks;
+
+		Statistics m_statistics;
+	};
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+namespace Core
+{
+	/**
+	 * Sparse per-subresource values stored as sorted runs of consecutive subresources that
+	 * share a value. Transitioning a mip or slice range only adds a run or two, and up to
+	 * InlineRuns_ runs are stored without allocating.
+	 * Only subresources that were set are part of the list, like keys of a map.
+	 */
+	template<class Value_, uint32_t InlineRuns_ = 8>
+	class SubresourceRunList
+	{
+	public:
+		struct Run
+		{
+			uint32_t First;
+			uint32_t Count;
+			Value_ Value;
+		};
+
+	public:
+		SubresourceRunList() = default;
+
+		bool Empty() const { return this->m_numRuns == 0; }
+		void Clear();
+
+		// Leaves value untouched if the subresource was never set.
+		bool Find(uint32_t subresource, Value_& value) const;
+		void Set(uint32_t subresource, Value_ value);
+
+		// Calls function(subresource, value) for every subresource that was set, in order.
+		template<class Function_>
+		void ForEach(Function_&& function) const;
+
+		Run const* GetRuns() const { return this->m_isSpilled ? this->m_spilledRuns.data() : this->m_inlineRuns; }
+		uint32_t GetNumRuns() const { return this->m_numRuns; }
+		bool IsInline() const { return !this->m_isSpilled; }
+
+	private:
+		Run* GetMutableRuns() { return this->m_isSpilled ? this->m_spilledRuns.data() : this->m_inlineRuns; }
+
+		// Replaces numRemoved runs at index with the new runs.
+		void Replace(uint32_t index, uint32_t numRemoved, Run const* newRuns, uint32_t numNewRuns);
+
+		// Joins neighbouring runs in [first, last] that are contiguous and share a value.
+		void Coalesce(uint32_t first, uint32_t last);
+
+	private:
+		Run m_inlineRuns[InlineRuns_] = {};
+		std::vector<Run> m_spilledRuns;
+		uint32_t m_numRuns = 0;
+		bool m_isSpilled = false;
+	};
+
+	template<class Value_, uint32_t InlineRuns_>
+	inline void SubresourceRunList<Value_, InlineRuns_>::Clear()
+	{
+		this->m_numRuns = 0;
+		this->m_spilledRuns.clear();
+		this->m_isSpilled = false;
+	}
+
+	template<class Value_, uint32_t InlineRuns_>
+	inline bool SubresourceRunList<Value_, InlineRuns_>::Find(uint32_t subresource, Value_& value) const
+	{
+		Run const* runs = this->GetRuns();
+		for (uint32_t i = 0; i < this->m_numRuns; i++)
+		{
+			if (subresource < runs[i].First)
+			{
+				break;
+			}
+
+			if (subresource - runs[i].First < runs[i].Count)
+			{
+				value = runs[i].Value;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	template<class Value_, uint32_t InlineRuns_>
+	inline void SubresourceRunList<Value_, InlineRuns_>::Set(uint32_t subresource, Value_ value)
+	{
+		Run* runs = this->GetMutableRuns();
+
+		// First run that ends after the subresource.
+		uint32_t index = 0;
+		while (index < this->m_numRuns && runs[index].First + runs[index].Count <= subresource)
+		{
+			index++;
+		}
+
+		if (index < this->m_numRuns && runs[index].First <= subresource)
+		{
+			Run run = runs[index];
+			if (run.Value == value)
+			{
+				return;
+			}
+
+			// Split the run around the subresource.
+			Run newRuns[3];
+			uint32_t numNewRuns = 0;
+			if (subresource > run.First)
+			{
+				newRuns[numNewRuns++] = { run.First, subresource - run.First, run.Value };
+			}
+
+			uint32_t newRunIndex = index + numNewRuns;
+			newRuns[numNewRuns++] = { subresource, 1, value };
+
+			uint32_t runEnd = run.First + run.Count;
+			if (subresource + 1 < runEnd)
+			{
+				newRuns[numNewRuns++] = { subresource + 1, runEnd - subresource - 1, run.Value };
+			}
+
+			this->Replace(index, 1, newRuns, numNewRuns);
+			this->Coalesce(newRunIndex > 0 ? newRunIndex - 1 : 0, newRunIndex + 1);
+		}
+		else
+		{
+			Run newRun = { subresource, 1, value };
+			this->Replace(index, 0, &newRun, 1);
+			this->Coalesce(index > 0 ? index - 1 : 0, index + 1);
+		}
+	}
+
+	template<class Value_, uint32_t InlineRuns_>
+	template<class Function_>
+	inline void SubresourceRunList<Value_, InlineRuns_>::ForEach(Function_&& function) const
+	{
+		Run const* runs = this->GetRuns();
+		for (uint32_t i = 0; i < this->m_numRuns; i++)
+		{
+			for (uint32_t subresource = runs[i].First; subresource < runs[i].First + runs[i].Count; subresource++)
+			{
+				function(subresource, runs[i].Value);
+			}
+		}
+	}
+
+	template<class Value_, uint32_t InlineRuns_>
+	inline void SubresourceRunList<Value_, InlineRuns_>::Replace(
+		uint32_t index,
+		uint32_t numRemoved,
+		Run const* newRuns,
+		uint32_t numNewRuns)
+	{
+		uint32_t numRuns = this->m_numRuns - numRemoved + numNewRuns;
+		if (!this->m_isSpilled && numRuns > InlineRuns_)
+		{
+			this->m_spilledRuns.assign(this->m_inlineRuns, this->m_inlineRuns + this->m_numRuns);
+			this->m_isSpilled = true;
+		}
+
+		if (this->m_isSpilled)
+		{
+			auto position = this->m_spilledRuns.erase(
+				this->m_spilledRuns.begin() + index,
+				this->m_spilledRuns.begin() + index + numRemoved);
+			this->m_spilledRuns.insert(position, newRuns, newRuns + numNewRuns);
+		}
+		else
+		{
+			Run* runs = this->m_inlineRuns;
+			if (numNewRuns > numRemoved)
+			{
+				std::copy_backward(runs + index + numRemoved, runs + this->m_numRuns, runs + numRuns);
+			}
+			else
+			{
+				std::copy(runs + index + numRemoved, runs + this->m_numRuns, runs + index + numNewRuns);
+			}
+
+			std::copy(newRuns, newRuns + numNewRuns, runs + index);
+		}
+
+		this->m_numRuns = numRuns;
+	}
+
+	template<class Value_, uint32_t InlineRuns_>
+	inline void SubresourceRunList<Value_, InlineRuns_>::Coalesce(uint32_t first, uint32_t last)
+	{
+		last = std::min(last, this->m_numRuns - 1);
+		for (uint32_t i = last; i > first && i < this->m_numRuns; i--)
+		{
+			Run* runs = this->GetMutableRuns();
+			Run& previous = runs[i - 1];
+			if (previous.First + previous.Count == runs[i].First && previous.Value == runs[i].Value)
+			{
+				previous.Count += runs[i].Count;
+				this->Replace(i, 1, nullptr, 0);
+			}
+		}
+	}
+}
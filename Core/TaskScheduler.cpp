@@ -0,0 +1,306 @@
+#include "pch.h"
+#include "TaskScheduler.h"
+
+using namespace Core;
+
+namespace
+{
+	constexpr size_t MaxWorkerTasks = 4096;
+	constexpr size_t MaxSharedTasks = 4096;
+
+	// Failed attempts to find a task before a worker goes to sleep.
+	constexpr uint32_t MaxIdleSpins = 64;
+}
+
+thread_local TaskScheduler* TaskScheduler::ms_currentScheduler = nullptr;
+thread_local uint32_t TaskScheduler::ms_currentWorkerIndex = 0;
+
+Core::TaskScheduler::TaskScheduler(uint32_t numWorkers)
+	: m_sharedTasks(MaxSharedTasks)
+	, m_numQueuedTasks(0)
+	, m_numSleeping(0)
+	, m_numExternalExecuted(0)
+	, m_numExternalStolen(0)
+	, m_numExternalStealAttempts(0)
+	, m_isRunning(true)
+{
+	if (numWorkers == 0)
+	{
+		numWorkers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	}
+
+	// Every deque has to exist before any worker starts stealing.
+	this->m_workers.reserve(numWorkers);
+	for (uint32_t i = 0; i < numWorkers; i++)
+	{
+		this->m_workers.emplace_back(std::make_unique<Worker>());
+		this->m_workers.back()->NextVictim = i + 1;
+	}
+
+	this->m_threads.reserve(numWorkers);
+	for (uint32_t i = 0; i < numWorkers; i++)
+	{
+		this->m_threads.emplace_back(&TaskScheduler::WorkerLoop, this, i);
+	}
+}
+
+Core::TaskScheduler::~TaskScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->m_sleepMutex);
+		this->m_isRunning = false;
+	}
+
+	this->m_sleepCv.notify_all();
+
+	for (auto& thread : this->m_threads)
+	{
+		thread.join();
+	}
+
+	// Tasks of groups nobody waited on are dropped.
+	Task* task;
+	while (this->m_sharedTasks.TryPop(task))
+	{
+		delete task;
+	}
+
+	for (auto& worker : this->m_workers)
+	{
+		while (worker->Deque.Steal(task))
+		{
+			delete task;
+		}
+	}
+}
+
+void Core::TaskScheduler::Run(TaskGroup& group, TaskFunction function)
+{
+	group.m_numPending.fetch_add(1, std::memory_order_relaxed);
+
+	Task* task = new Task{ std::move(function), &group };
+
+	// Counted before the push so a worker never sees the task without the count.
+	this->m_numQueuedTasks++;
+
+	Worker* worker = this->GetCurrentWorker();
+	if (worker)
+	{
+		if (!worker->Deque.Push(task))
+		{
+			// The deque is full, running it right away keeps the order depth first.
+			this->m_numQueuedTasks--;
+			worker->NumExecuted.fetch_add(1, std::memory_order_relaxed);
+			this->Execute(task);
+			return;
+		}
+	}
+	else
+	{
+		while (!this->m_sharedTasks.TryPush(task))
+		{
+			if (!this->TryRunTask())
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	if (this->m_numSleeping > 0)
+	{
+		{
+			// Taking the lock orders the push with a worker that is about to sleep.
+			std::lock_guard<std::mutex> lock(this->m_sleepMutex);
+		}
+
+		this->m_sleepCv.notify_one();
+	}
+}
+
+void Core::TaskScheduler::Wait(TaskGroup& group)
+{
+	while (!group.IsDone())
+	{
+		if (!this->TryRunTask())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void Core::TaskScheduler::ParallelFor(
+	uint32_t count,
+	uint32_t grainSize,
+	std::function<void(uint32_t, uint32_t)> const& function)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	TaskGroup group;
+	this->SplitRange(group, 0, count, std::max(grainSize, 1u), function);
+	this->Wait(group);
+}
+
+void Core::TaskScheduler::ParallelFor(uint32_t count, std::function<void(uint32_t)> const& function)
+{
+	this->ParallelFor(count, 1, [&function](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
+		{
+			function(i);
+		}
+		});
+}
+
+TaskScheduler::Statistics Core::TaskScheduler::GetStatistics() const
+{
+	Statistics statistics = {};
+	statistics.NumExecuted = this->m_numExternalExecuted;
+	statistics.NumStolen = this->m_numExternalStolen;
+	statistics.NumStealAttempts = this->m_numExternalStealAttempts;
+
+	for (auto& worker : this->m_workers)
+	{
+		statistics.NumExecuted += worker->NumExecuted;
+		statistics.NumStolen += worker->NumStolen;
+		statistics.NumStealAttempts += worker->NumStealAttempts;
+	}
+
+	return statistics;
+}
+
+void Core::TaskScheduler::WorkerLoop(uint32_t workerIndex)
+{
+	ms_currentScheduler = this;
+	ms_currentWorkerIndex = workerIndex;
+
+	uint32_t numIdleSpins = 0;
+	while (this->m_isRunning)
+	{
+		if (this->TryRunTask())
+		{
+			numIdleSpins = 0;
+			continue;
+		}
+
+		if (++numIdleSpins < MaxIdleSpins)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(this->m_sleepMutex);
+		this->m_numSleeping++;
+		this->m_sleepCv.wait(lock, [this] {
+			return this->m_numQueuedTasks > 0 || !this->m_isRunning;
+			});
+		this->m_numSleeping--;
+
+		numIdleSpins = 0;
+	}
+
+	ms_currentScheduler = nullptr;
+}
+
+bool Core::TaskScheduler::TryRunTask()
+{
+	Worker* worker = this->GetCurrentWorker();
+
+	Task* task = this->FindTask(worker);
+	if (!task)
+	{
+		return false;
+	}
+
+	this->m_numQueuedTasks--;
+
+	if (worker)
+	{
+		worker->NumExecuted.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		this->m_numExternalExecuted.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	this->Execute(task);
+
+	return true;
+}
+
+TaskScheduler::Task* Core::TaskScheduler::FindTask(Worker* worker)
+{
+	Task* task = nullptr;
+	if (worker && worker->Deque.Pop(task))
+	{
+		return task;
+	}
+
+	if (this->m_sharedTasks.TryPop(task))
+	{
+		return task;
+	}
+
+	auto& numStealAttempts = worker ? worker->NumStealAttempts : this->m_numExternalStealAttempts;
+	auto& numStolen = worker ? worker->NumStolen : this->m_numExternalStolen;
+
+	// Workers start at a different victim each time so they don't all hit the same deque.
+	size_t numWorkers = this->m_workers.size();
+	size_t firstVictim = worker ? worker->NextVictim++ : 0;
+	for (size_t i = 0; i < numWorkers; i++)
+	{
+		Worker* victim = this->m_workers[(firstVictim + i) % numWorkers].get();
+		if (victim == worker)
+		{
+			continue;
+		}
+
+		numStealAttempts.fetch_add(1, std::memory_order_relaxed);
+		if (victim->Deque.Steal(task))
+		{
+			numStolen.fetch_add(1, std::memory_order_relaxed);
+			return task;
+		}
+	}
+
+	return nullptr;
+}
+
+void Core::TaskScheduler::Execute(Task* task)
+{
+	task->Function();
+
+	TaskGroup* group = task->Group;
+	delete task;
+
+	group->m_numPending.fetch_sub(1, std::memory_order_release);
+}
+
+void Core::TaskScheduler::SplitRange(
+	TaskGroup& group,
+	uint32_t begin,
+	uint32_t end,
+	uint32_t grainSize,
+	std::function<void(uint32_t, uint32_t)> const& function)
+{
+	// Hand the upper half to the scheduler and keep splitting the lower half.
+	while (end - begin > grainSize)
+	{
+		uint32_t middle = begin + (end - begin) / 2;
+		this->Run(group, [this, &group, middle, end, grainSize, &function]() {
+			this->SplitRange(group, middle, end, grainSize, function);
+			});
+
+		end = middle;
+	}
+
+	function(begin, end);
+}
+
+TaskScheduler::Worker* Core::TaskScheduler::GetCurrentWorker()
+{
+	return ms_currentScheduler == this
+		? this->m_workers[ms_currentWorkerIndex].get()
+		: nullptr;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MpmcQueue.h"
+#include "WorkStealingDeque.h"
+
+namespace Core
+{
+	/**
+	 * Counts the tasks of a fork/join region that haven't finished yet.
+	 */
+	class TaskGroup
+	{
+	public:
+		TaskGroup() : m_numPending(0) {}
+
+		TaskGroup(TaskGroup const&) = delete;
+		TaskGroup& operator=(TaskGroup const&) = delete;
+
+		bool IsDone() const { return this->m_numPending.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class TaskScheduler;
+		std::atomic_uint32_t m_numPending;
+	};
+
+	/**
+	 * Work-stealing task scheduler. Every worker pushes and pops its own tasks from a
+	 * Chase-Lev deque and steals from the other workers once it runs dry. Tasks run from
+	 * threads outside the scheduler go through a shared queue.
+	 * A thread waiting on a group runs tasks instead of blocking, so tasks can fork and
+	 * join from inside other tasks.
+	 */
+	class TaskScheduler
+	{
+	public:
+		using TaskFunction = std::function<void()>;
+
+		struct Statistics
+		{
+			uint64_t NumExecuted;
+			uint64_t NumStolen;        // Tasks taken from another worker's deque.
+			uint64_t NumStealAttempts;
+		};
+
+	public:
+		// Zero workers picks one less than the number of hardware threads.
+		explicit TaskScheduler(uint32_t numWorkers = 0);
+		~TaskScheduler();
+
+		TaskScheduler(TaskScheduler const&) = delete;
+		TaskScheduler& operator=(TaskScheduler const&) = delete;
+
+		void Run(TaskGroup& group, TaskFunction task);
+
+		// Runs tasks until every task of the group has finished.
+		void Wait(TaskGroup& group);
+
+		/**
+		 * Calls function(begin, end) over [0, count) in ranges of at most grainSize.
+		 * Ranges are split in halves so idle workers steal large ranges first.
+		 */
+		void ParallelFor(
+			uint32_t count,
+			uint32_t grainSize,
+			std::function<void(uint32_t, uint32_t)> const& function);
+
+		// Calls function(index) for every index in [0, count).
+		void ParallelFor(uint32_t count, std::function<void(uint32_t)> const& function);
+
+		uint32_t GetNumWorkers() const { return static_cast<uint32_t>(this->m_workers.size()); }
+
+		Statistics GetStatistics() const;
+
+	private:
+		struct Task
+		{
+			TaskFunction Function;
+			TaskGroup* Group;
+		};
+
+		struct alignas(64) Worker
+		{
+			WorkStealingDeque<Task*> Deque;
+			std::atomic_uint64_t NumExecuted{ 0 };
+			std::atomic_uint64_t NumStolen{ 0 };
+			std::atomic_uint64_t NumStealAttempts{ 0 };
+			uint32_t NextVictim = 0;
+		};
+
+		void WorkerLoop(uint32_t workerIndex);
+
+		// Returns false if there was nothing to run.
+		bool TryRunTask();
+		Task* FindTask(Worker* worker);
+		void Execute(Task* task);
+
+		void SplitRange(
+			TaskGroup& group,
+			uint32_t begin,
+			uint32_t end,
+			uint32_t grainSize,
+			std::function<void(uint32_t, uint32_t)> const& function);
+
+		// The worker the calling thread belongs to, or nullptr for threads outside this scheduler.
+		Worker* GetCurrentWorker();
+
+	private:
+		std::vector<std::unique_ptr<Worker>> m_workers;
+		std::vector<std::thread> m_threads;
+
+		// Tasks run from threads outside the scheduler.
+		MpmcQueue<Task*> m_sharedTasks;
+
+		// Counts tasks that have been run but not yet picked up, sleeping workers wait on it.
+		std::atomic_uint32_t m_numQueuedTasks;
+		std::atomic_uint32_t m_numSleeping;
+		std::mutex m_sleepMutex;
+		std::condition_variable m_sleepCv;
+
+		// Stats of the threads outside the scheduler.
+		std::atomic_uint64_t m_numExternalExecuted;
+		std::atomic_uint64_t m_numExternalStolen;
+		std::atomic_uint64_t m_numExternalStealAttempts;
+
+		std::atomic_bool m_isRunning;
+
+		static thread_local TaskScheduler* ms_currentScheduler;
+		static thread_local uint32_t ms_currentWorkerIndex;
+	};
+}
@@ -0,0 +1,279 @@
+#include "pch.h"
+
+#include "TlsfAllocator.h"
+#include "BitOperations.h"
+
+using namespace Core;
+using namespace Core::BitOperations;
+
+Core::TlsfAllocator::TlsfAllocator(uint32_t capacity)
+	: m_capacity(capacity)
+	, m_numFree(0)
+	, m_numFreeBlocks(0)
+	, m_firstLevelBitmap(0)
+	, m_blockAtOffset(capacity, InvalidBlock)
+{
+	LOG_CORE_ASSERT(capacity > 0, "Allocator needs a non-zero capacity");
+
+	std::fill(std::begin(this->m_secondLevelBitmaps), std::end(this->m_secondLevelBitmaps), 0);
+	std::fill(&this->m_freeLists[0][0], &this->m_freeLists[0][0] + FirstLevelCount * SecondLevelCount, InvalidBlock);
+
+	uint32_t block = this->CreateBlock(0, capacity, InvalidBlock, InvalidBlock);
+	this->InsertFreeBlock(block);
+}
+
+uint32_t Core::TlsfAllocator::Allocate(uint32_t size)
+{
+	if (size == 0 || size > this->m_numFree)
+	{
+		return InvalidOffset;
+	}
+
+	uint32_t block = this->FindFreeBlock(size);
+	if (block == InvalidBlock)
+	{
+		return InvalidOffset;
+	}
+
+	this->RemoveFreeBlock(block);
+
+	// Return the left-over to the free list.
+	if (this->m_blocks[block].Size > size)
+	{
+		Block const& allocated = this->m_blocks[block];
+		uint32_t remainder = this->CreateBlock(
+			allocated.Offset + size,
+			allocated.Size - size,
+			block,
+			allocated.NextPhysical);
+
+		if (this->m_blocks[remainder].NextPhysical != InvalidBlock)
+		{
+			this->m_blocks[this->m_blocks[remainder].NextPhysical].PreviousPhysical = remainder;
+		}
+
+		this->m_blocks[block].NextPhysical = remainder;
+		this->m_blocks[block].Size = size;
+		this->InsertFreeBlock(remainder);
+	}
+
+	uint32_t offset = this->m_blocks[block].Offset;
+	this->m_blockAtOffset[offset] = block;
+
+	return offset;
+}
+
+uint32_t Core::TlsfAllocator::Free(uint32_t offset)
+{
+	LOG_CORE_ASSERT(offset < this->m_capacity, "Offset is outside of the allocator");
+
+	uint32_t block = this->m_blockAtOffset[offset];
+	LOG_CORE_ASSERT(block != InvalidBlock, "No allocation starts at this offset");
+	LOG_CORE_ASSERT(!this->m_blocks[block].IsFree, "Block is freed twice");
+
+	this->m_blockAtOffset[offset] = InvalidBlock;
+	uint32_t size = this->m_blocks[block].Size;
+
+	uint32_t previous = this->m_blocks[block].PreviousPhysical;
+	if (previous != InvalidBlock && this->m_blocks[previous].IsFree)
+	{
+		this->RemoveFreeBlock(previous);
+		block = this->MergeWithPrevious(block);
+	}
+
+	uint32_t next = this->m_blocks[block].NextPhysical;
+	if (next != InvalidBlock && this->m_blocks[next].IsFree)
+	{
+		this->RemoveFreeBlock(next);
+		block = this->MergeWithPrevious(next);
+	}
+
+	this->InsertFreeBlock(block);
+
+	return size;
+}
+
+uint32_t Core::TlsfAllocator::GetLargestFreeBlock() const
+{
+	if (this->m_firstLevelBitmap == 0)
+	{
+		return 0;
+	}
+
+	uint32_t firstLevel = FindHighestBit(this->m_firstLevelBitmap);
+	uint32_t secondLevel = FindHighestBit(this->m_secondLevelBitmaps[firstLevel]);
+
+	uint32_t largestSize = 0;
+	for (uint32_t block = this->m_freeLists[firstLevel][secondLevel]; block != InvalidBlock; block = this->m_blocks[block].NextFree)
+	{
+		largestSize = std::max(largestSize, this->m_blocks[block].Size);
+	}
+
+	return largestSize;
+}
+
+void Core::TlsfAllocator::MapSize(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+	// Sizes below SecondLevelCount fall into the linear sub-ranges of the first bin.
+	if (size < SecondLevelCount)
+	{
+		firstLevel = 0;
+		secondLevel = size;
+		return;
+	}
+
+	uint32_t highestBit = FindHighestBit(size);
+	firstLevel = highestBit - SecondLevelBits + 1;
+	secondLevel = (size >> (highestBit - SecondLevelBits)) - SecondLevelCount;
+}
+
+uint32_t Core::TlsfAllocator::FindFreeBlock(uint32_t size) const
+{
+	// Round the size up to the next bin, any block in it or above is large enough.
+	uint32_t searchSize = size;
+	if (size >= SecondLevelCount)
+	{
+		uint32_t round = (1u << (FindHighestBit(size) - SecondLevelBits)) - 1;
+		searchSize = size > ~0u - round ? ~0u : size + round;
+	}
+
+	uint32_t firstLevel;
+	uint32_t secondLevel;
+	MapSize(searchSize, firstLevel, secondLevel);
+
+	uint32_t secondLevelMap = this->m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+	if (secondLevelMap == 0)
+	{
+		uint32_t firstLevelMap = firstLevel + 1 < FirstLevelCount
+			? this->m_firstLevelBitmap & (~0u << (firstLevel + 1))
+			: 0;
+
+		if (firstLevelMap != 0)
+		{
+			firstLevel = FindLowestBit(firstLevelMap);
+			secondLevelMap = this->m_secondLevelBitmaps[firstLevel];
+		}
+	}
+
+	if (secondLevelMap != 0)
+	{
+		return this->m_freeLists[firstLevel][FindLowestBit(secondLevelMap)];
+	}
+
+	// Blocks in the size's own bin may still be large enough, only scanned when the page is
+	// nearly full so a fitting block is never missed.
+	MapSize(size, firstLevel, secondLevel);
+	for (uint32_t block = this->m_freeLists[firstLevel][secondLevel]; block != InvalidBlock; block = this->m_blocks[block].NextFree)
+	{
+		if (this->m_blocks[block].Size >= size)
+		{
+			return block;
+		}
+	}
+
+	return InvalidBlock;
+}
+
+uint32_t Core::TlsfAllocator::CreateBlock(uint32_t offset, uint32_t size, uint32_t previousPhysical, uint32_t nextPhysical)
+{
+	uint32_t block;
+	if (!this->m_unusedBlocks.empty())
+	{
+		block = this->m_unusedBlocks.back();
+		this->m_unusedBlocks.pop_back();
+	}
+	else
+	{
+		block = static_cast<uint32_t>(this->m_blocks.size());
+		this->m_blocks.emplace_back();
+	}
+
+	this->m_blocks[block] = { offset, size, previousPhysical, nextPhysical, InvalidBlock, InvalidBlock, false };
+
+	return block;
+}
+
+void Core::TlsfAllocator::ReleaseBlock(uint32_t block)
+{
+	this->m_unusedBlocks.push_back(block);
+}
+
+void Core::TlsfAllocator::InsertFreeBlock(uint32_t block)
+{
+	Block& freeBlock = this->m_blocks[block];
+
+	uint32_t firstLevel;
+	uint32_t secondLevel;
+	MapSize(freeBlock.Size, firstLevel, secondLevel);
+
+	uint32_t& head = this->m_freeLists[firstLevel][secondLevel];
+	freeBlock.PreviousFree = InvalidBlock;
+	freeBlock.NextFree = head;
+	freeBlock.IsFree = true;
+
+	if (head != InvalidBlock)
+	{
+		this->m_blocks[head].PreviousFree = block;
+	}
+
+	head = block;
+	this->m_firstLevelBitmap |= 1u << firstLevel;
+	this->m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+
+	this->m_numFree += freeBlock.Size;
+	this->m_numFreeBlocks++;
+}
+
+void Core::TlsfAllocator::RemoveFreeBlock(uint32_t block)
+{
+	Block& freeBlock = this->m_blocks[block];
+
+	uint32_t firstLevel;
+	uint32_t secondLevel;
+	MapSize(freeBlock.Size, firstLevel, secondLevel);
+
+	if (freeBlock.PreviousFree != InvalidBlock)
+	{
+		this->m_blocks[freeBlock.PreviousFree].NextFree = freeBlock.NextFree;
+	}
+	else
+	{
+		this->m_freeLists[firstLevel][secondLevel] = freeBlock.NextFree;
+	}
+
+	if (freeBlock.NextFree != InvalidBlock)
+	{
+		this->m_blocks[freeBlock.NextFree].PreviousFree = freeBlock.PreviousFree;
+	}
+
+	if (this->m_freeLists[firstLevel][secondLevel] == InvalidBlock)
+	{
+		this->m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+		if (this->m_secondLevelBitmaps[firstLevel] == 0)
+		{
+			this->m_firstLevelBitmap &= ~(1u << firstLevel);
+		}
+	}
+
+	freeBlock.IsFree = false;
+
+	this->m_numFree -= freeBlock.Size;
+	this->m_numFreeBlocks--;
+}
+
+uint32_t Core::TlsfAllocator::MergeWithPrevious(uint32_t block)
+{
+	Block const& merged = this->m_blocks[block];
+	uint32_t previous = merged.PreviousPhysical;
+
+	this->m_blocks[previous].Size += merged.Size;
+	this->m_blocks[previous].NextPhysical = merged.NextPhysical;
+	if (merged.NextPhysical != InvalidBlock)
+	{
+		this->m_blocks[merged.NextPhysical].PreviousPhysical = previous;
+	}
+
+	this->ReleaseBlock(block);
+
+	return previous;
+}
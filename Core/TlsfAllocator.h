@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace Core
+{
+	/**
+	 * Two-level segregated fit allocator for ranges of [0, capacity) units, e.g. descriptors
+	 * in a heap or blocks of a buffer. Free blocks are binned by size into power of two
+	 * ranges split into 16 linear sub-ranges, a bitmap per level finds a fitting bin in
+	 * constant time. Freed blocks are coalesced with their free neighbours straight away.
+	 * Doesn't allocate once the block pool has grown, but keeps a block index per unit, so
+	 * the capacity should be counted in allocation granules rather than bytes.
+	 * Not thread safe.
+	 * @source: http://www.gii.upv.es/tlsf/files/ecrts04_tlsf.pdf
+	 */
+	class TlsfAllocator
+	{
+	public:
+		static constexpr uint32_t InvalidOffset = ~0u;
+
+	public:
+		explicit TlsfAllocator(uint32_t capacity);
+
+		// Returns InvalidOffset if there is no free block large enough.
+		uint32_t Allocate(uint32_t size);
+
+		// Frees a block returned by Allocate, returns its size.
+		uint32_t Free(uint32_t offset);
+
+		bool HasSpace(uint32_t size) const { return this->FindFreeBlock(size) != InvalidBlock; }
+
+		uint32_t GetCapacity() const { return this->m_capacity; }
+		uint32_t GetNumFree() const { return this->m_numFree; }
+		uint32_t GetNumFreeBlocks() const { return this->m_numFreeBlocks; }
+
+		// Only scans the free list of the highest bin that isn't empty.
+		uint32_t GetLargestFreeBlock() const;
+
+	private:
+		static constexpr uint32_t InvalidBlock = ~0u;
+		static constexpr uint32_t SecondLevelBits = 4;
+		static constexpr uint32_t SecondLevelCount = 1 << SecondLevelBits;
+		static constexpr uint32_t FirstLevelCount = 32;
+
+		struct Block
+		{
+			uint32_t Offset;
+			uint32_t Size;
+
+			// Neighbours in address order.
+			uint32_t PreviousPhysical;
+			uint32_t NextPhysical;
+
+			// Neighbours in the free list of the block's bin.
+			uint32_t PreviousFree;
+			uint32_t NextFree;
+
+			bool IsFree;
+		};
+
+		static void MapSize(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+		uint32_t FindFreeBlock(uint32_t size) const;
+
+		uint32_t CreateBlock(uint32_t offset, uint32_t size, uint32_t previousPhysical, uint32_t nextPhysical);
+		void ReleaseBlock(uint32_t block);
+
+		void InsertFreeBlock(uint32_t block);
+		void RemoveFreeBlock(uint32_t block);
+
+		// Merges block into its previous physical neighbour, returns the merged block.
+		uint32_t MergeWithPrevious(uint32_t block);
+
+	private:
+		uint32_t m_capacity;
+		uint32_t m_numFree;
+		uint32_t m_numFreeBlocks;
+
+		uint32_t m_firstLevelBitmap;
+		uint32_t m_secondLevelBitmaps[FirstLevelCount];
+		uint32_t m_freeLists[FirstLevelCount][SecondLevelCount];
+
+		std::vector<Block> m_blocks;
+		std::vector<uint32_t> m_unusedBlocks;
+
+		// The block that starts at a given offset, only valid for allocated blocks.
+		std::vector<uint32_t> m_blockAtOffset;
+	};
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+namespace Core
+{
+	/**
+	 * Bounded Chase-Lev deque. The owning thread pushes and pops at the bottom without
+	 * contention, any other thread can steal from the top.
+	 * @source: https://fzn.fr/readings/ppopp13.pdf (Correct and Efficient Work-Stealing for Weak Memory Models)
+	 */
+	template<class Type_>
+	class WorkStealingDeque
+	{
+		static_assert(std::is_trivially_copyable<Type_>::value, "Deque values are copied through std::atomic");
+
+	public:
+		// The capacity is rounded up to the next power of two.
+		explicit WorkStealingDeque(size_t capacity = 4096);
+
+		WorkStealingDeque(WorkStealingDeque const&) = delete;
+		WorkStealingDeque& operator=(WorkStealingDeque const&) = delete;
+
+		// Owner only. Returns false if the deque is full.
+		bool Push(Type_ value);
+
+		// Owner only.
+		bool Pop(Type_& value);
+
+		// Any thread. Fails if the deque is empty or another thread won the race for the value.
+		bool Steal(Type_& value);
+
+		// Only a snapshot while other threads use the deque.
+		size_t Size() const;
+
+	private:
+		std::unique_ptr<std::atomic<Type_>[]> m_values;
+		int64_t m_mask;
+
+		// Thieves move the top, only the owner moves the bottom.
+		alignas(64) std::atomic<int64_t> m_top;
+		alignas(64) std::atomic<int64_t> m_bottom;
+	};
+
+	template<class Type_>
+	inline WorkStealingDeque<Type_>::WorkStealingDeque(size_t capacity)
+		: m_top(0)
+		, m_bottom(0)
+	{
+		size_t roundedCapacity = 2;
+		while (roundedCapacity < capacity)
+		{
+			roundedCapacity <<= 1;
+		}
+
+		this->m_mask = static_cast<int64_t>(roundedCapacity) - 1;
+		this->m_values = std::make_unique<std::atomic<Type_>[]>(roundedCapacity);
+	}
+
+	template<class Type_>
+	inline bool WorkStealingDeque<Type_>::Push(Type_ value)
+	{
+		int64_t bottom = this->m_bottom.load(std::memory_order_relaxed);
+		int64_t top = this->m_top.load(std::memory_order_acquire);
+		if (bottom - top > this->m_mask)
+		{
+			return false;
+		}
+
+		this->m_values[bottom & this->m_mask].store(value, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		this->m_bottom.store(bottom + 1, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	template<class Type_>
+	inline bool WorkStealingDeque<Type_>::Pop(Type_& value)
+	{
+		int64_t bottom = this->m_bottom.load(std::memory_order_relaxed) - 1;
+		this->m_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = this->m_top.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			// Empty, put the bottom back.
+			this->m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		value = this->m_values[bottom & this->m_mask].load(std::memory_order_relaxed);
+		if (top != bottom)
+		{
+			return true;
+		}
+
+		// Last value, race the thieves for it.
+		bool isTaken = this->m_top.compare_exchange_strong(
+			top,
+			top + 1,
+			std::memory_order_seq_cst,
+			std::memory_order_relaxed);
+
+		this->m_bottom.store(bottom + 1, std::memory_order_relaxed);
+
+		return isTaken;
+	}
+
+	template<class Type_>
+	inline bool WorkStealingDeque<Type_>::Steal(Type_& value)
+	{
+		int64_t top = this->m_top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t bottom = this->m_bottom.load(std::memory_order_acquire);
+
+		if (top >= bottom)
+		{
+			return false;
+		}
+
+		value = this->m_values[top & this->m_mask].load(std::memory_order_relaxed);
+
+		return this->m_top.compare_exchange_strong(
+			top,
+			top + 1,
+			std::memory_order_seq_cst,
+			std::memory_order_relaxed);
+	}
+
+	template<class Type_>
+	inline size_t WorkStealingDeque<Type_>::Size() const
+	{
+		int64_t bottom = this->m_bottom.load(std::memory_order_relaxed);
+		int64_t top = this->m_top.load(std::memory_order_relaxed);
+
+		return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+	}
+}
@@ -209,7 +209,7 @@ void BRDFLightingApp::LoadContent()
 
     this->CreateLightModelPSO();
 
-    copyQueue->WaitForFenceValue(uploadFence);
+    this->m_renderDevice->GetQueue()->Wait(*copyQueue, uploadFence);
 }
 
 void BRDFLightingApp::Update(double deltaTime)
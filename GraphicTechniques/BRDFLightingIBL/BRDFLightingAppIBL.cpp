@@ -127,7 +127,10 @@ private:
         std::string const& pixelShanderName);
 
 private:
-    RenderTarget m_hdrRenderTarget;
+    D3D12_RESOURCE_DESC m_hdrColorDesc = {};
+    D3D12_CLEAR_VALUE m_hdrColorClearValue = {};
+    D3D12_RESOURCE_DESC m_depthDesc = {};
+    D3D12_CLEAR_VALUE m_depthClearValue = {};
 
     std::array<FLOAT, 4> m_clearValue = { 0.0f, 0.0f, 0.0f, 1.0f };
     Camera m_camera;
@@ -184,7 +187,8 @@ void BRDFLightingIBLApp::LoadContent()
         // TODOL HDR Format and tone mapping
         DXGI_FORMAT hdrFormat = DXGI_FORMAT_R8G8B8A8_UNORM; //DXGI_FORMAT_R16G16B16A16_FLOAT;
 
-        // Create an off-screen render target with a single color buffer and a depth buffer.
+        // An off-screen render target with a single color buffer and a depth buffer. The
+        // textures are taken from the transient texture pool every frame.
         auto colorResourceDesc =
             CD3DX12_RESOURCE_DESC::Tex2D(
                 hdrFormat,
@@ -195,17 +199,12 @@ void BRDFLightingIBLApp::LoadContent()
 
         colorResourceDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
 
-        D3D12_CLEAR_VALUE colorClearValue;
-        colorClearValue.Format = colorResourceDesc.Format;
-        colorClearValue.Color[0] = this->m_clearValue[0];
-        colorClearValue.Color[1] = this->m_clearValue[1];
-        colorClearValue.Color[2] = this->m_clearValue[2];
-        colorClearValue.Color[3] = this->m_clearValue[3];
-
-        Dx12Texture hdrTexture(this->m_renderDevice, colorResourceDesc, &colorClearValue);
-        hdrTexture.CreateViews();
-
-        this->m_hdrRenderTarget.AttachTexture(AttachmentPoint::Color0, hdrTexture);
+        this->m_hdrColorDesc = colorResourceDesc;
+        this->m_hdrColorClearValue.Format = colorResourceDesc.Format;
+        this->m_hdrColorClearValue.Color[0] = this->m_clearValue[0];
+        this->m_hdrColorClearValue.Color[1] = this->m_clearValue[1];
+        this->m_hdrColorClearValue.Color[2] = this->m_clearValue[2];
+        this->m_hdrColorClearValue.Color[3] = this->m_clearValue[3];
     }
 
     {
@@ -215,7 +214,7 @@ void BRDFLightingIBLApp::LoadContent()
         optimizedClearValue.Format = DXGI_FORMAT_D32_FLOAT;
         optimizedClearValue.DepthStencil = { 1.0f, 0 };
 
-        // Create a depth buffer for the HDR render target.
+        // A depth buffer for the HDR render target.
         auto depthDesc = CD3DX12_RESOURCE_DESC::Tex2D(
             depthBufferFormat,
             this->m_window->GetWidth(),
@@ -223,10 +222,8 @@ void BRDFLightingIBLApp::LoadContent()
 
         depthDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
 
-        Dx12Texture depthTexture(this->m_renderDevice, depthDesc, &optimizedClearValue);
-        depthTexture.CreateViews();
-
-        this->m_hdrRenderTarget.AttachTexture(AttachmentPoint::DepthStencil, depthTexture);
+        this->m_depthDesc = depthDesc;
+        this->m_depthClearValue = optimizedClearValue;
     }
 
     {
@@ -276,7 +273,7 @@ void BRDFLightingIBLApp::LoadContent()
 
     this->CreatePipelineStateObjects();
 
-    copyQueue->WaitForFenceValue(uploadFence);
+    this->m_renderDevice->GetQueue()->Wait(*copyQueue, uploadFence);
 }
 
 void BRDFLightingIBLApp::Update(double deltaTime)
@@ -285,14 +282,26 @@ void BRDFLightingIBLApp::Update(double deltaTime)
 
 void BRDFLightingIBLApp::RenderScene(Dx12Texture& sceneTexture)
 {
+    // Pass 0 renders the scene, pass 1 copies it out of the render target and pass 2, the
+    // application, copies that to the back buffer. The depth buffer is done after pass 0, so
+    // the scene texture is placed in its memory.
+    auto hdrHandle = this->m_transientTexturePool->Declare(this->m_hdrColorDesc, &this->m_hdrColorClearValue, 0, 1);
+    auto depthHandle = this->m_transientTexturePool->Declare(this->m_depthDesc, &this->m_depthClearValue, 0, 0);
+    auto sceneHandle = this->m_transientTexturePool->Declare(this->m_hdrColorDesc, nullptr, 1, 2);
+    this->m_transientTexturePool->Compile();
+
     auto commandList = this->m_renderDevice->GetQueue()->GetCommandList();
 
+    RenderTarget hdrRenderTarget;
+    hdrRenderTarget.AttachTexture(Color0, this->m_transientTexturePool->Acquire(*commandList, hdrHandle));
+    hdrRenderTarget.AttachTexture(DepthStencil, this->m_transientTexturePool->Acquire(*commandList, depthHandle));
+
     commandList->ClearRenderTarget(
-        this->m_hdrRenderTarget.GetTexture(Color0),
+        hdrRenderTarget.GetTexture(Color0),
         this->m_clearValue);
 
     commandList->ClearDepthStencilTexture(
-            this->m_hdrRenderTarget.GetTexture(AttachmentPoint::DepthStencil),
+            hdrRenderTarget.GetTexture(AttachmentPoint::DepthStencil),
             D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL);
 
     static CD3DX12_VIEWPORT viewport = CD3DX12_VIEWPORT(0.0f, 0.0f, this->m_window->GetWidth(), this->m_window->GetHeight());
@@ -302,7 +311,7 @@ void BRDFLightingIBLApp::RenderScene(Dx12Texture& sceneTexture)
     commandList->SetScissorRect(rect);
 
     // Set Render Target
-    commandList->SetRenderTarget(this->m_hdrRenderTarget);
+    commandList->SetRenderTarget(hdrRenderTarget);
 
     // Render Skybox
     {
@@ -382,8 +391,12 @@ void BRDFLightingIBLApp::RenderScene(Dx12Texture& sceneTexture)
     // -- Draw Ambient Mesh ---
     this->m_sphereMesh->Draw(*commandList);
 
+    // The copy fully writes the scene texture, no clear is needed after acquiring it.
+    auto const& scene = this->m_transientTexturePool->Acquire(*commandList, sceneHandle);
+    commandList->CopyResource(scene, hdrRenderTarget.GetTexture(Color0));
+
     this->m_renderDevice->GetQueue()->ExecuteCommandList(commandList);
-    sceneTexture.SetDx12Resource(this->m_hdrRenderTarget.GetTexture(Color0).GetDx12Resource());
+    sceneTexture.SetDx12Resource(scene.GetDx12Resource());
 }
 
 void BRDFLightingIBLApp::RenderUI()
@@ -533,8 +546,12 @@ Microsoft::WRL::ComPtr<ID3D12PipelineState> BRDFLightingIBLApp::CreatePipelineSt
     pipelineStateStream.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
     pipelineStateStream.VS = CD3DX12_SHADER_BYTECODE(vertexByteData.data(), vertexByteData.size());
     pipelineStateStream.PS = CD3DX12_SHADER_BYTECODE(pixelByteData.data(), pixelByteData.size());
-    pipelineStateStream.DSVFormat = this->m_hdrRenderTarget.GetDepthStencilFormat();
-    pipelineStateStream.RTVFormats = this->m_hdrRenderTarget.GetRenderTargetForamts();
+    D3D12_RT_FORMAT_ARRAY rtvFormats = {};
+    rtvFormats.NumRenderTargets = 1;
+    rtvFormats.RTFormats[0] = this->m_hdrColorDesc.Format;
+
+    pipelineStateStream.DSVFormat = this->m_depthDesc.Format;
+    pipelineStateStream.RTVFormats = rtvFormats;
 
 
     D3D12_PIPELINE_STATE_STREAM_DESC pipelineStateStreamDesc =
@@ -201,7 +201,7 @@ void BlinnPhongLightingApp::LoadContent()
     
     this->CreateLightModelPSO();
 
-    copyQueue->WaitForFenceValue(uploadFence);
+    this->m_renderDevice->GetQueue()->Wait(*copyQueue, uploadFence);
 }
 
 void BlinnPhongLightingApp::Update(double deltaTime)
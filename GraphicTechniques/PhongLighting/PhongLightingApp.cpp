@@ -199,7 +199,7 @@ void PhongLightingApp::LoadContent()
     
     this->CreateLightModelPSO();
 
-    copyQueue->WaitForFenceValue(uploadFence);
+    this->m_renderDevice->GetQueue()->Wait(*copyQueue, uploadFence);
 }
 
 void PhongLightingApp::Update(double deltaTime)
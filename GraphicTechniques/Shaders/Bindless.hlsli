@@ -0,0 +1,19 @@
+#ifndef __BINDLESS_HLSLI__
+#define __BINDLESS_HLSLI__
+
+// Unbounded arrays over the device's bindless heap, all starting at index 0 of the heap.
+// Bound with CommandList::SetGraphicsBindlessTable, the root signature's table is built
+// with GpuDescriptorHeap::GetBindlessDescriptorRanges. Index them with the views'
+// bindless indices, passed in through root constants.
+Texture2D BindlessTexture2D[] : register(t0, space100);
+TextureCube BindlessTextureCube[] : register(t0, space101);
+ByteAddressBuffer BindlessBuffers[] : register(t0, space102);
+RWTexture2D<float4> BindlessRWTexture2D[] : register(u0, space103);
+
+// Indices can differ between the pixels of a wave, e.g. per instance material indices.
+#define GetBindlessTexture2D(index) BindlessTexture2D[NonUniformResourceIndex(index)]
+#define GetBindlessTextureCube(index) BindlessTextureCube[NonUniformResourceIndex(index)]
+#define GetBindlessBuffer(index) BindlessBuffers[NonUniformResourceIndex(index)]
+#define GetBindlessRWTexture2D(index) BindlessRWTexture2D[NonUniformResourceIndex(index)]
+
+#endif // __BINDLESS_HLSLI__
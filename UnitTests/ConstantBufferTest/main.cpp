@@ -109,7 +109,7 @@ void TexturedTriangleTestApp::LoadContent()
 
     uint64_t uploadFence = copyQueue->ExecuteCommandList(uploadCmdList);
     this->CreatePipelineStateObjects();
-    copyQueue->WaitForFenceValue(uploadFence);
+    this->m_renderDevice->GetQueue()->Wait(*copyQueue, uploadFence);
 }
 
 void TexturedTriangleTestApp::Update(double deltaTime)
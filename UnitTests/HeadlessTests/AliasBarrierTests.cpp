@@ -0,0 +1,90 @@
+#include "HeadlessTest.h"
+
+#include "SubmissionReplay.h"
+
+using namespace Core;
+using namespace SubmissionReplay;
+
+namespace
+{
+	// Resolves and commits the command list, returns the barriers recorded ahead of it.
+	std::vector<D3D12_RESOURCE_BARRIER> Submit(ReplayCommandList& commandList)
+	{
+		commandList.Close();
+
+		PendingBarrierBatch batch;
+		std::vector<D3D12_RESOURCE_BARRIER> orderedBarriers;
+
+		ResourceStateTracker::Lock();
+		commandList.Tracker.ResolvePendingResourceBarriers(batch, orderedBarriers);
+		commandList.Tracker.CommitFinalResourceStates();
+		ResourceStateTracker::DecayResourceStates(batch, D3D12_COMMAND_LIST_TYPE_DIRECT);
+		ResourceStateTracker::Unlock();
+
+		auto barriers = batch.LeadingBarriers;
+		barriers.insert(barriers.end(), orderedBarriers.begin(), orderedBarriers.end());
+		return barriers;
+	}
+}
+
+HEADLESS_TEST(TransitionFollowsTheAliasingBarrier)
+{
+	// Left sampled by the frame before.
+	auto textures = CreateTextures(1, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	auto texture = textures.front().Get();
+
+	ReplayCommandList commandList;
+	commandList.Tracker.AliasBarrier(nullptr, texture);
+	commandList.RecordPass({ texture }, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+	CHECK(Submit(commandList).empty());
+
+	auto const& barriers = commandList.D3DCommandList->Barriers;
+	CHECK(barriers.size() == 2);
+	CHECK(barriers[0].Type == D3D12_RESOURCE_BARRIER_TYPE_ALIASING);
+	CHECK(barriers[0].Aliasing.pResourceAfter == texture);
+	CHECK(barriers[1].Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION);
+	CHECK(barriers[1].Transition.StateBefore == D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	CHECK(barriers[1].Transition.StateAfter == D3D12_RESOURCE_STATE_RENDER_TARGET);
+}
+
+HEADLESS_TEST(AliasedTextureContinuesFromItsLastFrame)
+{
+	auto textures = CreateTextures(1, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	auto texture = textures.front().Get();
+
+	for (uint32_t frame = 0; frame < 3; frame++)
+	{
+		ReplayCommandList commandList;
+		commandList.Tracker.AliasBarrier(nullptr, texture);
+		commandList.RecordPass({ texture }, D3D12_RESOURCE_STATE_RENDER_TARGET);
+		commandList.RecordPass({ texture }, D3D12_RESOURCE_STATE_COPY_SOURCE);
+
+		CHECK(Submit(commandList).empty());
+
+		// The first frame starts out as a render target, the others from the copy.
+		auto const& barriers = commandList.D3DCommandList->Barriers;
+		CHECK(barriers.size() == (frame == 0 ? 2u : 3u));
+		CHECK(barriers[0].Type == D3D12_RESOURCE_BARRIER_TYPE_ALIASING);
+		CHECK(barriers.back().Transition.StateAfter == D3D12_RESOURCE_STATE_COPY_SOURCE);
+	}
+}
+
+HEADLESS_TEST(UsedBeforeTheBarrierKeepsItsStateInTheCommandList)
+{
+	auto textures = CreateTextures(1, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	auto texture = textures.front().Get();
+
+	ReplayCommandList commandList;
+	commandList.RecordPass({ texture }, D3D12_RESOURCE_STATE_COPY_DEST);
+	commandList.Tracker.AliasBarrier(nullptr, texture);
+	commandList.RecordPass({ texture }, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+	// The first use is still resolved ahead of the command list.
+	auto pendingBarriers = Submit(commandList);
+	CHECK(pendingBarriers.size() == 1);
+
+	auto const& barriers = commandList.D3DCommandList->Barriers;
+	CHECK(barriers.size() == 2);
+	CHECK(barriers[1].Transition.StateBefore == D3D12_RESOURCE_STATE_COPY_DEST);
+}
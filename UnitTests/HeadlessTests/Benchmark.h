@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "spdlog/fmt/fmt.h"
+
+/**
+ * Helpers shared by the headless benchmarks. Every benchmark is its own executable printing
+ * a table, "--quick" shrinks the runs so ctest only checks that it still works.
+ */
+namespace Benchmark
+{
+	inline bool IsQuick(int argc, char** argv)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			if (strcmp(argv[i], "--quick") == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	template<class Function_>
+	double MeasureSeconds(Function_&& function)
+	{
+		auto start = std::chrono::steady_clock::now();
+		function();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Right aligned columns, the first one left aligned.
+	class Table
+	{
+	public:
+		explicit Table(std::vector<std::string> columns)
+			: m_columns(std::move(columns))
+		{
+			this->PrintRow(this->m_columns);
+		}
+
+		void PrintRow(std::vector<std::string> const& values) const
+		{
+			std::string line;
+			for (size_t i = 0; i < values.size(); i++)
+			{
+				size_t width = i < this->m_columns.size() ? std::max<size_t>(this->m_columns[i].size(), 12) : 12;
+				line += i == 0
+					? fmt::format("{:<{}}", values[i], std::max<size_t>(width, 24))
+					: fmt::format("  {:>{}}", values[i], width);
+			}
+
+			printf("%s\n", line.c_str());
+		}
+
+	private:
+		std::vector<std::string> m_columns;
+	};
+}
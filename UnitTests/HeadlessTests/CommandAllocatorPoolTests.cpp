@@ -0,0 +1,97 @@
+#include "HeadlessTest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "pch.h"
+#include "Dx12/CommandAllocatorPool.h"
+
+using namespace Core;
+
+namespace
+{
+	Microsoft::WRL::ComPtr<ID3D12Device2> CreateDevice()
+	{
+		Microsoft::WRL::ComPtr<ID3D12Device2> device;
+		device.Attach(new ID3D12Device2());
+		return device;
+	}
+}
+
+HEADLESS_TEST(ReusesCompletedAllocatorsOfTheSameThread)
+{
+	CommandAllocatorPool pool(CreateDevice(), D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+	auto allocator = pool.RequestAllocator(0);
+	pool.DiscardAllocator(1, allocator);
+
+	// Fence value 1 hasn't completed yet.
+	auto other = pool.RequestAllocator(0);
+	CHECK(other != allocator);
+	pool.DiscardAllocator(2, other);
+
+	CHECK(pool.RequestAllocator(1) == allocator);
+
+	auto statistics = pool.GetStatistics();
+	CHECK(statistics.NumAllocators == 2);
+	CHECK(statistics.NumThreadLocalHits == 1);
+	CHECK(statistics.NumInUse == 1);
+}
+
+HEADLESS_TEST(ExitingThreadHandsItsAllocatorsBack)
+{
+	CommandAllocatorPool pool(CreateDevice(), D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+	ID3D12CommandAllocator* allocators[3];
+	std::thread([&] {
+		for (auto& allocator : allocators)
+		{
+			allocator = pool.RequestAllocator(0);
+		}
+
+		for (auto allocator : allocators)
+		{
+			pool.DiscardAllocator(1, allocator);
+		}
+		}).join();
+
+	// Only the shared pool could have them now.
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		auto allocator = pool.RequestAllocator(1);
+		CHECK(std::find(std::begin(allocators), std::end(allocators), allocator) != std::end(allocators));
+	}
+
+	auto statistics = pool.GetStatistics();
+	CHECK(statistics.NumAllocators == 3);
+	CHECK(statistics.NumSharedHits == 3);
+}
+
+HEADLESS_TEST(ThreadsOutlivingThePoolDontTouchIt)
+{
+	auto pool = std::make_unique<CommandAllocatorPool>(CreateDevice(), D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+	std::atomic_bool isDiscarded(false);
+	std::atomic_bool isPoolDestroyed(false);
+	std::thread thread([&] {
+		pool->DiscardAllocator(1, pool->RequestAllocator(0));
+		isDiscarded = true;
+
+		while (!isPoolDestroyed)
+		{
+			std::this_thread::yield();
+		}
+		});
+
+	while (!isDiscarded)
+	{
+		std::this_thread::yield();
+	}
+
+	pool.reset();
+	isPoolDestroyed = true;
+
+	// Exits without a pool to hand its allocator back to.
+	thread.join();
+}
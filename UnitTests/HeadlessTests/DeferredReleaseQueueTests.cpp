@@ -0,0 +1,191 @@
+#include "HeadlessTest.h"
+
+#include "pch.h"
+#include "DeferredReleaseQueue.h"
+
+using namespace Core;
+
+namespace
+{
+	// Flags its release, moved into the queue without flagging the moved-from copy.
+	struct Tracked
+	{
+		explicit Tracked(bool& isReleased) : IsReleased(&isReleased) {}
+		Tracked(Tracked&& other) : IsReleased(other.IsReleased) { other.IsReleased = nullptr; }
+		~Tracked() { if (this->IsReleased) { *this->IsReleased = true; } }
+
+		bool* IsReleased;
+	};
+
+	// Stands in for CommandQueue::SignalLocked, the GPU signals later through Complete.
+	struct SoftwareQueue
+	{
+		explicit SoftwareQueue(DeferredReleaseQueue& deferredReleaseQueue)
+			: ReleaseQueue(deferredReleaseQueue)
+		{
+			this->ReleaseQueue.RegisterFence(&this->Fence, 0);
+		}
+
+		uint64_t Submit()
+		{
+			this->ReleaseQueue.SetLastSubmittedValue(&this->Fence, ++this->FenceValue);
+			return this->FenceValue;
+		}
+
+		void Complete(uint64_t fenceValue)
+		{
+			this->Fence.Signal(fenceValue);
+			this->ReleaseQueue.ReleaseCompleted(&this->Fence);
+		}
+
+		DeferredReleaseQueue& ReleaseQueue;
+		SoftwareFence Fence;
+		uint64_t FenceValue = 0;
+	};
+}
+
+HEADLESS_TEST(ReleasesRightAwayWithoutQueues)
+{
+	DeferredReleaseQueue deferredReleaseQueue;
+
+	bool isReleased = false;
+	deferredReleaseQueue.Release(Tracked(isReleased));
+
+	CHECK(isReleased);
+	CHECK(deferredReleaseQueue.GetNumPending() == 0);
+}
+
+HEADLESS_TEST(WaitsForTheLastSubmissionOfEveryQueue)
+{
+	DeferredReleaseQueue deferredReleaseQueue;
+	SoftwareQueue direct(deferredReleaseQueue);
+	SoftwareQueue compute(deferredReleaseQueue);
+
+	uint64_t directValue = direct.Submit();
+	uint64_t computeValue = compute.Submit();
+
+	bool isReleased = false;
+	deferredReleaseQueue.Release(Tracked(isReleased));
+	CHECK(deferredReleaseQueue.GetNumPending() == 2);
+
+	direct.Complete(directValue);
+	CHECK(!isReleased);
+
+	compute.Complete(computeValue);
+	CHECK(isReleased);
+	CHECK(deferredReleaseQueue.GetNumPending() == 0);
+}
+
+HEADLESS_TEST(IdleQueuesDontHoldObjects)
+{
+	DeferredReleaseQueue deferredReleaseQueue;
+	SoftwareQueue direct(deferredReleaseQueue);
+	SoftwareQueue compute(deferredReleaseQueue);
+	SoftwareQueue copy(deferredReleaseQueue);
+
+	// The copy queue never submitted, the compute queue's work is done.
+	compute.Complete(compute.Submit());
+	uint64_t directValue = direct.Submit();
+
+	bool isReleased = false;
+	deferredReleaseQueue.Release(Tracked(isReleased));
+	CHECK(deferredReleaseQueue.GetNumPending() == 1);
+
+	// Only the direct queue signals from here on.
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		direct.Complete(directValue);
+		directValue = direct.Submit();
+	}
+
+	CHECK(isReleased);
+	CHECK(deferredReleaseQueue.GetNumPending() == 0);
+}
+
+HEADLESS_TEST(DoesntWaitForWorkSubmittedAfterTheRelease)
+{
+	DeferredReleaseQueue deferredReleaseQueue;
+	SoftwareQueue direct(deferredReleaseQueue);
+
+	uint64_t before = direct.Submit();
+
+	bool isReleased = false;
+	deferredReleaseQueue.Release(Tracked(isReleased));
+
+	uint64_t after = direct.Submit();
+
+	direct.Complete(before);
+	CHECK(isReleased);
+
+	direct.Complete(after);
+}
+
+HEADLESS_TEST(ExplicitValuesReleaseInOrder)
+{
+	DeferredReleaseQueue deferredReleaseQueue;
+	SoftwareQueue direct(deferredReleaseQueue);
+
+	bool isFirstReleased = false;
+	bool isSecondReleased = false;
+	bool isThirdReleased = false;
+	deferredReleaseQueue.Release(&direct.Fence, 1, Tracked(isFirstReleased));
+	deferredReleaseQueue.Release(&direct.Fence, 3, Tracked(isSecondReleased));
+	deferredReleaseQueue.Release(&direct.Fence, 2, Tracked(isThirdReleased));
+
+	direct.Complete(1);
+	CHECK(isFirstReleased);
+	CHECK(!isSecondReleased);
+
+	// Behind an object that waits longer, it waits with it.
+	direct.Complete(2);
+	CHECK(!isThirdReleased);
+
+	direct.Complete(3);
+	CHECK(isSecondReleased);
+	CHECK(isThirdReleased);
+}
+
+HEADLESS_TEST(DeferRunsOnceAfterTheSlowestQueue)
+{
+	DeferredReleaseQueue deferredReleaseQueue;
+	SoftwareQueue direct(deferredReleaseQueue);
+	SoftwareQueue compute(deferredReleaseQueue);
+
+	uint64_t directValue = direct.Submit();
+	uint64_t computeValue = compute.Submit();
+
+	uint32_t numCalls = 0;
+	deferredReleaseQueue.Defer([&numCalls]() { numCalls++; });
+
+	compute.Complete(computeValue);
+	CHECK(numCalls == 0);
+
+	direct.Complete(directValue);
+	CHECK(numCalls == 1);
+
+	// Nothing left to run when the queues complete again.
+	direct.Complete(direct.Submit());
+	compute.Complete(compute.Submit());
+	CHECK(numCalls == 1);
+}
+
+HEADLESS_TEST(ReleaseCompletedChecksEveryFence)
+{
+	DeferredReleaseQueue deferredReleaseQueue;
+	SoftwareQueue direct(deferredReleaseQueue);
+	SoftwareQueue compute(deferredReleaseQueue);
+
+	uint64_t directValue = direct.Submit();
+	uint64_t computeValue = compute.Submit();
+
+	bool isReleased = false;
+	deferredReleaseQueue.Release(Tracked(isReleased));
+
+	// Signaled without running the completion callbacks.
+	direct.Fence.Signal(directValue);
+	compute.Fence.Signal(computeValue);
+	CHECK(!isReleased);
+
+	deferredReleaseQueue.ReleaseCompleted();
+	CHECK(isReleased);
+}
@@ -0,0 +1,155 @@
+#include "Benchmark.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "pch.h"
+#include "Dx12/DescriptorAllocator.h"
+#include "Dx12/DescriptorAllocatorPage.h"
+
+using namespace Core;
+
+namespace
+{
+	constexpr uint32_t NumDescriptorsPerHeap = 256;
+
+	// Single descriptors a thread holds at once, e.g. the views of the textures it loads.
+	constexpr uint32_t DescriptorsPerRound = 64;
+
+	/**
+	 * How DescriptorAllocator handed out single descriptors before the magazines: every
+	 * allocation takes the allocator's lock and searches the pages. Frees go through the
+	 * pages like they do now.
+	 */
+	class LockedDescriptorAllocator
+	{
+	public:
+		LockedDescriptorAllocator(Microsoft::WRL::ComPtr<ID3D12Device2> device, std::shared_ptr<DeferredReleaseQueue> deferredReleaseQueue)
+			: m_device(device)
+			, m_deferredReleaseQueue(deferredReleaseQueue)
+		{}
+
+		DescriptorAllocation Allocate()
+		{
+			std::lock_guard<std::mutex> lock(this->m_allocationMutex);
+
+			for (auto const& page : this->m_pages)
+			{
+				if (page->NumFreeHandles() > 0)
+				{
+					auto allocation = page->Allocate(1);
+					if (!allocation.IsNull())
+					{
+						return allocation;
+					}
+				}
+			}
+
+			this->m_pages.push_back(std::make_shared<DescriptorAllocatorPage>(
+				D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+				NumDescriptorsPerHeap,
+				this->m_device,
+				this->m_deferredReleaseQueue));
+
+			return this->m_pages.back()->Allocate(1);
+		}
+
+		void FlushStaleDescriptors()
+		{
+			std::lock_guard<std::mutex> lock(this->m_allocationMutex);
+			for (auto const& page : this->m_pages)
+			{
+				page->FlushStaleDescriptors();
+			}
+		}
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12Device2> m_device;
+		std::shared_ptr<DeferredReleaseQueue> m_deferredReleaseQueue;
+		std::vector<std::shared_ptr<DescriptorAllocatorPage>> m_pages;
+		std::mutex m_allocationMutex;
+	};
+
+	/**
+	 * Every thread allocates DescriptorsPerRound single descriptors and frees them again.
+	 * No queue is registered, so freed descriptors are back in their page once the thread's
+	 * batch is deferred. Returns millions of allocations per second over all threads.
+	 */
+	template<class Allocator_>
+	double Run(Allocator_& allocator, uint32_t numThreads, uint32_t numRoundsPerThread)
+	{
+		std::atomic_bool start(false);
+		std::vector<std::thread> threads;
+		for (uint32_t i = 0; i < numThreads; i++)
+		{
+			threads.emplace_back([&] {
+				std::vector<DescriptorAllocation> descriptors;
+				descriptors.reserve(DescriptorsPerRound);
+
+				while (!start.load(std::memory_order_acquire))
+				{
+					std::this_thread::yield();
+				}
+
+				for (uint32_t round = 0; round < numRoundsPerThread; round++)
+				{
+					for (uint32_t j = 0; j < DescriptorsPerRound; j++)
+					{
+						descriptors.push_back(allocator.Allocate());
+					}
+
+					descriptors.clear();
+				}
+				});
+		}
+
+		double seconds = Benchmark::MeasureSeconds([&] {
+			start.store(true, std::memory_order_release);
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+			});
+
+		allocator.FlushStaleDescriptors();
+
+		return static_cast<double>(numThreads) * numRoundsPerThread * DescriptorsPerRound / seconds * 1e-6;
+	}
+}
+
+// Single descriptor allocation throughput with a lock per allocation and with per thread magazines.
+int main(int argc, char** argv)
+{
+	Log::Initialize();
+
+	const bool isQuick = Benchmark::IsQuick(argc, argv);
+	const uint32_t numAllocations = isQuick ? 20000 : 4000000;
+
+	Microsoft::WRL::ComPtr<ID3D12Device2> device;
+	device.Attach(new ID3D12Device2());
+	auto deferredReleaseQueue = std::make_shared<DeferredReleaseQueue>();
+
+	Benchmark::Table table({ "Threads", "Locked M/s", "Magazine M/s", "Speedup" });
+
+	for (uint32_t numThreads : { 1u, 2u, 4u, 8u, 16u, 32u })
+	{
+		// The same total work split over the threads.
+		uint32_t numRoundsPerThread = std::max(numAllocations / (DescriptorsPerRound * numThreads), 1u);
+
+		LockedDescriptorAllocator lockedAllocator(device, deferredReleaseQueue);
+		double locked = Run(lockedAllocator, numThreads, numRoundsPerThread);
+
+		DescriptorAllocator magazineAllocator(device, deferredReleaseQueue, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, NumDescriptorsPerHeap);
+		double magazine = Run(magazineAllocator, numThreads, numRoundsPerThread);
+
+		table.PrintRow({
+			fmt::format("{}", numThreads),
+			fmt::format("{:.2f}", locked),
+			fmt::format("{:.2f}", magazine),
+			fmt::format("{:.2f}x", magazine / locked) });
+	}
+
+	printf("\nM/s: millions of single descriptor allocations per second over all threads, frees included.\n");
+	return 0;
+}
@@ -0,0 +1,200 @@
+#include "Benchmark.h"
+
+#include "pch.h"
+#include "Dx12/DynamicDescriptorHeap.h"
+#include "Dx12/GpuDescriptorHeap.h"
+#include "Dx12/RootSignature.h"
+
+using namespace Core;
+
+// RootSignature.cpp serializes and creates the root signature through the render device, the
+// dynamic heaps only read the table layout. These stand in for it, counting the tables the same way.
+Core::RootSignature::RootSignature(
+	std::shared_ptr<Dx12RenderDevice> renderDevice,
+	D3D12_ROOT_SIGNATURE_DESC1 rootSignatureDesc,
+	D3D_ROOT_SIGNATURE_VERSION,
+	std::wstring debugName)
+	: m_renderDevice(renderDevice)
+	, m_rootSignatureDesc(rootSignatureDesc)
+	, m_numDescriptorsPerTable{ 0 }
+	, m_samplerTableBitMask{ 0 }
+	, m_descriptorTableBitMask{ 0 }
+	, m_debugName(debugName)
+{
+	for (UINT i = 0; i < rootSignatureDesc.NumParameters; i++)
+	{
+		auto const& table = rootSignatureDesc.pParameters[i].DescriptorTable;
+		if (table.pDescriptorRanges[0].RangeType == D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER)
+		{
+			this->m_samplerTableBitMask |= 1 << i;
+		}
+		else
+		{
+			this->m_descriptorTableBitMask |= 1 << i;
+		}
+
+		for (UINT j = 0; j < table.NumDescriptorRanges; j++)
+		{
+			this->m_numDescriptorsPerTable[i] += table.pDescriptorRanges[j].NumDescriptors;
+		}
+	}
+}
+
+Core::RootSignature::~RootSignature() = default;
+
+uint32_t Core::RootSignature::GetDescriptorTableBitMask(D3D12_DESCRIPTOR_HEAP_TYPE descriptorHeapType) const
+{
+	return descriptorHeapType == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER
+		? this->m_samplerTableBitMask
+		: this->m_descriptorTableBitMask;
+}
+
+uint32_t Core::RootSignature::GetNumDescriptors(uint32_t rootIndex) const
+{
+	return this->m_numDescriptorsPerTable[rootIndex];
+}
+
+namespace
+{
+	// A frame's command list, the heaps are reset after it like when the list is retired.
+	constexpr uint32_t NumDrawsPerFrame = 1000;
+
+	// Root parameters of the layout below: an object's CBV, its material's textures and sampler.
+	constexpr uint32_t ObjectTable = 0;
+	constexpr uint32_t MaterialTable = 1;
+	constexpr uint32_t SamplerTable = 2;
+	constexpr uint32_t NumMaterialTextures = 4;
+
+	// The sizes Dx12RenderDevice creates its shader visible heaps with.
+	constexpr uint32_t NumDynamicDescriptors = 1 << 17;
+	constexpr uint32_t NumDescriptorsPerChunk = 1024;
+	constexpr uint32_t NumDynamicSamplers = 2048;
+	constexpr uint32_t NumSamplersPerChunk = 64;
+
+	struct Scenario
+	{
+		const char* Name;
+		uint32_t NumMaterials;    // Draws cycle through the materials, every draw has its own CBV.
+	};
+
+	struct Result
+	{
+		double NanosecondsPerDraw;
+		double CopyCallsPerDraw;
+		double DescriptorsPerDraw;
+		double TableSetsPerDraw;
+		double HitRate;
+	};
+
+	D3D12_CPU_DESCRIPTOR_HANDLE CpuDescriptor(uint32_t heap, uint32_t index)
+	{
+		// Staged descriptors come from non shader visible pages, only the values matter here.
+		return { (static_cast<SIZE_T>(heap) << 32) + index * 64 };
+	}
+
+	Result Run(Scenario const& scenario, uint32_t numFrames)
+	{
+		Microsoft::WRL::ComPtr<ID3D12Device2> device;
+		device.Attach(new ID3D12Device2());
+		auto deferredReleaseQueue = std::make_shared<DeferredReleaseQueue>();
+
+		auto gpuHeap = std::make_shared<GpuDescriptorHeap>(
+			device, deferredReleaseQueue, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 0, NumDynamicDescriptors, NumDescriptorsPerChunk);
+		auto gpuSamplerHeap = std::make_shared<GpuDescriptorHeap>(
+			device, deferredReleaseQueue, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, 0, NumDynamicSamplers, NumSamplersPerChunk);
+
+		DynamicDescriptorHeap dynamicHeap(device, gpuHeap);
+		DynamicDescriptorHeap dynamicSamplerHeap(device, gpuSamplerHeap);
+
+		const D3D12_DESCRIPTOR_RANGE1 ranges[] = {
+			{ D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1 },
+			{ D3D12_DESCRIPTOR_RANGE_TYPE_SRV, NumMaterialTextures },
+			{ D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER, 1 },
+		};
+
+		D3D12_ROOT_PARAMETER1 parameters[3] = {};
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			parameters[i].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+			parameters[i].DescriptorTable = { 1, &ranges[i] };
+		}
+
+		D3D12_ROOT_SIGNATURE_DESC1 rootSignatureDesc = {};
+		rootSignatureDesc.NumParameters = 3;
+		rootSignatureDesc.pParameters = parameters;
+		RootSignature rootSignature(nullptr, rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1_1);
+
+		ID3D12GraphicsCommandList commandList;
+
+		double seconds = Benchmark::MeasureSeconds([&] {
+			uint32_t draw = 0;
+			for (uint32_t frame = 0; frame < numFrames; frame++)
+			{
+				dynamicHeap.ParseRootSignature(rootSignature);
+				dynamicSamplerHeap.ParseRootSignature(rootSignature);
+
+				for (uint32_t i = 0; i < NumDrawsPerFrame; i++, draw++)
+				{
+					uint32_t material = draw % scenario.NumMaterials;
+
+					dynamicHeap.StageDescriptors(ObjectTable, 0, 1, CpuDescriptor(0, i));
+					dynamicHeap.StageDescriptors(MaterialTable, 0, NumMaterialTextures, CpuDescriptor(1, material * NumMaterialTextures));
+					dynamicSamplerHeap.StageDescriptors(SamplerTable, 0, 1, CpuDescriptor(2, material));
+
+					dynamicHeap.CommitStagedDescriptorsForDraw(&commandList);
+					dynamicSamplerHeap.CommitStagedDescriptorsForDraw(&commandList);
+				}
+
+				dynamicHeap.Reset();
+				dynamicSamplerHeap.Reset();
+			}
+			});
+
+		double numDraws = static_cast<double>(numFrames) * NumDrawsPerFrame;
+		auto const& cache = dynamicHeap.GetTableHashCache();
+		auto const& samplerCache = dynamicSamplerHeap.GetTableHashCache();
+		double numHits = static_cast<double>(cache.GetNumHits() + samplerCache.GetNumHits());
+		double numLookups = numHits + cache.GetNumMisses() + samplerCache.GetNumMisses();
+
+		return {
+			seconds * 1e9 / numDraws,
+			device->NumCopyCalls / numDraws,
+			device->NumCopiedDescriptors / numDraws,
+			commandList.NumSetRootDescriptorTables / numDraws,
+			numHits / numLookups };
+	}
+}
+
+// CPU cost of staging and committing a draw's descriptor tables against the stand-in device.
+int main(int argc, char** argv)
+{
+	Log::Initialize();
+
+	const bool isQuick = Benchmark::IsQuick(argc, argv);
+	const uint32_t numFrames = isQuick ? 5 : 2000;
+
+	const Scenario scenarios[] = {
+		{ "Material per draw", NumDrawsPerFrame },
+		{ "64 materials", 64 },
+		{ "1 material", 1 },
+	};
+
+	Benchmark::Table table({ "Scenario", "ns/draw", "Copies/draw", "Descriptors/draw", "Tables/draw", "Hit rate" });
+
+	for (auto const& scenario : scenarios)
+	{
+		Result result = Run(scenario, numFrames);
+
+		table.PrintRow({
+			scenario.Name,
+			fmt::format("{:.1f}", result.NanosecondsPerDraw),
+			fmt::format("{:.2f}", result.CopyCallsPerDraw),
+			fmt::format("{:.2f}", result.DescriptorsPerDraw),
+			fmt::format("{:.2f}", result.TableSetsPerDraw),
+			fmt::format("{:.0f}%", result.HitRate * 100.0) });
+	}
+
+	printf("\nEach draw stages an object CBV, %u material textures and a sampler, then commits both heaps.\n", NumMaterialTextures);
+	printf("Copies: CopyDescriptors calls. Hit rate: tables that reused a range copied earlier in the frame.\n");
+	return 0;
+}
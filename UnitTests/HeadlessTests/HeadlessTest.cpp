@@ -0,0 +1,74 @@
+#include "HeadlessTest.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <exception>
+#include <vector>
+
+#include "Log.h"
+
+namespace
+{
+	struct Test
+	{
+		const char* Name;
+		HeadlessTest::TestFunction Function;
+	};
+
+	std::vector<Test>& GetTests()
+	{
+		static std::vector<Test> tests;
+		return tests;
+	}
+
+	uint32_t s_numFailedChecks = 0;
+}
+
+HeadlessTest::Registration::Registration(const char* name, TestFunction function)
+{
+	GetTests().push_back({ name, function });
+}
+
+void HeadlessTest::ReportFailure(const char* file, int line, const char* expression)
+{
+	fprintf(stderr, "%s(%d): CHECK(%s) failed\n", file, line, expression);
+	s_numFailedChecks++;
+}
+
+int main(int argc, char** argv)
+{
+	Core::Log::Initialize();
+
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+
+	uint32_t numRun = 0;
+	uint32_t numFailed = 0;
+	for (auto const& test : GetTests())
+	{
+		if (filter && !strstr(test.Name, filter))
+		{
+			continue;
+		}
+
+		uint32_t numFailedChecks = s_numFailedChecks;
+		try
+		{
+			test.Function();
+		}
+		catch (std::exception const& exception)
+		{
+			fprintf(stderr, "%s threw: %s\n", test.Name, exception.what());
+			s_numFailedChecks++;
+		}
+
+		bool isPassed = numFailedChecks == s_numFailedChecks;
+		printf("[%s] %s\n", isPassed ? "  OK  " : "FAILED", test.Name);
+
+		numRun++;
+		numFailed += isPassed ? 0 : 1;
+	}
+
+	printf("%u of %u tests passed\n", numRun - numFailed, numRun);
+	return numFailed == 0 && numRun > 0 ? 0 : 1;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Minimal test registration for the headless tests, no framework to fetch or build.
+ * A test is a function declared with HEADLESS_TEST, CHECK records a failure and carries on.
+ * Every test executable links HeadlessTest.cpp, whose main runs all the tests it registered,
+ * or only the ones whose name contains the first argument.
+ */
+namespace HeadlessTest
+{
+	using TestFunction = void(*)();
+
+	struct Registration
+	{
+		Registration(const char* name, TestFunction function);
+	};
+
+	void ReportFailure(const char* file, int line, const char* expression);
+}
+
+#define HEADLESS_TEST(name_) \
+	static void name_(); \
+	static ::HeadlessTest::Registration s_registration##name_(#name_, &name_); \
+	static void name_()
+
+#define CHECK(expression_) \
+	do { if (!(expression_)) { ::HeadlessTest::ReportFailure(__FILE__, __LINE__, #expression_); } } while (false)
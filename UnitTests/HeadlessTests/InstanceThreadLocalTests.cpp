@@ -0,0 +1,142 @@
+#include "HeadlessTest.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "InstanceThreadLocal.h"
+
+using namespace Core;
+
+namespace
+{
+	std::atomic_int32_t s_numLiveValues(0);
+
+	struct CountedValue
+	{
+		CountedValue() { s_numLiveValues++; }
+		~CountedValue() { s_numLiveValues--; }
+
+		uint32_t Value = 0;
+	};
+}
+
+HEADLESS_TEST(EveryThreadAndInstanceHasItsOwnValue)
+{
+	InstanceThreadLocal<uint32_t> a;
+	InstanceThreadLocal<uint32_t> b;
+
+	a.Get() = 1;
+	b.Get() = 2;
+
+	std::thread([&] {
+		CHECK(a.Get() == 0);
+		a.Get() = 3;
+		}).join();
+
+	CHECK(a.Get() == 1);
+	CHECK(b.Get() == 2);
+}
+
+HEADLESS_TEST(ThreadExitHandsTheValueToTheOwner)
+{
+	std::vector<uint32_t> handedBack;
+	InstanceThreadLocal<std::vector<uint32_t>> threadLocal([&](std::vector<uint32_t>& values) {
+		handedBack.insert(handedBack.end(), values.begin(), values.end());
+		});
+
+	std::thread([&] {
+		threadLocal.Get().push_back(7);
+		threadLocal.Get().push_back(8);
+		}).join();
+
+	CHECK(handedBack.size() == 2);
+	CHECK(handedBack[0] == 7 && handedBack[1] == 8);
+
+	// The thread that's still running isn't affected.
+	threadLocal.Get().push_back(9);
+	CHECK(handedBack.size() == 2);
+}
+
+HEADLESS_TEST(ThreadExitDestroysTheValues)
+{
+	int32_t numLiveValues = s_numLiveValues;
+	InstanceThreadLocal<CountedValue> threadLocal;
+
+	std::thread([&] {
+		threadLocal.Get().Value = 1;
+		CHECK(s_numLiveValues == numLiveValues + 1);
+		}).join();
+
+	CHECK(s_numLiveValues == numLiveValues);
+}
+
+HEADLESS_TEST(DestroyedOwnerDestroysTheValuesOfLiveThreads)
+{
+	int32_t numLiveValues = s_numLiveValues;
+	auto threadLocal = std::make_unique<InstanceThreadLocal<CountedValue>>();
+
+	std::atomic_bool hasValue(false);
+	std::atomic_bool isOwnerDestroyed(false);
+	std::atomic_uint32_t newValue(~0u);
+	std::thread thread([&] {
+		threadLocal->Get().Value = 1;
+		hasValue = true;
+
+		while (!isOwnerDestroyed)
+		{
+			std::this_thread::yield();
+		}
+
+		// A new owner, possibly at the same address, starts from a new value.
+		InstanceThreadLocal<CountedValue> other;
+		newValue = other.Get().Value;
+		});
+
+	while (!hasValue)
+	{
+		std::this_thread::yield();
+	}
+
+	threadLocal->Get().Value = 2;
+	CHECK(s_numLiveValues == numLiveValues + 2);
+
+	threadLocal.reset();
+	CHECK(s_numLiveValues == numLiveValues);
+
+	isOwnerDestroyed = true;
+	thread.join();
+
+	CHECK(newValue == 0);
+	CHECK(s_numLiveValues == numLiveValues);
+}
+
+HEADLESS_TEST(OwnersAndThreadsComeAndGoConcurrently)
+{
+	int32_t numLiveValues = s_numLiveValues;
+
+	std::atomic_uint32_t numHandedBack(0);
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		threads.emplace_back([&] {
+			for (uint32_t j = 0; j < 200; j++)
+			{
+				InstanceThreadLocal<CountedValue> owner([&numHandedBack](CountedValue&) { numHandedBack++; });
+				owner.Get().Value = j;
+
+				// Short lived threads exit while the owner is alive.
+				std::thread([&owner] { owner.Get().Value++; }).join();
+			}
+			});
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	CHECK(numHandedBack == 800);
+	CHECK(s_numLiveValues == numLiveValues);
+}
@@ -0,0 +1,156 @@
+#include "HeadlessTest.h"
+
+#include <random>
+#include <vector>
+
+#include "pch.h"
+#include "IntervalAllocator.h"
+
+using namespace Core;
+
+namespace
+{
+	bool IsOverlappingMemory(IntervalAllocator const& allocator, uint32_t a, uint32_t b)
+	{
+		uint64_t offsetA = allocator.GetOffset(a);
+		uint64_t offsetB = allocator.GetOffset(b);
+		return offsetA < offsetB + allocator.GetSize(b) && offsetB < offsetA + allocator.GetSize(a);
+	}
+}
+
+HEADLESS_TEST(DisjointLifetimesShareMemory)
+{
+	IntervalAllocator allocator;
+
+	uint32_t first = allocator.Add(1024, 256, 0, 1);
+	uint32_t second = allocator.Add(1024, 256, 2, 3);
+	uint32_t third = allocator.Add(512, 256, 4, 4);
+
+	CHECK(allocator.Pack() == 1024);
+	CHECK(allocator.GetOffset(first) == 0);
+	CHECK(allocator.GetOffset(second) == 0);
+	CHECK(allocator.GetOffset(third) == 0);
+}
+
+HEADLESS_TEST(OverlappingLifetimesDontShareMemory)
+{
+	IntervalAllocator allocator;
+
+	// Only sharing the last pass of one and the first of the other is alive together too.
+	uint32_t first = allocator.Add(1024, 256, 0, 2);
+	uint32_t second = allocator.Add(1024, 256, 2, 3);
+
+	CHECK(allocator.Pack() == 2048);
+	CHECK(!IsOverlappingMemory(allocator, first, second));
+}
+
+HEADLESS_TEST(SmallBlocksFillGapsBetweenLargeOnes)
+{
+	IntervalAllocator allocator;
+
+	// The large block is placed first, the small ones stack on top and reuse each other's memory.
+	uint32_t large = allocator.Add(4096, 256, 0, 3);
+	uint32_t early = allocator.Add(1024, 256, 0, 1);
+	uint32_t late = allocator.Add(1024, 256, 2, 3);
+
+	CHECK(allocator.Pack() == 5120);
+	CHECK(allocator.GetOffset(large) == 0);
+	CHECK(allocator.GetOffset(early) == 4096);
+	CHECK(allocator.GetOffset(late) == 4096);
+}
+
+HEADLESS_TEST(OffsetsAreAligned)
+{
+	IntervalAllocator allocator;
+
+	uint32_t odd = allocator.Add(100, 1, 0, 1);
+	uint32_t aligned = allocator.Add(64, 4096, 0, 1);
+
+	CHECK(allocator.Pack() == 4096 + 64);
+	CHECK(allocator.GetOffset(odd) == 0);
+	CHECK(allocator.GetOffset(aligned) == 4096);
+}
+
+HEADLESS_TEST(StatisticsCountPeakAndUnaliasedBytes)
+{
+	IntervalAllocator allocator;
+
+	allocator.Add(1024, 256, 0, 0);
+	allocator.Add(2048, 256, 0, 1);
+	allocator.Add(512, 256, 1, 2);
+	allocator.Add(4096, 256, 3, 3);
+
+	uint64_t packedBytes = allocator.Pack();
+	auto statistics = allocator.GetStatistics();
+
+	CHECK(statistics.NumBlocks == 4);
+	CHECK(statistics.PackedBytes == packedBytes);
+	CHECK(statistics.UnaliasedBytes == 1024 + 2048 + 512 + 4096);
+
+	// Pass 3 holds the most on its own, the blocks of the passes before fit in its memory.
+	CHECK(statistics.PeakLiveBytes == 4096);
+	CHECK(statistics.PackedBytes == 4096);
+
+	allocator.Reset();
+	CHECK(allocator.GetNumBlocks() == 0);
+	CHECK(allocator.GetStatistics().PackedBytes == 0);
+}
+
+HEADLESS_TEST(RandomFramesNeverOverlapLiveBlocks)
+{
+	constexpr uint32_t NumPasses = 16;
+	constexpr uint64_t Alignments[] = { 1, 256, 4096, 65536 };
+
+	struct Lifetime
+	{
+		uint32_t FirstPass;
+		uint32_t LastPass;
+		uint64_t Alignment;
+	};
+
+	IntervalAllocator allocator;
+	std::vector<Lifetime> lifetimes;
+	std::mt19937 random(11);
+
+	for (uint32_t frame = 0; frame < 200; frame++)
+	{
+		lifetimes.clear();
+
+		uint32_t numBlocks = 1 + random() % 24;
+		for (uint32_t i = 0; i < numBlocks; i++)
+		{
+			Lifetime lifetime = {};
+			lifetime.FirstPass = random() % NumPasses;
+			lifetime.LastPass = lifetime.FirstPass + random() % (NumPasses - lifetime.FirstPass);
+			lifetime.Alignment = Alignments[random() % 4];
+
+			allocator.Add(1 + random() % (1 << 20), lifetime.Alignment, lifetime.FirstPass, lifetime.LastPass);
+			lifetimes.push_back(lifetime);
+		}
+
+		uint64_t packedBytes = allocator.Pack();
+		auto statistics = allocator.GetStatistics();
+		CHECK(packedBytes >= statistics.PeakLiveBytes);
+		CHECK(packedBytes <= statistics.UnaliasedBytes + numBlocks * Alignments[3]);
+
+		for (uint32_t a = 0; a < numBlocks; a++)
+		{
+			CHECK(allocator.GetOffset(a) % lifetimes[a].Alignment == 0);
+			CHECK(allocator.GetOffset(a) + allocator.GetSize(a) <= packedBytes);
+
+			for (uint32_t b = a + 1; b < numBlocks; b++)
+			{
+				bool isAliveTogether =
+					lifetimes[a].FirstPass <= lifetimes[b].LastPass &&
+					lifetimes[b].FirstPass <= lifetimes[a].LastPass;
+
+				if (isAliveTogether)
+				{
+					CHECK(!IsOverlappingMemory(allocator, a, b));
+				}
+			}
+		}
+
+		allocator.Reset();
+	}
+}
@@ -0,0 +1,137 @@
+#include "Benchmark.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#include "MpmcQueue.h"
+#include "Log.h"
+
+using namespace Core;
+
+namespace
+{
+	// The mutex guarded pool the command list pool used before MpmcQueue, kept as the baseline.
+	template<class Type_>
+	class MutexPool
+	{
+	public:
+		void Push(Type_ value)
+		{
+			std::lock_guard<std::mutex> lock(this->m_mutex);
+			this->m_queue.push(std::move(value));
+		}
+
+		bool TryPop(Type_& value)
+		{
+			std::lock_guard<std::mutex> lock(this->m_mutex);
+			if (this->m_queue.empty())
+			{
+				return false;
+			}
+
+			value = std::move(this->m_queue.front());
+			this->m_queue.pop();
+
+			return true;
+		}
+
+	private:
+		std::queue<Type_> m_queue;
+		std::mutex m_mutex;
+	};
+
+	// Stands in for the pooled command lists.
+	using PooledObject = std::shared_ptr<uint64_t>;
+
+	constexpr size_t PoolCapacity = 1024;
+
+	/**
+	 * Every thread takes an object from the pool and hands it back, like GetCommandList
+	 * and the recycle callback do. Returns millions of pop and push pairs per second.
+	 */
+	template<class Pool_>
+	double RunPool(Pool_& pool, uint32_t numThreads, uint32_t numOperationsPerThread)
+	{
+		for (size_t i = 0; i < PoolCapacity / 2; i++)
+		{
+			pool.Push(std::make_shared<uint64_t>(i));
+		}
+
+		std::atomic_uint32_t numReady(0);
+		std::atomic_bool isStarted(false);
+		std::vector<std::thread> threads;
+		for (uint32_t i = 0; i < numThreads; i++)
+		{
+			threads.emplace_back([&] {
+				numReady++;
+				while (!isStarted)
+				{
+					std::this_thread::yield();
+				}
+
+				// The number of objects stays the same, the queue never fills up.
+				PooledObject object;
+				for (uint32_t j = 0; j < numOperationsPerThread; j++)
+				{
+					while (!pool.TryPop(object))
+					{
+						std::this_thread::yield();
+					}
+
+					(*object)++;
+					pool.Push(std::move(object));
+				}
+				});
+		}
+
+		while (numReady < numThreads)
+		{
+			std::this_thread::yield();
+		}
+
+		double seconds = Benchmark::MeasureSeconds([&] {
+			isStarted = true;
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+			});
+
+		return static_cast<double>(numThreads) * numOperationsPerThread / seconds / 1e6;
+	}
+}
+
+// Contention of the lock-free MpmcQueue against the mutex guarded pool it replaced, 1 to 32 threads.
+int main(int argc, char** argv)
+{
+	Log::Initialize();
+
+	const bool isQuick = Benchmark::IsQuick(argc, argv);
+	const uint32_t numOperations = isQuick ? 20000 : 4000000;
+
+	Benchmark::Table table({ "Threads", "Mutex Mops/s", "Mpmc Mops/s", "Speedup" });
+
+	for (uint32_t numThreads = 1; numThreads <= 32; numThreads *= 2)
+	{
+		uint32_t numOperationsPerThread = std::max(numOperations / numThreads, 1u);
+
+		MutexPool<PooledObject> mutexPool;
+		double mutexRate = RunPool(mutexPool, numThreads, numOperationsPerThread);
+
+		MpmcQueue<PooledObject> mpmcQueue(PoolCapacity);
+		double mpmcRate = RunPool(mpmcQueue, numThreads, numOperationsPerThread);
+
+		table.PrintRow({
+			fmt::format("{}", numThreads),
+			fmt::format("{:.2f}", mutexRate),
+			fmt::format("{:.2f}", mpmcRate),
+			fmt::format("{:.2f}x", mpmcRate / mutexRate) });
+	}
+
+	printf("\nMops/s: millions of pop and push pairs per second over all threads. Threads beyond the core count (%u) only add preemption.\n",
+		std::thread::hardware_concurrency());
+	return 0;
+}
@@ -0,0 +1,135 @@
+#include "HeadlessTest.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "MpmcQueue.h"
+
+using namespace Core;
+
+HEADLESS_TEST(PopsInPushOrder)
+{
+	MpmcQueue<uint32_t> queue(8);
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		CHECK(queue.TryPush(i));
+	}
+
+	CHECK(!queue.TryPush(8));
+	CHECK(queue.Size() == 8);
+
+	uint32_t value;
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		CHECK(queue.TryPop(value) && value == i);
+	}
+
+	CHECK(!queue.TryPop(value));
+	CHECK(queue.Empty());
+}
+
+HEADLESS_TEST(PopsABatchOfReadyValues)
+{
+	MpmcQueue<uint32_t> queue(16);
+	for (uint32_t i = 0; i < 10; i++)
+	{
+		queue.Push(i);
+	}
+
+	std::vector<uint32_t> values;
+	CHECK(queue.TryPopBatch(values, 4) == 4);
+	CHECK(queue.TryPopBatch(values, 100) == 6);
+	CHECK(queue.TryPopBatch(values, 100) == 0);
+
+	CHECK(values.size() == 10);
+	for (uint32_t i = 0; i < values.size(); i++)
+	{
+		CHECK(values[i] == i);
+	}
+}
+
+HEADLESS_TEST(DestroysTheValuesLeft)
+{
+	auto object = std::make_shared<uint32_t>(0);
+	{
+		MpmcQueue<std::shared_ptr<uint32_t>> queue(4);
+		queue.Push(object);
+		queue.Push(object);
+		CHECK(object.use_count() == 3);
+	}
+
+	CHECK(object.use_count() == 1);
+}
+
+HEADLESS_TEST(EveryValueIsPoppedOnceUnderContention)
+{
+	constexpr uint32_t NumProducers = 4;
+	constexpr uint32_t NumConsumers = 4;
+	constexpr uint32_t NumValuesPerProducer = 20000;
+
+	MpmcQueue<uint32_t> queue(64);
+	std::vector<std::atomic_uint8_t> popped(NumProducers * NumValuesPerProducer);
+	std::atomic_uint32_t numPopped(0);
+
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < NumProducers; i++)
+	{
+		threads.emplace_back([&, i] {
+			for (uint32_t j = 0; j < NumValuesPerProducer; j++)
+			{
+				queue.Push(i * NumValuesPerProducer + j);
+			}
+			});
+	}
+
+	for (uint32_t i = 0; i < NumConsumers; i++)
+	{
+		threads.emplace_back([&, i] {
+			std::vector<uint32_t> values;
+			while (numPopped < popped.size())
+			{
+				// Half the consumers pop in batches.
+				values.clear();
+				if (i % 2 == 0)
+				{
+					queue.TryPopBatch(values, 8);
+				}
+				else
+				{
+					uint32_t value;
+					if (queue.TryPop(value))
+					{
+						values.push_back(value);
+					}
+				}
+
+				if (values.empty())
+				{
+					std::this_thread::yield();
+				}
+
+				for (uint32_t value : values)
+				{
+					popped[value]++;
+				}
+
+				numPopped += static_cast<uint32_t>(values.size());
+			}
+			});
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	uint32_t numPoppedOnce = 0;
+	for (auto const& count : popped)
+	{
+		numPoppedOnce += count == 1 ? 1 : 0;
+	}
+
+	CHECK(numPoppedOnce == popped.size());
+}
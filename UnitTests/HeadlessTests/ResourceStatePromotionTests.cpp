@@ -0,0 +1,221 @@
+#include "HeadlessTest.h"
+
+#include "SubmissionReplay.h"
+#include "Dx12/ResourceStatePromotion.h"
+
+using namespace Core;
+using namespace Core::ResourceStatePromotion;
+
+namespace
+{
+	constexpr D3D12_RESOURCE_STATES Common = D3D12_RESOURCE_STATE_COMMON;
+
+	D3D12_RESOURCE_DESC BufferDesc()
+	{
+		D3D12_RESOURCE_DESC desc = {};
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+		desc.Width = 65536;
+		desc.Height = 1;
+		desc.DepthOrArraySize = 1;
+		desc.MipLevels = 1;
+		desc.SampleDesc.Count = 1;
+		return desc;
+	}
+
+	D3D12_RESOURCE_DESC TextureDesc(D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE)
+	{
+		D3D12_RESOURCE_DESC desc = {};
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+		desc.Width = 256;
+		desc.Height = 256;
+		desc.DepthOrArraySize = 1;
+		desc.MipLevels = 1;
+		desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.SampleDesc.Count = 1;
+		desc.Flags = flags;
+		return desc;
+	}
+
+	Microsoft::WRL::ComPtr<ID3D12Resource> CreateResource(D3D12_RESOURCE_DESC const& desc)
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+		resource.Attach(new ID3D12Resource(desc));
+		ResourceStateTracker::AddGlobalResourceState(resource.Get(), Common);
+		return resource;
+	}
+
+	/**
+	 * Resolves and commits one command list the way CommandQueue does for a single list
+	 * submission, returns the barriers the queue would have had to record ahead of it.
+	 */
+	std::vector<D3D12_RESOURCE_BARRIER> Submit(SubmissionReplay::ReplayCommandList& commandList, D3D12_COMMAND_LIST_TYPE queueType)
+	{
+		commandList.Close();
+
+		PendingBarrierBatch batch;
+		std::vector<D3D12_RESOURCE_BARRIER> orderedBarriers;
+
+		ResourceStateTracker::Lock();
+		commandList.Tracker.ResolvePendingResourceBarriers(batch, orderedBarriers);
+		commandList.Tracker.CommitFinalResourceStates();
+		ResourceStateTracker::DecayResourceStates(batch, queueType);
+		ResourceStateTracker::Unlock();
+
+		commandList.Reset();
+
+		auto barriers = batch.LeadingBarriers;
+		barriers.insert(barriers.end(), orderedBarriers.begin(), orderedBarriers.end());
+		return barriers;
+	}
+}
+
+HEADLESS_TEST(ResourceKindFollowsDimensionAndFlags)
+{
+	CHECK(GetResourceKind(BufferDesc()) == ResourceKind::Buffer);
+	CHECK(GetResourceKind(TextureDesc()) == ResourceKind::Texture);
+	CHECK(GetResourceKind(TextureDesc(D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS)) == ResourceKind::SimultaneousAccessTexture);
+}
+
+HEADLESS_TEST(OnlyCommonIsPromoted)
+{
+	for (auto kind : { ResourceKind::Buffer, ResourceKind::SimultaneousAccessTexture, ResourceKind::Texture })
+	{
+		CHECK(!CanPromote(kind, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE));
+		CHECK(!CanPromote(kind, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+		CHECK(!CanPromote(kind, Common, Common));
+	}
+}
+
+HEADLESS_TEST(BuffersPromoteToAnyStateButDepth)
+{
+	for (auto kind : { ResourceKind::Buffer, ResourceKind::SimultaneousAccessTexture })
+	{
+		CHECK(CanPromote(kind, Common, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER));
+		CHECK(CanPromote(kind, Common, D3D12_RESOURCE_STATE_INDEX_BUFFER));
+		CHECK(CanPromote(kind, Common, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT));
+		CHECK(CanPromote(kind, Common, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+		CHECK(CanPromote(kind, Common, D3D12_RESOURCE_STATE_RENDER_TARGET));
+		CHECK(CanPromote(kind, Common, D3D12_RESOURCE_STATE_COPY_DEST));
+		CHECK(CanPromote(kind, Common, D3D12_RESOURCE_STATE_GENERIC_READ));
+
+		CHECK(!CanPromote(kind, Common, D3D12_RESOURCE_STATE_DEPTH_WRITE));
+		CHECK(!CanPromote(kind, Common, D3D12_RESOURCE_STATE_DEPTH_READ));
+	}
+}
+
+HEADLESS_TEST(TexturesOnlyPromoteToShaderResourceAndCopyStates)
+{
+	CHECK(CanPromote(ResourceKind::Texture, Common, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+	CHECK(CanPromote(ResourceKind::Texture, Common, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+	CHECK(CanPromote(ResourceKind::Texture, Common, D3D12_RESOURCE_STATE_COPY_SOURCE));
+	CHECK(CanPromote(ResourceKind::Texture, Common, D3D12_RESOURCE_STATE_COPY_DEST));
+	CHECK(CanPromote(
+		ResourceKind::Texture,
+		Common,
+		D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+
+	CHECK(!CanPromote(ResourceKind::Texture, Common, D3D12_RESOURCE_STATE_RENDER_TARGET));
+	CHECK(!CanPromote(ResourceKind::Texture, Common, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+	CHECK(!CanPromote(ResourceKind::Texture, Common, D3D12_RESOURCE_STATE_DEPTH_WRITE));
+	CHECK(!CanPromote(ResourceKind::Texture, Common, D3D12_RESOURCE_STATE_RESOLVE_SOURCE));
+}
+
+HEADLESS_TEST(WriteStatesCantBeCombined)
+{
+	CHECK(!CanPromote(
+		ResourceKind::Buffer,
+		Common,
+		D3D12_RESOURCE_STATE_UNORDERED_ACCESS | D3D12_RESOURCE_STATE_COPY_DEST));
+	CHECK(!CanPromote(
+		ResourceKind::Buffer,
+		Common,
+		D3D12_RESOURCE_STATE_COPY_DEST | D3D12_RESOURCE_STATE_COPY_SOURCE));
+	CHECK(!CanPromote(
+		ResourceKind::Texture,
+		Common,
+		D3D12_RESOURCE_STATE_COPY_DEST | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+}
+
+HEADLESS_TEST(DecayTable)
+{
+	constexpr auto Direct = D3D12_COMMAND_LIST_TYPE_DIRECT;
+	constexpr auto Compute = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+	constexpr auto Copy = D3D12_COMMAND_LIST_TYPE_COPY;
+
+	// Buffers and simultaneous-access textures always decay.
+	for (auto kind : { ResourceKind::Buffer, ResourceKind::SimultaneousAccessTexture })
+	{
+		CHECK(DecaysToCommon(kind, Direct, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, false));
+		CHECK(DecaysToCommon(kind, Compute, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, false));
+	}
+
+	// Everything used on a copy queue decays.
+	CHECK(DecaysToCommon(ResourceKind::Texture, Copy, D3D12_RESOURCE_STATE_COPY_DEST, false));
+
+	// Other textures only when the submission promoted them to read states.
+	CHECK(DecaysToCommon(ResourceKind::Texture, Direct, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, true));
+	CHECK(!DecaysToCommon(ResourceKind::Texture, Direct, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, false));
+	CHECK(!DecaysToCommon(ResourceKind::Texture, Direct, D3D12_RESOURCE_STATE_COPY_DEST, true));
+	CHECK(!DecaysToCommon(ResourceKind::Texture, Compute, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, false));
+}
+
+HEADLESS_TEST(PromotedBufferNeedsNoBarrierInAnySubmission)
+{
+	auto buffer = CreateResource(BufferDesc());
+
+	SubmissionReplay::ReplayCommandList commandList;
+	for (uint32_t frame = 0; frame < 3; frame++)
+	{
+		// Decayed back to COMMON after every submission, so promoted again.
+		commandList.RecordPass({ buffer.Get() }, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+		CHECK(Submit(commandList, D3D12_COMMAND_LIST_TYPE_COMPUTE).empty());
+
+		commandList.RecordPass({ buffer.Get() }, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+		CHECK(Submit(commandList, D3D12_COMMAND_LIST_TYPE_DIRECT).empty());
+	}
+}
+
+HEADLESS_TEST(TextureSampledFromCommonDecays)
+{
+	auto texture = CreateResource(TextureDesc());
+
+	SubmissionReplay::ReplayCommandList commandList;
+	commandList.RecordPass({ texture.Get() }, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	CHECK(Submit(commandList, D3D12_COMMAND_LIST_TYPE_DIRECT).empty());
+
+	// Back in COMMON, copying from it is a promotion too.
+	commandList.RecordPass({ texture.Get() }, D3D12_RESOURCE_STATE_COPY_SOURCE);
+	CHECK(Submit(commandList, D3D12_COMMAND_LIST_TYPE_DIRECT).empty());
+}
+
+HEADLESS_TEST(TextureRenderTargetNeedsABarrierAndStays)
+{
+	auto texture = CreateResource(TextureDesc(D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET));
+
+	SubmissionReplay::ReplayCommandList commandList;
+	commandList.RecordPass({ texture.Get() }, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+	auto barriers = Submit(commandList, D3D12_COMMAND_LIST_TYPE_DIRECT);
+	CHECK(barriers.size() == 1);
+	CHECK(barriers.size() == 1 && barriers[0].Transition.StateBefore == Common);
+	CHECK(barriers.size() == 1 && barriers[0].Transition.StateAfter == D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+	// A written texture doesn't decay, the next use transitions from RENDER_TARGET.
+	commandList.RecordPass({ texture.Get() }, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	barriers = Submit(commandList, D3D12_COMMAND_LIST_TYPE_DIRECT);
+	CHECK(barriers.size() == 1);
+	CHECK(barriers.size() == 1 && barriers[0].Transition.StateBefore == D3D12_RESOURCE_STATE_RENDER_TARGET);
+}
+
+HEADLESS_TEST(TextureCopiedOnACopyQueueDecays)
+{
+	auto texture = CreateResource(TextureDesc());
+
+	SubmissionReplay::ReplayCommandList commandList;
+	commandList.RecordPass({ texture.Get() }, D3D12_RESOURCE_STATE_COPY_DEST);
+	CHECK(Submit(commandList, D3D12_COMMAND_LIST_TYPE_COPY).empty());
+
+	commandList.RecordPass({ texture.Get() }, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	CHECK(Submit(commandList, D3D12_COMMAND_LIST_TYPE_DIRECT).empty());
+}
@@ -0,0 +1,186 @@
+#include "HeadlessTest.h"
+
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "pch.h"
+#include "RingAllocator.h"
+
+using namespace Core;
+
+namespace
+{
+	/**
+	 * Plays the GPU reading an upload buffer: a submission's blocks are checked against the
+	 * bytes written into them when it executes. It only executes when waited on or told to
+	 * catch up, so a block reused too early is caught.
+	 */
+	class FakeGpu : public IFence
+	{
+	public:
+		explicit FakeGpu(std::vector<uint8_t> const& mappedBuffer)
+			: m_mappedBuffer(mappedBuffer)
+		{}
+
+		struct Block
+		{
+			uint64_t Offset;
+			uint64_t Size;
+			uint8_t Value;
+		};
+
+		void Submit(uint64_t fenceValue, std::vector<Block> blocks)
+		{
+			this->m_submissions.push_back({ fenceValue, std::move(blocks) });
+		}
+
+		// Executes the submissions up to the value.
+		void Execute(uint64_t value)
+		{
+			while (!this->m_submissions.empty() && this->m_submissions.front().FenceValue <= value)
+			{
+				for (auto const& block : this->m_submissions.front().Blocks)
+				{
+					for (uint64_t i = block.Offset; i < block.Offset + block.Size; i++)
+					{
+						if (this->m_mappedBuffer[i] != block.Value)
+						{
+							this->NumCorruptedBlocks++;
+							break;
+						}
+					}
+				}
+
+				this->m_completedValue = this->m_submissions.front().FenceValue;
+				this->m_submissions.pop_front();
+			}
+		}
+
+		uint64_t GetCompletedValue() const override { return this->m_completedValue; }
+
+		void WaitForValue(uint64_t value) override
+		{
+			this->NumWaits++;
+			this->Execute(value);
+		}
+
+		uint64_t NumCorruptedBlocks = 0;
+		uint64_t NumWaits = 0;
+
+	private:
+		struct Submission
+		{
+			uint64_t FenceValue;
+			std::vector<Block> Blocks;
+		};
+
+		std::vector<uint8_t> const& m_mappedBuffer;
+		std::deque<Submission> m_submissions;
+		uint64_t m_completedValue = 0;
+	};
+}
+
+HEADLESS_TEST(AlignsAndSkipsTheEndWhenWrapping)
+{
+	RingAllocator ring(256);
+
+	uint64_t first = ring.Allocate(100, 1);
+	uint64_t second = ring.Allocate(100, 64);
+	CHECK(first == 0);
+	CHECK(second == 128);
+
+	ring.Retire(first, nullptr, 0);
+	ring.ReleaseCompleted();
+
+	// Neither fits at the end nor before the tail, and the oldest block isn't retired.
+	CHECK(ring.Allocate(120, 1) == RingAllocator::InvalidOffset);
+
+	// The end of the ring is skipped and counted with the block.
+	uint64_t third = ring.Allocate(90, 1);
+	CHECK(third == 0);
+	CHECK(ring.GetNumUsed() == (28 + 100) + (256 - 228 + 90));
+
+	CHECK(ring.Allocate(257, 1) == RingAllocator::InvalidOffset);
+}
+
+HEADLESS_TEST(ReclaimsInAllocationOrder)
+{
+	RingAllocator ring(1024);
+	SoftwareFence fence;
+
+	uint64_t first = ring.Allocate(64, 16);
+	uint64_t second = ring.Allocate(64, 16);
+
+	// Retired out of order, the first block holds back the second.
+	ring.Retire(second, &fence, 1);
+	ring.Retire(first, &fence, 2);
+
+	fence.Signal(1);
+	ring.ReleaseCompleted();
+	CHECK(ring.GetNumBlocks() == 2);
+
+	fence.Signal(2);
+	ring.ReleaseCompleted();
+	CHECK(ring.GetNumBlocks() == 0);
+	CHECK(ring.GetNumUsed() == 0);
+
+	// Empty again, allocations start over at the beginning.
+	CHECK(ring.Allocate(1024, 256) == 0);
+}
+
+HEADLESS_TEST(NeverHandsOutBytesTheGpuStillReads)
+{
+	constexpr uint64_t Capacity = 64 * 1024;
+	constexpr uint64_t Alignments[] = { 1, 16, 256, 4096 };
+
+	// Stands in for the persistently mapped upload buffer.
+	std::vector<uint8_t> mappedBuffer(Capacity, 0);
+	FakeGpu gpu(mappedBuffer);
+	RingAllocator ring(Capacity);
+
+	std::mt19937 random(7);
+	uint64_t numBlocks = 0;
+
+	for (uint64_t fenceValue = 1; fenceValue <= 4000; fenceValue++)
+	{
+		std::vector<FakeGpu::Block> blocks;
+
+		uint32_t numSubmissionBlocks = 1 + random() % 4;
+		for (uint32_t i = 0; i < numSubmissionBlocks; i++)
+		{
+			uint64_t size = 1 + random() % (Capacity / 8);
+			uint64_t alignment = Alignments[random() % 4];
+
+			uint64_t offset = ring.Allocate(size, alignment);
+			CHECK(offset != RingAllocator::InvalidOffset);
+			CHECK(offset % alignment == 0);
+			CHECK(offset + size <= Capacity);
+
+			uint8_t value = static_cast<uint8_t>(++numBlocks);
+			std::fill(mappedBuffer.begin() + offset, mappedBuffer.begin() + offset + size, value);
+			blocks.push_back({ offset, size, value });
+		}
+
+		for (auto const& block : blocks)
+		{
+			ring.Retire(block.Offset, &gpu, fenceValue);
+		}
+
+		gpu.Submit(fenceValue, std::move(blocks));
+
+		// The GPU runs a few submissions behind.
+		if (fenceValue > 3)
+		{
+			gpu.Execute(fenceValue - 3);
+		}
+	}
+
+	gpu.Execute(~0ull);
+
+	CHECK(gpu.NumCorruptedBlocks == 0);
+
+	// The ring was full often enough to wait on the GPU.
+	CHECK(gpu.NumWaits > 0);
+	CHECK(ring.GetStatistics().NumStalls > 0);
+}
@@ -0,0 +1,219 @@
+#include "HeadlessTest.h"
+
+#include <unordered_map>
+
+#include "SubmissionReplay.h"
+
+using namespace Core;
+using namespace SubmissionReplay;
+
+namespace
+{
+	// MinConfidence of the tracker's prediction, the repeats it takes before splitting.
+	constexpr uint32_t SplitPredictionFrames = 2;
+
+	// Turns the split barrier mode on for one test.
+	struct ScopedSplitBarriers
+	{
+		ScopedSplitBarriers() { ResourceStateTracker::SetSplitBarriers(true); }
+		~ScopedSplitBarriers() { ResourceStateTracker::SetSplitBarriers(false); }
+	};
+
+	/**
+	 * Checks that every BEGIN_ONLY the command list recorded is ended by one END_ONLY with
+	 * the same transition, and that nothing else touched the resource in between.
+	 * Returns the number of pairs.
+	 */
+	uint32_t CheckSplitPairs(std::vector<D3D12_RESOURCE_BARRIER> const& barriers)
+	{
+		uint32_t numPairs = 0;
+		std::unordered_map<ID3D12Resource*, D3D12_RESOURCE_TRANSITION_BARRIER> begun;
+		for (auto const& barrier : barriers)
+		{
+			if (barrier.Type != D3D12_RESOURCE_BARRIER_TYPE_TRANSITION)
+			{
+				continue;
+			}
+
+			auto const& transition = barrier.Transition;
+			auto iter = begun.find(transition.pResource);
+			if (barrier.Flags == D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY)
+			{
+				CHECK(iter == begun.end());
+				begun[transition.pResource] = transition;
+			}
+			else if (barrier.Flags == D3D12_RESOURCE_BARRIER_FLAG_END_ONLY)
+			{
+				CHECK(iter != begun.end());
+				if (iter != begun.end())
+				{
+					CHECK(iter->second.StateBefore == transition.StateBefore);
+					CHECK(iter->second.StateAfter == transition.StateAfter);
+					CHECK(iter->second.Subresource == transition.Subresource);
+					begun.erase(iter);
+					numPairs++;
+				}
+			}
+			else
+			{
+				// Used while its split transition was still in flight.
+				CHECK(iter == begun.end());
+			}
+		}
+
+		CHECK(begun.empty());
+		return numPairs;
+	}
+
+	ID3D12Resource* CreateTexture(std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>>& textures)
+	{
+		auto created = CreateTextures(1, D3D12_RESOURCE_STATE_COMMON);
+		textures.push_back(created.front());
+		return textures.back().Get();
+	}
+
+	// A pass rendering to the texture, the command list is done writing to it afterwards.
+	void RecordRenderPass(ReplayCommandList& commandList, ID3D12Resource* texture)
+	{
+		commandList.RecordPass({ texture }, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	}
+
+	// Renders and samples the texture often enough for the tracker to predict the transition.
+	void Train(ReplayCommandList& commandList, ID3D12Resource* texture)
+	{
+		for (uint32_t i = 0; i <= SplitPredictionFrames; i++)
+		{
+			RecordRenderPass(commandList, texture);
+			commandList.RecordPass({ texture }, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		}
+	}
+}
+
+HEADLESS_TEST(PredictedTransitionIsBegunAndEndedInPairs)
+{
+	ScopedSplitBarriers splitBarriers;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> textures;
+	auto texture = CreateTexture(textures);
+
+	ReplayCommandList commandList;
+	Train(commandList, texture);
+
+	for (uint32_t frame = 0; frame < 4; frame++)
+	{
+		RecordRenderPass(commandList, texture);
+		commandList.Tracker.BeginSplitTransition(texture);
+
+		// Work between the end of the writes and the next use overlaps the transition.
+		commandList.Tracker.FlushResourceBarriers(commandList.D3DCommandList.Get());
+		commandList.RecordPass({ texture }, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	}
+
+	commandList.Close();
+
+	CHECK(CheckSplitPairs(commandList.D3DCommandList->Barriers) == 4);
+
+	auto const& statistics = commandList.Tracker.GetSplitBarrierStatistics();
+	CHECK(statistics.NumBegun == 4);
+	CHECK(statistics.NumHits == 4);
+	CHECK(statistics.NumMisses == 0);
+}
+
+HEADLESS_TEST(BeginIsOnlyRecordedForAPredictedTransition)
+{
+	ScopedSplitBarriers splitBarriers;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> textures;
+	auto texture = CreateTexture(textures);
+
+	// Rendered and sampled once, not enough to predict.
+	ReplayCommandList commandList;
+	RecordRenderPass(commandList, texture);
+	commandList.RecordPass({ texture }, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	RecordRenderPass(commandList, texture);
+	commandList.Tracker.BeginSplitTransition(texture);
+	commandList.Tracker.FlushResourceBarriers(commandList.D3DCommandList.Get());
+	commandList.Close();
+
+	CHECK(CheckSplitPairs(commandList.D3DCommandList->Barriers) == 0);
+	CHECK(commandList.Tracker.GetSplitBarrierStatistics().NumBegun == 0);
+}
+
+HEADLESS_TEST(UnflushedBeginIsDroppedForAFullTransition)
+{
+	ScopedSplitBarriers splitBarriers;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> textures;
+	auto texture = CreateTexture(textures);
+
+	ReplayCommandList commandList;
+	Train(commandList, texture);
+	size_t numTrainingBarriers = commandList.D3DCommandList->Barriers.size();
+
+	// Nothing was recorded between the begin and the next use, it never reaches the command list.
+	RecordRenderPass(commandList, texture);
+	commandList.Tracker.BeginSplitTransition(texture);
+	commandList.RecordPass({ texture }, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	commandList.Close();
+
+	auto const& barriers = commandList.D3DCommandList->Barriers;
+	CHECK(CheckSplitPairs(barriers) == 0);
+	CHECK(barriers.size() == numTrainingBarriers + 2);
+
+	auto const& last = barriers.back();
+	CHECK(last.Flags == D3D12_RESOURCE_BARRIER_FLAG_NONE);
+	CHECK(last.Transition.StateBefore == D3D12_RESOURCE_STATE_RENDER_TARGET);
+	CHECK(last.Transition.StateAfter == D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+}
+
+HEADLESS_TEST(MispredictedTransitionIsEndedBeforeTheActualOne)
+{
+	ScopedSplitBarriers splitBarriers;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> textures;
+	auto texture = CreateTexture(textures);
+
+	ReplayCommandList commandList;
+	Train(commandList, texture);
+
+	RecordRenderPass(commandList, texture);
+	commandList.Tracker.BeginSplitTransition(texture);
+	commandList.Tracker.FlushResourceBarriers(commandList.D3DCommandList.Get());
+
+	// Copied from instead of sampled.
+	commandList.RecordPass({ texture }, D3D12_RESOURCE_STATE_COPY_SOURCE);
+	commandList.Close();
+
+	auto const& barriers = commandList.D3DCommandList->Barriers;
+	CHECK(CheckSplitPairs(barriers) == 1);
+	CHECK(barriers.size() >= 2);
+
+	// The end lands the resource in the predicted state, the next barrier starts from there.
+	auto const& end = barriers[barriers.size() - 2];
+	auto const& actual = barriers.back();
+	CHECK(end.Flags == D3D12_RESOURCE_BARRIER_FLAG_END_ONLY);
+	CHECK(actual.Flags == D3D12_RESOURCE_BARRIER_FLAG_NONE);
+	CHECK(actual.Transition.StateBefore == D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	CHECK(actual.Transition.StateAfter == D3D12_RESOURCE_STATE_COPY_SOURCE);
+
+	CHECK(commandList.Tracker.GetSplitBarrierStatistics().NumMisses == 1);
+}
+
+HEADLESS_TEST(OpenSplitTransitionIsEndedWhenClosing)
+{
+	ScopedSplitBarriers splitBarriers;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> textures;
+	auto first = CreateTexture(textures);
+	auto second = CreateTexture(textures);
+
+	ReplayCommandList commandList;
+	Train(commandList, first);
+	Train(commandList, second);
+
+	RecordRenderPass(commandList, first);
+	RecordRenderPass(commandList, second);
+	commandList.Tracker.BeginSplitTransition(first);
+	commandList.Tracker.BeginSplitTransition(second);
+	commandList.Tracker.FlushResourceBarriers(commandList.D3DCommandList.Get());
+	commandList.Close();
+
+	CHECK(CheckSplitPairs(commandList.D3DCommandList->Barriers) == 2);
+	CHECK(commandList.Tracker.GetSplitBarrierStatistics().NumMisses == 2);
+}
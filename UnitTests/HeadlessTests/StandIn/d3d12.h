@@ -0,0 +1,787 @@
+#pragma once
+
+/**
+ * Stand-in for the D3D12 headers, so the Core sources that only record into D3D12 objects
+ * build and run without Windows or a GPU. Enum values match the real headers. The objects
+ * don't execute anything, they count and record the calls made on them so tests can check
+ * them and benchmarks measure the CPU side alone.
+ * Only what the headless tests build is declared, add to it as more sources are built.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "wrl.h"
+
+// -- Windows types ----
+
+using HRESULT = int32_t;
+using UINT = uint32_t;
+using UINT8 = uint8_t;
+using UINT16 = uint16_t;
+using UINT64 = uint64_t;
+using INT = int32_t;
+using ULONG = uint32_t;
+using DWORD = uint32_t;
+using BOOL = int32_t;
+using FLOAT = float;
+using SIZE_T = size_t;
+using LPCWSTR = const wchar_t*;
+
+#define S_OK ((HRESULT)0)
+#define E_FAIL ((HRESULT)0x80004005)
+#define E_NOINTERFACE ((HRESULT)0x80004002)
+#define E_INVALIDARG ((HRESULT)0x80070057)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+
+#define STDMETHODCALLTYPE
+
+struct GUID
+{
+	uint32_t Data1;
+	uint16_t Data2;
+	uint16_t Data3;
+	uint8_t Data4[8];
+};
+
+inline bool operator==(GUID const& a, GUID const& b) { return memcmp(&a, &b, sizeof(GUID)) == 0; }
+inline bool operator!=(GUID const& a, GUID const& b) { return !(a == b); }
+inline bool operator<(GUID const& a, GUID const& b) { return memcmp(&a, &b, sizeof(GUID)) < 0; }
+
+using IID = GUID;
+using REFGUID = GUID const&;
+using REFIID = GUID const&;
+
+// The stand-in objects are created by the method that's called, the interface id is never looked at.
+constexpr GUID IID_StandIn = { 0x5afe5afe, 0x0, 0x0, { 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x1 } };
+#define __uuidof(x) IID_StandIn
+#define IID_PPV_ARGS(ppType) IID_StandIn, reinterpret_cast<void**>(ppType)
+
+inline unsigned char _BitScanForward(unsigned long* index, unsigned long mask)
+{
+	if (mask == 0)
+	{
+		return 0;
+	}
+
+	*index = static_cast<unsigned long>(__builtin_ctzl(mask));
+	return 1;
+}
+
+inline unsigned char _BitScanReverse(unsigned long* index, unsigned long mask)
+{
+	if (mask == 0)
+	{
+		return 0;
+	}
+
+	*index = static_cast<unsigned long>(sizeof(unsigned long) * 8 - 1 - __builtin_clzl(mask));
+	return 1;
+}
+
+// DWORD is 32 bit here, unlike unsigned long.
+inline unsigned char _BitScanForward(DWORD* index, DWORD mask)
+{
+	unsigned long longIndex;
+	unsigned char isFound = _BitScanForward(&longIndex, static_cast<unsigned long>(mask));
+	*index = static_cast<DWORD>(longIndex);
+	return isFound;
+}
+
+inline unsigned char _BitScanReverse(DWORD* index, DWORD mask)
+{
+	unsigned long longIndex;
+	unsigned char isFound = _BitScanReverse(&longIndex, static_cast<unsigned long>(mask));
+	*index = static_cast<DWORD>(longIndex);
+	return isFound;
+}
+
+#define DEFINE_STAND_IN_FLAG_OPERATORS(Enum_) \
+	constexpr Enum_ operator|(Enum_ a, Enum_ b) { return static_cast<Enum_>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b)); } \
+	constexpr Enum_ operator&(Enum_ a, Enum_ b) { return static_cast<Enum_>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b)); } \
+	constexpr Enum_ operator^(Enum_ a, Enum_ b) { return static_cast<Enum_>(static_cast<uint32_t>(a) ^ static_cast<uint32_t>(b)); } \
+	constexpr Enum_ operator~(Enum_ a) { return static_cast<Enum_>(~static_cast<uint32_t>(a)); } \
+	inline Enum_& operator|=(Enum_& a, Enum_ b) { return a = a | b; } \
+	inline Enum_& operator&=(Enum_& a, Enum_ b) { return a = a & b; }
+
+// -- Enums ----
+
+enum DXGI_FORMAT
+{
+	DXGI_FORMAT_UNKNOWN = 0,
+	DXGI_FORMAT_R32G32B32A32_FLOAT = 2,
+	DXGI_FORMAT_R16G16B16A16_FLOAT = 10,
+	DXGI_FORMAT_R32G8X24_TYPELESS = 19,
+	DXGI_FORMAT_D32_FLOAT_S8X24_UINT = 20,
+	DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS = 21,
+	DXGI_FORMAT_X32_TYPELESS_G8X24_UINT = 22,
+	DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+	DXGI_FORMAT_R32_TYPELESS = 39,
+	DXGI_FORMAT_D32_FLOAT = 40,
+	DXGI_FORMAT_R32_FLOAT = 41,
+	DXGI_FORMAT_R24G8_TYPELESS = 44,
+	DXGI_FORMAT_D24_UNORM_S8_UINT = 45,
+	DXGI_FORMAT_R24_UNORM_X8_TYPELESS = 46,
+	DXGI_FORMAT_X24_TYPELESS_G8_UINT = 47,
+	DXGI_FORMAT_R16_UINT = 57,
+	DXGI_FORMAT_NV12 = 103,
+	DXGI_FORMAT_P010 = 104,
+	DXGI_FORMAT_P016 = 105,
+	DXGI_FORMAT_420_OPAQUE = 106,
+	DXGI_FORMAT_NV11 = 110,
+};
+
+struct DXGI_SAMPLE_DESC
+{
+	UINT Count;
+	UINT Quality;
+};
+
+enum D3D12_COMMAND_LIST_TYPE
+{
+	D3D12_COMMAND_LIST_TYPE_DIRECT = 0,
+	D3D12_COMMAND_LIST_TYPE_BUNDLE = 1,
+	D3D12_COMMAND_LIST_TYPE_COMPUTE = 2,
+	D3D12_COMMAND_LIST_TYPE_COPY = 3,
+};
+
+enum D3D12_RESOURCE_STATES
+{
+	D3D12_RESOURCE_STATE_COMMON = 0,
+	D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER = 0x1,
+	D3D12_RESOURCE_STATE_INDEX_BUFFER = 0x2,
+	D3D12_RESOURCE_STATE_RENDER_TARGET = 0x4,
+	D3D12_RESOURCE_STATE_UNORDERED_ACCESS = 0x8,
+	D3D12_RESOURCE_STATE_DEPTH_WRITE = 0x10,
+	D3D12_RESOURCE_STATE_DEPTH_READ = 0x20,
+	D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE = 0x40,
+	D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE = 0x80,
+	D3D12_RESOURCE_STATE_STREAM_OUT = 0x100,
+	D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT = 0x200,
+	D3D12_RESOURCE_STATE_COPY_DEST = 0x400,
+	D3D12_RESOURCE_STATE_COPY_SOURCE = 0x800,
+	D3D12_RESOURCE_STATE_RESOLVE_DEST = 0x1000,
+	D3D12_RESOURCE_STATE_RESOLVE_SOURCE = 0x2000,
+	D3D12_RESOURCE_STATE_GENERIC_READ = 0x1 | 0x2 | 0x40 | 0x80 | 0x200 | 0x800,
+	D3D12_RESOURCE_STATE_PRESENT = 0,
+	D3D12_RESOURCE_STATE_PREDICATION = 0x200,
+};
+DEFINE_STAND_IN_FLAG_OPERATORS(D3D12_RESOURCE_STATES)
+
+enum D3D12_RESOURCE_BARRIER_TYPE
+{
+	D3D12_RESOURCE_BARRIER_TYPE_TRANSITION = 0,
+	D3D12_RESOURCE_BARRIER_TYPE_ALIASING = 1,
+	D3D12_RESOURCE_BARRIER_TYPE_UAV = 2,
+};
+
+enum D3D12_RESOURCE_BARRIER_FLAGS
+{
+	D3D12_RESOURCE_BARRIER_FLAG_NONE = 0,
+	D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY = 0x1,
+	D3D12_RESOURCE_BARRIER_FLAG_END_ONLY = 0x2,
+};
+DEFINE_STAND_IN_FLAG_OPERATORS(D3D12_RESOURCE_BARRIER_FLAGS)
+
+#define D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES 0xffffffff
+
+enum D3D12_RESOURCE_DIMENSION
+{
+	D3D12_RESOURCE_DIMENSION_UNKNOWN = 0,
+	D3D12_RESOURCE_DIMENSION_BUFFER = 1,
+	D3D12_RESOURCE_DIMENSION_TEXTURE1D = 2,
+	D3D12_RESOURCE_DIMENSION_TEXTURE2D = 3,
+	D3D12_RESOURCE_DIMENSION_TEXTURE3D = 4,
+};
+
+enum D3D12_TEXTURE_LAYOUT
+{
+	D3D12_TEXTURE_LAYOUT_UNKNOWN = 0,
+	D3D12_TEXTURE_LAYOUT_ROW_MAJOR = 1,
+};
+
+enum D3D12_RESOURCE_FLAGS
+{
+	D3D12_RESOURCE_FLAG_NONE = 0,
+	D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET = 0x1,
+	D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL = 0x2,
+	D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS = 0x4,
+	D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE = 0x8,
+	D3D12_RESOURCE_FLAG_ALLOW_CROSS_ADAPTER = 0x10,
+	D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS = 0x20,
+};
+DEFINE_STAND_IN_FLAG_OPERATORS(D3D12_RESOURCE_FLAGS)
+
+enum D3D12_DESCRIPTOR_HEAP_TYPE
+{
+	D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV = 0,
+	D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER = 1,
+	D3D12_DESCRIPTOR_HEAP_TYPE_RTV = 2,
+	D3D12_DESCRIPTOR_HEAP_TYPE_DSV = 3,
+	D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES = 4,
+};
+
+enum D3D12_DESCRIPTOR_HEAP_FLAGS
+{
+	D3D12_DESCRIPTOR_HEAP_FLAG_NONE = 0,
+	D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE = 0x1,
+};
+DEFINE_STAND_IN_FLAG_OPERATORS(D3D12_DESCRIPTOR_HEAP_FLAGS)
+
+enum D3D12_DESCRIPTOR_RANGE_TYPE
+{
+	D3D12_DESCRIPTOR_RANGE_TYPE_SRV = 0,
+	D3D12_DESCRIPTOR_RANGE_TYPE_UAV = 1,
+	D3D12_DESCRIPTOR_RANGE_TYPE_CBV = 2,
+	D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER = 3,
+};
+
+enum D3D12_DESCRIPTOR_RANGE_FLAGS
+{
+	D3D12_DESCRIPTOR_RANGE_FLAG_NONE = 0,
+	D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE = 0x1,
+	D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE = 0x2,
+	D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE = 0x4,
+	D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC = 0x8,
+};
+DEFINE_STAND_IN_FLAG_OPERATORS(D3D12_DESCRIPTOR_RANGE_FLAGS)
+
+#define D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND 0xffffffff
+
+enum D3D12_ROOT_PARAMETER_TYPE
+{
+	D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE = 0,
+	D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS = 1,
+	D3D12_ROOT_PARAMETER_TYPE_CBV = 2,
+	D3D12_ROOT_PARAMETER_TYPE_SRV = 3,
+	D3D12_ROOT_PARAMETER_TYPE_UAV = 4,
+};
+
+enum D3D12_SHADER_VISIBILITY
+{
+	D3D12_SHADER_VISIBILITY_ALL = 0,
+	D3D12_SHADER_VISIBILITY_PIXEL = 5,
+};
+
+enum D3D12_ROOT_SIGNATURE_FLAGS
+{
+	D3D12_ROOT_SIGNATURE_FLAG_NONE = 0,
+};
+
+enum D3D_ROOT_SIGNATURE_VERSION
+{
+	D3D_ROOT_SIGNATURE_VERSION_1 = 0x1,
+	D3D_ROOT_SIGNATURE_VERSION_1_0 = 0x1,
+	D3D_ROOT_SIGNATURE_VERSION_1_1 = 0x2,
+};
+
+enum D3D12_SRV_DIMENSION
+{
+	D3D12_SRV_DIMENSION_UNKNOWN = 0,
+	D3D12_SRV_DIMENSION_BUFFER = 1,
+	D3D12_SRV_DIMENSION_TEXTURE1D = 2,
+	D3D12_SRV_DIMENSION_TEXTURE1DARRAY = 3,
+	D3D12_SRV_DIMENSION_TEXTURE2D = 4,
+	D3D12_SRV_DIMENSION_TEXTURE2DARRAY = 5,
+	D3D12_SRV_DIMENSION_TEXTURE2DMS = 6,
+	D3D12_SRV_DIMENSION_TEXTURE2DMSARRAY = 7,
+	D3D12_SRV_DIMENSION_TEXTURE3D = 8,
+	D3D12_SRV_DIMENSION_TEXTURECUBE = 9,
+	D3D12_SRV_DIMENSION_TEXTURECUBEARRAY = 10,
+};
+
+enum D3D12_UAV_DIMENSION
+{
+	D3D12_UAV_DIMENSION_UNKNOWN = 0,
+	D3D12_UAV_DIMENSION_BUFFER = 1,
+	D3D12_UAV_DIMENSION_TEXTURE1D = 2,
+	D3D12_UAV_DIMENSION_TEXTURE1DARRAY = 3,
+	D3D12_UAV_DIMENSION_TEXTURE2D = 4,
+	D3D12_UAV_DIMENSION_TEXTURE2DARRAY = 5,
+	D3D12_UAV_DIMENSION_TEXTURE3D = 8,
+};
+
+enum D3D12_BUFFER_SRV_FLAGS { D3D12_BUFFER_SRV_FLAG_NONE = 0, D3D12_BUFFER_SRV_FLAG_RAW = 0x1 };
+enum D3D12_BUFFER_UAV_FLAGS { D3D12_BUFFER_UAV_FLAG_NONE = 0, D3D12_BUFFER_UAV_FLAG_RAW = 0x1 };
+
+// -- Structures ----
+
+class ID3D12Resource;
+class ID3D12DescriptorHeap;
+
+using D3D12_GPU_VIRTUAL_ADDRESS = UINT64;
+
+struct D3D12_CPU_DESCRIPTOR_HANDLE
+{
+	SIZE_T ptr;
+};
+
+struct D3D12_GPU_DESCRIPTOR_HANDLE
+{
+	UINT64 ptr;
+};
+
+struct D3D12_RESOURCE_TRANSITION_BARRIER
+{
+	ID3D12Resource* pResource;
+	UINT Subresource;
+	D3D12_RESOURCE_STATES StateBefore;
+	D3D12_RESOURCE_STATES StateAfter;
+};
+
+struct D3D12_RESOURCE_ALIASING_BARRIER
+{
+	ID3D12Resource* pResourceBefore;
+	ID3D12Resource* pResourceAfter;
+};
+
+struct D3D12_RESOURCE_UAV_BARRIER
+{
+	ID3D12Resource* pResource;
+};
+
+struct D3D12_RESOURCE_BARRIER
+{
+	D3D12_RESOURCE_BARRIER_TYPE Type;
+	D3D12_RESOURCE_BARRIER_FLAGS Flags;
+	union
+	{
+		D3D12_RESOURCE_TRANSITION_BARRIER Transition;
+		D3D12_RESOURCE_ALIASING_BARRIER Aliasing;
+		D3D12_RESOURCE_UAV_BARRIER UAV;
+	};
+};
+
+struct D3D12_RESOURCE_DESC
+{
+	D3D12_RESOURCE_DIMENSION Dimension;
+	UINT64 Alignment;
+	UINT64 Width;
+	UINT Height;
+	UINT16 DepthOrArraySize;
+	UINT16 MipLevels;
+	DXGI_FORMAT Format;
+	DXGI_SAMPLE_DESC SampleDesc;
+	D3D12_TEXTURE_LAYOUT Layout;
+	D3D12_RESOURCE_FLAGS Flags;
+};
+
+struct D3D12_DESCRIPTOR_HEAP_DESC
+{
+	D3D12_DESCRIPTOR_HEAP_TYPE Type;
+	UINT NumDescriptors;
+	D3D12_DESCRIPTOR_HEAP_FLAGS Flags;
+	UINT NodeMask;
+};
+
+struct D3D12_DESCRIPTOR_RANGE1
+{
+	D3D12_DESCRIPTOR_RANGE_TYPE RangeType;
+	UINT NumDescriptors;
+	UINT BaseShaderRegister;
+	UINT RegisterSpace;
+	D3D12_DESCRIPTOR_RANGE_FLAGS Flags;
+	UINT OffsetInDescriptorsFromTableStart;
+};
+
+struct D3D12_ROOT_DESCRIPTOR_TABLE1
+{
+	UINT NumDescriptorRanges;
+	const D3D12_DESCRIPTOR_RANGE1* pDescriptorRanges;
+};
+
+struct D3D12_ROOT_CONSTANTS
+{
+	UINT ShaderRegister;
+	UINT RegisterSpace;
+	UINT Num32BitValues;
+};
+
+struct D3D12_ROOT_DESCRIPTOR1
+{
+	UINT ShaderRegister;
+	UINT RegisterSpace;
+	UINT Flags;
+};
+
+struct D3D12_ROOT_PARAMETER1
+{
+	D3D12_ROOT_PARAMETER_TYPE ParameterType;
+	union
+	{
+		D3D12_ROOT_DESCRIPTOR_TABLE1 DescriptorTable;
+		D3D12_ROOT_CONSTANTS Constants;
+		D3D12_ROOT_DESCRIPTOR1 Descriptor;
+	};
+	D3D12_SHADER_VISIBILITY ShaderVisibility;
+};
+
+struct D3D12_STATIC_SAMPLER_DESC
+{
+	UINT Filter;
+	UINT AddressU;
+	UINT AddressV;
+	UINT AddressW;
+	FLOAT MipLODBias;
+	UINT MaxAnisotropy;
+	UINT ComparisonFunc;
+	UINT BorderColor;
+	FLOAT MinLOD;
+	FLOAT MaxLOD;
+	UINT ShaderRegister;
+	UINT RegisterSpace;
+	D3D12_SHADER_VISIBILITY ShaderVisibility;
+};
+
+struct D3D12_ROOT_SIGNATURE_DESC1
+{
+	UINT NumParameters;
+	const D3D12_ROOT_PARAMETER1* pParameters;
+	UINT NumStaticSamplers;
+	const D3D12_STATIC_SAMPLER_DESC* pStaticSamplers;
+	D3D12_ROOT_SIGNATURE_FLAGS Flags;
+};
+
+struct D3D12_BUFFER_SRV { UINT64 FirstElement; UINT NumElements; UINT StructureByteStride; D3D12_BUFFER_SRV_FLAGS Flags; };
+struct D3D12_TEX1D_SRV { UINT MostDetailedMip; UINT MipLevels; FLOAT ResourceMinLODClamp; };
+struct D3D12_TEX1D_ARRAY_SRV { UINT MostDetailedMip; UINT MipLevels; UINT FirstArraySlice; UINT ArraySize; FLOAT ResourceMinLODClamp; };
+struct D3D12_TEX2D_SRV { UINT MostDetailedMip; UINT MipLevels; UINT PlaneSlice; FLOAT ResourceMinLODClamp; };
+struct D3D12_TEX2D_ARRAY_SRV { UINT MostDetailedMip; UINT MipLevels; UINT FirstArraySlice; UINT ArraySize; UINT PlaneSlice; FLOAT ResourceMinLODClamp; };
+struct D3D12_TEX2DMS_SRV { UINT UnusedField_NothingToDefine; };
+struct D3D12_TEX2DMS_ARRAY_SRV { UINT FirstArraySlice; UINT ArraySize; };
+struct D3D12_TEX3D_SRV { UINT MostDetailedMip; UINT MipLevels; FLOAT ResourceMinLODClamp; };
+struct D3D12_TEXCUBE_SRV { UINT MostDetailedMip; UINT MipLevels; FLOAT ResourceMinLODClamp; };
+struct D3D12_TEXCUBE_ARRAY_SRV { UINT MostDetailedMip; UINT MipLevels; UINT First2DArrayFace; UINT NumCubes; FLOAT ResourceMinLODClamp; };
+
+struct D3D12_SHADER_RESOURCE_VIEW_DESC
+{
+	DXGI_FORMAT Format;
+	D3D12_SRV_DIMENSION ViewDimension;
+	UINT Shader4ComponentMapping;
+	union
+	{
+		D3D12_BUFFER_SRV Buffer;
+		D3D12_TEX1D_SRV Texture1D;
+		D3D12_TEX1D_ARRAY_SRV Texture1DArray;
+		D3D12_TEX2D_SRV Texture2D;
+		D3D12_TEX2D_ARRAY_SRV Texture2DArray;
+		D3D12_TEX2DMS_SRV Texture2DMS;
+		D3D12_TEX2DMS_ARRAY_SRV Texture2DMSArray;
+		D3D12_TEX3D_SRV Texture3D;
+		D3D12_TEXCUBE_SRV TextureCube;
+		D3D12_TEXCUBE_ARRAY_SRV TextureCubeArray;
+	};
+};
+
+struct D3D12_BUFFER_UAV { UINT64 FirstElement; UINT NumElements; UINT StructureByteStride; UINT64 CounterOffsetInBytes; D3D12_BUFFER_UAV_FLAGS Flags; };
+struct D3D12_TEX1D_UAV { UINT MipSlice; };
+struct D3D12_TEX1D_ARRAY_UAV { UINT MipSlice; UINT FirstArraySlice; UINT ArraySize; };
+struct D3D12_TEX2D_UAV { UINT MipSlice; UINT PlaneSlice; };
+struct D3D12_TEX2D_ARRAY_UAV { UINT MipSlice; UINT FirstArraySlice; UINT ArraySize; UINT PlaneSlice; };
+struct D3D12_TEX3D_UAV { UINT MipSlice; UINT FirstWSlice; UINT WSize; };
+
+struct D3D12_UNORDERED_ACCESS_VIEW_DESC
+{
+	DXGI_FORMAT Format;
+	D3D12_UAV_DIMENSION ViewDimension;
+	union
+	{
+		D3D12_BUFFER_UAV Buffer;
+		D3D12_TEX1D_UAV Texture1D;
+		D3D12_TEX1D_ARRAY_UAV Texture1DArray;
+		D3D12_TEX2D_UAV Texture2D;
+		D3D12_TEX2D_ARRAY_UAV Texture2DArray;
+		D3D12_TEX3D_UAV Texture3D;
+	};
+};
+
+// -- Objects ----
+
+struct IUnknown
+{
+	virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) = 0;
+	virtual ULONG STDMETHODCALLTYPE AddRef() = 0;
+	virtual ULONG STDMETHODCALLTYPE Release() = 0;
+
+	virtual ~IUnknown() = default;
+};
+
+// Reference counting and private data, shared by every stand-in object.
+class ID3D12Object : public IUnknown
+{
+public:
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, void** object) override
+	{
+		*object = static_cast<IUnknown*>(this);
+		this->AddRef();
+		return S_OK;
+	}
+
+	ULONG STDMETHODCALLTYPE AddRef() override { return ++this->m_refCount; }
+
+	ULONG STDMETHODCALLTYPE Release() override
+	{
+		ULONG refCount = --this->m_refCount;
+		if (refCount == 0)
+		{
+			delete this;
+		}
+
+		return refCount;
+	}
+
+	HRESULT GetPrivateData(REFGUID guid, UINT* dataSize, void* data)
+	{
+		std::lock_guard<std::mutex> lock(this->m_privateDataMutex);
+
+		auto iter = this->m_privateData.find(guid);
+		if (iter == this->m_privateData.end())
+		{
+			*dataSize = 0;
+			return E_FAIL;
+		}
+
+		if (data == nullptr)
+		{
+			*dataSize = static_cast<UINT>(iter->second.size());
+			return S_OK;
+		}
+
+		if (*dataSize < iter->second.size())
+		{
+			return E_INVALIDARG;
+		}
+
+		*dataSize = static_cast<UINT>(iter->second.size());
+		memcpy(data, iter->second.data(), iter->second.size());
+		return S_OK;
+	}
+
+	HRESULT SetPrivateData(REFGUID guid, UINT dataSize, const void* data)
+	{
+		std::lock_guard<std::mutex> lock(this->m_privateDataMutex);
+
+		if (data == nullptr)
+		{
+			this->m_privateData.erase(guid);
+			return S_OK;
+		}
+
+		auto bytes = static_cast<const uint8_t*>(data);
+		this->m_privateData[guid].assign(bytes, bytes + dataSize);
+		return S_OK;
+	}
+
+	HRESULT SetPrivateDataInterface(REFGUID guid, const IUnknown* data)
+	{
+		Microsoft::WRL::ComPtr<IUnknown> released;
+
+		std::lock_guard<std::mutex> lock(this->m_privateDataMutex);
+
+		auto iter = this->m_privateInterfaces.find(guid);
+		if (iter != this->m_privateInterfaces.end())
+		{
+			released = std::move(iter->second);
+			this->m_privateInterfaces.erase(iter);
+		}
+
+		if (data != nullptr)
+		{
+			this->m_privateInterfaces.emplace(guid, const_cast<IUnknown*>(data));
+		}
+
+		return S_OK;
+	}
+
+	HRESULT SetName(LPCWSTR) { return S_OK; }
+
+protected:
+	ID3D12Object() = default;
+
+	~ID3D12Object() override
+	{
+		// Released before the object is gone, like D3D12 does.
+		std::map<GUID, Microsoft::WRL::ComPtr<IUnknown>> privateInterfaces;
+		privateInterfaces.swap(this->m_privateInterfaces);
+	}
+
+private:
+	std::atomic<ULONG> m_refCount{ 1 };
+
+	std::mutex m_privateDataMutex;
+	std::map<GUID, std::vector<uint8_t>> m_privateData;
+	std::map<GUID, Microsoft::WRL::ComPtr<IUnknown>> m_privateInterfaces;
+};
+
+class ID3D12DeviceChild : public ID3D12Object {};
+class ID3D12Pageable : public ID3D12DeviceChild {};
+
+class ID3D12Resource : public ID3D12Pageable
+{
+public:
+	explicit ID3D12Resource(D3D12_RESOURCE_DESC const& desc = {})
+		: m_desc(desc)
+		, m_gpuVirtualAddress(NextGpuVirtualAddress(desc.Width))
+	{}
+
+	D3D12_RESOURCE_DESC GetDesc() const { return this->m_desc; }
+	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() const { return this->m_gpuVirtualAddress; }
+
+private:
+	static D3D12_GPU_VIRTUAL_ADDRESS NextGpuVirtualAddress(UINT64 size)
+	{
+		static std::atomic<UINT64> nextAddress(0x100000000ull);
+		return nextAddress.fetch_add((size + 0xffff) & ~0xffffull);
+	}
+
+	D3D12_RESOURCE_DESC m_desc;
+	D3D12_GPU_VIRTUAL_ADDRESS m_gpuVirtualAddress;
+};
+
+class ID3D12RootSignature : public ID3D12DeviceChild {};
+class ID3D12PipelineState : public ID3D12Pageable {};
+
+class ID3D12CommandAllocator : public ID3D12Pageable
+{
+public:
+	HRESULT Reset()
+	{
+		this->NumResets++;
+		return S_OK;
+	}
+
+	std::atomic_uint64_t NumResets{ 0 };
+};
+
+class ID3D12DescriptorHeap : public ID3D12Pageable
+{
+public:
+	ID3D12DescriptorHeap(D3D12_DESCRIPTOR_HEAP_DESC const& desc, UINT incrementSize)
+		: m_desc(desc)
+	{
+		// Handles are never dereferenced, every heap only needs its own address range.
+		static std::atomic<UINT64> nextAddress(0x10000);
+		UINT64 size = (static_cast<UINT64>(desc.NumDescriptors) * incrementSize + 0xffff) & ~0xffffull;
+		this->m_baseAddress = nextAddress.fetch_add(size + 0x10000);
+	}
+
+	D3D12_DESCRIPTOR_HEAP_DESC GetDesc() const { return this->m_desc; }
+	D3D12_CPU_DESCRIPTOR_HANDLE GetCPUDescriptorHandleForHeapStart() const { return { static_cast<SIZE_T>(this->m_baseAddress) }; }
+	D3D12_GPU_DESCRIPTOR_HANDLE GetGPUDescriptorHandleForHeapStart() const { return { this->m_baseAddress | (1ull << 48) }; }
+
+private:
+	D3D12_DESCRIPTOR_HEAP_DESC m_desc;
+	UINT64 m_baseAddress;
+};
+
+class ID3D12CommandList : public ID3D12DeviceChild {};
+
+// Records the barriers and counts the other calls.
+class ID3D12GraphicsCommandList : public ID3D12CommandList
+{
+public:
+	HRESULT Close() { return S_OK; }
+	HRESULT Reset(ID3D12CommandAllocator*, ID3D12PipelineState*)
+	{
+		this->Barriers.clear();
+		this->NumResourceBarrierCalls = 0;
+		return S_OK;
+	}
+
+	void ResourceBarrier(UINT numBarriers, const D3D12_RESOURCE_BARRIER* barriers)
+	{
+		this->NumResourceBarrierCalls++;
+		this->Barriers.insert(this->Barriers.end(), barriers, barriers + numBarriers);
+	}
+
+	void SetDescriptorHeaps(UINT, ID3D12DescriptorHeap* const*) { this->NumSetDescriptorHeaps++; }
+	void SetGraphicsRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE) { this->NumSetRootDescriptorTables++; }
+	void SetComputeRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE) { this->NumSetRootDescriptorTables++; }
+
+	std::vector<D3D12_RESOURCE_BARRIER> Barriers;
+	uint64_t NumResourceBarrierCalls = 0;
+	uint64_t NumSetDescriptorHeaps = 0;
+	uint64_t NumSetRootDescriptorTables = 0;
+};
+
+class ID3D12GraphicsCommandList1 : public ID3D12GraphicsCommandList {};
+class ID3D12GraphicsCommandList2 : public ID3D12GraphicsCommandList1 {};
+
+class ID3D12CommandQueue : public ID3D12Pageable
+{
+public:
+	void ExecuteCommandLists(UINT numCommandLists, ID3D12CommandList* const*)
+	{
+		this->NumExecuteCalls++;
+		this->NumExecutedCommandLists += numCommandLists;
+	}
+
+	std::atomic_uint64_t NumExecuteCalls{ 0 };
+	std::atomic_uint64_t NumExecutedCommandLists{ 0 };
+};
+
+// Creates stand-in objects. Descriptor copies are only counted.
+class ID3D12Device : public ID3D12Object
+{
+public:
+	UINT GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE type) const
+	{
+		return type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER ? 32 : 64;
+	}
+
+	HRESULT CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC* desc, REFIID, void** heap)
+	{
+		*heap = new ID3D12DescriptorHeap(*desc, this->GetDescriptorHandleIncrementSize(desc->Type));
+		return S_OK;
+	}
+
+	HRESULT CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE, REFIID, void** allocator)
+	{
+		this->NumCreatedCommandAllocators++;
+		*allocator = new ID3D12CommandAllocator();
+		return S_OK;
+	}
+
+	void CopyDescriptors(
+		UINT numDestRanges,
+		const D3D12_CPU_DESCRIPTOR_HANDLE*,
+		const UINT* destRangeSizes,
+		UINT,
+		const D3D12_CPU_DESCRIPTOR_HANDLE*,
+		const UINT*,
+		D3D12_DESCRIPTOR_HEAP_TYPE)
+	{
+		this->NumCopyCalls++;
+		for (UINT i = 0; i < numDestRanges; i++)
+		{
+			this->NumCopiedDescriptors += destRangeSizes ? destRangeSizes[i] : 1;
+		}
+	}
+
+	void CopyDescriptorsSimple(
+		UINT numDescriptors,
+		D3D12_CPU_DESCRIPTOR_HANDLE,
+		D3D12_CPU_DESCRIPTOR_HANDLE,
+		D3D12_DESCRIPTOR_HEAP_TYPE)
+	{
+		this->NumCopyCalls++;
+		this->NumCopiedDescriptors += numDescriptors;
+	}
+
+	std::atomic_uint64_t NumCopyCalls{ 0 };
+	std::atomic_uint64_t NumCopiedDescriptors{ 0 };
+	std::atomic_uint64_t NumCreatedCommandAllocators{ 0 };
+};
+
+class ID3D12Device1 : public ID3D12Device {};
+class ID3D12Device2 : public ID3D12Device1 {};
+
+// The real d3dx12.h is kept out with its include guard, the helpers Core uses follow.
+#include "d3dx12_stand_in.h"
@@ -0,0 +1,192 @@
+#pragma once
+
+// The d3dx12.h helpers the headless Core sources use, same names and arguments as the real ones.
+
+struct CD3DX12_DEFAULT {};
+inline const CD3DX12_DEFAULT D3D12_DEFAULT{};
+
+struct CD3DX12_RESOURCE_BARRIER : public D3D12_RESOURCE_BARRIER
+{
+	CD3DX12_RESOURCE_BARRIER() = default;
+	explicit CD3DX12_RESOURCE_BARRIER(D3D12_RESOURCE_BARRIER const& o) : D3D12_RESOURCE_BARRIER(o) {}
+
+	static inline CD3DX12_RESOURCE_BARRIER Transition(
+		ID3D12Resource* resource,
+		D3D12_RESOURCE_STATES stateBefore,
+		D3D12_RESOURCE_STATES stateAfter,
+		UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+		D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE)
+	{
+		D3D12_RESOURCE_BARRIER result = {};
+		result.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+		result.Flags = flags;
+		result.Transition.pResource = resource;
+		result.Transition.StateBefore = stateBefore;
+		result.Transition.StateAfter = stateAfter;
+		result.Transition.Subresource = subresource;
+		return CD3DX12_RESOURCE_BARRIER(result);
+	}
+
+	static inline CD3DX12_RESOURCE_BARRIER Aliasing(ID3D12Resource* resourceBefore, ID3D12Resource* resourceAfter)
+	{
+		D3D12_RESOURCE_BARRIER result = {};
+		result.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+		result.Aliasing.pResourceBefore = resourceBefore;
+		result.Aliasing.pResourceAfter = resourceAfter;
+		return CD3DX12_RESOURCE_BARRIER(result);
+	}
+
+	static inline CD3DX12_RESOURCE_BARRIER UAV(ID3D12Resource* resource)
+	{
+		D3D12_RESOURCE_BARRIER result = {};
+		result.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+		result.UAV.pResource = resource;
+		return CD3DX12_RESOURCE_BARRIER(result);
+	}
+};
+
+struct CD3DX12_CPU_DESCRIPTOR_HANDLE : public D3D12_CPU_DESCRIPTOR_HANDLE
+{
+	CD3DX12_CPU_DESCRIPTOR_HANDLE() = default;
+	explicit CD3DX12_CPU_DESCRIPTOR_HANDLE(D3D12_CPU_DESCRIPTOR_HANDLE const& o) : D3D12_CPU_DESCRIPTOR_HANDLE(o) {}
+	CD3DX12_CPU_DESCRIPTOR_HANDLE(CD3DX12_DEFAULT) { this->ptr = 0; }
+
+	CD3DX12_CPU_DESCRIPTOR_HANDLE(D3D12_CPU_DESCRIPTOR_HANDLE const& other, INT offsetScaledByIncrementSize)
+	{
+		this->ptr = static_cast<SIZE_T>(static_cast<int64_t>(other.ptr) + offsetScaledByIncrementSize);
+	}
+
+	CD3DX12_CPU_DESCRIPTOR_HANDLE(D3D12_CPU_DESCRIPTOR_HANDLE const& other, INT offsetInDescriptors, UINT descriptorIncrementSize)
+	{
+		this->ptr = static_cast<SIZE_T>(
+			static_cast<int64_t>(other.ptr) + static_cast<int64_t>(offsetInDescriptors) * descriptorIncrementSize);
+	}
+
+	CD3DX12_CPU_DESCRIPTOR_HANDLE& Offset(INT offsetInDescriptors, UINT descriptorIncrementSize)
+	{
+		this->ptr = static_cast<SIZE_T>(
+			static_cast<int64_t>(this->ptr) + static_cast<int64_t>(offsetInDescriptors) * descriptorIncrementSize);
+		return *this;
+	}
+
+	CD3DX12_CPU_DESCRIPTOR_HANDLE& Offset(INT offsetScaledByIncrementSize)
+	{
+		this->ptr = static_cast<SIZE_T>(static_cast<int64_t>(this->ptr) + offsetScaledByIncrementSize);
+		return *this;
+	}
+
+	CD3DX12_CPU_DESCRIPTOR_HANDLE& operator=(D3D12_CPU_DESCRIPTOR_HANDLE const& other) { this->ptr = other.ptr; return *this; }
+
+	bool operator==(D3D12_CPU_DESCRIPTOR_HANDLE const& other) const { return this->ptr == other.ptr; }
+	bool operator!=(D3D12_CPU_DESCRIPTOR_HANDLE const& other) const { return this->ptr != other.ptr; }
+};
+
+struct CD3DX12_GPU_DESCRIPTOR_HANDLE : public D3D12_GPU_DESCRIPTOR_HANDLE
+{
+	CD3DX12_GPU_DESCRIPTOR_HANDLE() = default;
+	explicit CD3DX12_GPU_DESCRIPTOR_HANDLE(D3D12_GPU_DESCRIPTOR_HANDLE const& o) : D3D12_GPU_DESCRIPTOR_HANDLE(o) {}
+	CD3DX12_GPU_DESCRIPTOR_HANDLE(CD3DX12_DEFAULT) { this->ptr = 0; }
+
+	CD3DX12_GPU_DESCRIPTOR_HANDLE(D3D12_GPU_DESCRIPTOR_HANDLE const& other, INT offsetScaledByIncrementSize)
+	{
+		this->ptr = static_cast<UINT64>(static_cast<int64_t>(other.ptr) + offsetScaledByIncrementSize);
+	}
+
+	CD3DX12_GPU_DESCRIPTOR_HANDLE(D3D12_GPU_DESCRIPTOR_HANDLE const& other, INT offsetInDescriptors, UINT descriptorIncrementSize)
+	{
+		this->ptr = static_cast<UINT64>(
+			static_cast<int64_t>(other.ptr) + static_cast<int64_t>(offsetInDescriptors) * descriptorIncrementSize);
+	}
+
+	CD3DX12_GPU_DESCRIPTOR_HANDLE& Offset(INT offsetInDescriptors, UINT descriptorIncrementSize)
+	{
+		this->ptr = static_cast<UINT64>(
+			static_cast<int64_t>(this->ptr) + static_cast<int64_t>(offsetInDescriptors) * descriptorIncrementSize);
+		return *this;
+	}
+
+	CD3DX12_GPU_DESCRIPTOR_HANDLE& Offset(INT offsetScaledByIncrementSize)
+	{
+		this->ptr = static_cast<UINT64>(static_cast<int64_t>(this->ptr) + offsetScaledByIncrementSize);
+		return *this;
+	}
+
+	CD3DX12_GPU_DESCRIPTOR_HANDLE& operator=(D3D12_GPU_DESCRIPTOR_HANDLE const& other) { this->ptr = other.ptr; return *this; }
+
+	bool operator==(D3D12_GPU_DESCRIPTOR_HANDLE const& other) const { return this->ptr == other.ptr; }
+	bool operator!=(D3D12_GPU_DESCRIPTOR_HANDLE const& other) const { return this->ptr != other.ptr; }
+};
+
+struct CD3DX12_DESCRIPTOR_RANGE1 : public D3D12_DESCRIPTOR_RANGE1
+{
+	CD3DX12_DESCRIPTOR_RANGE1() = default;
+
+	CD3DX12_DESCRIPTOR_RANGE1(
+		D3D12_DESCRIPTOR_RANGE_TYPE rangeType,
+		UINT numDescriptors,
+		UINT baseShaderRegister,
+		UINT registerSpace = 0,
+		D3D12_DESCRIPTOR_RANGE_FLAGS flags = D3D12_DESCRIPTOR_RANGE_FLAG_NONE,
+		UINT offsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND)
+	{
+		this->Init(rangeType, numDescriptors, baseShaderRegister, registerSpace, flags, offsetInDescriptorsFromTableStart);
+	}
+
+	void Init(
+		D3D12_DESCRIPTOR_RANGE_TYPE rangeType,
+		UINT numDescriptors,
+		UINT baseShaderRegister,
+		UINT registerSpace = 0,
+		D3D12_DESCRIPTOR_RANGE_FLAGS flags = D3D12_DESCRIPTOR_RANGE_FLAG_NONE,
+		UINT offsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND)
+	{
+		this->RangeType = rangeType;
+		this->NumDescriptors = numDescriptors;
+		this->BaseShaderRegister = baseShaderRegister;
+		this->RegisterSpace = registerSpace;
+		this->Flags = flags;
+		this->OffsetInDescriptorsFromTableStart = offsetInDescriptorsFromTableStart;
+	}
+};
+
+struct CD3DX12_ROOT_PARAMETER1 : public D3D12_ROOT_PARAMETER1
+{
+	CD3DX12_ROOT_PARAMETER1() = default;
+
+	void InitAsDescriptorTable(
+		UINT numDescriptorRanges,
+		const D3D12_DESCRIPTOR_RANGE1* descriptorRanges,
+		D3D12_SHADER_VISIBILITY visibility = D3D12_SHADER_VISIBILITY_ALL)
+	{
+		this->ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+		this->ShaderVisibility = visibility;
+		this->DescriptorTable.NumDescriptorRanges = numDescriptorRanges;
+		this->DescriptorTable.pDescriptorRanges = descriptorRanges;
+	}
+
+	void InitAsConstants(
+		UINT num32BitValues,
+		UINT shaderRegister,
+		UINT registerSpace = 0,
+		D3D12_SHADER_VISIBILITY visibility = D3D12_SHADER_VISIBILITY_ALL)
+	{
+		this->ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+		this->ShaderVisibility = visibility;
+		this->Constants.Num32BitValues = num32BitValues;
+		this->Constants.ShaderRegister = shaderRegister;
+		this->Constants.RegisterSpace = registerSpace;
+	}
+
+	void InitAsConstantBufferView(
+		UINT shaderRegister,
+		UINT registerSpace = 0,
+		UINT flags = 0,
+		D3D12_SHADER_VISIBILITY visibility = D3D12_SHADER_VISIBILITY_ALL)
+	{
+		this->ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+		this->ShaderVisibility = visibility;
+		this->Descriptor.ShaderRegister = shaderRegister;
+		this->Descriptor.RegisterSpace = registerSpace;
+		this->Descriptor.Flags = flags;
+	}
+};
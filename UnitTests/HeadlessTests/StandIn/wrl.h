@@ -0,0 +1,108 @@
+#pragma once
+
+#include <utility>
+
+// Stand-in for the WRL ComPtr, enough of it for the Core sources the headless tests build.
+namespace Microsoft
+{
+	namespace WRL
+	{
+		template<class Type_>
+		class ComPtr
+		{
+		public:
+			ComPtr() = default;
+			ComPtr(decltype(nullptr)) {}
+
+			ComPtr(Type_* pointer)
+				: m_pointer(pointer)
+			{
+				this->InternalAddRef();
+			}
+
+			ComPtr(ComPtr const& other)
+				: m_pointer(other.m_pointer)
+			{
+				this->InternalAddRef();
+			}
+
+			template<class Other_>
+			ComPtr(ComPtr<Other_> const& other)
+				: m_pointer(other.Get())
+			{
+				this->InternalAddRef();
+			}
+
+			ComPtr(ComPtr&& other) noexcept
+				: m_pointer(other.m_pointer)
+			{
+				other.m_pointer = nullptr;
+			}
+
+			~ComPtr() { this->InternalRelease(); }
+
+			ComPtr& operator=(ComPtr other)
+			{
+				std::swap(this->m_pointer, other.m_pointer);
+				return *this;
+			}
+
+			Type_* Get() const { return this->m_pointer; }
+			Type_* operator->() const { return this->m_pointer; }
+			explicit operator bool() const { return this->m_pointer != nullptr; }
+
+			Type_** GetAddressOf() { return &this->m_pointer; }
+
+			Type_** ReleaseAndGetAddressOf()
+			{
+				this->InternalRelease();
+				return &this->m_pointer;
+			}
+
+			Type_** operator&() { return this->ReleaseAndGetAddressOf(); }
+
+			void Attach(Type_* pointer)
+			{
+				this->InternalRelease();
+				this->m_pointer = pointer;
+			}
+
+			Type_* Detach()
+			{
+				Type_* pointer = this->m_pointer;
+				this->m_pointer = nullptr;
+				return pointer;
+			}
+
+			void Reset() { this->InternalRelease(); }
+
+		private:
+			void InternalAddRef()
+			{
+				if (this->m_pointer)
+				{
+					this->m_pointer->AddRef();
+				}
+			}
+
+			void InternalRelease()
+			{
+				Type_* pointer = this->m_pointer;
+				if (pointer)
+				{
+					this->m_pointer = nullptr;
+					pointer->Release();
+				}
+			}
+
+		private:
+			Type_* m_pointer = nullptr;
+		};
+
+		template<class A_, class B_>
+		bool operator==(ComPtr<A_> const& a, ComPtr<B_> const& b) { return a.Get() == b.Get(); }
+
+		template<class A_, class B_>
+		bool operator!=(ComPtr<A_> const& a, ComPtr<B_> const& b) { return a.Get() != b.Get(); }
+	}
+}
@@ -0,0 +1,105 @@
+#include "Benchmark.h"
+
+#include "SubmissionReplay.h"
+#include "Log.h"
+
+using namespace Core;
+using namespace SubmissionReplay;
+
+namespace
+{
+	constexpr uint32_t ResourcesPerList = 4;
+
+	struct Result
+	{
+		double MicrosecondsPerList;
+		uint64_t NumExecuteCalls;
+		uint64_t NumExecutedLists;
+	};
+
+	// Every frame records numLists command lists, each rendering to and then sampling its own textures.
+	Result Run(uint32_t numLists, uint32_t numFrames, bool isBatched)
+	{
+		QueueDependencyTracker queueDependencyTracker;
+		DeferredReleaseQueue deferredReleaseQueue;
+		ReplayQueue queue(D3D12_COMMAND_LIST_TYPE_DIRECT, queueDependencyTracker, deferredReleaseQueue);
+		std::mutex submitMutex;
+
+		auto textures = CreateTextures(numLists * ResourcesPerList, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+		std::vector<ReplayCommandList> commandLists(numLists);
+		std::vector<std::vector<ID3D12Resource*>> listResources(numLists);
+		std::vector<ReplayCommandList*> batch;
+		for (uint32_t i = 0; i < numLists; i++)
+		{
+			for (uint32_t j = 0; j < ResourcesPerList; j++)
+			{
+				listResources[i].push_back(textures[i * ResourcesPerList + j].Get());
+			}
+
+			batch.push_back(&commandLists[i]);
+		}
+
+		// Only the submissions are timed, recording is the same either way.
+		double seconds = 0.0;
+		for (uint32_t frame = 0; frame < numFrames; frame++)
+		{
+			for (uint32_t i = 0; i < numLists; i++)
+			{
+				commandLists[i].Reset();
+				commandLists[i].RecordPass(listResources[i], D3D12_RESOURCE_STATE_RENDER_TARGET);
+				commandLists[i].RecordPass(listResources[i], D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+			}
+
+			seconds += Benchmark::MeasureSeconds([&] {
+				if (isBatched)
+				{
+					queue.Execute(batch, submitMutex);
+				}
+				else
+				{
+					for (auto commandList : batch)
+					{
+						queue.Execute({ commandList }, submitMutex);
+					}
+				}
+				});
+		}
+
+		Result result = {};
+		result.MicrosecondsPerList = seconds * 1e6 / (static_cast<double>(numFrames) * numLists);
+		result.NumExecuteCalls = queue.GetD3DQueue()->NumExecuteCalls;
+		result.NumExecutedLists = queue.GetD3DQueue()->NumExecutedCommandLists;
+		return result;
+	}
+}
+
+// Per command list cost of submitting a frame's command lists one at a time or with one ExecuteCommandLists call.
+int main(int argc, char** argv)
+{
+	Log::Initialize();
+
+	const bool isQuick = Benchmark::IsQuick(argc, argv);
+	const uint32_t numListsTotal = isQuick ? 2000 : 400000;
+
+	Benchmark::Table table({ "Lists per frame", "Single us", "Batched us", "Speedup", "Single calls", "Batched calls" });
+
+	for (uint32_t numLists : { 1u, 4u, 16u, 64u })
+	{
+		uint32_t numFrames = std::max(numListsTotal / numLists, 1u);
+
+		Result single = Run(numLists, numFrames, false);
+		Result batched = Run(numLists, numFrames, true);
+
+		table.PrintRow({
+			fmt::format("{}", numLists),
+			fmt::format("{:.3f}", single.MicrosecondsPerList),
+			fmt::format("{:.3f}", batched.MicrosecondsPerList),
+			fmt::format("{:.2f}x", single.MicrosecondsPerList / batched.MicrosecondsPerList),
+			fmt::format("{}", single.NumExecuteCalls),
+			fmt::format("{}", batched.NumExecuteCalls) });
+	}
+
+	printf("\nus: CPU time to submit one command list, closing included. Calls: ExecuteCommandLists calls on the queue.\n");
+	return 0;
+}
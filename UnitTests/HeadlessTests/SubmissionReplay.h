@@ -0,0 +1,231 @@
+#pragma once
+
+#include <d3d12.h>
+#include <wrl.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "DeferredReleaseQueue.h"
+#include "Fence.h"
+#include "QueueDependencyTracker.h"
+#include "Dx12/ResourceStateTracker.h"
+
+/**
+ * The CPU side of CommandQueue::ExecuteCommandLists, step by step, with the real state
+ * tracker, queue dependency tracker and deferred release queue. CommandQueue itself needs a
+ * device, here the D3D12 queue and command lists are stand-ins and the GPU completes every
+ * submission as soon as it's signaled. Keep it in line with CommandQueue.cpp.
+ */
+namespace SubmissionReplay
+{
+	struct ReplayCommandList
+	{
+		ReplayCommandList()
+		{
+			this->D3DCommandList.Attach(new ID3D12GraphicsCommandList2());
+		}
+
+		// Transitions the resources the way a pass does and flushes like a draw would.
+		void RecordPass(std::vector<ID3D12Resource*> const& resources, D3D12_RESOURCE_STATES state)
+		{
+			for (auto resource : resources)
+			{
+				this->Tracker.TransitionResource(resource, state);
+			}
+
+			this->Tracker.FlushResourceBarriers(this->D3DCommandList.Get());
+		}
+
+		void Close()
+		{
+			this->Tracker.EndSplitTransitions();
+			this->Tracker.FlushResourceBarriers(this->D3DCommandList.Get());
+			this->D3DCommandList->Close();
+		}
+
+		void Reset()
+		{
+			this->Tracker.Reset();
+			this->D3DCommandList->Reset(nullptr, nullptr);
+		}
+
+		Core::ResourceStateTracker Tracker;
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> D3DCommandList;
+	};
+
+	class ReplayQueue
+	{
+	public:
+		ReplayQueue(
+			D3D12_COMMAND_LIST_TYPE type,
+			Core::QueueDependencyTracker& queueDependencyTracker,
+			Core::DeferredReleaseQueue& deferredReleaseQueue)
+			: m_type(type)
+			, m_queueDependencyTracker(queueDependencyTracker)
+			, m_deferredReleaseQueue(deferredReleaseQueue)
+			, m_fenceValue(0)
+		{
+			this->m_d3dQueue.Attach(new ID3D12CommandQueue());
+			this->m_queueDependencyTracker.RegisterQueue(type, &this->m_fence);
+			this->m_deferredReleaseQueue.RegisterFence(&this->m_fence, 0);
+		}
+
+		/**
+		 * Submits the command lists together. submitMutex stands in for the queue's submit
+		 * mutex, passing the same one to every queue serializes them like a device wide lock.
+		 */
+		uint64_t Execute(std::vector<ReplayCommandList*> const& commandLists, std::mutex& submitMutex)
+		{
+			for (auto commandList : commandLists)
+			{
+				commandList->Close();
+			}
+
+			std::lock_guard<std::mutex> submitLock(submitMutex);
+
+			std::vector<ID3D12CommandList*> d3d12CommandLists;
+			d3d12CommandLists.reserve(commandLists.size() + 1);
+
+			auto pendingCommandList = this->GetCommandList();
+			std::vector<std::unique_ptr<ReplayCommandList>> toBeQueued;
+			d3d12CommandLists.push_back(pendingCommandList->D3DCommandList.Get());
+
+			uint64_t fenceValue = this->m_fenceValue + 1;
+
+			Core::PendingBarrierBatch pendingBarrierBatch;
+			std::vector<std::vector<D3D12_RESOURCE_BARRIER>> orderedBarriers(commandLists.size());
+			std::vector<Core::QueueDependencyTracker::ResourceUsage> resourceUsages;
+			std::vector<Core::QueueDependencyTracker::QueueWait> queueWaits;
+
+			Core::ResourceStateTracker::Lock();
+			for (size_t i = 0; i < commandLists.size(); i++)
+			{
+				commandLists[i]->Tracker.ResolvePendingResourceBarriers(pendingBarrierBatch, orderedBarriers[i]);
+				commandLists[i]->Tracker.CommitFinalResourceStates();
+			}
+
+			Core::ResourceStateTracker::DecayResourceStates(pendingBarrierBatch, this->m_type);
+
+			resourceUsages.reserve(pendingBarrierBatch.BatchResources.size());
+			for (auto const& batchResource : pendingBarrierBatch.BatchResources)
+			{
+				resourceUsages.push_back({ batchResource.first, batchResource.second });
+			}
+
+			queueWaits = this->m_queueDependencyTracker.ResolveWaits(this->m_type, resourceUsages);
+			this->m_queueDependencyTracker.RecordSubmission(this->m_type, fenceValue, resourceUsages);
+			Core::ResourceStateTracker::Unlock();
+
+			for (size_t i = 0; i < commandLists.size(); i++)
+			{
+				if (!orderedBarriers[i].empty())
+				{
+					auto orderedCommandList = this->GetCommandList();
+					orderedCommandList->D3DCommandList->ResourceBarrier(
+						static_cast<UINT>(orderedBarriers[i].size()),
+						orderedBarriers[i].data());
+					orderedCommandList->D3DCommandList->Close();
+
+					d3d12CommandLists.push_back(orderedCommandList->D3DCommandList.Get());
+					toBeQueued.push_back(std::move(orderedCommandList));
+				}
+
+				d3d12CommandLists.push_back(commandLists[i]->D3DCommandList.Get());
+			}
+
+			auto& leadingBarriers = pendingBarrierBatch.LeadingBarriers;
+			if (!leadingBarriers.empty())
+			{
+				pendingCommandList->D3DCommandList->ResourceBarrier(
+					static_cast<UINT>(leadingBarriers.size()),
+					leadingBarriers.data());
+			}
+
+			pendingCommandList->D3DCommandList->Close();
+			toBeQueued.push_back(std::move(pendingCommandList));
+
+			this->NumQueueWaits += queueWaits.size();
+
+			size_t firstCommandList = leadingBarriers.empty() ? 1 : 0;
+			this->m_d3dQueue->ExecuteCommandLists(
+				static_cast<UINT>(d3d12CommandLists.size() - firstCommandList),
+				d3d12CommandLists.data() + firstCommandList);
+
+			// Signal, the stand-in GPU is done right away.
+			this->m_fenceValue = fenceValue;
+			this->m_deferredReleaseQueue.SetLastSubmittedValue(&this->m_fence, fenceValue);
+			this->m_fence.Signal(fenceValue);
+
+			for (auto commandList : commandLists)
+			{
+				this->m_deferredReleaseQueue.Release(&this->m_fence, fenceValue, commandList->D3DCommandList);
+			}
+
+			this->m_deferredReleaseQueue.ReleaseCompleted(&this->m_fence);
+
+			// Recycled once their fence completed, which it already has.
+			for (auto& commandList : toBeQueued)
+			{
+				commandList->Reset();
+				this->m_availableCommandLists.push_back(std::move(commandList));
+			}
+
+			return fenceValue;
+		}
+
+		ID3D12CommandQueue* GetD3DQueue() const { return this->m_d3dQueue.Get(); }
+
+		uint64_t NumQueueWaits = 0;
+
+	private:
+		std::unique_ptr<ReplayCommandList> GetCommandList()
+		{
+			if (this->m_availableCommandLists.empty())
+			{
+				return std::make_unique<ReplayCommandList>();
+			}
+
+			auto commandList = std::move(this->m_availableCommandLists.back());
+			this->m_availableCommandLists.pop_back();
+			return commandList;
+		}
+
+	private:
+		const D3D12_COMMAND_LIST_TYPE m_type;
+
+		Core::QueueDependencyTracker& m_queueDependencyTracker;
+		Core::DeferredReleaseQueue& m_deferredReleaseQueue;
+
+		Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_d3dQueue;
+		Core::SoftwareFence m_fence;
+		uint64_t m_fenceValue;
+
+		// Only used under the submit mutex.
+		std::vector<std::unique_ptr<ReplayCommandList>> m_availableCommandLists;
+	};
+
+	// Textures registered with the global state tracker, released with the vector.
+	inline std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> CreateTextures(uint32_t count, D3D12_RESOURCE_STATES state)
+	{
+		D3D12_RESOURCE_DESC desc = {};
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+		desc.Width = 256;
+		desc.Height = 256;
+		desc.DepthOrArraySize = 1;
+		desc.MipLevels = 1;
+		desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.SampleDesc.Count = 1;
+		desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+		std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> textures(count);
+		for (auto& texture : textures)
+		{
+			texture.Attach(new ID3D12Resource(desc));
+			Core::ResourceStateTracker::AddGlobalResourceState(texture.Get(), state);
+		}
+
+		return textures;
+	}
+}
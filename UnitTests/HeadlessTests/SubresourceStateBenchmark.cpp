@@ -0,0 +1,327 @@
+#include "Benchmark.h"
+
+#include <stdlib.h>
+#include <atomic>
+#include <map>
+#include <new>
+
+#include "SubmissionReplay.h"
+#include "SubresourceRunList.h"
+#include "Log.h"
+
+using namespace Core;
+using namespace SubmissionReplay;
+
+// Counts every heap allocation of the benchmark, the point of the run list is to not make any.
+namespace
+{
+	std::atomic_uint64_t g_numAllocations(0);
+}
+
+void* operator new(size_t size)
+{
+	g_numAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* memory = malloc(size ? size : 1))
+	{
+		return memory;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+
+namespace
+{
+	constexpr uint32_t AllSubresources = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+	// Resources of the trace.
+	enum TraceResource : uint32_t
+	{
+		Pano,
+		Cubemap,
+		CubemapStaging,
+		IrradianceMap,
+		IrradianceStaging,
+		NumTraceResources,
+	};
+
+	constexpr uint32_t CubemapMips = 10;   // 512x512 faces.
+	constexpr uint32_t IrradianceMips = 6; // 32x32 faces.
+	constexpr uint32_t NumFaces = 6;
+
+	struct TraceBarrier
+	{
+		uint32_t Resource;
+		uint32_t Subresource;
+		D3D12_RESOURCE_STATES State;
+		bool IsDispatch; // Flushes the barriers recorded so far, like a Dispatch or Copy does.
+	};
+
+	using Trace = std::vector<TraceBarrier>;
+
+	uint32_t CalcSubresource(uint32_t mip, uint32_t face, uint32_t numMips)
+	{
+		return mip + face * numMips;
+	}
+
+	/**
+	 * PanoToCubemap followed by GenerateIrradianceMap, both through UAV staging textures. The
+	 * dispatches transition the mips they write on every face to UNORDERED_ACCESS, and then
+	 * to NON_PIXEL_SHADER_RESOURCE for the passes reading them, one subresource at a time.
+	 */
+	Trace BuildIblTrace()
+	{
+		Trace trace;
+		auto transition = [&](uint32_t resource, uint32_t subresource, D3D12_RESOURCE_STATES state) {
+			trace.push_back({ resource, subresource, state, false });
+		};
+
+		auto dispatch = [&]() {
+			trace.push_back({ 0, 0, D3D12_RESOURCE_STATE_COMMON, true });
+		};
+
+		auto generate = [&](uint32_t source, uint32_t target, uint32_t staging, uint32_t numMips) {
+			transition(staging, AllSubresources, D3D12_RESOURCE_STATE_COPY_DEST);
+			transition(target, AllSubresources, D3D12_RESOURCE_STATE_COPY_SOURCE);
+			dispatch();
+
+			transition(source, AllSubresources, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+
+			// At most five mips per pass.
+			for (uint32_t firstMip = 0; firstMip < numMips; firstMip += 5)
+			{
+				uint32_t lastMip = std::min(firstMip + 5, numMips);
+				for (uint32_t mip = firstMip; mip < lastMip; mip++)
+				{
+					for (uint32_t face = 0; face < NumFaces; face++)
+					{
+						transition(staging, CalcSubresource(mip, face, numMips), D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+					}
+				}
+
+				dispatch();
+
+				for (uint32_t mip = firstMip; mip < lastMip; mip++)
+				{
+					for (uint32_t face = 0; face < NumFaces; face++)
+					{
+						transition(staging, CalcSubresource(mip, face, numMips), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+					}
+				}
+			}
+
+			transition(staging, AllSubresources, D3D12_RESOURCE_STATE_COPY_SOURCE);
+			transition(target, AllSubresources, D3D12_RESOURCE_STATE_COPY_DEST);
+			dispatch();
+
+			transition(target, AllSubresources, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+			dispatch();
+		};
+
+		generate(Pano, Cubemap, CubemapStaging, CubemapMips);
+		generate(Cubemap, IrradianceMap, IrradianceStaging, IrradianceMips);
+		return trace;
+	}
+
+	uint32_t CountBarriers(Trace const& trace)
+	{
+		return static_cast<uint32_t>(std::count_if(trace.begin(), trace.end(), [](TraceBarrier const& barrier) {
+			return !barrier.IsDispatch;
+			}));
+	}
+
+	// ResourceState as it was before SubresourceRunList, copied on every transition.
+	struct MapResourceState
+	{
+		D3D12_RESOURCE_STATES State = D3D12_RESOURCE_STATE_COMMON;
+		std::map<uint32_t, D3D12_RESOURCE_STATES> SubresourceState;
+
+		D3D12_RESOURCE_STATES GetSubresourceState(uint32_t subresource) const
+		{
+			auto iter = this->SubresourceState.find(subresource);
+			return iter != this->SubresourceState.end() ? iter->second : this->State;
+		}
+
+		void SetSubresourceState(uint32_t subresource, D3D12_RESOURCE_STATES state)
+		{
+			if (subresource == AllSubresources)
+			{
+				this->State = state;
+				this->SubresourceState.clear();
+			}
+			else
+			{
+				this->SubresourceState[subresource] = state;
+			}
+		}
+	};
+
+	struct RunListResourceState
+	{
+		D3D12_RESOURCE_STATES State = D3D12_RESOURCE_STATE_COMMON;
+		SubresourceRunList<D3D12_RESOURCE_STATES> SubresourceState;
+
+		D3D12_RESOURCE_STATES GetSubresourceState(uint32_t subresource) const
+		{
+			D3D12_RESOURCE_STATES state = this->State;
+			this->SubresourceState.Find(subresource, state);
+			return state;
+		}
+
+		void SetSubresourceState(uint32_t subresource, D3D12_RESOURCE_STATES state)
+		{
+			if (subresource == AllSubresources)
+			{
+				this->State = state;
+				this->SubresourceState.Clear();
+			}
+			else
+			{
+				this->SubresourceState.Set(subresource, state);
+			}
+		}
+	};
+
+	struct Result
+	{
+		double NanosecondsPerBarrier;
+		double AllocationsPerBarrier;
+	};
+
+	/**
+	 * The known final state bookkeeping of ResourceStateTracker::ResourceBarrier on its own:
+	 * look up the state before, then record the state after. isCopied copies the state first
+	 * like the tracker did with the map.
+	 */
+	template<class ResourceState_>
+	Result RunStates(Trace const& trace, uint32_t numFrames, bool isCopied)
+	{
+		uint64_t numChanged = 0;
+		uint64_t numAllocations = g_numAllocations.load(std::memory_order_relaxed);
+
+		double seconds = Benchmark::MeasureSeconds([&] {
+			for (uint32_t frame = 0; frame < numFrames; frame++)
+			{
+				ResourceState_ finalStates[NumTraceResources];
+				for (auto const& barrier : trace)
+				{
+					if (barrier.IsDispatch)
+					{
+						continue;
+					}
+
+					auto& finalState = finalStates[barrier.Resource];
+					D3D12_RESOURCE_STATES stateBefore;
+					if (isCopied)
+					{
+						ResourceState_ resourceState = finalState;
+						stateBefore = resourceState.GetSubresourceState(barrier.Subresource);
+					}
+					else
+					{
+						stateBefore = finalState.GetSubresourceState(barrier.Subresource);
+					}
+
+					numChanged += stateBefore != barrier.State;
+					finalState.SetSubresourceState(barrier.Subresource, barrier.State);
+				}
+			}
+			});
+
+		numAllocations = g_numAllocations.load(std::memory_order_relaxed) - numAllocations;
+
+		// Keeps the loop from being optimized away.
+		if (numChanged == 0)
+		{
+			printf("No state changed\n");
+		}
+
+		double numBarriers = static_cast<double>(numFrames) * CountBarriers(trace);
+		return { seconds * 1e9 / numBarriers, numAllocations / numBarriers };
+	}
+
+	// The trace recorded on the real state tracker, one command list per frame.
+	Result RunTracker(Trace const& trace, uint32_t numFrames)
+	{
+		std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> resources;
+		for (uint32_t i = 0; i < NumTraceResources; i++)
+		{
+			D3D12_RESOURCE_DESC desc = {};
+			desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+			desc.Width = i == IrradianceMap || i == IrradianceStaging ? 32 : 512;
+			desc.Height = desc.Width;
+			desc.DepthOrArraySize = i == Pano ? 1 : NumFaces;
+			desc.MipLevels = static_cast<UINT16>(i == Pano ? 1 : (desc.Width == 32 ? IrradianceMips : CubemapMips));
+			desc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+			desc.SampleDesc.Count = 1;
+
+			resources.emplace_back();
+			resources.back().Attach(new ID3D12Resource(desc));
+			ResourceStateTracker::AddGlobalResourceState(resources.back().Get(), D3D12_RESOURCE_STATE_COMMON);
+		}
+
+		ReplayCommandList commandList;
+
+		// Warm up the command list's vectors and maps, the frames after reuse them.
+		auto record = [&]() {
+			for (auto const& barrier : trace)
+			{
+				if (barrier.IsDispatch)
+				{
+					commandList.Tracker.FlushResourceBarriers(commandList.D3DCommandList.Get());
+				}
+				else
+				{
+					commandList.Tracker.TransitionResource(resources[barrier.Resource].Get(), barrier.State, barrier.Subresource);
+				}
+			}
+
+			commandList.Close();
+			commandList.Reset();
+		};
+
+		record();
+
+		uint64_t numAllocations = g_numAllocations.load(std::memory_order_relaxed);
+		double seconds = Benchmark::MeasureSeconds([&] {
+			for (uint32_t frame = 0; frame < numFrames; frame++)
+			{
+				record();
+			}
+			});
+
+		numAllocations = g_numAllocations.load(std::memory_order_relaxed) - numAllocations;
+
+		double numBarriers = static_cast<double>(numFrames) * CountBarriers(trace);
+		return { seconds * 1e9 / numBarriers, numAllocations / numBarriers };
+	}
+}
+
+// Cost of tracking the subresource states of IBL precomputation, per transition.
+int main(int argc, char** argv)
+{
+	Log::Initialize();
+
+	const bool isQuick = Benchmark::IsQuick(argc, argv);
+	const uint32_t numFrames = isQuick ? 20 : 20000;
+
+	Trace trace = BuildIblTrace();
+
+	Benchmark::Table table({ "Final state storage", "ns per barrier", "Allocs per barrier" });
+	auto printRow = [&](const char* name, Result const& result) {
+		table.PrintRow({
+			name,
+			fmt::format("{:.1f}", result.NanosecondsPerBarrier),
+			fmt::format("{:.3f}", result.AllocationsPerBarrier) });
+	};
+
+	printRow("std::map, copied", RunStates<MapResourceState>(trace, numFrames, true));
+	printRow("std::map", RunStates<MapResourceState>(trace, numFrames, false));
+	printRow("SubresourceRunList", RunStates<RunListResourceState>(trace, numFrames, false));
+	printRow("ResourceStateTracker", RunTracker(trace, numFrames));
+
+	printf("\n%u transitions per frame, PanoToCubemap and GenerateIrradianceMap with per mip UAV writes.\n", CountBarriers(trace));
+	return 0;
+}
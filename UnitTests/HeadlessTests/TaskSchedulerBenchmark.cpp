@@ -0,0 +1,117 @@
+#include "Benchmark.h"
+
+#include <atomic>
+#include <thread>
+
+#include "TaskScheduler.h"
+#include "Log.h"
+
+using namespace Core;
+
+namespace
+{
+	// About a microsecond of work, the size of a small recording or culling task.
+	void Spin(uint32_t iterations)
+	{
+		volatile uint32_t value = 0;
+		for (uint32_t i = 0; i < iterations; i++)
+		{
+			value = value + i;
+		}
+	}
+
+	uint64_t Fibonacci(TaskScheduler& scheduler, uint32_t n)
+	{
+		if (n < 12)
+		{
+			return n < 2 ? n : Fibonacci(scheduler, n - 1) + Fibonacci(scheduler, n - 2);
+		}
+
+		uint64_t a = 0;
+		TaskGroup group;
+		scheduler.Run(group, [&] { a = Fibonacci(scheduler, n - 1); });
+		uint64_t b = Fibonacci(scheduler, n - 2);
+		scheduler.Wait(group);
+
+		return a + b;
+	}
+
+	void Report(Benchmark::Table const& table, const char* name, uint32_t numWorkers, double seconds, TaskScheduler::Statistics const& statistics)
+	{
+		double numExecuted = static_cast<double>(statistics.NumExecuted);
+		table.PrintRow({
+			name,
+			fmt::format("{}", numWorkers),
+			fmt::format("{:.2f}", numExecuted / seconds / 1e6),
+			fmt::format("{:.1f}%", numExecuted > 0 ? 100.0 * statistics.NumStolen / numExecuted : 0.0),
+			fmt::format("{:.1f}%", statistics.NumStealAttempts > 0 ? 100.0 * statistics.NumStolen / statistics.NumStealAttempts : 0.0),
+			fmt::format("{:.1f}", seconds * 1e3) });
+	}
+}
+
+// Task throughput and steal rates of the scheduler over a range of worker counts.
+int main(int argc, char** argv)
+{
+	Log::Initialize();
+
+	const bool isQuick = Benchmark::IsQuick(argc, argv);
+	const uint32_t numTasks = isQuick ? 20000 : 1000000;
+	const uint32_t fibonacciN = isQuick ? 20 : 30;
+	const uint32_t maxWorkers = std::max(std::thread::hardware_concurrency(), 2u);
+
+	Benchmark::Table table({ "Workload", "Workers", "MTasks/s", "Stolen", "StealHit", "ms" });
+
+	for (uint32_t numWorkers = 1; numWorkers <= maxWorkers; numWorkers *= 2)
+	{
+		// Independent tasks run from outside, they all go through the shared queue.
+		{
+			TaskScheduler scheduler(numWorkers);
+			std::atomic_uint32_t numRun(0);
+
+			double seconds = Benchmark::MeasureSeconds([&] {
+				TaskGroup group;
+				for (uint32_t i = 0; i < numTasks; i++)
+				{
+					scheduler.Run(group, [&numRun] { Spin(200); numRun++; });
+				}
+
+				scheduler.Wait(group);
+				});
+
+			Report(table, "External Run", numWorkers, seconds, scheduler.GetStatistics());
+		}
+
+		// Range splitting, the idle workers steal the upper halves.
+		{
+			TaskScheduler scheduler(numWorkers);
+
+			double seconds = Benchmark::MeasureSeconds([&] {
+				TaskGroup group;
+				scheduler.Run(group, [&] {
+					scheduler.ParallelFor(numTasks, 16, [](uint32_t begin, uint32_t end) { Spin(200 * (end - begin)); });
+					});
+				scheduler.Wait(group);
+				});
+
+			Report(table, "ParallelFor grain 16", numWorkers, seconds, scheduler.GetStatistics());
+		}
+
+		// Deep fork/join with tiny tasks, mostly measures the deque and the steals.
+		{
+			TaskScheduler scheduler(numWorkers);
+
+			uint64_t result = 0;
+			double seconds = Benchmark::MeasureSeconds([&] { result = Fibonacci(scheduler, fibonacciN); });
+
+			if (result == 0)
+			{
+				return 1;
+			}
+
+			Report(table, "Recursive fork/join", numWorkers, seconds, scheduler.GetStatistics());
+		}
+	}
+
+	printf("\nStolen: tasks run by another worker than the one that pushed them. StealHit: steal attempts that found a task.\n");
+	return 0;
+}
@@ -0,0 +1,166 @@
+#include "HeadlessTest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "TaskScheduler.h"
+
+using namespace Core;
+
+namespace
+{
+	uint64_t Fibonacci(TaskScheduler& scheduler, uint32_t n)
+	{
+		if (n < 2)
+		{
+			return n;
+		}
+
+		uint64_t a = 0;
+		TaskGroup group;
+		scheduler.Run(group, [&] { a = Fibonacci(scheduler, n - 1); });
+		uint64_t b = Fibonacci(scheduler, n - 2);
+		scheduler.Wait(group);
+
+		return a + b;
+	}
+}
+
+HEADLESS_TEST(RunsEveryTaskOfAGroup)
+{
+	TaskScheduler scheduler(3);
+
+	std::atomic_uint32_t numRun(0);
+	TaskGroup group;
+	for (uint32_t i = 0; i < 1000; i++)
+	{
+		scheduler.Run(group, [&numRun] { numRun++; });
+	}
+
+	scheduler.Wait(group);
+
+	CHECK(group.IsDone());
+	CHECK(numRun == 1000);
+	CHECK(scheduler.GetStatistics().NumExecuted == 1000);
+}
+
+HEADLESS_TEST(TasksForkAndJoinInsideTasks)
+{
+	TaskScheduler scheduler(3);
+	CHECK(Fibonacci(scheduler, 20) == 6765);
+}
+
+HEADLESS_TEST(WaitsWithoutWorkers)
+{
+	// One worker, the waiting thread runs the shared tasks itself while it's busy.
+	TaskScheduler scheduler(1);
+	CHECK(scheduler.GetNumWorkers() == 1);
+	CHECK(Fibonacci(scheduler, 15) == 610);
+}
+
+HEADLESS_TEST(ParallelForVisitsEveryIndexOnce)
+{
+	TaskScheduler scheduler(3);
+
+	for (uint32_t grainSize : { 1u, 7u, 64u, 5000u })
+	{
+		std::vector<std::atomic_uint32_t> visits(4099);
+		scheduler.ParallelFor(static_cast<uint32_t>(visits.size()), grainSize, [&](uint32_t begin, uint32_t end) {
+			CHECK(begin < end);
+			CHECK(end - begin <= grainSize);
+			for (uint32_t i = begin; i < end; i++)
+			{
+				visits[i]++;
+			}
+			});
+
+		uint32_t numVisitedOnce = 0;
+		for (auto const& count : visits)
+		{
+			numVisitedOnce += count == 1 ? 1 : 0;
+		}
+
+		CHECK(numVisitedOnce == visits.size());
+	}
+
+	bool isCalled = false;
+	scheduler.ParallelFor(0, [&](uint32_t) { isCalled = true; });
+	CHECK(!isCalled);
+}
+
+HEADLESS_TEST(RunsTasksOnceTheWorkerDequeIsFull)
+{
+	TaskScheduler scheduler(2);
+
+	// More tasks than a worker deque holds, run from inside a worker.
+	std::atomic_uint32_t numRun(0);
+	TaskGroup outer;
+	scheduler.Run(outer, [&] {
+		TaskGroup inner;
+		for (uint32_t i = 0; i < 10000; i++)
+		{
+			scheduler.Run(inner, [&numRun] { numRun++; });
+		}
+
+		scheduler.Wait(inner);
+		});
+
+	scheduler.Wait(outer);
+	CHECK(numRun == 10000);
+}
+
+HEADLESS_TEST(AcceptsTasksFromManyThreads)
+{
+	TaskScheduler scheduler(3);
+
+	std::atomic_uint32_t numRun(0);
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		threads.emplace_back([&] {
+			TaskGroup group;
+			for (uint32_t j = 0; j < 5000; j++)
+			{
+				scheduler.Run(group, [&numRun] { numRun++; });
+			}
+
+			scheduler.Wait(group);
+			});
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	CHECK(numRun == 20000);
+}
+
+HEADLESS_TEST(WorkersStealFromEachOther)
+{
+	TaskScheduler scheduler(2);
+
+	// The worker that pushed the inner task spins until it ran, only the other worker can steal it.
+	std::atomic_bool isInnerRun(false);
+	TaskGroup group;
+	scheduler.Run(group, [&] {
+		scheduler.Run(group, [&isInnerRun] { isInnerRun = true; });
+		while (!isInnerRun)
+		{
+			std::this_thread::yield();
+		}
+		});
+
+	while (!isInnerRun)
+	{
+		std::this_thread::yield();
+	}
+
+	scheduler.Wait(group);
+
+	auto statistics = scheduler.GetStatistics();
+	CHECK(statistics.NumExecuted == 2);
+	CHECK(statistics.NumStolen == 1);
+	CHECK(statistics.NumStealAttempts >= statistics.NumStolen);
+}
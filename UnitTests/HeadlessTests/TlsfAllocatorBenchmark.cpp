@@ -0,0 +1,254 @@
+#include "Benchmark.h"
+
+#include <map>
+#include <random>
+
+#include "TlsfAllocator.h"
+#include "Log.h"
+
+using namespace Core;
+
+namespace
+{
+	constexpr uint32_t InvalidOffset = TlsfAllocator::InvalidOffset;
+
+	/**
+	 * The free lists DescriptorAllocatorPage kept before TlsfAllocator, without the page's lock:
+	 * free blocks in a map by offset and a multimap by size, best fit through lower_bound.
+	 */
+	class MapFreeList
+	{
+	public:
+		explicit MapFreeList(uint32_t capacity)
+		{
+			this->AddNewBlock(0, capacity);
+		}
+
+		uint32_t Allocate(uint32_t size)
+		{
+			auto smallestBlockIt = this->m_freeListBySize.lower_bound(size);
+			if (smallestBlockIt == this->m_freeListBySize.end())
+			{
+				return InvalidOffset;
+			}
+
+			uint32_t blockSize = smallestBlockIt->first;
+			auto offsetIt = smallestBlockIt->second;
+			uint32_t offset = offsetIt->first;
+
+			this->m_freeListBySize.erase(smallestBlockIt);
+			this->m_freeListByOffset.erase(offsetIt);
+
+			if (blockSize > size)
+			{
+				this->AddNewBlock(offset + size, blockSize - size);
+			}
+
+			return offset;
+		}
+
+		void Free(uint32_t offset, uint32_t size)
+		{
+			auto nextBlockIt = this->m_freeListByOffset.upper_bound(offset);
+			auto prevBlockIt = nextBlockIt;
+			if (prevBlockIt != this->m_freeListByOffset.begin())
+			{
+				--prevBlockIt;
+			}
+			else
+			{
+				prevBlockIt = this->m_freeListByOffset.end();
+			}
+
+			if (prevBlockIt != this->m_freeListByOffset.end() &&
+				offset == prevBlockIt->first + prevBlockIt->second.Size)
+			{
+				offset = prevBlockIt->first;
+				size += prevBlockIt->second.Size;
+
+				this->m_freeListBySize.erase(prevBlockIt->second.FreeListBySizeIter);
+				this->m_freeListByOffset.erase(prevBlockIt);
+			}
+
+			if (nextBlockIt != this->m_freeListByOffset.end() &&
+				offset + size == nextBlockIt->first)
+			{
+				size += nextBlockIt->second.Size;
+
+				this->m_freeListBySize.erase(nextBlockIt->second.FreeListBySizeIter);
+				this->m_freeListByOffset.erase(nextBlockIt);
+			}
+
+			this->AddNewBlock(offset, size);
+		}
+
+	private:
+		struct FreeBlockInfo;
+		using FreeListByOffset = std::map<uint32_t, FreeBlockInfo>;
+		using FreeListBySize = std::multimap<uint32_t, FreeListByOffset::iterator>;
+
+		struct FreeBlockInfo
+		{
+			FreeBlockInfo(uint32_t size) : Size(size) {}
+
+			uint32_t Size;
+			FreeListBySize::iterator FreeListBySizeIter;
+		};
+
+		void AddNewBlock(uint32_t offset, uint32_t size)
+		{
+			auto offsetIt = this->m_freeListByOffset.emplace(offset, size);
+			auto sizeIt = this->m_freeListBySize.emplace(size, offsetIt.first);
+			offsetIt.first->second.FreeListBySizeIter = sizeIt;
+		}
+
+	private:
+		FreeListByOffset m_freeListByOffset;
+		FreeListBySize m_freeListBySize;
+	};
+
+	// Frees take the size, like DescriptorAllocatorPage's stale descriptors do.
+	class TlsfFreeList
+	{
+	public:
+		explicit TlsfFreeList(uint32_t capacity) : m_allocator(capacity) {}
+
+		uint32_t Allocate(uint32_t size) { return this->m_allocator.Allocate(size); }
+		void Free(uint32_t offset, uint32_t) { this->m_allocator.Free(offset); }
+
+	private:
+		TlsfAllocator m_allocator;
+	};
+
+	struct TraceOperation
+	{
+		bool IsAllocate;
+		uint32_t Size;     // Allocations only.
+		uint32_t Index;    // The allocation freed, counted in allocation order.
+	};
+
+	struct TraceDesc
+	{
+		const char* Name;
+		uint32_t Capacity;
+		uint32_t MaxSize;
+		uint32_t NumLive;     // Allocations kept alive once warmed up.
+	};
+
+	/**
+	 * Keeps NumLive allocations of random sizes alive, freeing a random one for every new one.
+	 * Small sizes are the most common, like descriptor tables of a few entries.
+	 */
+	std::vector<TraceOperation> BuildTrace(TraceDesc const& desc, uint32_t numOperations)
+	{
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		std::vector<TraceOperation> trace;
+		std::vector<uint32_t> live;
+		uint32_t numAllocations = 0;
+
+		while (trace.size() < numOperations)
+		{
+			if (live.size() < desc.NumLive)
+			{
+				float t = unit(random);
+				uint32_t size = 1 + static_cast<uint32_t>(t * t * t * (desc.MaxSize - 1));
+				trace.push_back({ true, size, numAllocations });
+				live.push_back(numAllocations++);
+			}
+			else
+			{
+				size_t victim = random() % live.size();
+				trace.push_back({ false, 0, live[victim] });
+				live[victim] = live.back();
+				live.pop_back();
+			}
+		}
+
+		return trace;
+	}
+
+	struct Result
+	{
+		double NanosecondsPerOperation;
+		uint32_t NumFailed;
+	};
+
+	template<class FreeList_>
+	Result Replay(TraceDesc const& desc, std::vector<TraceOperation> const& trace, uint32_t numRepeats)
+	{
+		struct Allocation
+		{
+			uint32_t Offset;
+			uint32_t Size;
+		};
+
+		std::vector<Allocation> allocations;
+		allocations.reserve(trace.size());
+
+		uint32_t numFailed = 0;
+		double seconds = 0.0;
+		for (uint32_t repeat = 0; repeat < numRepeats; repeat++)
+		{
+			FreeList_ freeList(desc.Capacity);
+			allocations.clear();
+			numFailed = 0;
+
+			seconds += Benchmark::MeasureSeconds([&] {
+				for (auto const& operation : trace)
+				{
+					if (operation.IsAllocate)
+					{
+						uint32_t offset = freeList.Allocate(operation.Size);
+						numFailed += offset == InvalidOffset;
+						allocations.push_back({ offset, operation.Size });
+					}
+					else if (allocations[operation.Index].Offset != InvalidOffset)
+					{
+						freeList.Free(allocations[operation.Index].Offset, allocations[operation.Index].Size);
+					}
+				}
+				});
+		}
+
+		return { seconds * 1e9 / (static_cast<double>(trace.size()) * numRepeats), numFailed };
+	}
+}
+
+// Allocate and free cost of the TLSF allocator against the map and multimap free lists it replaced.
+int main(int argc, char** argv)
+{
+	Log::Initialize();
+
+	const bool isQuick = Benchmark::IsQuick(argc, argv);
+	const uint32_t numOperations = isQuick ? 20000 : 2000000;
+	const uint32_t numRepeats = isQuick ? 1 : 5;
+
+	const TraceDesc traces[] = {
+		{ "Descriptor tables", 4096, 32, 256 },
+		{ "Large descriptor heap", 65536, 64, 2048 },
+		{ "Buffer blocks", 1 << 20, 4096, 512 },
+	};
+
+	Benchmark::Table table({ "Trace", "Map ns/op", "TLSF ns/op", "Speedup", "Map failed", "TLSF failed" });
+
+	for (auto const& desc : traces)
+	{
+		auto trace = BuildTrace(desc, numOperations);
+
+		Result map = Replay<MapFreeList>(desc, trace, numRepeats);
+		Result tlsf = Replay<TlsfFreeList>(desc, trace, numRepeats);
+
+		table.PrintRow({
+			desc.Name,
+			fmt::format("{:.1f}", map.NanosecondsPerOperation),
+			fmt::format("{:.1f}", tlsf.NanosecondsPerOperation),
+			fmt::format("{:.2f}x", map.NanosecondsPerOperation / tlsf.NanosecondsPerOperation),
+			fmt::format("{}", map.NumFailed),
+			fmt::format("{}", tlsf.NumFailed) });
+	}
+
+	printf("\nns/op: time per allocate or free. Failed: allocations that found no block large enough.\n");
+	return 0;
+}
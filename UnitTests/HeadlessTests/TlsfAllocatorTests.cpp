@@ -0,0 +1,112 @@
+#include "HeadlessTest.h"
+
+#include <random>
+#include <vector>
+
+#include "BitOperations.h"
+#include "TlsfAllocator.h"
+
+using namespace Core;
+
+HEADLESS_TEST(BitScansFindTheLowestAndHighestBit)
+{
+	CHECK(BitOperations::FindLowestBit(1u) == 0);
+	CHECK(BitOperations::FindHighestBit(1u) == 0);
+	CHECK(BitOperations::FindLowestBit(0x80000000u) == 31);
+	CHECK(BitOperations::FindHighestBit(0x80000000u) == 31);
+	CHECK(BitOperations::FindLowestBit(0x00f0f000u) == 12);
+	CHECK(BitOperations::FindHighestBit(0x00f0f000u) == 23);
+}
+
+HEADLESS_TEST(FillsToCapacityAndCoalescesOnFree)
+{
+	TlsfAllocator allocator(64);
+
+	std::vector<uint32_t> offsets;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		offsets.push_back(allocator.Allocate(4));
+		CHECK(offsets.back() != TlsfAllocator::InvalidOffset);
+	}
+
+	CHECK(allocator.GetNumFree() == 0);
+	CHECK(allocator.Allocate(1) == TlsfAllocator::InvalidOffset);
+
+	// Every other block, nothing larger than 4 fits until the neighbours are freed too.
+	for (size_t i = 0; i < offsets.size(); i += 2)
+	{
+		CHECK(allocator.Free(offsets[i]) == 4);
+	}
+
+	CHECK(allocator.GetNumFree() == 32);
+	CHECK(allocator.GetLargestFreeBlock() == 4);
+	CHECK(!allocator.HasSpace(5));
+
+	for (size_t i = 1; i < offsets.size(); i += 2)
+	{
+		allocator.Free(offsets[i]);
+	}
+
+	CHECK(allocator.GetNumFreeBlocks() == 1);
+	CHECK(allocator.GetLargestFreeBlock() == 64);
+	CHECK(allocator.Allocate(64) == 0);
+}
+
+HEADLESS_TEST(RandomTraceNeverOverlaps)
+{
+	constexpr uint32_t Capacity = 4096;
+	TlsfAllocator allocator(Capacity);
+
+	struct Allocation
+	{
+		uint32_t Offset;
+		uint32_t Size;
+	};
+
+	std::vector<bool> isUsed(Capacity, false);
+	std::vector<Allocation> live;
+	uint32_t numUsed = 0;
+
+	std::mt19937 random(42);
+	for (uint32_t i = 0; i < 20000; i++)
+	{
+		if (live.empty() || random() % 2 == 0)
+		{
+			uint32_t size = 1 + random() % 96;
+			uint32_t offset = allocator.Allocate(size);
+			if (offset == TlsfAllocator::InvalidOffset)
+			{
+				// Only fails when no free block is large enough.
+				CHECK(!allocator.HasSpace(size));
+				continue;
+			}
+
+			CHECK(offset + size <= Capacity);
+			for (uint32_t unit = offset; unit < offset + size && unit < Capacity; unit++)
+			{
+				CHECK(!isUsed[unit]);
+				isUsed[unit] = true;
+			}
+
+			live.push_back({ offset, size });
+			numUsed += size;
+		}
+		else
+		{
+			size_t victim = random() % live.size();
+			Allocation allocation = live[victim];
+			live[victim] = live.back();
+			live.pop_back();
+
+			CHECK(allocator.Free(allocation.Offset) == allocation.Size);
+			for (uint32_t unit = allocation.Offset; unit < allocation.Offset + allocation.Size; unit++)
+			{
+				isUsed[unit] = false;
+			}
+
+			numUsed -= allocation.Size;
+		}
+
+		CHECK(allocator.GetNumFree() == Capacity - numUsed);
+	}
+}
@@ -0,0 +1,140 @@
+#include "HeadlessTest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingDeque.h"
+
+using namespace Core;
+
+HEADLESS_TEST(OwnerPopsLastPushedFirst)
+{
+	WorkStealingDeque<uint32_t> deque(8);
+	for (uint32_t i = 0; i < 5; i++)
+	{
+		CHECK(deque.Push(i));
+	}
+
+	CHECK(deque.Size() == 5);
+
+	uint32_t value;
+	for (uint32_t i = 5; i-- > 0;)
+	{
+		CHECK(deque.Pop(value));
+		CHECK(value == i);
+	}
+
+	CHECK(!deque.Pop(value));
+	CHECK(deque.Size() == 0);
+}
+
+HEADLESS_TEST(ThievesStealFirstPushedFirst)
+{
+	WorkStealingDeque<uint32_t> deque(8);
+	for (uint32_t i = 0; i < 5; i++)
+	{
+		deque.Push(i);
+	}
+
+	uint32_t value;
+	CHECK(deque.Steal(value) && value == 0);
+	CHECK(deque.Steal(value) && value == 1);
+	CHECK(deque.Pop(value) && value == 4);
+	CHECK(deque.Size() == 2);
+}
+
+HEADLESS_TEST(PushFailsOnceFull)
+{
+	// Rounded up to 8.
+	WorkStealingDeque<uint32_t> deque(5);
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		CHECK(deque.Push(i));
+	}
+
+	CHECK(!deque.Push(8));
+
+	// A steal frees a slot for the owner.
+	uint32_t value;
+	CHECK(deque.Steal(value));
+	CHECK(deque.Push(8));
+}
+
+HEADLESS_TEST(WrapsAroundTheBuffer)
+{
+	WorkStealingDeque<uint32_t> deque(4);
+
+	uint32_t value;
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		CHECK(deque.Push(i));
+		CHECK(deque.Push(i + 1000));
+		CHECK(deque.Steal(value) && value == i);
+		CHECK(deque.Pop(value) && value == i + 1000);
+	}
+
+	CHECK(!deque.Steal(value));
+}
+
+HEADLESS_TEST(EveryValueIsTakenOnceUnderContention)
+{
+	constexpr uint32_t NumValues = 200000;
+	constexpr uint32_t NumThieves = 4;
+
+	WorkStealingDeque<uint32_t> deque(1024);
+	std::vector<std::atomic_uint8_t> taken(NumValues);
+	std::atomic_bool isPushing(true);
+
+	std::vector<std::thread> thieves;
+	for (uint32_t i = 0; i < NumThieves; i++)
+	{
+		thieves.emplace_back([&] {
+			uint32_t value;
+			while (isPushing || deque.Size() > 0)
+			{
+				if (deque.Steal(value))
+				{
+					taken[value]++;
+				}
+			}
+			});
+	}
+
+	// The owner pops every third value itself, racing the thieves for the last one.
+	uint32_t value;
+	for (uint32_t i = 0; i < NumValues; i++)
+	{
+		while (!deque.Push(i))
+		{
+			if (deque.Pop(value))
+			{
+				taken[value]++;
+			}
+		}
+
+		if (i % 3 == 0 && deque.Pop(value))
+		{
+			taken[value]++;
+		}
+	}
+
+	while (deque.Pop(value))
+	{
+		taken[value]++;
+	}
+
+	isPushing = false;
+	for (auto& thief : thieves)
+	{
+		thief.join();
+	}
+
+	uint32_t numTakenOnce = 0;
+	for (auto const& count : taken)
+	{
+		numTakenOnce += count == 1 ? 1 : 0;
+	}
+
+	CHECK(numTakenOnce == NumValues);
+}
@@ -175,7 +175,7 @@ void LightingApp::LoadContent()
 
     this->CreatePipelineStateObjects();
 
-    copyQueue->WaitForFenceValue(uploadFence);
+    this->m_renderDevice->GetQueue()->Wait(*copyQueue, uploadFence);
 }
 
 void LightingApp::Update(double deltaTime)
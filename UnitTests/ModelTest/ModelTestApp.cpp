@@ -52,6 +52,16 @@ struct DirectionLight
     float padding = 0.0f;
 };
 
+namespace
+{
+    // Enough draws that recording them on one thread shows up in the frame time.
+    constexpr uint32_t CubeGridSize = 64;
+    constexpr float CubeSpacing = 0.25f;
+    constexpr float CubeScale = 0.1f;
+
+    constexpr uint32_t NumDrawChunks = 8;
+}
+
 void XM_CALLCONV ComputeMatrices(FXMMATRIX model, CXMMATRIX view, CXMMATRIX viewProjection, Matrices& mat)
 {
     mat.ModelMatrix = model;
@@ -74,6 +84,9 @@ protected:
 private:
     void CreatePipelineStateObjects();
 
+    // Records the chunk's share of the cube grid.
+    void XM_CALLCONV RecordCubes(CommandList& commandList, uint32_t chunk, FXMMATRIX viewMatrix, CXMMATRIX viewProjectionMatrix);
+
 private:
     Microsoft::WRL::ComPtr<ID3D12PipelineState> m_pso;
     std::unique_ptr<RootSignature> m_rootSignature;
@@ -176,7 +189,7 @@ void ModelTestApp::LoadContent()
 
     this->CreatePipelineStateObjects();
 
-    copyQueue->WaitForFenceValue(uploadFence);
+    this->m_renderDevice->GetQueue()->Wait(*copyQueue, uploadFence);
 }
 
 void ModelTestApp::Update(double deltaTime)
@@ -185,48 +198,70 @@ void ModelTestApp::Update(double deltaTime)
 
 void ModelTestApp::RenderScene(Dx12Texture& sceneTexture)
 {
-    auto commandList = this->m_renderDevice->GetQueue()->GetCommandList();
+    XMMATRIX viewMatrix = this->m_camera.GetViewMatrix();
+    XMMATRIX viewProjectionMatrix = viewMatrix * this->m_camera.GetProjectionMatrix();
+
+    // Each chunk records a slice of the cube grid on a worker, the chunks are submitted in order.
+    auto commandQueue = this->m_renderDevice->GetQueue();
+    commandQueue->ExecuteParallel(
+        this->GetTaskScheduler(),
+        NumDrawChunks,
+        [&](CommandList& commandList, uint32_t chunk) {
+            // The first chunk is submitted first, so it clears for everyone.
+            if (chunk == 0)
+            {
+                commandList.ClearRenderTarget(
+                    this->m_sceneRenderTarget.GetTexture(Color0),
+                    this->m_clearValue);
+
+                commandList.ClearDepthStencilTexture(
+                    this->m_sceneRenderTarget.GetTexture(AttachmentPoint::DepthStencil),
+                    D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL);
+            }
+
+            this->RecordCubes(commandList, chunk, viewMatrix, viewProjectionMatrix);
+        });
 
-    commandList->ClearRenderTarget(
-        this->m_sceneRenderTarget.GetTexture(Color0),
-        this->m_clearValue);
+    sceneTexture.SetDx12Resource(this->m_sceneRenderTarget.GetTexture(Color0).GetDx12Resource());
+}
 
-    commandList->ClearDepthStencilTexture(
-            this->m_sceneRenderTarget.GetTexture(AttachmentPoint::DepthStencil),
-            D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL);
+void XM_CALLCONV ModelTestApp::RecordCubes(CommandList& commandList, uint32_t chunk, FXMMATRIX viewMatrix, CXMMATRIX viewProjectionMatrix)
+{
+    // Every chunk starts from a reset command list and binds its own state.
+    CD3DX12_VIEWPORT viewport = CD3DX12_VIEWPORT(0.0f, 0.0f, this->m_window->GetWidth(), this->m_window->GetHeight());
+    commandList.SetViewport(viewport);
 
-    static CD3DX12_VIEWPORT viewport = CD3DX12_VIEWPORT(0.0f, 0.0f, this->m_window->GetWidth(), this->m_window->GetHeight());
-    commandList->SetViewport(viewport);
+    CD3DX12_RECT rect = CD3DX12_RECT(0, 0, LONG_MAX, LONG_MAX);
+    commandList.SetScissorRect(rect);
 
-    static CD3DX12_RECT rect = CD3DX12_RECT(0, 0, LONG_MAX, LONG_MAX);
-    commandList->SetScissorRect(rect);
+    commandList.SetRenderTarget(this->m_sceneRenderTarget);
 
-    // Set Render Target
-    commandList->SetRenderTarget(this->m_sceneRenderTarget);
+    commandList.SetGraphicsRootSignature(*this->m_rootSignature);
+    commandList.SetPipelineState(this->m_pso);
 
-    commandList->SetGraphicsRootSignature(*this->m_rootSignature);
-    commandList->SetPipelineState(this->m_pso);
+    commandList.SetGraphicsDynamicConstantBuffer(PbrRootParameters::MaterialCB, this->m_material);
+    commandList.SetGraphicsDynamicConstantBuffer(PbrRootParameters::DirectionLightCB, this->m_directionLighting);
+    commandList.SetShaderResourceView(PbrRootParameters::Textures, 0, *this->m_texture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 
-    // Set Matrix data
-    XMMATRIX translationMatrix = XMMatrixTranslation(0.0f, 0.0f, 0.0f);
-    XMMATRIX rotationMatrix = XMMatrixIdentity();
-    XMMATRIX scaleMatrix = XMMatrixScaling(1.0f, 1.0f, 1.0f);
-    XMMATRIX worldMatrix = scaleMatrix * rotationMatrix * translationMatrix;
-    XMMATRIX viewMatrix = this->m_camera.GetViewMatrix();
-    XMMATRIX viewProjectionMatrix = viewMatrix * this->m_camera.GetProjectionMatrix();
+    const uint32_t numCubes = CubeGridSize * CubeGridSize;
+    const uint32_t cubesPerChunk = (numCubes + NumDrawChunks - 1) / NumDrawChunks;
+    const uint32_t begin = chunk * cubesPerChunk;
+    const uint32_t end = std::min(begin + cubesPerChunk, numCubes);
 
-    Matrices matrices;
-    ComputeMatrices(worldMatrix, viewMatrix, viewProjectionMatrix, matrices);
-    commandList->SetGraphicsDynamicConstantBuffer(PbrRootParameters::MatricesCB, matrices);
-    commandList->SetGraphicsDynamicConstantBuffer(PbrRootParameters::MaterialCB, this->m_material);
-    commandList->SetGraphicsDynamicConstantBuffer(PbrRootParameters::DirectionLightCB, this->m_directionLighting);
+    for (uint32_t i = begin; i < end; i++)
+    {
+        float x = (static_cast<float>(i % CubeGridSize) - 0.5f * (CubeGridSize - 1)) * CubeSpacing;
+        float z = (static_cast<float>(i / CubeGridSize) - 0.5f * (CubeGridSize - 1)) * CubeSpacing;
 
-    commandList->SetShaderResourceView(PbrRootParameters::Textures, 0, *this->m_texture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        XMMATRIX scaleMatrix = XMMatrixScaling(CubeScale, CubeScale, CubeScale);
+        XMMATRIX worldMatrix = scaleMatrix * XMMatrixTranslation(x, 0.0f, z);
 
-    this->m_cubeMesh->Draw(*commandList);
+        Matrices matrices;
+        ComputeMatrices(worldMatrix, viewMatrix, viewProjectionMatrix, matrices);
+        commandList.SetGraphicsDynamicConstantBuffer(PbrRootParameters::MatricesCB, matrices);
 
-    this->m_renderDevice->GetQueue()->ExecuteCommandList(commandList);
-    sceneTexture.SetDx12Resource(this->m_sceneRenderTarget.GetTexture(Color0).GetDx12Resource());
+        this->m_cubeMesh->Draw(commandList);
+    }
 }
 
 void ModelTestApp::RenderUI()
@@ -126,7 +126,7 @@ void TexturedTriangleTestApp::LoadContent()
 
     this->CreatePipelineStateObjects();
 
-    copyQueue->WaitForFenceValue(uploadFence);
+    this->m_renderDevice->GetQueue()->Wait(*copyQueue, uploadFence);
 }
 
 void TexturedTriangleTestApp::Update(double deltaTime)